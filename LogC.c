@@ -1,3 +1,6 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE /* For O_DIRECT */
+#endif /* __linux__ */
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,6 +9,9 @@
 #include <errno.h>
 #include <limits.h>
 #include "LogC.h"
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  #include "LogC_Index.h"
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
 
 #ifndef LOGC_LIBRARY_DEBUG
   #define NDEBUG
@@ -21,6 +27,8 @@
 #define LOGC_PREFIX_FORMAT_FILEFCTNAME  LOGC_PREFIX_FORMAT_FILEINFO ", " LOGC_PREFIX_FORMAT_FCTNAME
 
 #define LOGC_TEXT_UNKNOWN "???"
+#define LOGC_TEXT_DROPPED "[LogC] %llu entries dropped\n" /* Marker entry after entries were dropped */
+#define LOGC_BACKPRESSURE_WAIT_MAX_MS 64 /* Maximum wait between two retries of a blocked entry */
 
 #ifdef _WIN32
   #define WIN32_LEAN_AND_MEAN /* Avoid include of useless windows headers */
@@ -32,7 +40,31 @@
     #define LOGC_MUTEX_DESTROY(log) do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) DeleteCriticalSection(&(log)->tMutex);     }while(0)
     #define LOGC_MUTEX_LOCK(log)    do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) EnterCriticalSection(&(log)->tMutex);      }while(0)
     #define LOGC_MUTEX_UNLOCK(log)  do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) LeaveCriticalSection(&(log)->tMutex);      }while(0)
+    typedef CONDITION_VARIABLE TCond;
+    #define LOGC_COND_INIT(log,cond)      do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) InitializeConditionVariable(&(log)->cond);                     }while(0)
+    #define LOGC_COND_DESTROY(log,cond)   do{ }while(0) /* Nothing to do for Win32 condition variables */
+    #define LOGC_COND_WAIT(log,cond)      do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) SleepConditionVariableCS(&(log)->cond,&(log)->tMutex,INFINITE); }while(0)
+    #define LOGC_COND_BROADCAST(log,cond) do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) WakeAllConditionVariable(&(log)->cond);                        }while(0)
   #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+  #ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    #include <io.h>    /* For _open(), _commit() */
+    #include <fcntl.h>
+    #include <sys/types.h>
+    #include <sys/stat.h> /* For _stati64() */
+    #define LOGC_FILE_CLOSE(fd) _close(fd)
+  #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+  #ifdef LOGC_FEATURE_ENABLE_SHM
+    #error LOGC_FEATURE_ENABLE_SHM is just available for POSIX systems!
+  #endif /* LOGC_FEATURE_ENABLE_SHM */
+  #ifdef LOGC_FEATURE_ENABLE_FILECACHE
+    #error LOGC_FEATURE_ENABLE_FILECACHE is just available for POSIX systems!
+  #endif /* LOGC_FEATURE_ENABLE_FILECACHE */
+  #ifdef LOGC_FEATURE_ENABLE_SOCKET
+    #error LOGC_FEATURE_ENABLE_SOCKET is just available for POSIX systems!
+  #endif /* LOGC_FEATURE_ENABLE_SOCKET */
+  #ifdef LOGC_FEATURE_ENABLE_PERCPU
+    #error LOGC_FEATURE_ENABLE_PERCPU is just available for Linux!
+  #endif /* LOGC_FEATURE_ENABLE_PERCPU */
 #elif defined(__unix__)
   #include <unistd.h> /* For determining the current POSIX-Version, etc. */
   #if defined(_POSIX_VERSION) && (_POSIX_VERSION >= 200112L) /* POSIX IEEE 1003.1-2001 or newer */
@@ -47,7 +79,70 @@
       #define LOGC_MUTEX_DESTROY(log) do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) assert(!pthread_mutex_destroy(&(log)->tMutex));   }while(0)
       #define LOGC_MUTEX_LOCK(log)    do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) assert(!pthread_mutex_lock(&(log)->tMutex));      }while(0)
       #define LOGC_MUTEX_UNLOCK(log)  do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) assert(!pthread_mutex_unlock(&(log)->tMutex));    }while(0)
+      typedef pthread_cond_t TCond;
+      #define LOGC_COND_INIT(log,cond)      do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) pthread_cond_init(&(log)->cond,NULL);          }while(0)
+      #define LOGC_COND_DESTROY(log,cond)   do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) pthread_cond_destroy(&(log)->cond);            }while(0)
+      #define LOGC_COND_WAIT(log,cond)      do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) pthread_cond_wait(&(log)->cond,&(log)->tMutex); }while(0)
+      #define LOGC_COND_BROADCAST(log,cond) do{ if(((log)->uiLogOptions&LOGC_OPTION_THREADSAFE)) pthread_cond_broadcast(&(log)->cond);          }while(0)
     #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+    #ifdef LOGC_FEATURE_ENABLE_LOGFILE
+      #include <fcntl.h> /* For open(), fdatasync() */
+      #include <sys/stat.h> /* For stat() */
+      #define LOGC_FILE_CLOSE(fd) close(fd)
+    #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+    #ifdef LOGC_FEATURE_ENABLE_IOURING
+      #ifndef __linux__
+        #error LOGC_FEATURE_ENABLE_IOURING is just available for Linux!
+      #endif /* __linux__ */
+      #ifndef LOGC_FEATURE_ENABLE_LOGFILE
+        #error LOGC_FEATURE_ENABLE_IOURING needs LOGC_FEATURE_ENABLE_LOGFILE!
+      #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+      #include <sys/syscall.h>
+      #include <sys/mman.h>
+      #include <sys/uio.h>
+      #include <linux/io_uring.h>
+    #endif /* LOGC_FEATURE_ENABLE_IOURING */
+    #if defined(LOGC_FEATURE_ENABLE_LOGFILE) && defined(__linux__)
+      #include <sys/stat.h>
+      #define LOGC_FILEMODE_DIRECT_AVAILABLE /* O_DIRECT is available */
+    #endif /* LOGC_FEATURE_ENABLE_LOGFILE && __linux__ */
+    #ifdef LOGC_FEATURE_ENABLE_LOGFILE
+      #define LOGC_FILEMODE_APPEND_AVAILABLE /* Single write() calls with O_APPEND */
+    #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+    #ifdef LOGC_FEATURE_ENABLE_FILECACHE
+      #ifndef LOGC_FEATURE_ENABLE_LOGFILE
+        #error LOGC_FEATURE_ENABLE_FILECACHE needs LOGC_FEATURE_ENABLE_LOGFILE!
+      #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+      #include <sys/uio.h> /* For writev() */
+    #endif /* LOGC_FEATURE_ENABLE_FILECACHE */
+    #ifdef LOGC_FEATURE_ENABLE_SHM
+      #include <fcntl.h>    /* For O_CREAT, etc. */
+      #include <sys/mman.h> /* For shm_open(), mmap() */
+      #include <sys/stat.h>
+      #include <signal.h>   /* For kill() */
+      #include "LogC_Shm.h"
+    #endif /* LOGC_FEATURE_ENABLE_SHM */
+    #ifdef LOGC_FEATURE_ENABLE_SOCKET
+      #include <fcntl.h>
+      #include <sys/socket.h>
+      #include <sys/un.h>
+      #ifndef MSG_NOSIGNAL
+        #define MSG_NOSIGNAL 0 /* Not available, SIGPIPE must be ignored by the application then */
+      #endif /* MSG_NOSIGNAL */
+    #endif /* LOGC_FEATURE_ENABLE_SOCKET */
+    #ifdef LOGC_FEATURE_ENABLE_PERCPU
+      #ifndef __linux__
+        #error LOGC_FEATURE_ENABLE_PERCPU is just available for Linux!
+      #endif /* __linux__ */
+      #include <sched.h>    /* For sched_getcpu() */
+      #include <sys/mman.h>
+    #endif /* LOGC_FEATURE_ENABLE_PERCPU */
+    #if (defined(LOGC_FEATURE_ENABLE_TRACE) || defined(LOGC_FEATURE_ENABLE_CONTEXT)) && defined(__linux__)
+      #include <sys/syscall.h> /* For SYS_gettid */
+    #endif /* (LOGC_FEATURE_ENABLE_TRACE || LOGC_FEATURE_ENABLE_CONTEXT) && __linux__ */
+    #ifdef LOGC_FEATURE_ENABLE_CONTEXT
+      #include <pthread.h> /* For pthread_atfork() */
+    #endif /* LOGC_FEATURE_ENABLE_CONTEXT */
   #else
     #error POSIX Version too old, must be POSIX IEEE 1003.1-2001 or newer.
   #endif
@@ -60,8 +155,41 @@
   #define LOGC_MUTEX_DESTROY(log)
   #define LOGC_MUTEX_LOCK(log)
   #define LOGC_MUTEX_UNLOCK(log)
+  #define LOGC_COND_INIT(log,cond)
+  #define LOGC_COND_DESTROY(log,cond)
+  #define LOGC_COND_WAIT(log,cond)
+  #define LOGC_COND_BROADCAST(log,cond)
 #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
 
+#if defined(LOGC_FEATURE_ENABLE_ENGINE) && (!defined(LOGC_FEATURE_ENABLE_LOGFILE) || !defined(LOGC_FEATURE_ENABLE_THREADSAFETY))
+  #error LOGC_FEATURE_ENABLE_ENGINE needs LOGC_FEATURE_ENABLE_LOGFILE and LOGC_FEATURE_ENABLE_THREADSAFETY!
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+#if defined(LOGC_FEATURE_ENABLE_LOGFILE) && defined(LOGC_FEATURE_ENABLE_THREADSAFETY)
+  #define LOGC_FILEQUEUE_SWAP /* Full filequeues of threadsafe Log-Objects are written without holding the mutex */
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE && LOGC_FEATURE_ENABLE_THREADSAFETY */
+#if defined(LOGC_FEATURE_ENABLE_FLUSHTIMER) && (!defined(LOGC_FEATURE_ENABLE_LOGFILE) || !defined(LOGC_FEATURE_ENABLE_THREADSAFETY))
+  #error LOGC_FEATURE_ENABLE_FLUSHTIMER needs LOGC_FEATURE_ENABLE_LOGFILE and LOGC_FEATURE_ENABLE_THREADSAFETY!
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+#if defined(LOGC_FEATURE_ENABLE_PERCPU) && !defined(LOGC_FEATURE_ENABLE_THREADSAFETY)
+  #error LOGC_FEATURE_ENABLE_PERCPU needs LOGC_FEATURE_ENABLE_THREADSAFETY!
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+#if defined(LOGC_FEATURE_ENABLE_TRACE) && !defined(LOGC_FEATURE_ENABLE_THREADSAFETY)
+  #error LOGC_FEATURE_ENABLE_TRACE needs LOGC_FEATURE_ENABLE_THREADSAFETY!
+#endif /* LOGC_FEATURE_ENABLE_TRACE */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #include <x86intrin.h> /* For __rdtsc() */
+  #include <cpuid.h>
+  #define LOGC_TSC_AVAILABLE
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h> /* For __rdtsc(), __cpuid() */
+  #define LOGC_TSC_AVAILABLE
+#endif /* __GNUC__ && x86 */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP>=2))
+  #include <emmintrin.h> /* For the hexdump encoder */
+  #define LOGC_HEX_SSE2
+#endif /* __SSE2__ */
+
 #define BITS_UNSET(val,bitmap) (val&(~(bitmap)))
 #define LOGC_OPTIONS_ENABLED(log,option) (((log)->uiLogOptions&(option))==(option))
 
@@ -75,6 +203,115 @@
 
 #define LOGC_PATH_MAXLEN           260 /* Should be enough for any usual cases */
 #define LOGC_DEFAULT_FILEQUEUESIZE 10
+#define LOGC_HEXDUMP_TEXT_MAXLEN   256 /* Text of a hexdump including '\0', it's repeated in each continuation entry */
+
+#define LOGC_TIMESTAMP_FRACTIONS (LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MILLISECS|LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MICROSECS|LOGC_OPTION_PREFIX_TIMESTAMP_TIME_NANOSECS)
+#ifdef LOGC_FEATURE_ENABLE_CONTEXT
+  #define LOGC_OPTIONS_PREFIX (0x00FF|LOGC_OPTION_PREFIX_THREADID|LOGC_OPTION_PREFIX_CONTEXT) /* All LOGC_OPTION_PREFIX_XXX bits */
+#else
+  #define LOGC_OPTIONS_PREFIX 0x00FF
+#endif /* LOGC_FEATURE_ENABLE_CONTEXT */
+#define LOGC_OPTIONS_OTHER (0xFF00&~LOGC_OPTIONS_PREFIX) /* Bits of LogC_SetLogOptions() and LOGC_OPTION_THREADSAFE */
+#define LOGC_TIMESTAMP_TSC_CALIBRATE_MS 10
+
+/**
+ * Offsets to convert the selected clock to the wall clock, @see LogC_SetTimeSource().
+ */
+typedef struct
+{
+  int iTimeSource;
+  long long llOffsetNs;         /* Wall clock minus monotonic clock, for LOGC_TIMESOURCE_MONOTONIC */
+#ifdef LOGC_TSC_AVAILABLE
+  unsigned long long ullTscBase; /* TSC and wall clock at calibration, for LOGC_TIMESOURCE_TSC */
+  unsigned long long ullTscBaseNs;
+  double dTscNsPerTick;
+#endif /* LOGC_TSC_AVAILABLE */
+}TagLogCTimeBase;
+
+/**
+ * Text of an entry, either a printf format with its arguments or an already formatted text.
+ * A hexdump payload may be appended behind the text, as much as fits into one entry.
+ */
+typedef struct
+{
+  const char *pcFormat;         /* NULL if pcText is used */
+  va_list *pvaArgs;
+  const char *pcText;           /* Not terminated */
+  size_t szTextLength;
+  const unsigned char *pucData; /* Rest of the payload, NULL if there's none */
+  size_t szDataLength;
+  size_t szDataOffset;          /* Offset of pucData in the whole payload */
+  size_t szDataTotal;
+  size_t szDataAdded;           /* Returns the count of bytes added to the entry */
+  unsigned long long ullTimeNs; /* Time of the entry, 0 for now */
+}TagLogCMessage;
+
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+/**
+ * Stages measured with LOGC_PROFILE_START()/LOGC_PROFILE_END(), @see LogC_DumpProfile().
+ */
+enum
+{
+  LOGC_PROFILE_ADDENTRY,
+  LOGC_PROFILE_LOCK,
+  LOGC_PROFILE_TIMESTAMP,
+  LOGC_PROFILE_PREFIX,
+  LOGC_PROFILE_FORMAT,
+  LOGC_PROFILE_PRINT,
+  LOGC_PROFILE_FILEWRITE,
+  LOGC_PROFILE_FILESYNC,
+  LOGC_PROFILE_STAGES
+};
+static const char *const pcaLogCProfileStages_m[LOGC_PROFILE_STAGES]=
+{
+  "addentry","lock","timestamp","prefix","format","print","filewrite","filesync"
+};
+#define LOGC_PROFILE_SUBBITS 2 /* 4 linear buckets per power of 2 */
+#define LOGC_PROFILE_BUCKETS ((64-LOGC_PROFILE_SUBBITS+1)<<LOGC_PROFILE_SUBBITS)
+#ifdef LOGC_TSC_AVAILABLE
+  #define LOGC_PROFILE_UNIT "cycles"
+#else
+  #define LOGC_PROFILE_UNIT "ns"
+#endif /* LOGC_TSC_AVAILABLE */
+/* Stages may be measured without holding the mutex, e.g. while syncing or adding to the per-CPU buffers */
+#ifdef _MSC_VER
+  #define LOGC_PROFILE_ADD(ptr,val)   _InterlockedExchangeAdd64((volatile long long*)(ptr),(long long)(val))
+  #define LOGC_PROFILE_LOAD(ptr)      ((unsigned long long)_InterlockedCompareExchange64((volatile long long*)(ptr),0,0))
+  #define LOGC_PROFILE_STORE(ptr,val) _InterlockedExchange64((volatile long long*)(ptr),(long long)(val))
+#else /* __GNUC__ */
+  #define LOGC_PROFILE_ADD(ptr,val)   __atomic_fetch_add((ptr),(val),__ATOMIC_RELAXED)
+  #define LOGC_PROFILE_LOAD(ptr)      __atomic_load_n((ptr),__ATOMIC_RELAXED)
+  #define LOGC_PROFILE_STORE(ptr,val) __atomic_store_n((ptr),(val),__ATOMIC_RELAXED)
+#endif /* _MSC_VER */
+#define LOGC_PROFILE_VAR(var)           unsigned long long var;
+#define LOGC_PROFILE_START(var)         (var)=ullLogC_ProfileTicks_m()
+#define LOGC_PROFILE_END(log,stage,var) vLogC_ProfileAdd_m((log),(stage),ullLogC_ProfileTicks_m()-(var))
+
+/**
+ * Log-linear histogram of one stage, the buckets below 4 hold one value each,
+ * above each power of 2 is split into 4 buckets of the same width.
+ */
+typedef struct
+{
+  unsigned long long ullTotal;
+  unsigned long long ullaBuckets[LOGC_PROFILE_BUCKETS];
+}TagLogCProfile;
+#else /* Compiled out completely */
+  #define LOGC_PROFILE_VAR(var)
+  #define LOGC_PROFILE_START(var)
+  #define LOGC_PROFILE_END(log,stage,var)
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
+
+/**
+ * Date and time text of the last second, so strftime() is just called once per second.
+ */
+typedef struct
+{
+  unsigned long long ullSecond; /* Seconds since the epoch of caText */
+  unsigned int uiOptions;       /* Date/time and timezone options of caText, 0 if not set */
+  size_t szLength;
+  char caText[32];
+}TagLogCTimeCache;
 
 typedef enum
 {
@@ -97,6 +334,435 @@ static const struct TagLogType
   {LOGC_FATAL,      LOGC_STDERR, "Fatal"},
 };
 
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+#define LOGC_IOURING_ENTRIES 4
+#define LOGC_IOURING_BUFFERS 2 /* One write in flight and one buffer for the next write, not more than LOGC_IOURING_ENTRIES */
+/**
+ * io_uring instance of a logfile, the filequeue is copied into the next of the registered buffers
+ * and submitted, the write completes while the next filequeue is filled. Completions are reaped lazily.
+ * The logfile is opened with O_APPEND, so other writers of the same logfile (other Log-Objects or processes)
+ * don't overwrite the entries. Appends in flight at the same time may reach the file in any order
+ * and linked writes are just ordered within one submission, so just one write is in flight:
+ * it's completed before the next one is submitted.
+ */
+typedef struct
+{
+  int iRingFd;
+  int iFileFd;
+  void *pvSqRing;
+  size_t szSqRingSize;
+  void *pvCqRing;
+  size_t szCqRingSize;
+  struct io_uring_sqe *ptagSqes;
+  size_t szSqesSize;
+  unsigned int *puiSqHead;
+  unsigned int *puiSqTail;
+  unsigned int *puiSqMask;
+  unsigned int *puiSqArray;
+  unsigned int *puiCqHead;
+  unsigned int *puiCqTail;
+  unsigned int *puiCqMask;
+  struct io_uring_cqe *ptagCqes;
+  char *pcaBuffers[LOGC_IOURING_BUFFERS];
+  size_t szaLengths[LOGC_IOURING_BUFFERS];             /* Length of the write in flight, 0 if the buffer is free */
+  size_t szBufferSize;
+  unsigned int uiNextBuffer;         /* Buffer to be filled with the next write */
+  unsigned int uiInFlight;           /* Count of submitted writes, which are not reaped yet */
+}TagLogCUring;
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+#define LOGC_DIRECT_BLOCKSIZE  4096
+#define LOGC_DIRECT_BUFFERSIZE (64*LOGC_DIRECT_BLOCKSIZE) /* Minimum size, see ptagLogC_DirectNew_m() */
+/**
+ * Logfile written with O_DIRECT, the entries are collected in an aligned buffer,
+ * pcBuffer[0] is always at the block aligned offset tFileOffset in the file.
+ * A partial block at the end stays in the buffer and is rewritten with the next write.
+ */
+typedef struct
+{
+  int iFileFd;
+  char *pcBuffer;
+  size_t szBufferSize;
+  size_t szBufferLength;
+  off_t tFileOffset;
+}TagLogCDirect;
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+#ifdef PIPE_BUF
+  #define LOGC_APPEND_WRITESIZE PIPE_BUF /* Writes up to this size are never interleaved, even if the logfile is a FIFO */
+#else
+  #define LOGC_APPEND_WRITESIZE 512      /* Minimum PIPE_BUF of POSIX */
+#endif /* PIPE_BUF */
+/**
+ * Logfile kept open with O_APPEND, the entries are collected in the buffer and
+ * each filled buffer is written with one write(), so it always ends with a complete entry.
+ */
+typedef struct
+{
+  int iFileFd;
+  char *pcBuffer;
+  size_t szBufferSize; /* LOGC_APPEND_WRITESIZE, or the size of one entry if it's larger */
+}TagLogCAppend;
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+
+#ifdef LOGC_FEATURE_ENABLE_FILECACHE
+#define LOGC_FILECACHE_BUCKETS_MIN 64
+#define LOGC_FILECACHE_IOVECS      64 /* Entries per writev() call */
+/**
+ * Descriptor of a logfile opened with O_APPEND, kept open for the next writes to the same path.
+ */
+typedef struct TagLogCFileCacheEntry
+{
+  struct TagLogCFileCacheEntry *ptagHashNext;
+  struct TagLogCFileCacheEntry *ptagPrev;     /* LRU list, most recently used first */
+  struct TagLogCFileCacheEntry *ptagNext;
+  int iFileFd;
+  size_t szUsers;                             /* Writes in progress, the descriptor isn't closed while set */
+  int iDropped;                               /* Removed from the cache while in use, closed by the last release */
+  size_t szHash;
+  char caPath[LOGC_PATH_MAXLEN];
+}TagLogCFileCacheEntry;
+
+/**
+ * The descriptor cache, just one per process and shared by all Log-Objects, @see LogC_SetFileCache().
+ * The mutex is just held to look up the descriptor, not while writing.
+ */
+typedef struct
+{
+  size_t szMaxFiles;                          /* 0 if disabled */
+  size_t szCount;
+  TagLogCFileCacheEntry **pptagBuckets;
+  size_t szBuckets;                           /* Power of 2 */
+  TagLogCFileCacheEntry *ptagFirst;
+  TagLogCFileCacheEntry *ptagLast;
+}TagLogCFileCache;
+static TagLogCFileCache tagFileCache_m;
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+static pthread_mutex_t tFileCacheMutex_m=PTHREAD_MUTEX_INITIALIZER;
+  #define LOGC_FILECACHE_LOCK()   pthread_mutex_lock(&tFileCacheMutex_m)
+  #define LOGC_FILECACHE_UNLOCK() pthread_mutex_unlock(&tFileCacheMutex_m)
+#else
+  #define LOGC_FILECACHE_LOCK()
+  #define LOGC_FILECACHE_UNLOCK()
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+#endif /* LOGC_FEATURE_ENABLE_FILECACHE */
+
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+/**
+ * Additional logfile for a range of logtypes, @see LogC_SetFileRoutes().
+ * The queues have the same layout as the filequeue and are swapped like it, the logfile is written with normal writes.
+ */
+typedef struct
+{
+  int iMinLogType;
+  int iMaxLogType;
+  int iSyncMode;
+  unsigned int uiSyncIntervalMs;
+  int iUnsynced;                /* Set if written since the last sync */
+  int iSyncFd;                  /* Kept open for syncing, -1 if not opened yet */
+  unsigned long long ullLastSyncNs;
+  unsigned long long ullDroppedPending; /* Counter for the marker entry of the queue */
+  int iWriting;                 /* Set while the pending queue is written without holding the mutex */
+  size_t szQueueSize;
+  size_t szQueueCount;
+  char *pcQueue;
+  char *pcSpare;                /* Exactly one of spare and pending queue is set */
+  char *pcPending;              /* Full queue swapped out, written before the current queue */
+  size_t szPendingCount;
+  char caPath[LOGC_PATH_MAXLEN];
+}TagLogCFileRoute;
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+#define LOGC_SOCKET_BATCHSIZE    32   /* Maximum entries sent with one syscall */
+#define LOGC_SOCKET_RECONNECT_MS 1000 /* Minimum time between two attempts to connect */
+/**
+ * Entry in the batch for the socket, the texts are stored one after another in pcSocketBuffer, without '\0'.
+ */
+typedef struct
+{
+  size_t szOffset;
+  size_t szLength;
+  int iLogType;
+}TagLogCSocketEntry;
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+#define LOGC_ENGINE_INTERVAL_DEFAULT 100
+/**
+ * The writer engine, just one per process. The thread releases the list mutex while writing a Log-Object,
+ * so attaching and detaching don't wait for a pass, detaching just waits if the engine writes this Log-Object.
+ * The wake mutex is just held briefly, so handing over a queue never waits for the I/O.
+ * Lock order: list mutex, mutex of the Log-Object, wake mutex.
+ * The list mutex and condition are initialized once and kept, iRunning is just accessed with the list mutex.
+ */
+typedef struct
+{
+  int iInitialized;
+  int iRunning;              /* 1 while running, 2 while stopping: Log-Objects can just be detached then */
+  int iStop;
+  int iWake;                 /* Set if a queue was handed over since the last pass */
+  unsigned int uiIntervalMs;
+  LogC *ptagLogs;            /* Attached Log-Objects */
+  size_t szLogsCount;
+  size_t szLogsSize;
+  size_t szPassIndex;        /* Next Log-Object of the current pass, kept valid when detaching */
+  LogC ptagWriting;          /* Log-Object written by the engine without holding the list mutex */
+  TMutex tListMutex;
+  TMutex tWakeMutex;
+  TCond tWakeCond;
+  TCond tListCond;           /* Signalled when the engine finished writing a Log-Object */
+#ifdef _WIN32
+  HANDLE tThread;
+#else
+  pthread_t tThread;
+#endif /* _WIN32 */
+}TagLogCEngine;
+static TagLogCEngine tagEngine_m;
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+
+#ifdef LOGC_FEATURE_ENABLE_FLUSHTIMER
+/**
+ * The flush timer, just one per process. The thread sleeps until the oldest entry of a registered
+ * filequeue reaches the max age of its Log-Object, so idle Log-Objects don't wake it up at all.
+ * Lock order: list mutex, mutex of the Log-Object, wake mutex.
+ * The list mutex is initialized once and kept, iRunning is just accessed with it.
+ */
+typedef struct
+{
+  int iInitialized;
+  int iRunning;                 /* 1 while running, 2 while stopping: Log-Objects can just be removed then */
+  int iStop;
+  unsigned long long ullNextNs; /* Earliest deadline of a filequeue known to the thread, ULLONG_MAX if none */
+  LogC *ptagLogs;               /* Registered Log-Objects */
+  size_t szLogsCount;
+  size_t szLogsSize;
+  TMutex tListMutex;
+  TMutex tWakeMutex;
+  TCond tWakeCond;
+#ifdef _WIN32
+  HANDLE tThread;
+#else
+  pthread_t tThread;
+#endif /* _WIN32 */
+}TagLogCFlushTimer;
+static TagLogCFlushTimer tagFlushTimer_m;
+
+/* Called with the mutex of the Log-Object locked, before an entry is added to the filequeue */
+#define LOGC_FLUSHTIMER_ARM(log) do { if(((log)->uiFileMaxAgeMs) && (!(log)->szLogFileQueueCount)) \
+                                        vLogC_FlushTimerArm_m(log); } while(0)
+/* Called with the mutex of the Log-Object locked, if a sync is skipped because of the sync interval */
+#define LOGC_FLUSHTIMER_ARM_SYNC(log) do { if((log)->uiFileMaxAgeMs) \
+                                             vLogC_FlushTimerWake_m((log)->ullFileLastSyncNs+(log)->uiFileSyncIntervalMs*1000000ULL); } while(0)
+#else
+  #define LOGC_FLUSHTIMER_ARM(log)
+  #define LOGC_FLUSHTIMER_ARM_SYNC(log)
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+
+#ifdef LOGC_FEATURE_ENABLE_TRACE
+#define LOGC_TRACE_EVENTS_DEFAULT 4096
+#ifdef _MSC_VER
+  #define LOGC_TRACE_RUNNING() _InterlockedCompareExchange((volatile long*)&tagTrace_m.iRunning,0,0) /* Read without a mutex */
+  #define LOGC_TRACE_SET_RUNNING(val) _InterlockedExchange((volatile long*)&tagTrace_m.iRunning,(long)(val))
+  #define LOGC_TRACE_GENERATION() ((unsigned int)_InterlockedCompareExchange((volatile long*)&tagTrace_m.uiGeneration,0,0))
+  #define LOGC_TRACE_SET_GENERATION(val) _InterlockedExchange((volatile long*)&tagTrace_m.uiGeneration,(long)(val))
+#else /* __GNUC__ */
+  #define LOGC_TRACE_RUNNING() __atomic_load_n(&tagTrace_m.iRunning,__ATOMIC_ACQUIRE) /* Read without a mutex */
+  #define LOGC_TRACE_SET_RUNNING(val) __atomic_store_n(&tagTrace_m.iRunning,(val),__ATOMIC_RELEASE)
+  #define LOGC_TRACE_GENERATION() __atomic_load_n(&tagTrace_m.uiGeneration,__ATOMIC_ACQUIRE)
+  #define LOGC_TRACE_SET_GENERATION(val) __atomic_store_n(&tagTrace_m.uiGeneration,(val),__ATOMIC_RELEASE)
+#endif /* _MSC_VER */
+/**
+ * Begin or end of a span, the end has no name.
+ */
+typedef struct
+{
+  const char *pcName;
+  unsigned long long ullTimeNs;
+}TagLogCTraceEvent;
+
+/**
+ * Events of one thread. The mutex is just contended while another thread writes the events.
+ */
+typedef struct TagLogCTraceBuffer_t
+{
+  struct TagLogCTraceBuffer_t *ptagNext;
+  TMutex tMutex;
+  unsigned long long ullThreadId;
+  unsigned int uiGeneration;     /* Trace the events belong to, they are dropped if it's not the current one */
+  unsigned int uiDepth;          /* Spans begun and not ended yet */
+  size_t szCount;
+  size_t szSize;
+  TagLogCTraceEvent tagaEvents[1];
+}TagLogCTraceBuffer;
+
+/**
+ * The trace, just one per process. The buffers of the threads are kept in a list,
+ * the file is written with the list mutex held. Lock order: list mutex, mutex of a buffer.
+ * The thread local key and the list mutex are created once with the first trace and kept,
+ * so the buffers of exiting threads can be released anytime.
+ * Each trace has a new generation, so events recorded while one trace is stopped don't end up in the next one.
+ */
+typedef struct
+{
+  int iRunning;
+  int iInitialized;
+  unsigned int uiGeneration;    /* Changed under the list mutex when a trace is started */
+  int iFirstEvent;              /* No event written to the file yet */
+  int iFailed;                  /* Writing the file failed */
+  size_t szEventsPerThread;
+  unsigned long ulPid;
+  FILE *fpFile;
+  TagLogCTraceBuffer *ptagBuffers;
+  TMutex tListMutex;
+#ifdef _WIN32
+  DWORD dwFlsIndex;
+#else
+  pthread_key_t tKey;
+#endif /* _WIN32 */
+}TagLogCTrace;
+static TagLogCTrace tagTrace_m;
+#endif /* LOGC_FEATURE_ENABLE_TRACE */
+
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+#define LOGC_PERCPU_MAXSLOTS 256
+#define LOGC_PERCPU_SLOTS(log)   __atomic_load_n(&(log)->pptagPerCpuSlots,__ATOMIC_ACQUIRE) /* Read without the mutex */
+#define LOGC_PERCPU_ENABLED(log) __atomic_load_n(&(log)->iPerCpuEnabled,__ATOMIC_ACQUIRE)   /* Checked again with the slot locked */
+/**
+ * Staging buffer of one CPU. The header is a page of its own, which is kept until LogC_End(),
+ * because adding threads may still lock it after the buffers were disabled. The entries are a separate mapping,
+ * just present while the buffers are enabled, so they are placed on the NUMA node of the CPU
+ * which touches them first, which is the CPU the slot belongs to.
+ * The entries have the same layout as the filequeue, with the monotonic time of the adding thread,
+ * which is strictly increasing per thread, so merging the slots by time keeps the order of each thread.
+ */
+typedef struct
+{
+  pthread_mutex_t tMutex;
+  TagLogCTimeCache tagTimeCache;
+  size_t szCount;
+  size_t szMergePos;                /* Next entry to be merged while draining */
+  size_t szMapSize;                 /* Size of the mapping of the entries, 0 while disabled */
+  unsigned long long *pullTimes;
+  size_t *pszLengths;               /* Length of each entry without '\0' */
+  int *piLogTypes;
+  char *pcEntries;
+}TagLogCPerCpuSlot;
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+  #ifdef _WIN32
+    #define LOGC_RECORDER_GET(recorder)      ((TagLogCRecorderRing*)FlsGetValue((recorder)->dwFlsIndex))
+    #define LOGC_RECORDER_SET(recorder,ring) (!FlsSetValue((recorder)->dwFlsIndex,(ring))) /* Not 0 on Error */
+  #else
+    #define LOGC_RECORDER_GET(recorder)      ((TagLogCRecorderRing*)pthread_getspecific((recorder)->tKey))
+    #define LOGC_RECORDER_SET(recorder,ring) pthread_setspecific((recorder)->tKey,(ring))
+  #endif /* _WIN32 */
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+#define LOGC_RECORDER_SPEC_MAXLEN 32 /* Flags, width and precision of one conversion, longer ones are formatted immediately */
+
+/**
+ * Length modifiers of a recorded conversion.
+ */
+enum
+{
+  LOGC_RECORDER_LENGTH_NONE,
+  LOGC_RECORDER_LENGTH_HH,
+  LOGC_RECORDER_LENGTH_H,
+  LOGC_RECORDER_LENGTH_L,
+  LOGC_RECORDER_LENGTH_LL,
+  LOGC_RECORDER_LENGTH_Z,
+  LOGC_RECORDER_LENGTH_T,
+  LOGC_RECORDER_LENGTH_LD
+};
+
+/**
+ * One conversion of a recorded format, from the '%' to the conversion character.
+ */
+typedef struct
+{
+  const char *pcLength;   /* Behind flags, width and precision */
+  int iPrecision;         /* -1 if not set, for '*' it's set while packing */
+  int iLength;
+  char cConversion;
+}TagLogCRecorderSpec;
+
+/**
+ * One recorded entry, followed by the packed arguments of pcFormat, or the formatted text if pcFormat is NULL.
+ * Integers are packed as long long, floating point numbers as double or long double and strings with their '\0'.
+ */
+typedef struct
+{
+  const char *pcFormat;
+  const char *pcFileName;
+  const char *pcFunction;
+  unsigned long long ullTimeNs;
+  size_t szArgsLength;
+  int iLogType;
+  int iLineNr;
+}TagLogCRecord;
+
+/**
+ * Ring of one thread, just used by this thread, followed by the slots and a buffer for formatting.
+ * The rings of a Log-Object are kept in a list, protected by the mutex of the Log-Object.
+ */
+typedef struct TagLogCRecorderRing_t
+{
+  struct TagLogCRecorderRing_t *ptagNext;
+  LogC ptagLog;
+  size_t szNext;  /* Slot of the next record */
+  size_t szCount; /* Records in the ring */
+  unsigned char *pucSlots;
+  char *pcText;
+}TagLogCRecorderRing;
+
+typedef struct
+{
+  int iMinLogType;
+  int iTriggerLogType;
+  size_t szEntries;
+  size_t szArgsSize;
+  size_t szSlotSize;               /* Record and its arguments, aligned for the next record */
+  TagLogCRecorderRing *ptagRings;  /* Just one without LOGC_OPTION_THREADSAFE */
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+  #ifdef _WIN32
+  DWORD dwFlsIndex;                /* Its callback releases the ring of an exiting thread */
+  #else
+  pthread_key_t tKey;
+  #endif /* _WIN32 */
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+}TagLogCRecorder;
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+
+#ifdef LOGC_FEATURE_ENABLE_CONTEXT
+#ifdef _MSC_VER
+  #define LOGC_THREAD_LOCAL __declspec(thread)
+#else
+  #define LOGC_THREAD_LOCAL __thread
+#endif /* _MSC_VER */
+#define LOGC_CONTEXT_MAXDEPTH        16  /* Fields per thread, see LogC_ContextPush() */
+#define LOGC_CONTEXT_MAXLEN          256 /* Rendered fields per thread, including '\0' */
+#define LOGC_CONTEXT_THREADID_MAXLEN 32
+#define LOGC_PREFIX_FORMAT_THREADID  "tid=%llu"
+
+/**
+ * Context of one thread, the prefix texts are rendered when they change, adding an entry just copies them.
+ */
+typedef struct
+{
+  size_t szLength;                                /* Length of the rendered fields in caText */
+  size_t szDepth;                                 /* Count of pushed fields */
+  size_t szaStart[LOGC_CONTEXT_MAXDEPTH];         /* Length of caText before each field, restored by LogC_ContextPop() */
+  size_t szThreadIdLength;                        /* Length of caThreadId, 0 until it's rendered */
+  char caThreadId[LOGC_CONTEXT_THREADID_MAXLEN];
+  char caText[LOGC_CONTEXT_MAXLEN];
+}TagLogCContext;
+static LOGC_THREAD_LOCAL TagLogCContext tagContext_m;
+#endif /* LOGC_FEATURE_ENABLE_CONTEXT */
+
 #if defined(LOGC_FEATURE_ENABLE_LOG_STORAGE)
 struct TagLogCEntry_t
 {
@@ -105,6 +771,18 @@ struct TagLogCEntry_t
   struct TagLogCEntry_t *ptagNext;
 };
 typedef struct TagLogCEntry_t TagLogCEntry;
+
+/**
+ * Index record for each stored entry, kept in a ring in the same order as the entries.
+ */
+typedef struct
+{
+  unsigned long long ullTimeMs; /* Never decreasing, so the index can be searched binary */
+  unsigned long long ullSeq;
+  int iLogType;
+  TagLogCEntry *ptagEntry;
+}TagLogCIndex;
+#define LOGC_STORAGE_INDEX_MINSIZE 16
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
 
 struct TagLog_t
@@ -113,22 +791,127 @@ struct TagLog_t
   unsigned int uiLogOptions;
   size_t szMaxEntryLength;
   char *pcTextBuffer;
+  TagLogCTimeBase tagTimeBase;
+  TagLogCTimeCache tagTimeCache; /* Used with pcTextBuffer */
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
   size_t szLogFileQueueCount;
   char *pcLogFileQueueBuffer;
   char caLogPath[LOGC_PATH_MAXLEN];
+  int iFileSyncMode;
+  unsigned int uiFileSyncIntervalMs;
+  int iFileSyncRunning;                  /* Set while one thread syncs the logfile without holding the mutex */
+  int iFileSyncFd;                       /* Kept open for syncing, -1 if not opened yet */
+  unsigned long long ullFileWriteSeq;    /* Incremented with each write of the filequeue */
+  unsigned long long ullFileSyncedSeq;   /* All writes up to this one are synced to disk */
+  unsigned long long ullFileLastSyncNs;
+  TagLogCFileRoute *ptagFileRoutes;      /* NULL if no routes are set, the queues are in the same allocation */
+  size_t szFileRouteCount;
+  size_t szIndexBlockSize;               /* Both 0 if no index is written */
+  unsigned int uiIndexIntervalMs;
+  unsigned long long ullIndexOffset;     /* Position of the next entry added to the filequeue in the logfile */
+  LogCIndexRecord tagIndexBlock;         /* Block of the entries added since the last record, ullLength is 0 if empty */
+  FILE *fpIndex;                         /* Kept open while the index is written, NULL otherwise */
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FILEQUEUE_SWAP
+  int iFileQueueWriting;           /* Set while the pending queue is written without holding the mutex */
+  char *pcFileQueueSpare;          /* Allocated with the first swap, then exactly one of spare and pending queue is set */
+  char *pcFileQueuePending;        /* Full queue swapped out, written before the current filequeue */
+  size_t szFileQueuePendingCount;
+#endif /* LOGC_FILEQUEUE_SWAP */
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+  int iEngineAttached;
+  int iEngineFailed;               /* Set if the engine failed to write the pending queue, it retries with the next pass */
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+#ifdef LOGC_FEATURE_ENABLE_FLUSHTIMER
+  unsigned int uiFileMaxAgeMs;             /* 0 if not registered at the flush timer */
+  unsigned long long ullFileQueueSinceNs;  /* Time the first entry was added to the empty filequeue */
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  int iFileMode;
 #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+  TagLogCUring *ptagUring; /* NULL if io_uring is not available, normal writes are used then */
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+  TagLogCDirect *ptagDirect; /* Just set with LOGC_FILEMODE_DIRECT */
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+  TagLogCAppend *ptagAppend; /* Just set with LOGC_FILEMODE_APPEND */
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  LogCShmHeader *ptagShm;                 /* NULL if no shared memory ring is set */
+  char *pcShmData;
+  size_t szShmDataSize;                   /* Own copy, the header may be changed by other processes */
+  unsigned long long ullShmDroppedPending; /* Dropped entries not reported by a marker entry in the ring yet */
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  TagLogCSocketEntry *ptagSocketEntries; /* NULL if no socket is set, pcSocketBuffer is in the same allocation */
+  char *pcSocketBuffer;
+  size_t szSocketEntryCount;
+  size_t szSocketBufferLength;
+  char caSocketPath[sizeof(((struct sockaddr_un*)0)->sun_path)];
+  int iSocketType;
+  int iSocketFallback;
+  int iSocketFd;                         /* -1 if not connected */
+  int iSocketPartial;                    /* Set if the first entry of a stream is partially sent */
+  unsigned long long ullSocketLastConnectNs;
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  TagLogCPerCpuSlot **pptagPerCpuSlots; /* NULL until enabled the first time, then kept until LogC_End() */
+  size_t szPerCpuSlots;
+  size_t szPerCpuEntries;               /* 0 while disabled, the entries of the slots are unmapped then */
+  int iPerCpuEnabled;                   /* Just changed while holding the mutexes of all slots */
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+  TagLogCRecorder *ptagRecorder; /* NULL if no flight recorder is set */
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
 #ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
   size_t szMaxStorageCount;
   size_t szStoredLogsCount;
   TagLogCEntry *ptagSavedLogFirst;
   TagLogCEntry *ptagSavedLogLast;
+  TagLogCIndex *ptagStorageIndex;   /* Ring, szStoredLogsCount records starting at szStorageIndexFirst */
+  size_t szStorageIndexSize;
+  size_t szStorageIndexFirst;
+  unsigned long long ullStorageSeq; /* Sequence number of the last added entry */
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+  int iBackpressurePolicy;
+  int iBackpressureKeepLevel;
+  unsigned int uiBackpressureTimeoutMs;
+  unsigned long long ullDroppedPending; /* Dropped entries not reported by a marker entry yet */
+  LogCStats tagStats;
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+  TagLogCProfile tagaProfile[LOGC_PROFILE_STAGES];
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
 #ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
   TMutex tMutex;
+  #ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  TCond tFileSyncCond;
+  TCond tFileQueueCond;
+  #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
 #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
 };
 
+typedef struct
+{
+  size_t szLength; /* Length of the entry with '\n', without '\0' */
+  const struct TagLogType *ptagLogType;
+}TagLogCBatchEntry;
+
+/**
+ * Entries formatted by one thread, which are added at once, see LogC_BatchBegin().
+ */
+struct TagLogCBatch_t
+{
+  LogC ptagLog;
+  TagLogCTimeCache tagTimeCache;
+  size_t szCount;
+  size_t szSize;                 /* Count of entries which fit into pcEntries */
+  int iMaxLogType;               /* Highest logtype of the entries, for the backpressure policy */
+  TagLogCBatchEntry *ptagEntries;
+  char *pcEntries;               /* Entries in the layout of the filequeue, szMaxEntryLength+2 bytes each */
+};
+
 INLINE_PROT int iLogC_snprintf(char *pcDest,
                                size_t szBufferSize,
                                const char *pcFormat,
@@ -139,9 +922,57 @@ INLINE_PROT int iLogC_vsnprintf(char *pcBuffer,
                                 const char *pcFormat,
                                 va_list vaArgs);
 
+INLINE_PROT int iLogC_FormatEntry_m(LogC ptagLog,
+                                    char *pcBuffer,
+                                    TagLogCTimeCache *ptagTimeCache,
+                                    const struct TagLogType *ptagLogType,
+                                    const char *pcFileName,
+                                    int iLineNr,
+                                    const char *pcFunction,
+                                    TagLogCMessage *ptagMessage,
+                                    size_t *pszLength);
+INLINE_PROT int iLogC_AddHexData_m(LogC ptagLog,
+                                   char *pcBuffer,
+                                   size_t *pszBufferPos,
+                                   TagLogCMessage *ptagMessage);
+INLINE_PROT void vLogC_HexEncode_m(char *pcDest,
+                                   const unsigned char *pucData,
+                                   size_t szLength);
+INLINE_PROT int iLogC_AddEntry_m(LogC log,
+                                 int logType,
+                                 const char *fileName,
+                                 int lineNr,
+                                 const char *functionName,
+                                 TagLogCMessage *ptagMessage);
+INLINE_PROT int iLogC_BatchAddMessage_m(LogCBatch ptagBatch,
+                                        const struct TagLogType *ptagLogType,
+                                        const char *pcFileName,
+                                        int iLineNr,
+                                        const char *pcFunction,
+                                        TagLogCMessage *ptagMessage);
+INLINE_PROT void vLogC_BatchFree_m(LogCBatch ptagBatch);
+INLINE_PROT void vLogC_PrintEntry_m(LogC ptagLog,
+                                    const char *pcText,
+                                    const struct TagLogType *ptagLogType);
 INLINE_PROT int iLogC_AddTimeStamp_m(LogC ptagLog,
+                                     char *pcBuffer,
+                                     TagLogCTimeCache *ptagTimeCache,
+                                     unsigned long long ullTimeNs,
                                      size_t *pszBufferPos);
+INLINE_PROT int iLogC_TimeBaseNew_m(TagLogCTimeBase *ptagTimeBase,
+                                    int iTimeSource);
+INLINE_PROT unsigned long long ullLogC_GetEntryTimeNs_m(LogC ptagLog);
+INLINE_PROT unsigned long long ullLogC_GetRealTimeNs_m(void);
+#ifdef LOGC_FEATURE_ENABLE_CONTEXT
+INLINE_PROT int iLogC_AddPrefixText_m(LogC ptagLog,
+                                      char *pcBuffer,
+                                      size_t *pszBufferPos,
+                                      const char *pcText,
+                                      size_t szTextLength);
+INLINE_PROT void vLogC_ContextThreadId_m(TagLogCContext *ptagContext);
+#endif /* LOGC_FEATURE_ENABLE_CONTEXT */
 INLINE_PROT int iLogC_AddPrefix_m(LogC ptagLog,
+                                  char *pcBuffer,
                                   size_t *pszBufferPos,
                                   const struct TagLogType *ptagLogType,
                                   const char *pcFileName,
@@ -154,19 +985,264 @@ INLINE_PROT int iLogC_SetLogOptions_m(LogC ptagLog,
                                       unsigned int uiOptions);
 
 INLINE_PROT const struct TagLogType *ptagLogC_GetLogType_m(int iLogType);
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+INLINE_PROT unsigned long long ullLogC_ProfileTicks_m(void);
+INLINE_PROT void vLogC_ProfileAdd_m(LogC ptagLog,
+                                    int iStage,
+                                    unsigned long long ullTicks);
+INLINE_PROT unsigned long long ullLogC_ProfileBucketStart_m(size_t szBucket);
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
+INLINE_PROT unsigned long long ullLogC_GetTimeNs_m(void);
+INLINE_PROT void vLogC_SleepMs_m(unsigned int uiMs);
+INLINE_PROT int iLogC_BackpressureDrop_m(LogC ptagLog,
+                                         int iLogType,
+                                         unsigned long long *pullDeadlineNs,
+                                         unsigned int *puiWaitMs,
+                                         unsigned long long *pullDroppedPending);
 
 /* Functions if logfile is enabled */
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
-INLINE_FCT int iLogC_CheckFilePathValid_m(const char *pcPath);
+INLINE_PROT int iLogC_CheckFilePathValid_m(const char *pcPath);
 INLINE_PROT int iLogC_WriteEntriesToDisk_m(LogC ptagLog);
+INLINE_PROT int iLogC_FileWrite_m(LogC ptagLog,
+                                  const char *pcQueueBuffer,
+                                  size_t szEntryCount);
+INLINE_PROT int iLogC_FileWritten_m(LogC ptagLog);
+INLINE_PROT int iLogC_FileQueueReserve_m(LogC ptagLog,
+                                         int iLogType);
+INLINE_PROT int iLogC_WriteQueueToFile_m(const char *pcPath,
+                                         const char *pcQueueBuffer,
+                                         size_t szEntryCount,
+                                         size_t szEntrySize);
+INLINE_PROT int iLogC_FileQueueAdd_m(LogC ptagLog,
+                                     const char *pcText,
+                                     size_t szLength,
+                                     int iLogType);
+INLINE_PROT int iLogC_FileQueueAddBatch_m(LogC ptagLog,
+                                          const TagLogCBatchEntry *ptagEntries,
+                                          const char *pcEntries,
+                                          size_t szCount);
+INLINE_PROT int iLogC_FileSync_m(LogC ptagLog,
+                                 int iForce);
+INLINE_PROT int iLogC_SyncFile_m(const char *pcPath,
+                                 int *piFd);
+INLINE_PROT void vLogC_FileSyncClose_m(LogC ptagLog);
+INLINE_PROT int iLogC_FileBackendOpen_m(LogC ptagLog);
+INLINE_PROT int iLogC_FileBackendComplete_m(LogC ptagLog);
+INLINE_PROT int iLogC_FileBackendClose_m(LogC ptagLog);
+INLINE_PROT TagLogCFileRoute *ptagLogC_FileRoutesNew_m(size_t szMaxEntryLength,
+                                                      const LogCFileRoute *ptagRoutes,
+                                                      size_t szRouteCount);
+INLINE_PROT int iLogC_FileRoutesReserve_m(LogC ptagLog,
+                                          int iLogType,
+                                          int *piWriteFailed);
+INLINE_PROT int iLogC_FileRoutesAdd_m(LogC ptagLog,
+                                      const char *pcText,
+                                      size_t szLength,
+                                      int iLogType,
+                                      int iMayRelease);
+INLINE_PROT void vLogC_FileRouteSwap_m(TagLogCFileRoute *ptagRoute);
+INLINE_PROT int iLogC_FileRouteWrite_m(LogC ptagLog,
+                                       TagLogCFileRoute *ptagRoute,
+                                       int iAll,
+                                       int iForceSync);
+INLINE_PROT int iLogC_FileRoutesWrite_m(LogC ptagLog);
+INLINE_PROT int iLogC_FileRoutesFlush_m(LogC ptagLog,
+                                        int iForceSync);
+INLINE_PROT int iLogC_FileRoutesEnd_m(LogC ptagLog);
+INLINE_PROT int iLogC_FileIndexOpen_m(LogC ptagLog);
+INLINE_PROT void vLogC_FileIndexAdd_m(LogC ptagLog,
+                                      int iLogType,
+                                      size_t szLength);
+INLINE_PROT void vLogC_FileIndexDrop_m(LogC ptagLog);
+INLINE_PROT void vLogC_FileIndexWrite_m(LogC ptagLog);
+INLINE_PROT void vLogC_FileIndexClose_m(LogC ptagLog);
 #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+INLINE_PROT int iLogC_EngineInit_m(void);
+INLINE_PROT int iLogC_EngineDetach_m(LogC ptagLog);
+INLINE_PROT void vLogC_EngineRun_m(void);
+INLINE_PROT void vLogC_EngineWait_m(unsigned int uiMs);
+INLINE_PROT void vLogC_EngineWake_m(void);
+INLINE_PROT void vLogC_EngineWriteLog_m(LogC ptagLog,
+                                        int iFlushPartial);
+INLINE_PROT int iLogC_EngineHandOver_m(LogC ptagLog,
+                                       int iWait);
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+#ifdef LOGC_FILEQUEUE_SWAP
+INLINE_PROT int iLogC_FileQueueSwap_m(LogC ptagLog);
+INLINE_PROT void vLogC_FileQueueWaitWriter_m(LogC ptagLog);
+#else
+  #define iLogC_FileQueueSwap_m(log) iLogC_WriteEntriesToDisk_m(log)
+#endif /* LOGC_FILEQUEUE_SWAP */
+#ifdef LOGC_FEATURE_ENABLE_FLUSHTIMER
+INLINE_PROT int iLogC_FlushTimerInit_m(void);
+INLINE_PROT void vLogC_FlushTimerRun_m(void);
+INLINE_PROT void vLogC_FlushTimerWait_m(unsigned long long ullNs);
+INLINE_PROT void vLogC_FlushTimerArm_m(LogC ptagLog);
+INLINE_PROT void vLogC_FlushTimerWake_m(unsigned long long ullDeadlineNs);
+INLINE_PROT unsigned long long ullLogC_FlushTimerCheckLog_m(LogC ptagLog,
+                                                            unsigned long long ullTimeNs);
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+#ifdef LOGC_FEATURE_ENABLE_TRACE
+INLINE_PROT int iLogC_TraceInit_m(void);
+INLINE_PROT TagLogCTraceBuffer *ptagLogC_TraceBuffer_m(unsigned int uiGeneration);
+INLINE_PROT int iLogC_TraceAdd_m(const char *pcName,
+                                 unsigned int uiGeneration);
+INLINE_PROT void vLogC_TraceWriteBuffer_m(TagLogCTraceBuffer *ptagBuffer);
+INLINE_PROT void vLogC_TraceWriteString_m(const char *pcText);
+INLINE_PROT unsigned long long ullLogC_TraceThreadId_m(void);
+#endif /* LOGC_FEATURE_ENABLE_TRACE */
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+INLINE_PROT TagLogCUring *ptagLogC_UringNew_m(const char *pcPath,
+                                              size_t szBufferSize);
+INLINE_PROT int iLogC_UringWrite_m(TagLogCUring *ptagUring,
+                                   const char *pcQueueBuffer,
+                                   size_t szEntryCount,
+                                   size_t szEntrySize);
+INLINE_PROT int iLogC_UringReap_m(TagLogCUring *ptagUring,
+                                  int iWait);
+INLINE_PROT int iLogC_UringComplete_m(TagLogCUring *ptagUring);
+INLINE_PROT int iLogC_UringEnd_m(TagLogCUring *ptagUring);
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+INLINE_PROT TagLogCDirect *ptagLogC_DirectNew_m(const char *pcPath,
+                                                size_t szQueueSize);
+INLINE_PROT int iLogC_DirectWrite_m(TagLogCDirect *ptagDirect,
+                                    const char *pcQueueBuffer,
+                                    size_t szEntryCount,
+                                    size_t szEntrySize);
+INLINE_PROT int iLogC_DirectWriteBlocks_m(TagLogCDirect *ptagDirect,
+                                          int iPartial);
+INLINE_PROT int iLogC_DirectEnd_m(TagLogCDirect *ptagDirect);
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+INLINE_PROT TagLogCAppend *ptagLogC_AppendNew_m(const char *pcPath,
+                                                size_t szEntrySize);
+INLINE_PROT int iLogC_AppendWrite_m(TagLogCAppend *ptagAppend,
+                                    const char *pcQueueBuffer,
+                                    size_t szEntryCount,
+                                    size_t szEntrySize);
+INLINE_PROT int iLogC_AppendWriteBuffer_m(TagLogCAppend *ptagAppend,
+                                          size_t szLength);
+INLINE_PROT void vLogC_AppendEnd_m(TagLogCAppend *ptagAppend);
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+#ifdef LOGC_FEATURE_ENABLE_FILECACHE
+INLINE_PROT size_t szLogC_FileCacheHash_m(const char *pcPath);
+INLINE_PROT TagLogCFileCacheEntry *ptagLogC_FileCacheFind_m(const char *pcPath,
+                                                            size_t szHash);
+INLINE_PROT TagLogCFileCacheEntry *ptagLogC_FileCacheAcquire_m(const char *pcPath);
+INLINE_PROT void vLogC_FileCacheDrop_m(const char *pcPath);
+INLINE_PROT void vLogC_FileCacheRelease_m(TagLogCFileCacheEntry *ptagEntry,
+                                          int iFailed);
+INLINE_PROT void vLogC_FileCacheRemove_m(TagLogCFileCacheEntry *ptagEntry);
+INLINE_PROT void vLogC_FileCacheInsert_m(TagLogCFileCacheEntry *ptagEntry);
+INLINE_PROT int iLogC_FileCacheWrite_m(int iFileFd,
+                                       const char *pcQueueBuffer,
+                                       size_t szEntryCount,
+                                       size_t szEntrySize);
+#endif /* LOGC_FEATURE_ENABLE_FILECACHE */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+INLINE_PROT int iLogC_ShmOpen_m(LogC ptagLog,
+                                const char *pcName,
+                                size_t szSize);
+INLINE_PROT int iLogC_ShmRemoveStale_m(const char *pcName);
+INLINE_PROT void vLogC_ShmClose_m(LogC ptagLog);
+INLINE_PROT int iLogC_ShmReserve_m(LogC ptagLog,
+                                   int iLogType,
+                                   size_t szEntrySize);
+INLINE_PROT void vLogC_ShmWrite_m(LogC ptagLog,
+                                  const char *pcText,
+                                  size_t szLength);
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+INLINE_PROT int iLogC_SocketReady_m(LogC ptagLog);
+INLINE_PROT int iLogC_SocketAdd_m(LogC ptagLog,
+                                  const char *pcText,
+                                  size_t szLength,
+                                  int iLogType);
+INLINE_PROT int iLogC_SocketFlush_m(LogC ptagLog);
+INLINE_PROT void vLogC_SocketRemove_m(LogC ptagLog,
+                                      size_t szCount);
+INLINE_PROT void vLogC_SocketFallback_m(LogC ptagLog,
+                                        size_t szFirst,
+                                        int iClose);
+INLINE_PROT const char *pcLogC_SyslogPriority_m(int iLogType);
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+INLINE_PROT int iLogC_PerCpuNew_m(LogC ptagLog);
+INLINE_PROT int iLogC_PerCpuMap_m(LogC ptagLog,
+                                  size_t szEntries);
+INLINE_PROT void vLogC_PerCpuUnmap_m(LogC ptagLog);
+INLINE_PROT void vLogC_PerCpuFree_m(LogC ptagLog);
+INLINE_PROT void vLogC_PerCpuLock_m(LogC ptagLog,
+                                    int iLock);
+INLINE_PROT int iLogC_PerCpuAdd_m(LogC ptagLog,
+                                  const struct TagLogType *ptagLogType,
+                                  const char *pcFileName,
+                                  int iLineNr,
+                                  const char *pcFunction,
+                                  TagLogCMessage *ptagMessage);
+INLINE_PROT int iLogC_PerCpuDrain_m(LogC ptagLog);
+INLINE_PROT int iLogC_PerCpuMerge_m(LogC ptagLog);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+INLINE_PROT TagLogCRecorderRing *ptagLogC_RecorderRingNew_m(LogC ptagLog,
+                                                           TagLogCRecorder *ptagRecorder);
+INLINE_PROT TagLogCRecorderRing *ptagLogC_RecorderRing_m(LogC ptagLog,
+                                                        int iCreate);
+INLINE_PROT int iLogC_RecorderAdd_m(LogC ptagLog,
+                                    int iLogType,
+                                    const char *pcFileName,
+                                    int iLineNr,
+                                    const char *pcFunction,
+                                    const char *pcFormat,
+                                    va_list *pvaArgs,
+                                    const char *pcText,
+                                    size_t szTextLength);
+INLINE_PROT const char *pcLogC_RecorderSpec_m(const char *pcFormat,
+                                              TagLogCRecorderSpec *ptagSpec);
+INLINE_PROT int iLogC_RecorderPack_m(const char *pcFormat,
+                                     va_list *pvaArgs,
+                                     unsigned char *pucArgs,
+                                     size_t szArgsSize,
+                                     size_t *pszLength);
+INLINE_PROT int iLogC_RecorderPut_m(unsigned char *pucArgs,
+                                    size_t szArgsSize,
+                                    size_t *pszPos,
+                                    const void *pvValue,
+                                    size_t szSize);
+INLINE_PROT size_t szLogC_RecorderFormat_m(const TagLogCRecord *ptagRecord,
+                                           char *pcText,
+                                           size_t szTextSize);
+INLINE_PROT int iLogC_RecorderDump_m(LogC ptagLog,
+                                    LogCBatch ptagBatch);
+INLINE_PROT int iLogC_RecorderTrigger_m(LogC ptagLog,
+                                       int iLogType,
+                                       const char *pcFileName,
+                                       int iLineNr,
+                                       const char *pcFunction,
+                                       TagLogCMessage *ptagMessage);
+INLINE_PROT void vLogC_RecorderFree_m(LogC ptagLog);
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
 #ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
-INLINE_PROT void vLogC_StoragePush_m(LogC ptagLog,
-                                     TagLogCEntry *ptagEntry);
+INLINE_PROT int iLogC_StorageAdd_m(LogC ptagLog,
+                                   const char *pcText,
+                                   size_t szLength,
+                                   int iLogType);
+INLINE_PROT int iLogC_StoragePush_m(LogC ptagLog,
+                                    TagLogCEntry *ptagEntry,
+                                    int iLogType);
+INLINE_PROT size_t szLogC_StorageIndexSearch_m(LogC ptagLog,
+                                               unsigned long long ullTimeMs,
+                                               unsigned long long ullSeq);
 
 INLINE_PROT char *pcLogC_StoragePop_m(LogC ptagLog,
                                       size_t *pszEntryLength);
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+#if defined(LOGC_FEATURE_ENABLE_LOG_STORAGE) || defined(LOGC_FEATURE_ENABLE_LOGFILE)
+INLINE_PROT unsigned long long ullLogC_GetRealTimeMs_m(void);
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE || LOGC_FEATURE_ENABLE_LOGFILE */
 
 LogC LogC_New(int logLevel,
               size_t maxEntryLength,
@@ -185,7 +1261,7 @@ LogC LogC_New(int logLevel,
   if(maxEntryLength<10)
     return(NULL);
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
-  if((logFile) && (iLogC_CheckFilePathValid_m(logFile->pcFilePath)))
+  if((logFile) && (logFile->pcFilePath) && (iLogC_CheckFilePathValid_m(logFile->pcFilePath)))
       return(NULL);
 #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
 
@@ -199,16 +1275,16 @@ LogC LogC_New(int logLevel,
   ptagNewLog->uiLogOptions=0;
   if((iLogC_SetLogOptions_m(ptagNewLog,
 #ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
-                            BITS_UNSET(logOptions,(0x00FF|LOGC_OPTION_THREADSAFE))
+                            BITS_UNSET(logOptions,(LOGC_OPTIONS_PREFIX|LOGC_OPTION_THREADSAFE))
 #else
-                            BITS_UNSET(logOptions,0x00FF)
+                            BITS_UNSET(logOptions,LOGC_OPTIONS_PREFIX)
 #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
                             )) ||
      (iLogC_SetPrefixFormat_m(ptagNewLog,
 #ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
-                              BITS_UNSET(logOptions,(0xFF00|LOGC_OPTION_THREADSAFE))
+                              BITS_UNSET(logOptions,(LOGC_OPTIONS_OTHER|LOGC_OPTION_THREADSAFE))
 #else
-                              BITS_UNSET(logOptions,0xFF00)
+                              BITS_UNSET(logOptions,LOGC_OPTIONS_OTHER)
 #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
                               )))
   {
@@ -217,58 +1293,187 @@ LogC LogC_New(int logLevel,
   }
   ptagNewLog->pcTextBuffer=((char*)ptagNewLog)+sizeof(struct TagLog_t);
   ptagNewLog->szMaxEntryLength=maxEntryLength;
+  iLogC_TimeBaseNew_m(&ptagNewLog->tagTimeBase,LOGC_TIMESOURCE_REALTIME);
+  ptagNewLog->tagTimeCache.uiOptions=0;
   ptagNewLog->iLogLevel=logLevel;
 
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
-  if(logFile)
+  ptagNewLog->pcLogFileQueueBuffer=NULL;
+  ptagNewLog->ptagFileRoutes=NULL;
+  ptagNewLog->szFileRouteCount=0;
+  if((logFile) && (logFile->ptagRoutes) && (logFile->szRouteCount))
   {
-    if(!(ptagNewLog->pcLogFileQueueBuffer=malloc(LOGC_DEFAULT_FILEQUEUESIZE*(maxEntryLength+2))))
+    if(!(ptagNewLog->ptagFileRoutes=ptagLogC_FileRoutesNew_m(maxEntryLength,logFile->ptagRoutes,logFile->szRouteCount)))
     {
       free(ptagNewLog);
       return(NULL);
     }
-    strcpy(ptagNewLog->caLogPath,logFile->pcFilePath);
+    ptagNewLog->szFileRouteCount=logFile->szRouteCount;
   }
-  else
+  if((logFile) && (logFile->pcFilePath))
   {
-    ptagNewLog->pcLogFileQueueBuffer=NULL;
+    if(!(ptagNewLog->pcLogFileQueueBuffer=malloc(LOGC_DEFAULT_FILEQUEUESIZE*(maxEntryLength+2))))
+    {
+      free(ptagNewLog->ptagFileRoutes);
+      free(ptagNewLog);
+      return(NULL);
+    }
+    strcpy(ptagNewLog->caLogPath,logFile->pcFilePath);
   }
+  ptagNewLog->iFileMode=LOGC_FILEMODE_DEFAULT;
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+  ptagNewLog->ptagUring=NULL;
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+  ptagNewLog->ptagDirect=NULL;
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+  ptagNewLog->ptagAppend=NULL;
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
   ptagNewLog->szLogFileQueueCount=0;
+  ptagNewLog->iFileSyncMode=LOGC_FILESYNC_NONE;
+  ptagNewLog->uiFileSyncIntervalMs=0;
+  ptagNewLog->iFileSyncRunning=0;
+  ptagNewLog->iFileSyncFd=-1;
+  ptagNewLog->ullFileWriteSeq=0;
+  ptagNewLog->ullFileSyncedSeq=0;
+  ptagNewLog->ullFileLastSyncNs=0;
+  ptagNewLog->szIndexBlockSize=0;
+  ptagNewLog->uiIndexIntervalMs=0;
+  ptagNewLog->fpIndex=NULL;
+  ptagNewLog->tagIndexBlock.ullLength=0;
 #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FILEQUEUE_SWAP
+  ptagNewLog->iFileQueueWriting=0;
+  ptagNewLog->pcFileQueueSpare=NULL;
+  ptagNewLog->pcFileQueuePending=NULL;
+  ptagNewLog->szFileQueuePendingCount=0;
+#endif /* LOGC_FILEQUEUE_SWAP */
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+  ptagNewLog->iEngineAttached=0;
+  ptagNewLog->iEngineFailed=0;
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+#ifdef LOGC_FEATURE_ENABLE_FLUSHTIMER
+  ptagNewLog->uiFileMaxAgeMs=0;
+  ptagNewLog->ullFileQueueSinceNs=0;
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  ptagNewLog->ptagShm=NULL;
+  ptagNewLog->ullShmDroppedPending=0;
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  ptagNewLog->ptagSocketEntries=NULL;
+  ptagNewLog->iSocketFd=-1;
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  ptagNewLog->pptagPerCpuSlots=NULL;
+  ptagNewLog->iPerCpuEnabled=0;
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+  ptagNewLog->ptagRecorder=NULL;
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
 #ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
   ptagNewLog->szMaxStorageCount=maxStorageCount;
   ptagNewLog->szStoredLogsCount=0;
   ptagNewLog->ptagSavedLogFirst=NULL;
+  ptagNewLog->ptagStorageIndex=NULL;
+  ptagNewLog->szStorageIndexSize=0;
+  ptagNewLog->szStorageIndexFirst=0;
+  ptagNewLog->ullStorageSeq=0;
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
 #ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
   ptagNewLog->uiLogOptions|=(logOptions&LOGC_OPTION_THREADSAFE);
 #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+  ptagNewLog->iBackpressurePolicy=LOGC_BACKPRESSURE_BLOCK;
+  ptagNewLog->iBackpressureKeepLevel=LOGC_NONE;
+  ptagNewLog->uiBackpressureTimeoutMs=0;
+  ptagNewLog->ullDroppedPending=0;
+  memset(&ptagNewLog->tagStats,0,sizeof(LogCStats));
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+  memset(ptagNewLog->tagaProfile,0,sizeof(ptagNewLog->tagaProfile));
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
   LOGC_MUTEX_INIT(ptagNewLog);
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  LOGC_COND_INIT(ptagNewLog,tFileSyncCond);
+  LOGC_COND_INIT(ptagNewLog,tFileQueueCond);
+  if(ptagNewLog->pcLogFileQueueBuffer)
+    iLogC_FileBackendOpen_m(ptagNewLog);
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
   return(ptagNewLog);
 }
 
 int LogC_End(LogC log)
 {
+#ifdef LOGC_FEATURE_ENABLE_FLUSHTIMER
+  /* The max age may be removed by LogC_FlushTimerStop() at the same time, so it's checked with the list mutex */
+  if((log->uiLogOptions&LOGC_OPTION_THREADSAFE) && (LogC_SetFileMaxAge(log,0)))
+    return(-1);
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+  /* Detached by LogC_EngineStop() at the same time, so it's checked with the list mutex */
+  if((log->uiLogOptions&LOGC_OPTION_THREADSAFE) && (iLogC_EngineDetach_m(log)<0))
+    return(-1);
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  if((log->pptagPerCpuSlots) && (iLogC_PerCpuDrain_m(log)))
+    return(-1);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
   LOGC_MUTEX_LOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  /* Before the logfile, it may get the entries which couldn't be sent */
+  iLogC_SocketFlush_m(log);
+  vLogC_SocketFallback_m(log,0,1);
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
-  /* Check if there are entries to be written */
-  if((log->pcLogFileQueueBuffer) && (log->szLogFileQueueCount))
+  /* The routes first, they are kept if they can't be written, so LogC_End() can be called again */
+  if(iLogC_FileRoutesEnd_m(log))
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    return(-1);
+  }
+  /* Check if there are entries to be written or synced */
+  if(log->pcLogFileQueueBuffer)
   {
-    if(iLogC_WriteEntriesToDisk_m(log))
+    if((iLogC_WriteEntriesToDisk_m(log)) ||
+       (iLogC_FileBackendClose_m(log)) ||
+       (iLogC_FileSync_m(log,1)))
     {
       LOGC_MUTEX_UNLOCK(log);
       return(-1);
     }
+    vLogC_FileIndexClose_m(log);
+    vLogC_FileSyncClose_m(log);
+#ifdef LOGC_FEATURE_ENABLE_FILECACHE
+    vLogC_FileCacheDrop_m(log->caLogPath);
+#endif /* LOGC_FEATURE_ENABLE_FILECACHE */
     free(log->pcLogFileQueueBuffer);
+    log->pcLogFileQueueBuffer=NULL;
   }
 #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FILEQUEUE_SWAP
+  free(log->pcFileQueueSpare); /* The pending queue is written already */
+#endif /* LOGC_FILEQUEUE_SWAP */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  vLogC_ShmClose_m(log);
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  vLogC_PerCpuFree_m(log);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
 #ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
   while(log->szStoredLogsCount)
   {
     free(pcLogC_StoragePop_m(log,NULL));
   }
+  free(log->ptagStorageIndex);
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+  vLogC_RecorderFree_m(log);
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
   LOGC_MUTEX_UNLOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  LOGC_COND_DESTROY(log,tFileSyncCond);
+  LOGC_COND_DESTROY(log,tFileQueueCond);
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
   LOGC_MUTEX_DESTROY(log);
   free(log);
   return(0);
@@ -278,9 +1483,15 @@ int LogC_SetPrefixFormat(LogC log,
                          unsigned int newPrefixFormat)
 {
   int iRc;
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  vLogC_PerCpuLock_m(log,1); /* The options are used while adding to the slots */
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
   LOGC_MUTEX_LOCK(log);
   iRc=iLogC_SetPrefixFormat_m(log,newPrefixFormat);
   LOGC_MUTEX_UNLOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  vLogC_PerCpuLock_m(log,0);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
   return(iRc);
 }
 
@@ -288,12 +1499,125 @@ int LogC_SetLogOptions(LogC log,
                        unsigned int newOptions)
 {
   int iRc;
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  vLogC_PerCpuLock_m(log,1);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
   LOGC_MUTEX_LOCK(log);
   iRc=iLogC_SetLogOptions_m(log,newOptions);
   LOGC_MUTEX_UNLOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  vLogC_PerCpuLock_m(log,0);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
   return(iRc);
 }
 
+int LogC_SetBackpressure(LogC log,
+                         int policy,
+                         int keepLevel,
+                         unsigned int timeoutMs)
+{
+  if((policy!=LOGC_BACKPRESSURE_BLOCK) &&
+     (policy!=LOGC_BACKPRESSURE_DROP_NEWEST) &&
+     (policy!=LOGC_BACKPRESSURE_DROP_OLDEST))
+    return(-1);
+  LOGC_MUTEX_LOCK(log);
+  log->iBackpressurePolicy=policy;
+  log->iBackpressureKeepLevel=keepLevel;
+  log->uiBackpressureTimeoutMs=timeoutMs;
+  LOGC_MUTEX_UNLOCK(log);
+  return(0);
+}
+
+int LogC_SetTimeSource(LogC log,
+                       int timeSource)
+{
+  TagLogCTimeBase tagTimeBase;
+
+  if(iLogC_TimeBaseNew_m(&tagTimeBase,timeSource)) /* Without holding the mutex, the TSC calibration sleeps */
+    return(-1);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  vLogC_PerCpuLock_m(log,1); /* The time base is used while adding to the slots */
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  LOGC_MUTEX_LOCK(log);
+  log->tagTimeBase=tagTimeBase;
+  LOGC_MUTEX_UNLOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  vLogC_PerCpuLock_m(log,0);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  return(0);
+}
+
+int LogC_GetStats(LogC log,
+                  LogCStats *stats)
+{
+  if(!stats)
+    return(-1);
+  LOGC_MUTEX_LOCK(log);
+  *stats=log->tagStats;
+  LOGC_MUTEX_UNLOCK(log);
+  return(0);
+}
+
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+int LogC_DumpProfile(LogC log,
+                     FILE *stream,
+                     int reset)
+{
+  /* Percentiles in 1/1000 */
+  static const unsigned int uiaPercentiles[]={500,900,990,999};
+  const TagLogCProfile *ptagProfile;
+  unsigned long long ullaBuckets[LOGC_PROFILE_BUCKETS];
+  unsigned long long ullCount;
+  unsigned long long ullSeen;
+  size_t szStage;
+  size_t szBucket;
+  size_t szPercentile;
+
+  if(fprintf(stream,"LogC profile, unit: " LOGC_PROFILE_UNIT "\n")<0)
+    return(-1);
+  /* Just atomic reads, the stages may be measured meanwhile */
+  for(szStage=0;szStage<LOGC_PROFILE_STAGES;++szStage)
+  {
+    ptagProfile=&log->tagaProfile[szStage];
+    ullCount=0;
+    for(szBucket=0;szBucket<LOGC_PROFILE_BUCKETS;++szBucket)
+      ullCount+=(ullaBuckets[szBucket]=LOGC_PROFILE_LOAD(&ptagProfile->ullaBuckets[szBucket]));
+    if(!ullCount)
+      continue;
+    fprintf(stream,"%-10s count %llu total %llu avg %llu",
+            pcaLogCProfileStages_m[szStage],
+            ullCount,
+            LOGC_PROFILE_LOAD(&ptagProfile->ullTotal),
+            LOGC_PROFILE_LOAD(&ptagProfile->ullTotal)/ullCount);
+    /* The percentile is the start of the bucket it falls into */
+    for(szPercentile=0,szBucket=0,ullSeen=ullaBuckets[0];
+        szPercentile<sizeof(uiaPercentiles)/sizeof(uiaPercentiles[0]);
+        ++szPercentile)
+    {
+      while(ullSeen*1000<ullCount*uiaPercentiles[szPercentile])
+        ullSeen+=ullaBuckets[++szBucket];
+      fprintf(stream," p%g %llu",uiaPercentiles[szPercentile]/10.0,ullLogC_ProfileBucketStart_m(szBucket));
+    }
+    fputc('\n',stream);
+    for(szBucket=0;szBucket<LOGC_PROFILE_BUCKETS;++szBucket)
+    {
+      if(ullaBuckets[szBucket])
+        fprintf(stream,"  >=%llu %llu\n",ullLogC_ProfileBucketStart_m(szBucket),ullaBuckets[szBucket]);
+    }
+  }
+  if(reset)
+  {
+    for(szStage=0;szStage<LOGC_PROFILE_STAGES;++szStage)
+    {
+      LOGC_PROFILE_STORE(&log->tagaProfile[szStage].ullTotal,0);
+      for(szBucket=0;szBucket<LOGC_PROFILE_BUCKETS;++szBucket)
+        LOGC_PROFILE_STORE(&log->tagaProfile[szStage].ullaBuckets[szBucket],0);
+    }
+  }
+  return((fflush(stream))?-1:0);
+}
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
+
 int LogC_AddEntry_Text(LogC log,
                        int logType,
                        const char *fileName,
@@ -303,114 +1627,561 @@ int LogC_AddEntry_Text(LogC log,
                        ...)
 {
   int iRc=0;
-  size_t szCurrBufferPos=0;
   va_list vaArgs;
-  const struct TagLogType *ptagCurrLogType;
+  TagLogCMessage tagMessage;
+  LOGC_PROFILE_VAR(ullProfileStart)
 
   if(logType<log->iLogLevel)
-    return(0);
-  if(!(ptagCurrLogType=ptagLogC_GetLogType_m(logType)))
-    return(-1);
+  {
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+    if((log->ptagRecorder) && (logType>=log->ptagRecorder->iMinLogType))
+    {
+      va_start(vaArgs,logText);
+      iRc=iLogC_RecorderAdd_m(log,logType,fileName,lineNr,functionName,logText,&vaArgs,NULL,0);
+      va_end(vaArgs);
+    }
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+    return(iRc);
+  }
+  LOGC_PROFILE_START(ullProfileStart);
+  va_start(vaArgs,logText);
+  tagMessage.pcFormat=logText;
+  tagMessage.pvaArgs=&vaArgs;
+  tagMessage.pucData=NULL;
+  tagMessage.ullTimeNs=0;
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+  /* The recorded entries of the thread are added ahead of the one which triggered them */
+  if((log->ptagRecorder) && (logType>=log->ptagRecorder->iTriggerLogType))
+    iRc=iLogC_RecorderTrigger_m(log,logType,fileName,lineNr,functionName,&tagMessage);
+  else
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+  if(iLogC_AddEntry_m(log,logType,fileName,lineNr,functionName,&tagMessage))
+    iRc=-1;
+  va_end(vaArgs);
+  LOGC_PROFILE_END(log,LOGC_PROFILE_ADDENTRY,ullProfileStart);
+  return(iRc);
+}
 
-  LOGC_MUTEX_LOCK(log);
-  /* Add Timestamp, if needed */
-  if(iLogC_AddTimeStamp_m(log,&szCurrBufferPos))
+int LogC_AddEntry_Message(LogC log,
+                          int logType,
+                          const char *fileName,
+                          int lineNr,
+                          const char *functionName,
+                          const char *text,
+                          size_t textLength)
+{
+  int iRc=0;
+  TagLogCMessage tagMessage;
+  LOGC_PROFILE_VAR(ullProfileStart)
+
+  if(logType<log->iLogLevel)
   {
-    LOGC_MUTEX_UNLOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+    if((log->ptagRecorder) && (logType>=log->ptagRecorder->iMinLogType))
+      iRc=iLogC_RecorderAdd_m(log,logType,fileName,lineNr,functionName,NULL,NULL,text,textLength);
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+    return(iRc);
+  }
+  LOGC_PROFILE_START(ullProfileStart);
+  tagMessage.pcFormat=NULL;
+  tagMessage.pcText=text;
+  tagMessage.szTextLength=textLength;
+  tagMessage.pucData=NULL;
+  tagMessage.ullTimeNs=0;
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+  if((log->ptagRecorder) && (logType>=log->ptagRecorder->iTriggerLogType))
+    iRc=iLogC_RecorderTrigger_m(log,logType,fileName,lineNr,functionName,&tagMessage);
+  else
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+  if(iLogC_AddEntry_m(log,logType,fileName,lineNr,functionName,&tagMessage))
+    iRc=-1;
+  LOGC_PROFILE_END(log,LOGC_PROFILE_ADDENTRY,ullProfileStart);
+  return(iRc);
+}
+
+int LogC_IsLogTypeEnabled(LogC log,
+                          int logType)
+{
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+  if((log->ptagRecorder) && (logType>=log->ptagRecorder->iMinLogType))
+    return(1);
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+  return(logType>=log->iLogLevel);
+}
+
+int LogC_AddEntry_HexDump(LogC log,
+                          int logType,
+                          const char *fileName,
+                          int lineNr,
+                          const char *functionName,
+                          const void *data,
+                          size_t dataLength,
+                          const char *logText,
+                          ...)
+{
+  int iRc;
+  va_list vaArgs;
+  TagLogCMessage tagMessage;
+  char caText[LOGC_HEXDUMP_TEXT_MAXLEN];
+  LOGC_PROFILE_VAR(ullProfileStart)
+
+  if(logType<log->iLogLevel)
+    return(0);
+  if((!data) && (dataLength))
     return(-1);
+  /* Format the text once, it's repeated in each continuation entry */
+  va_start(vaArgs,logText);
+  errno=0;
+  iRc=iLogC_vsnprintf(caText,
+                      (log->szMaxEntryLength<sizeof(caText))?log->szMaxEntryLength+1:sizeof(caText),
+                      logText,
+                      vaArgs);
+  va_end(vaArgs);
+  if(errno==EINVAL)
+    return(-1);
+  if(iRc<0) /* Truncated */
+  {
+    caText[sizeof(caText)-1]='\0';
+    iRc=(int)strlen(caText);
   }
-  if(iLogC_AddPrefix_m(log,&szCurrBufferPos,ptagCurrLogType,fileName,lineNr,functionName))
+  tagMessage.pcFormat=NULL;
+  tagMessage.pcText=caText;
+  tagMessage.szTextLength=(size_t)iRc;
+  tagMessage.pucData=(data)?data:(const void*)""; /* Without payload, the entry just gets the position */
+  tagMessage.szDataLength=dataLength;
+  tagMessage.szDataOffset=0;
+  tagMessage.szDataTotal=dataLength;
+  tagMessage.ullTimeNs=0;
+  LOGC_PROFILE_START(ullProfileStart);
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+  if((log->ptagRecorder) && (logType>=log->ptagRecorder->iTriggerLogType))
+    iRc=iLogC_RecorderTrigger_m(log,logType,fileName,lineNr,functionName,&tagMessage);
+  else
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+  do
   {
-    LOGC_MUTEX_UNLOCK(log);
-    return(-1);
+    if((iRc=iLogC_AddEntry_m(log,logType,fileName,lineNr,functionName,&tagMessage)))
+      break;
+    tagMessage.pucData+=tagMessage.szDataAdded;
+    tagMessage.szDataLength-=tagMessage.szDataAdded;
+    tagMessage.szDataOffset+=tagMessage.szDataAdded;
+  }while(tagMessage.szDataLength);
+  LOGC_PROFILE_END(log,LOGC_PROFILE_ADDENTRY,ullProfileStart);
+  return(iRc);
+}
+
+LogCBatch LogC_BatchBegin(LogC log,
+                          size_t entries)
+{
+  LogCBatch ptagBatch;
+
+  if(!entries)
+    entries=LOGC_DEFAULT_FILEQUEUESIZE;
+  /* Check for Overflow of size_t */
+  if(entries>((size_t)-1)/(log->szMaxEntryLength+2))
+    return(NULL);
+  if(!(ptagBatch=malloc(sizeof(struct TagLogCBatch_t))))
+    return(NULL);
+  ptagBatch->ptagEntries=malloc(entries*sizeof(TagLogCBatchEntry));
+  ptagBatch->pcEntries=malloc(entries*(log->szMaxEntryLength+2));
+  if((!ptagBatch->ptagEntries) || (!ptagBatch->pcEntries))
+  {
+    vLogC_BatchFree_m(ptagBatch);
+    return(NULL);
   }
-  if(szCurrBufferPos) /* Add ': ' */
+  ptagBatch->ptagLog=log;
+  ptagBatch->tagTimeCache.uiOptions=0;
+  ptagBatch->szCount=0;
+  ptagBatch->szSize=entries;
+  ptagBatch->iMaxLogType=LOGC_ALL;
+  return(ptagBatch);
+}
+
+int LogC_BatchAdd(LogCBatch batch,
+                  int logType,
+                  const char *fileName,
+                  int lineNr,
+                  const char *functionName,
+                  const char *logText,
+                  ...)
+{
+  LogC ptagLog=batch->ptagLog;
+  int iRc=0;
+  va_list vaArgs;
+  TagLogCMessage tagMessage;
+  const struct TagLogType *ptagLogType;
+  LOGC_PROFILE_VAR(ullProfileStart)
+
+  if(logType<ptagLog->iLogLevel)
   {
-    if(log->szMaxEntryLength-szCurrBufferPos>2)
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+    if((ptagLog->ptagRecorder) && (logType>=ptagLog->ptagRecorder->iMinLogType))
     {
-      log->pcTextBuffer[szCurrBufferPos++]=':';
-      log->pcTextBuffer[szCurrBufferPos++]=' ';
+      va_start(vaArgs,logText);
+      iRc=iLogC_RecorderAdd_m(ptagLog,logType,fileName,lineNr,functionName,logText,&vaArgs,NULL,0);
+      va_end(vaArgs);
     }
-    else
-      return(-1);
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+    return(iRc);
   }
-  errno=0;
+  if(!(ptagLogType=ptagLogC_GetLogType_m(logType)))
+    return(-1);
+  LOGC_PROFILE_START(ullProfileStart);
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+  /* The recorded entries are added to the batch ahead of the entry which triggered them */
+  if((ptagLog->ptagRecorder) && (logType>=ptagLog->ptagRecorder->iTriggerLogType))
+    iRc=iLogC_RecorderDump_m(ptagLog,batch);
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
   va_start(vaArgs,logText);
-  iRc=iLogC_vsnprintf(&log->pcTextBuffer[szCurrBufferPos],
-                      log->szMaxEntryLength+1-szCurrBufferPos, /* +1 is okay, we have 2 more bytes reserved then szMaxEntryLength */
-                      logText,
-                      vaArgs);
+  tagMessage.pcFormat=logText;
+  tagMessage.pvaArgs=&vaArgs;
+  tagMessage.pucData=NULL;
+  tagMessage.ullTimeNs=0;
+  if(iLogC_BatchAddMessage_m(batch,ptagLogType,fileName,lineNr,functionName,&tagMessage))
+    iRc=-1;
   va_end(vaArgs);
-  if(errno==EINVAL)
+  LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_ADDENTRY,ullProfileStart);
+  return(iRc);
+}
+
+int LogC_BatchCommit(LogCBatch batch)
+{
+  LogC ptagLog=batch->ptagLog;
+  const struct TagLogType *ptagLogType;
+  const char *pcEntry;
+  size_t szLength;
+  size_t szIndex;
+  int iRc=0;
+  LOGC_PROFILE_VAR(ullProfileStart)
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  int iFileDropped=0;
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  int iShmDropped=0;
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  int iToSocket=0;
+  int iSocketOnly=0;
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+
+  if(!batch->szCount)
   {
-    LOGC_MUTEX_UNLOCK(log);
-    return(-1);
+    vLogC_BatchFree_m(batch);
+    return(0);
   }
-  /* Check for truncation */
-  if(iRc<1)
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  /* Entries staged before are added ahead of the batch */
+  if((LOGC_PERCPU_ENABLED(ptagLog)) && (iLogC_PerCpuDrain_m(ptagLog)))
+    iRc=-1;
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  LOGC_PROFILE_START(ullProfileStart);
+  LOGC_MUTEX_LOCK(ptagLog);
+  LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_LOCK,ullProfileStart);
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  if((ptagLog->ptagSocketEntries) && (iLogC_SocketReady_m(ptagLog)))
   {
-    szCurrBufferPos=log->szMaxEntryLength;
-    log->pcTextBuffer[szCurrBufferPos]='\n';
-    log->pcTextBuffer[++szCurrBufferPos]='\0';
+    iToSocket=1;
+    iSocketOnly=ptagLog->iSocketFallback;
+  #ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    iFileDropped=iSocketOnly;
+  #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
   }
-  else
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  /* The ring takes the whole batch or nothing, this may release the mutex before any entry is added */
+  if(ptagLog->ptagShm)
   {
-    szCurrBufferPos+=iRc;
-    /* Check if there's already a newline at the end */
-    if(log->pcTextBuffer[szCurrBufferPos-1]!='\n')
+    for(szLength=0,szIndex=0;szIndex<batch->szCount;++szIndex)
+      szLength+=batch->ptagEntries[szIndex].szLength;
+    if(iLogC_ShmReserve_m(ptagLog,batch->iMaxLogType,szLength))
     {
-      log->pcTextBuffer[szCurrBufferPos]='\n';
-      log->pcTextBuffer[++szCurrBufferPos]='\0';
+      iShmDropped=1;
+      ptagLog->ullShmDroppedPending+=batch->szCount-1; /* One is counted by the backpressure policy */
+      ptagLog->tagStats.ullDroppedCount+=batch->szCount-1;
+      if((ptagLog->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK) || (batch->iMaxLogType>=ptagLog->iBackpressureKeepLevel))
+        iRc=-1;
     }
   }
-  switch(ptagCurrLogType->eOutStream)
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+  for(szIndex=0;szIndex<batch->szCount;++szIndex)
   {
-    case LOGC_STDOUT:
-      if(!LOGC_OPTIONS_ENABLED(log,LOGC_OPTION_IGNORE_STDOUT))
-        fputs(log->pcTextBuffer,stdout);
-      break;
-    case LOGC_STDERR:
-      if(!LOGC_OPTIONS_ENABLED(log,LOGC_OPTION_IGNORE_STDERR))
-        fputs(log->pcTextBuffer,stderr);
-      break;
-    default:
-      break;
+    pcEntry=&batch->pcEntries[szIndex*(ptagLog->szMaxEntryLength+2)];
+    szLength=batch->ptagEntries[szIndex].szLength;
+    ptagLogType=batch->ptagEntries[szIndex].ptagLogType;
+    vLogC_PrintEntry_m(ptagLog,pcEntry,ptagLogType);
+#ifdef LOGC_FEATURE_ENABLE_SHM
+    if((ptagLog->ptagShm) && (!iShmDropped))
+      vLogC_ShmWrite_m(ptagLog,pcEntry,szLength);
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+    /* A full batch of the socket is sent before the next entry is added */
+    if((iToSocket) &&
+       (ptagLog->ptagSocketEntries) &&
+       (iLogC_SocketAdd_m(ptagLog,pcEntry,szLength,ptagLogType->iLogType)))
+      iLogC_SocketFlush_m(ptagLog);
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    if((ptagLog->ptagFileRoutes) &&
+  #ifdef LOGC_FEATURE_ENABLE_SOCKET
+       (!iSocketOnly) &&
+  #endif /* LOGC_FEATURE_ENABLE_SOCKET */
+       (iLogC_FileRoutesAdd_m(ptagLog,pcEntry,szLength,ptagLogType->iLogType,1)))
+      iRc=-1;
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+    if((ptagLog->szMaxStorageCount) &&
+  #ifdef LOGC_FEATURE_ENABLE_SOCKET
+       (!iSocketOnly) &&
+  #endif /* LOGC_FEATURE_ENABLE_SOCKET */
+       (iLogC_StorageAdd_m(ptagLog,pcEntry,szLength,ptagLogType->iLogType)))
+      iRc=-1;
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+    (void)szLength; /* Not needed without logfile, storage, ring and socket */
+    ++ptagLog->tagStats.ullEntryCount;
+  }
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  /* Last, writing the logfile may release the mutex, but not between the entries of the batch */
+  if((ptagLog->pcLogFileQueueBuffer) &&
+     (!iFileDropped) &&
+     (iLogC_FileQueueAddBatch_m(ptagLog,batch->ptagEntries,batch->pcEntries,batch->szCount)))
+    iRc=-1;
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+  LOGC_MUTEX_UNLOCK(ptagLog);
+  vLogC_BatchFree_m(batch);
+  return(iRc);
+}
+
+/**
+ * Format one entry into the batch, the batch grows if it's full.
+ */
+INLINE_FCT int iLogC_BatchAddMessage_m(LogCBatch ptagBatch,
+                                       const struct TagLogType *ptagLogType,
+                                       const char *pcFileName,
+                                       int iLineNr,
+                                       const char *pcFunction,
+                                       TagLogCMessage *ptagMessage)
+{
+  LogC ptagLog=ptagBatch->ptagLog;
+  TagLogCBatchEntry *ptagEntries;
+  char *pcEntries;
+  size_t szEntrySize=ptagLog->szMaxEntryLength+2;
+
+  if(ptagBatch->szCount==ptagBatch->szSize)
+  {
+    if(ptagBatch->szSize>((size_t)-1)/2/szEntrySize)
+      return(-1);
+    if(!(ptagEntries=realloc(ptagBatch->ptagEntries,ptagBatch->szSize*2*sizeof(TagLogCBatchEntry))))
+      return(-1);
+    ptagBatch->ptagEntries=ptagEntries;
+    if(!(pcEntries=realloc(ptagBatch->pcEntries,ptagBatch->szSize*2*szEntrySize)))
+      return(-1);
+    ptagBatch->pcEntries=pcEntries;
+    ptagBatch->szSize*=2;
+  }
+  if(iLogC_FormatEntry_m(ptagLog,
+                         &ptagBatch->pcEntries[ptagBatch->szCount*szEntrySize],
+                         &ptagBatch->tagTimeCache,
+                         ptagLogType,
+                         pcFileName,
+                         iLineNr,
+                         pcFunction,
+                         ptagMessage,
+                         &ptagBatch->ptagEntries[ptagBatch->szCount].szLength))
+    return(-1);
+  ptagBatch->ptagEntries[ptagBatch->szCount++].ptagLogType=ptagLogType;
+  if(ptagLogType->iLogType>ptagBatch->iMaxLogType)
+    ptagBatch->iMaxLogType=ptagLogType->iLogType;
+  return(0);
+}
+
+INLINE_FCT void vLogC_BatchFree_m(LogCBatch ptagBatch)
+{
+  free(ptagBatch->ptagEntries);
+  free(ptagBatch->pcEntries);
+  free(ptagBatch);
+}
+
+/**
+ * Add one entry to all outputs, the level of logType must be checked already.
+ */
+INLINE_FCT int iLogC_AddEntry_m(LogC log,
+                                int logType,
+                                const char *fileName,
+                                int lineNr,
+                                const char *functionName,
+                                TagLogCMessage *ptagMessage)
+{
+  int iRc=0;
+  size_t szCurrBufferPos=0;
+  const struct TagLogType *ptagCurrLogType;
+  LOGC_PROFILE_VAR(ullProfileStart)
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  int iWriteToDisk=0;
+  int iFileDropped=0;
+  int iFileError=0;
+  int iRoutesFailed=0;
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  int iShmDropped=0;
+  int iShmError=0;
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  int iToSocket=0;
+  int iSocketOnly=0;
+  int iSocketFlush=0;
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+
+  if(!(ptagCurrLogType=ptagLogC_GetLogType_m(logType)))
+    return(-1);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  if(LOGC_PERCPU_ENABLED(log))
+  {
+    iRc=iLogC_PerCpuAdd_m(log,ptagCurrLogType,fileName,lineNr,functionName,ptagMessage);
+    if(iRc!=1) /* Not disabled meanwhile */
+      return(iRc);
+  }
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+
+  LOGC_PROFILE_START(ullProfileStart);
+  LOGC_MUTEX_LOCK(log);
+  LOGC_PROFILE_END(log,LOGC_PROFILE_LOCK,ullProfileStart);
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  if((log->ptagSocketEntries) && (iLogC_SocketReady_m(log)))
+  {
+    iToSocket=1;
+    iSocketOnly=log->iSocketFallback; /* Logfile and storage just get entries which couldn't be sent then */
+  #ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    iFileDropped=iSocketOnly;
+  #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+  }
+  (void)iSocketOnly; /* Not needed without logfile and storage */
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+  /* Make space in the buffers first, this may release the mutex, so pcTextBuffer can't be used before */
+  for(;;)
+  {
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    if((log->pcLogFileQueueBuffer) && (!iFileDropped) && (iLogC_FileQueueReserve_m(log,logType)))
+    {
+      iFileDropped=1;
+      /* Failed to write if blocking timed out, otherwise dropped as requested */
+      iFileError=(log->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK) || (logType>=log->iBackpressureKeepLevel);
+    }
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+    if((log->ptagShm) && (!iShmDropped) && (iLogC_ShmReserve_m(log,logType,log->szMaxEntryLength+1)))
+    {
+      iShmDropped=1;
+      iShmError=(log->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK) || (logType>=log->iBackpressureKeepLevel);
+    }
+  #ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    /* The filequeue may be filled by another thread while waiting for the ring */
+    if((log->pcLogFileQueueBuffer) && (!iFileDropped) && (log->szLogFileQueueCount>=LOGC_DEFAULT_FILEQUEUESIZE))
+      continue;
+  #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    /* The other buffers may be filled by another thread while a route is written */
+    if(
+  #ifdef LOGC_FEATURE_ENABLE_SOCKET
+       (!iSocketOnly) &&
+  #endif /* LOGC_FEATURE_ENABLE_SOCKET */
+       (log->ptagFileRoutes) &&
+       (iLogC_FileRoutesReserve_m(log,logType,&iRoutesFailed)))
+      continue;
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+    break;
+  }
+  iRc=iLogC_FormatEntry_m(log,
+                          log->pcTextBuffer,
+                          &log->tagTimeCache,
+                          ptagCurrLogType,
+                          fileName,
+                          lineNr,
+                          functionName,
+                          ptagMessage,
+                          &szCurrBufferPos);
+  if(iRc)
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    return(-1);
   }
+  vLogC_PrintEntry_m(log,log->pcTextBuffer,ptagCurrLogType);
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  if((log->ptagShm) && (!iShmDropped))
+    vLogC_ShmWrite_m(log,log->pcTextBuffer,szCurrBufferPos);
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  if((iToSocket) && (log->ptagSocketEntries)) /* May be closed while waiting for space in the buffers */
+    iSocketFlush=iLogC_SocketAdd_m(log,log->pcTextBuffer,szCurrBufferPos,logType);
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
   ++szCurrBufferPos;
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
-  /* Add entry to filequeue, if needed */
-  if(log->pcLogFileQueueBuffer)
+  /* Add entry to filequeue, if needed and not dropped */
+  if((log->pcLogFileQueueBuffer) && (!iFileDropped))
   {
     assert(log->szLogFileQueueCount<LOGC_DEFAULT_FILEQUEUESIZE);
     memcpy(&log->pcLogFileQueueBuffer[log->szLogFileQueueCount*(log->szMaxEntryLength+2)],
            log->pcTextBuffer,
            szCurrBufferPos);
+    LOGC_FLUSHTIMER_ARM(log);
     ++log->szLogFileQueueCount;
-    if(log->szLogFileQueueCount==LOGC_DEFAULT_FILEQUEUESIZE)
-    {
-      if(iLogC_WriteEntriesToDisk_m(log))
-      {
-        LOGC_MUTEX_UNLOCK(log);
-        return(-1);
-      }
-    }
+    vLogC_FileIndexAdd_m(log,logType,szCurrBufferPos-1);
+    /* Write it later, writing may release the mutex while syncing and pcTextBuffer is needed until then */
+    iWriteToDisk=(log->szLogFileQueueCount==LOGC_DEFAULT_FILEQUEUESIZE);
   }
+  if((log->ptagFileRoutes) &&
+  #ifdef LOGC_FEATURE_ENABLE_SOCKET
+     (!iSocketOnly) &&
+  #endif /* LOGC_FEATURE_ENABLE_SOCKET */
+     (iLogC_FileRoutesAdd_m(log,log->pcTextBuffer,szCurrBufferPos-1,logType,0)))
+    iFileError=1;
 #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
 #ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
-  if(log->szMaxStorageCount)
+  if((log->szMaxStorageCount) &&
+  #ifdef LOGC_FEATURE_ENABLE_SOCKET
+     (!iSocketOnly) &&
+  #endif /* LOGC_FEATURE_ENABLE_SOCKET */
+     (iLogC_StorageAdd_m(log,log->pcTextBuffer,szCurrBufferPos-1,logType)))
   {
-    char *pcTmp;
-    if(!(pcTmp=malloc(sizeof(TagLogCEntry)+szCurrBufferPos)))
-    {
-      LOGC_MUTEX_UNLOCK(log);
-      return(-1);
-    }
-    ((TagLogCEntry*)(pcTmp+szCurrBufferPos))->pcText=pcTmp;
-    ((TagLogCEntry*)(pcTmp+szCurrBufferPos))->szTextLength=szCurrBufferPos;
-    memcpy(pcTmp,log->pcTextBuffer,szCurrBufferPos);
-    vLogC_StoragePush_m(log,((TagLogCEntry*)(pcTmp+szCurrBufferPos)));
+    LOGC_MUTEX_UNLOCK(log);
+    return(-1);
   }
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+  ++log->tagStats.ullEntryCount;
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  /* Entries which couldn't be sent are passed to the fallback, pcTextBuffer is not needed anymore */
+  if(iSocketFlush)
+    iLogC_SocketFlush_m(log);
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+  /* The engine writes the full queue, if it's still busy with the last one, the next entry waits for it */
+  if((iWriteToDisk) && (log->iEngineAttached))
+  {
+    iLogC_EngineHandOver_m(log,0);
+    iWriteToDisk=0;
+  }
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  /* The queues of the routes swapped out for this entry are written by this thread too */
+  if((log->ptagFileRoutes) &&
+     (iLogC_FileRoutesWrite_m(log)) &&
+     (log->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK))
+    iFileError=1;
+  /* A failed write is handled by the backpressure policy with the next entry, just blocking reports it */
+  if((iFileError) ||
+     ((iWriteToDisk) && (iLogC_FileQueueSwap_m(log)) && (log->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK)))
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    return(-1);
+  }
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  if(iShmError)
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    return(-1);
+  }
+#endif /* LOGC_FEATURE_ENABLE_SHM */
   LOGC_MUTEX_UNLOCK(log);
   return(0);
 }
@@ -464,7 +2235,200 @@ INLINE_FCT int iLogC_vsnprintf(char *pcDest,
   return(iRc);
 }
 
+/**
+ * Format a complete entry with prefix and '\n' into pcBuffer, which must hold szMaxEntryLength+2 bytes.
+ *
+ * @param pszLength Returns the length of the entry including '\n', without '\0'.
+ */
+INLINE_FCT int iLogC_FormatEntry_m(LogC ptagLog,
+                                   char *pcBuffer,
+                                   TagLogCTimeCache *ptagTimeCache,
+                                   const struct TagLogType *ptagLogType,
+                                   const char *pcFileName,
+                                   int iLineNr,
+                                   const char *pcFunction,
+                                   TagLogCMessage *ptagMessage,
+                                   size_t *pszLength)
+{
+  int iRc;
+  size_t szBufferPos=0;
+  LOGC_PROFILE_VAR(ullProfileStart)
+
+  /* Add Timestamp, if needed */
+  LOGC_PROFILE_START(ullProfileStart);
+  if(iLogC_AddTimeStamp_m(ptagLog,pcBuffer,ptagTimeCache,ptagMessage->ullTimeNs,&szBufferPos))
+    return(-1);
+  LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_TIMESTAMP,ullProfileStart);
+  LOGC_PROFILE_START(ullProfileStart);
+  if(iLogC_AddPrefix_m(ptagLog,pcBuffer,&szBufferPos,ptagLogType,pcFileName,iLineNr,pcFunction))
+    return(-1);
+  if(szBufferPos) /* Add ': ' */
+  {
+    if(ptagLog->szMaxEntryLength-szBufferPos>2)
+    {
+      pcBuffer[szBufferPos++]=':';
+      pcBuffer[szBufferPos++]=' ';
+    }
+    else
+    {
+      return(-1);
+    }
+  }
+  LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_PREFIX,ullProfileStart);
+  LOGC_PROFILE_START(ullProfileStart);
+  if(ptagMessage->pcFormat)
+  {
+    errno=0;
+    iRc=iLogC_vsnprintf(&pcBuffer[szBufferPos],
+                        ptagLog->szMaxEntryLength+1-szBufferPos, /* +1 is okay, we have 2 more bytes reserved then szMaxEntryLength */
+                        ptagMessage->pcFormat,
+                        *ptagMessage->pvaArgs);
+    if(errno==EINVAL)
+      return(-1);
+  }
+  else if(ptagMessage->szTextLength<=ptagLog->szMaxEntryLength-szBufferPos)
+  {
+    memcpy(&pcBuffer[szBufferPos],ptagMessage->pcText,ptagMessage->szTextLength);
+    pcBuffer[szBufferPos+ptagMessage->szTextLength]='\0';
+    iRc=(int)ptagMessage->szTextLength;
+  }
+  else
+  {
+    /* Truncated like a formatted text */
+    memcpy(&pcBuffer[szBufferPos],ptagMessage->pcText,ptagLog->szMaxEntryLength-szBufferPos);
+    iRc=-1;
+  }
+  if(ptagMessage->pucData)
+  {
+    /* The payload is never truncated, the text must leave space for it */
+    if(iRc<0)
+      return(-1);
+    szBufferPos+=(size_t)iRc;
+    if(iLogC_AddHexData_m(ptagLog,pcBuffer,&szBufferPos,ptagMessage))
+      return(-1);
+    pcBuffer[szBufferPos]='\n';
+    pcBuffer[++szBufferPos]='\0';
+  }
+  /* Check for truncation */
+  else if(iRc<1)
+  {
+    szBufferPos=ptagLog->szMaxEntryLength;
+    pcBuffer[szBufferPos]='\n';
+    pcBuffer[++szBufferPos]='\0';
+  }
+  else
+  {
+    szBufferPos+=iRc;
+    /* Check if there's already a newline at the end */
+    if(pcBuffer[szBufferPos-1]!='\n')
+    {
+      pcBuffer[szBufferPos]='\n';
+      pcBuffer[++szBufferPos]='\0';
+    }
+  }
+  LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_FORMAT,ullProfileStart);
+  *pszLength=szBufferPos;
+  return(0);
+}
+
+/**
+ * Append the position of the payload and as many bytes as fit as hex to the entry.
+ */
+INLINE_FCT int iLogC_AddHexData_m(LogC ptagLog,
+                                  char *pcBuffer,
+                                  size_t *pszBufferPos,
+                                  TagLogCMessage *ptagMessage)
+{
+  int iRc;
+  size_t szSpace;
+
+  if((iRc=iLogC_snprintf(&pcBuffer[*pszBufferPos],
+                         ptagLog->szMaxEntryLength+1-*pszBufferPos,
+                         " [%llu/%llu]%s",
+                         (unsigned long long)ptagMessage->szDataOffset,
+                         (unsigned long long)ptagMessage->szDataTotal,
+                         (ptagMessage->szDataLength)?" ":""))<0)
+    return(-1);
+  *pszBufferPos+=(size_t)iRc;
+  szSpace=(ptagLog->szMaxEntryLength-*pszBufferPos)/2;
+  if((!szSpace) && (ptagMessage->szDataLength))
+    return(-1);
+  ptagMessage->szDataAdded=(ptagMessage->szDataLength<szSpace)?ptagMessage->szDataLength:szSpace;
+  vLogC_HexEncode_m(&pcBuffer[*pszBufferPos],ptagMessage->pucData,ptagMessage->szDataAdded);
+  *pszBufferPos+=ptagMessage->szDataAdded*2;
+  return(0);
+}
+
+/**
+ * Write szLength bytes as lowercase hex to pcDest, without termination.
+ */
+INLINE_FCT void vLogC_HexEncode_m(char *pcDest,
+                                  const unsigned char *pucData,
+                                  size_t szLength)
+{
+  static const char caHexDigits[]="0123456789abcdef";
+  size_t szIndex=0;
+#ifdef LOGC_HEX_SSE2
+  /* 16 bytes at once: split into nibbles, interleave them and map 0-9 to '0'-'9' and 10-15 to 'a'-'f' */
+  const __m128i tMaskLow=_mm_set1_epi8(0x0F);
+  const __m128i tNine=_mm_set1_epi8(9);
+  const __m128i tDigit=_mm_set1_epi8('0');
+  const __m128i tLetter=_mm_set1_epi8('a'-'0'-10);
+  __m128i tData;
+  __m128i tHigh;
+  __m128i tLow;
+  __m128i tNibbles;
+
+  for(;szIndex+16<=szLength;szIndex+=16)
+  {
+    tData=_mm_loadu_si128((const __m128i*)&pucData[szIndex]);
+    tHigh=_mm_and_si128(_mm_srli_epi16(tData,4),tMaskLow);
+    tLow=_mm_and_si128(tData,tMaskLow);
+    tNibbles=_mm_unpacklo_epi8(tHigh,tLow);
+    tNibbles=_mm_add_epi8(_mm_add_epi8(tNibbles,tDigit),_mm_and_si128(_mm_cmpgt_epi8(tNibbles,tNine),tLetter));
+    _mm_storeu_si128((__m128i*)&pcDest[szIndex*2],tNibbles);
+    tNibbles=_mm_unpackhi_epi8(tHigh,tLow);
+    tNibbles=_mm_add_epi8(_mm_add_epi8(tNibbles,tDigit),_mm_and_si128(_mm_cmpgt_epi8(tNibbles,tNine),tLetter));
+    _mm_storeu_si128((__m128i*)&pcDest[szIndex*2+16],tNibbles);
+  }
+#endif /* LOGC_HEX_SSE2 */
+  for(;szIndex<szLength;++szIndex)
+  {
+    pcDest[szIndex*2]=caHexDigits[pucData[szIndex]>>4];
+    pcDest[szIndex*2+1]=caHexDigits[pucData[szIndex]&0x0F];
+  }
+}
+
+INLINE_FCT void vLogC_PrintEntry_m(LogC ptagLog,
+                                   const char *pcText,
+                                   const struct TagLogType *ptagLogType)
+{
+  FILE *fpStream=NULL;
+  LOGC_PROFILE_VAR(ullProfileStart)
+
+  switch(ptagLogType->eOutStream)
+  {
+    case LOGC_STDOUT:
+      if(!LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_IGNORE_STDOUT))
+        fpStream=stdout;
+      break;
+    case LOGC_STDERR:
+      if(!LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_IGNORE_STDERR))
+        fpStream=stderr;
+      break;
+    default:
+      break;
+  }
+  if(fpStream)
+  {
+    LOGC_PROFILE_START(ullProfileStart);
+    fputs(pcText,fpStream);
+    LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_PRINT,ullProfileStart);
+  }
+}
+
 INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
+                                 char *pcBuffer,
                                  size_t *pszBufferPos,
                                  const struct TagLogType *ptagLogType,
                                  const char *pcFileName,
@@ -480,7 +2444,7 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
   if(*pszBufferPos) /* Add ' ' */
   {
     if(ptagLog->szMaxEntryLength-*pszBufferPos>2)
-      ptagLog->pcTextBuffer[(*pszBufferPos)++]=' ';
+      pcBuffer[(*pszBufferPos)++]=' ';
     else
       return(-1);
   }
@@ -489,7 +2453,7 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
   {
     if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_LOGTYPETEXT))
     {
-      iRc=iLogC_snprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
+      iRc=iLogC_snprintf(&pcBuffer[*pszBufferPos],
                          ptagLog->szMaxEntryLength-*pszBufferPos,
                          LOGC_PREFIX_FORMAT_LOGTYPE LOGC_PREFIX_FORMAT_FILEFCTNAME,
                          ptagLogType->pcText,
@@ -499,7 +2463,7 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
     }
     else
     {
-      iRc=iLogC_snprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
+      iRc=iLogC_snprintf(&pcBuffer[*pszBufferPos],
                          ptagLog->szMaxEntryLength-*pszBufferPos,
                          LOGC_PREFIX_FORMAT_FILEFCTNAME,
                          pcFileName,
@@ -512,7 +2476,7 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
   {
     if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_LOGTYPETEXT))
     {
-      iRc=iLogC_snprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
+      iRc=iLogC_snprintf(&pcBuffer[*pszBufferPos],
                          ptagLog->szMaxEntryLength-*pszBufferPos,
                          LOGC_PREFIX_FORMAT_LOGTYPE LOGC_PREFIX_FORMAT_FILEINFO,
                          ptagLogType->pcText,
@@ -521,7 +2485,7 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
     }
     else
     {
-      iRc=iLogC_snprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
+      iRc=iLogC_snprintf(&pcBuffer[*pszBufferPos],
                          ptagLog->szMaxEntryLength-*pszBufferPos,
                          LOGC_PREFIX_FORMAT_FILEINFO,
                          pcFileName,
@@ -533,7 +2497,7 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
   {
     if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_LOGTYPETEXT))
     {
-      iRc=iLogC_snprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
+      iRc=iLogC_snprintf(&pcBuffer[*pszBufferPos],
                          ptagLog->szMaxEntryLength-*pszBufferPos,
                          LOGC_PREFIX_FORMAT_LOGTYPE LOGC_PREFIX_FORMAT_FCTNAME,
                          ptagLogType->pcText,
@@ -541,7 +2505,7 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
     }
     else
     {
-      iRc=iLogC_snprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
+      iRc=iLogC_snprintf(&pcBuffer[*pszBufferPos],
                          ptagLog->szMaxEntryLength-*pszBufferPos,
                          LOGC_PREFIX_FORMAT_FCTNAME,
                          pcFunction);
@@ -551,8 +2515,8 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
   {
     if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_LOGTYPETEXT))
     {
-      iRc=iLogC_snprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
-                         *pszBufferPos,
+      iRc=iLogC_snprintf(&pcBuffer[*pszBufferPos],
+                         ptagLog->szMaxEntryLength-*pszBufferPos,
                          LOGC_PREFIX_FORMAT_LOGTYPE,
                          ptagLogType->pcText);
     }
@@ -563,67 +2527,138 @@ INLINE_FCT int iLogC_AddPrefix_m(LogC ptagLog,
     *pszBufferPos+=iRc;
   else if(*pszBufferPos) /* Remove previously added ' ', if no text was added here */
     --(*pszBufferPos);
+#ifdef LOGC_FEATURE_ENABLE_CONTEXT
+  if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_THREADID))
+  {
+    if(!tagContext_m.szThreadIdLength)
+      vLogC_ContextThreadId_m(&tagContext_m);
+    if(iLogC_AddPrefixText_m(ptagLog,pcBuffer,pszBufferPos,tagContext_m.caThreadId,tagContext_m.szThreadIdLength))
+      return(-1);
+  }
+  if((LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_CONTEXT)) && (tagContext_m.szLength))
+  {
+    if(iLogC_AddPrefixText_m(ptagLog,pcBuffer,pszBufferPos,tagContext_m.caText,tagContext_m.szLength))
+      return(-1);
+  }
+#endif /* LOGC_FEATURE_ENABLE_CONTEXT */
+  return(0);
+}
+
+#ifdef LOGC_FEATURE_ENABLE_CONTEXT
+/**
+ * Add an already rendered part of the prefix, separated by ' '.
+ */
+INLINE_FCT int iLogC_AddPrefixText_m(LogC ptagLog,
+                                     char *pcBuffer,
+                                     size_t *pszBufferPos,
+                                     const char *pcText,
+                                     size_t szTextLength)
+{
+  size_t szNeeded=szTextLength+((*pszBufferPos)?1:0);
+
+  if(ptagLog->szMaxEntryLength-*pszBufferPos<=szNeeded)
+    return(-1);
+  if(*pszBufferPos)
+    pcBuffer[(*pszBufferPos)++]=' ';
+  memcpy(&pcBuffer[*pszBufferPos],pcText,szTextLength);
+  *pszBufferPos+=szTextLength;
   return(0);
 }
+#endif /* LOGC_FEATURE_ENABLE_CONTEXT */
 
-INLINE_FCT int iLogC_AddTimeStamp_m(LogC ptagLog, size_t *pszBufferPos)
+/**
+ * Add date, time and fractions of the second, all taken from one reading of the time source.
+ * The date and time text is cached in ptagTimeCache and just rebuilt if the second changes.
+ */
+INLINE_FCT int iLogC_AddTimeStamp_m(LogC ptagLog,
+                                    char *pcBuffer,
+                                    TagLogCTimeCache *ptagTimeCache,
+                                    unsigned long long ullTimeNs,
+                                    size_t *pszBufferPos)
 {
+  unsigned int uiCacheOptions;
+
+  if(!(ptagLog->uiLogOptions&(LOGC_OPTION_PREFIX_TIMESTAMP_DATE|LOGC_OPTION_PREFIX_TIMESTAMP_TIME|LOGC_TIMESTAMP_FRACTIONS)))
+    return(0);
+  if(!ullTimeNs)
+    ullTimeNs=ullLogC_GetEntryTimeNs_m(ptagLog);
   if(   LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_DATE)
      || LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_TIME))
   {
-    time_t tTime=time(NULL);
+    uiCacheOptions=ptagLog->uiLogOptions&(LOGC_OPTION_PREFIX_TIMESTAMP_DATE|LOGC_OPTION_PREFIX_TIMESTAMP_TIME|
+                                          LOGC_OPTION_TIMESTAMP_UTC|LOGC_OPTION_TIMESTAMP_LOCALTIME);
+    if((ptagTimeCache->uiOptions!=uiCacheOptions) || (ptagTimeCache->ullSecond!=ullTimeNs/1000000000ULL))
+    {
+      time_t tTime=(time_t)(ullTimeNs/1000000000ULL);
 #if defined(LOGC_FEATURE_ENABLE_THREADSAFETY) && !defined(_WIN32) /* Check if threadsafe implementation is needed (WIN32 localtime() is threadsafe anyway) */
-    struct tm tagTime;
+      struct tm tagTime;
   #if defined(_POSIX_VERSION) && (_POSIX_VERSION >= 200112L) /* POSIX IEEE 1003.1-2001 or newer */
-    if(LOGC_OPTION_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_UTC))
-      gmtime_r(&tTime,&tagTime);
-    else if(LOGC_OPTION_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_LOCALTIME))
-      localtime_r(&tTime,&tagTime);
-    else
-      return(-1);
+      if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_TIMESTAMP_UTC))
+        gmtime_r(&tTime,&tagTime);
+      else if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_TIMESTAMP_LOCALTIME))
+        localtime_r(&tTime,&tagTime);
+      else
+        return(-1);
   #else /* No POSIX nor Win32 */
     #error No threadsafe localtime() available!
   #endif /* _POSIX_VERSION >= 200112L */
 #else /* !LOGC_FEATURE_ENABLE_THREADSAFETY or WIN32 */
-    struct tm *ptagTime;
-    if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_TIMESTAMP_UTC))
-      ptagTime=gmtime(&tTime);
-    else if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_TIMESTAMP_LOCALTIME))
-      ptagTime=localtime(&tTime);
-    else
-      return(-1);
+      struct tm *ptagTime;
+      if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_TIMESTAMP_UTC))
+        ptagTime=gmtime(&tTime);
+      else if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_TIMESTAMP_LOCALTIME))
+        ptagTime=localtime(&tTime);
+      else
+        return(-1);
 #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY && !WIN32 */
 
-    if(!(*pszBufferPos+=strftime(ptagLog->pcTextBuffer,
-                                 ptagLog->szMaxEntryLength,
-                                 (LOGC_OPTIONS_ENABLED(ptagLog,(LOGC_OPTION_PREFIX_TIMESTAMP_DATE|LOGC_OPTION_PREFIX_TIMESTAMP_TIME)))?
-                                 LOGC_TIMESTAMP_FORMAT_DATETIME:(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_DATE))?
-                                 LOGC_TIMESTAMP_FORMAT_DATE:LOGC_TIMESTAMP_FORMAT_TIME,
+      ptagTimeCache->uiOptions=0;
+      if(!(ptagTimeCache->szLength=strftime(ptagTimeCache->caText,
+                                            sizeof(ptagTimeCache->caText),
+                                            (LOGC_OPTIONS_ENABLED(ptagLog,(LOGC_OPTION_PREFIX_TIMESTAMP_DATE|LOGC_OPTION_PREFIX_TIMESTAMP_TIME)))?
+                                            LOGC_TIMESTAMP_FORMAT_DATETIME:(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_DATE))?
+                                            LOGC_TIMESTAMP_FORMAT_DATE:LOGC_TIMESTAMP_FORMAT_TIME,
 #if defined(LOGC_FEATURE_ENABLE_THREADSAFETY) && !defined(_WIN32)
-                                 &tagTime
+                                            &tagTime
 #else /* !LOGC_FEATURE_ENABLE_THREADSAFETY or WIN32 */
-                                 ptagTime
+                                            ptagTime
 #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY && !WIN32 */
-                                 )))
-    {
-      return(-1);
+                                            )))
+      {
+        return(-1);
+      }
+      ptagTimeCache->uiOptions=uiCacheOptions;
+      ptagTimeCache->ullSecond=ullTimeNs/1000000000ULL;
     }
+    if(*pszBufferPos+ptagTimeCache->szLength>=ptagLog->szMaxEntryLength)
+      return(-1);
+    memcpy(&pcBuffer[*pszBufferPos],ptagTimeCache->caText,ptagTimeCache->szLength);
+    *pszBufferPos+=ptagTimeCache->szLength;
   }
-  if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MILLISECS))
+  if(ptagLog->uiLogOptions&LOGC_TIMESTAMP_FRACTIONS)
   {
-#if defined _WIN32
-    SYSTEMTIME tCurrSysTime;
-    GetSystemTime(&tCurrSysTime);
-    *pszBufferPos+=sprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
-                           ((LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_TIME)) || (!*pszBufferPos))?".%.3u":" .%.3u",
-                           tCurrSysTime.wMilliseconds);
-#elif defined (__unix__) /* Checked above for availibility */
-    struct timespec tagTime;
-    clock_gettime(CLOCK_REALTIME,&tagTime);
-    *pszBufferPos+=sprintf(&ptagLog->pcTextBuffer[*pszBufferPos],
-                           ((LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_TIME)) || (!*pszBufferPos))?".%.3u":" .%.3u",
-                           tagTime.tv_nsec/1000000);
-#endif /* _WIN32 */
+    unsigned int uiFraction=(unsigned int)(ullTimeNs%1000000000ULL);
+    int iDigits;
+
+    if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_TIME_NANOSECS))
+    {
+      iDigits=9;
+    }
+    else if(LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MICROSECS))
+    {
+      iDigits=6;
+      uiFraction/=1000;
+    }
+    else
+    {
+      iDigits=3;
+      uiFraction/=1000000;
+    }
+    if((!LOGC_OPTIONS_ENABLED(ptagLog,LOGC_OPTION_PREFIX_TIMESTAMP_TIME)) && (*pszBufferPos))
+      pcBuffer[(*pszBufferPos)++]=' ';
+    if(*pszBufferPos+1+(size_t)iDigits>=ptagLog->szMaxEntryLength)
+      return(-1);
+    *pszBufferPos+=sprintf(&pcBuffer[*pszBufferPos],".%.*u",iDigits,uiFraction);
   }
   return(0);
 }
@@ -632,17 +2667,14 @@ INLINE_FCT int iLogC_SetPrefixFormat_m(LogC ptagLog,
                                        unsigned int uiFormat)
 {
   /* Check for invalid Options */
-  if(BITS_UNSET(uiFormat,
-                (LOGC_OPTION_PREFIX_TIMESTAMP_DATE           |
-                 LOGC_OPTION_PREFIX_TIMESTAMP_TIME           |
-                 LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MILLISECS |
-                 LOGC_OPTION_PREFIX_LOGTYPETEXT              |
-                 LOGC_OPTION_PREFIX_FILEINFO                 |
-                 LOGC_OPTION_PREFIX_FUNCTIONNAME)))
+  if(BITS_UNSET(uiFormat,LOGC_OPTIONS_PREFIX))
   {
     return(-1);
   }
-  ptagLog->uiLogOptions&=0xFF00; /* Reset all Format options, but keep others */
+  /* Just one precision for the fractions of the second */
+  if((uiFormat&LOGC_TIMESTAMP_FRACTIONS) & ((uiFormat&LOGC_TIMESTAMP_FRACTIONS)-1))
+    return(-1);
+  ptagLog->uiLogOptions&=LOGC_OPTIONS_OTHER; /* Reset all Format options, but keep others */
   ptagLog->uiLogOptions|=uiFormat;
   return(0);
 }
@@ -671,9 +2703,9 @@ INLINE_FCT int iLogC_SetLogOptions_m(LogC ptagLog,
       uiOptions|=ptagLog->uiLogOptions&(LOGC_OPTION_TIMESTAMP_UTC|LOGC_OPTION_TIMESTAMP_LOCALTIME);
   }
 #ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
-  ptagLog->uiLogOptions&=(0x00FF|LOGC_OPTION_THREADSAFE); /* Reset logoptions, but keep format options+threadsafe bit if set */
+  ptagLog->uiLogOptions&=(LOGC_OPTIONS_PREFIX|LOGC_OPTION_THREADSAFE); /* Reset logoptions, but keep format options+threadsafe bit if set */
 #else
-  ptagLog->uiLogOptions&=0x00FF; /* Reset logoptions, but keep format options */
+  ptagLog->uiLogOptions&=LOGC_OPTIONS_PREFIX; /* Reset logoptions, but keep format options */
 #endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
   ptagLog->uiLogOptions|=uiOptions;
   return(0);
@@ -683,20 +2715,47 @@ INLINE_FCT int iLogC_SetLogOptions_m(LogC ptagLog,
 int LogC_SetFilePath(LogC log,
                      const char *newPath)
 {
+  size_t szIndexBlockSize;
+  unsigned int uiIndexIntervalMs;
+  char caOldPath[LOGC_PATH_MAXLEN];
+  int iRc=0;
+
   /* If Path is set, check if it's valid */
   if((newPath) && (iLogC_CheckFilePathValid_m(newPath)))
     return(-1);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  if((LOGC_PERCPU_ENABLED(log)) && (iLogC_PerCpuDrain_m(log)))
+    return(-1);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
 
   LOGC_MUTEX_LOCK(log);
-  /* Write queue to old file first, if needed */
-  if((log->pcLogFileQueueBuffer) && (log->szLogFileQueueCount))
-    if(iLogC_WriteEntriesToDisk_m(log))
+  /* The index follows the logfile, it's stopped until the queue is written to the old file */
+  szIndexBlockSize=log->szIndexBlockSize;
+  uiIndexIntervalMs=log->uiIndexIntervalMs;
+  vLogC_FileIndexClose_m(log);
+  /* Write queue to old file first and sync it, if needed */
+  if(log->pcLogFileQueueBuffer)
+    if((iLogC_WriteEntriesToDisk_m(log)) ||
+       (iLogC_FileBackendClose_m(log)) ||
+       (iLogC_FileSync_m(log,1)))
     {
       LOGC_MUTEX_UNLOCK(log);
       return(-1);
     }
+  vLogC_FileSyncClose_m(log);
+#ifdef LOGC_FEATURE_ENABLE_FILECACHE
+  /* The old logfile may be rotated now, so its descriptor isn't kept */
+  if(log->pcLogFileQueueBuffer)
+    vLogC_FileCacheDrop_m(log->caLogPath);
+#endif /* LOGC_FEATURE_ENABLE_FILECACHE */
   if(newPath) /* If new path is set, copy anyway */
   {
+#ifdef LOGC_FILEQUEUE_SWAP
+    vLogC_FileQueueWaitWriter_m(log); /* The pending queue may be written with the path without holding the mutex */
+#endif /* LOGC_FILEQUEUE_SWAP */
+    caOldPath[0]='\0';
+    if(log->pcLogFileQueueBuffer)
+      strcpy(caOldPath,log->caLogPath);
     strcpy(log->caLogPath,newPath);
     if(!log->pcLogFileQueueBuffer)
       if(!(log->pcLogFileQueueBuffer=malloc(LOGC_DEFAULT_FILEQUEUESIZE*(log->szMaxEntryLength+2))))
@@ -704,6 +2763,30 @@ int LogC_SetFilePath(LogC log,
         LOGC_MUTEX_UNLOCK(log);
         return(-1);
       }
+    if(iLogC_FileBackendOpen_m(log))
+    {
+      /* The filemode is not supported for the new file, keep the old logfile */
+      iRc=-1;
+      if(!caOldPath[0])
+      {
+        free(log->pcLogFileQueueBuffer);
+        log->pcLogFileQueueBuffer=NULL;
+        LOGC_MUTEX_UNLOCK(log);
+        return(-1);
+      }
+      strcpy(log->caLogPath,caOldPath);
+      if(iLogC_FileBackendOpen_m(log)) /* Not even for the old file anymore, fall back to the default mode */
+      {
+        perror("Failed to reopen LogFile in its filemode, using the default filemode: ");
+        log->iFileMode=LOGC_FILEMODE_DEFAULT;
+        iLogC_FileBackendOpen_m(log);
+      }
+    }
+    if(((szIndexBlockSize) || (uiIndexIntervalMs)) && (!iLogC_FileIndexOpen_m(log)))
+    {
+      log->szIndexBlockSize=szIndexBlockSize;
+      log->uiIndexIntervalMs=uiIndexIntervalMs;
+    }
   }
   else if(log->pcLogFileQueueBuffer) /* Path was set before, but is not needed anymore */
   {
@@ -711,58 +2794,4567 @@ int LogC_SetFilePath(LogC log,
     log->pcLogFileQueueBuffer=NULL;
   }
   LOGC_MUTEX_UNLOCK(log);
-  return(0);
+  return(iRc);
 }
 
-int LogC_WriteEntriesToDisk(LogC log)
+int LogC_SetFileSync(LogC log,
+                     int syncMode,
+                     unsigned int intervalMs)
 {
-  int iRc;
+  if((syncMode!=LOGC_FILESYNC_NONE) &&
+     (syncMode!=LOGC_FILESYNC_FLUSH) &&
+     (syncMode!=LOGC_FILESYNC_INTERVAL))
+    return(-1);
   LOGC_MUTEX_LOCK(log);
-  if((!log->pcLogFileQueueBuffer) || (!log->szLogFileQueueCount))
-    iRc=0;
-  else
-    iRc=iLogC_WriteEntriesToDisk_m(log);
+  log->iFileSyncMode=syncMode;
+  log->uiFileSyncIntervalMs=intervalMs;
   LOGC_MUTEX_UNLOCK(log);
-  return(iRc);
+  return(0);
 }
 
-INLINE_FCT int iLogC_WriteEntriesToDisk_m(LogC ptagLog)
+int LogC_SetFileMode(LogC log,
+                     int fileMode)
 {
-  FILE *fp;
-  size_t szIndex;
-
-  if(!(fp=fopen(ptagLog->caLogPath,"a")))
+  int iRc=0;
+  int iOldMode;
+  if(fileMode==LOGC_FILEMODE_DEFAULT)
+    ;
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+  else if(fileMode==LOGC_FILEMODE_DIRECT)
+    ;
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+  else if(fileMode==LOGC_FILEMODE_APPEND)
+    ;
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+  else
+    return(-1);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  if((LOGC_PERCPU_ENABLED(log)) && (iLogC_PerCpuDrain_m(log)))
+    return(-1);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  LOGC_MUTEX_LOCK(log);
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+  /* The offsets of the index don't fit if other processes append to the logfile */
+  if((fileMode==LOGC_FILEMODE_APPEND) && (log->fpIndex))
   {
-    perror("Failed to Open LogFile: ");
+    LOGC_MUTEX_UNLOCK(log);
     return(-1);
   }
-  for(szIndex=0;szIndex<ptagLog->szLogFileQueueCount;++szIndex)
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+  iOldMode=log->iFileMode;
+  log->iFileMode=fileMode;
+  if(log->pcLogFileQueueBuffer)
   {
-    fputs(&ptagLog->pcLogFileQueueBuffer[szIndex*(ptagLog->szMaxEntryLength+2)],fp);
+    if((iLogC_WriteEntriesToDisk_m(log)) ||
+       (iLogC_FileBackendClose_m(log)))
+      iRc=-1;
+    else if(iLogC_FileBackendOpen_m(log))
+    {
+      log->iFileMode=iOldMode;
+      iLogC_FileBackendOpen_m(log);
+      iRc=-1;
+    }
   }
-  ptagLog->szLogFileQueueCount=0;
-  fclose(fp);
-  return(0);
+  LOGC_MUTEX_UNLOCK(log);
+  return(iRc);
 }
 
-INLINE_FCT int iLogC_CheckFilePathValid_m(const char *pcPath)
+int LogC_SetFileRoutes(LogC log,
+                       const LogCFileRoute *routes,
+                       size_t routeCount)
 {
-  FILE *fp;
+  TagLogCFileRoute *ptagRoutes=NULL;
 
-  if(!pcPath)
+  if(!routes)
+    routeCount=0;
+  if((routeCount) && (!(ptagRoutes=ptagLogC_FileRoutesNew_m(log->szMaxEntryLength,routes,routeCount))))
     return(-1);
-
-  if(strlen(pcPath)>LOGC_PATH_MAXLEN-1)
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  if((LOGC_PERCPU_ENABLED(log)) && (iLogC_PerCpuDrain_m(log)))
+  {
+    free(ptagRoutes);
     return(-1);
-
-  /* Check for valid file path and write permissions */
-  if(!(fp=fopen(pcPath,"a")))
+  }
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  LOGC_MUTEX_LOCK(log);
+  if(iLogC_FileRoutesEnd_m(log))
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    free(ptagRoutes);
     return(-1);
-
-  fclose(fp);
+  }
+  log->ptagFileRoutes=ptagRoutes;
+  log->szFileRouteCount=routeCount;
+  LOGC_MUTEX_UNLOCK(log);
   return(0);
 }
-#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+
+int LogC_SetFileIndex(LogC log,
+                      size_t blockSize,
+                      unsigned int intervalMs)
+{
+  int iRc=0;
+
+  LOGC_MUTEX_LOCK(log);
+  vLogC_FileIndexClose_m(log);
+  if((blockSize) || (intervalMs))
+  {
+    if(iLogC_FileIndexOpen_m(log))
+      iRc=-1;
+    else
+    {
+      log->szIndexBlockSize=blockSize;
+      log->uiIndexIntervalMs=intervalMs;
+    }
+  }
+  LOGC_MUTEX_UNLOCK(log);
+  return(iRc);
+}
+
+int LogC_WriteEntriesToDisk(LogC log)
+{
+  int iRc;
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  if((LOGC_PERCPU_ENABLED(log)) && (iLogC_PerCpuDrain_m(log)))
+    return(-1);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  LOGC_MUTEX_LOCK(log);
+  if(!log->pcLogFileQueueBuffer)
+    iRc=0;
+  else if(iLogC_WriteEntriesToDisk_m(log))
+    iRc=-1;
+  else if(iLogC_FileBackendComplete_m(log)) /* Wait for asynchronous writes too */
+    iRc=-1;
+  else /* Writes left unsynced by LOGC_FILESYNC_INTERVAL too */
+    iRc=iLogC_FileSync_m(log,1);
+  if(iLogC_FileRoutesFlush_m(log,1))
+    iRc=-1;
+  LOGC_MUTEX_UNLOCK(log);
+  return(iRc);
+}
+
+/**
+ * Write the filequeue, if there are entries. A pending queue, swapped out or handed over to the engine, is written first.
+ * May release the mutex while syncing.
+ */
+INLINE_FCT int iLogC_WriteEntriesToDisk_m(LogC ptagLog)
+{
+#ifdef LOGC_FILEQUEUE_SWAP
+  vLogC_FileQueueWaitWriter_m(ptagLog);
+  if(ptagLog->pcFileQueuePending) /* Not taken by the engine yet, or writing it failed */
+  {
+    if(iLogC_FileWrite_m(ptagLog,ptagLog->pcFileQueuePending,ptagLog->szFileQueuePendingCount))
+      return(-1);
+    ptagLog->pcFileQueueSpare=ptagLog->pcFileQueuePending;
+    ptagLog->pcFileQueuePending=NULL;
+    LOGC_COND_BROADCAST(ptagLog,tFileQueueCond);
+    if(!ptagLog->szLogFileQueueCount)
+      return(iLogC_FileWritten_m(ptagLog));
+    /* Count it, but sync once after the queue is written too */
+    ++ptagLog->ullFileWriteSeq;
+    ++ptagLog->tagStats.ullFileWriteCount;
+  }
+#endif /* LOGC_FILEQUEUE_SWAP */
+  if(!ptagLog->szLogFileQueueCount)
+    return(0);
+  if(iLogC_FileWrite_m(ptagLog,ptagLog->pcLogFileQueueBuffer,ptagLog->szLogFileQueueCount))
+    return(-1);
+  ptagLog->szLogFileQueueCount=0;
+  return(iLogC_FileWritten_m(ptagLog));
+}
+
+/**
+ * Write entries to the logfile with the current writer backend.
+ * Doesn't change the Log-Object, so the engine calls it without holding the mutex.
+ */
+INLINE_FCT int iLogC_FileWrite_m(LogC ptagLog,
+                                 const char *pcQueueBuffer,
+                                 size_t szEntryCount)
+{
+  int iRc;
+  LOGC_PROFILE_VAR(ullProfileStart)
+
+  LOGC_PROFILE_START(ullProfileStart);
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+  if(ptagLog->ptagDirect)
+    iRc=iLogC_DirectWrite_m(ptagLog->ptagDirect,
+                            pcQueueBuffer,
+                            szEntryCount,
+                            ptagLog->szMaxEntryLength+2);
+  else
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+  if(ptagLog->ptagAppend)
+    iRc=iLogC_AppendWrite_m(ptagLog->ptagAppend,
+                            pcQueueBuffer,
+                            szEntryCount,
+                            ptagLog->szMaxEntryLength+2);
+  else
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+  if(ptagLog->ptagUring)
+    iRc=iLogC_UringWrite_m(ptagLog->ptagUring,
+                           pcQueueBuffer,
+                           szEntryCount,
+                           ptagLog->szMaxEntryLength+2);
+  else
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+    iRc=iLogC_WriteQueueToFile_m(ptagLog->caLogPath,
+                                 pcQueueBuffer,
+                                 szEntryCount,
+                                 ptagLog->szMaxEntryLength+2);
+  LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_FILEWRITE,ullProfileStart);
+  return(iRc);
+}
+
+/**
+ * Count a successful write and sync the logfile according to the durability mode.
+ * May release the mutex while syncing.
+ */
+INLINE_FCT int iLogC_FileWritten_m(LogC ptagLog)
+{
+  ++ptagLog->ullFileWriteSeq;
+  ++ptagLog->tagStats.ullFileWriteCount;
+  /* The data must be written completely before it can be synced */
+  if((ptagLog->iFileSyncMode!=LOGC_FILESYNC_NONE) && (iLogC_FileBackendComplete_m(ptagLog)))
+    return(-1);
+  return(iLogC_FileSync_m(ptagLog,0));
+}
+
+/**
+ * Make sure there's a free entry in the filequeue, apply the backpressure policy if it's full.
+ * Adds the marker for dropped entries if there are at least 2 free entries.
+ *
+ * @return 0 if the entry can be added, 1 if it's dropped.
+ */
+INLINE_FCT int iLogC_FileQueueReserve_m(LogC ptagLog,
+                                        int iLogType)
+{
+  unsigned long long ullDeadlineNs=0;
+  unsigned int uiWaitMs=0;
+  size_t szEntrySize=ptagLog->szMaxEntryLength+2;
+
+  while(ptagLog->szLogFileQueueCount>=LOGC_DEFAULT_FILEQUEUESIZE)
+  {
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+    if(ptagLog->iEngineAttached)
+    {
+      /* Wait for the engine, unless the entry may be dropped */
+      if(!iLogC_EngineHandOver_m(ptagLog,
+                                 (ptagLog->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK) ||
+                                 (iLogType>=ptagLog->iBackpressureKeepLevel)))
+        break;
+    }
+    else
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+    /* Full if writing failed before or if it was filled again while the last queue was written, try again */
+    if(!iLogC_FileQueueSwap_m(ptagLog))
+      continue;
+    switch(iLogC_BackpressureDrop_m(ptagLog,iLogType,&ullDeadlineNs,&uiWaitMs,&ptagLog->ullDroppedPending))
+    {
+      case 0: /* Retry */
+        break;
+      case 2:
+        vLogC_FileIndexDrop_m(ptagLog);
+        memmove(ptagLog->pcLogFileQueueBuffer,
+                &ptagLog->pcLogFileQueueBuffer[szEntrySize],
+                (--ptagLog->szLogFileQueueCount)*szEntrySize);
+        break;
+      default:
+        return(1);
+    }
+  }
+  if((ptagLog->ullDroppedPending) &&
+     (ptagLog->szLogFileQueueCount+1<LOGC_DEFAULT_FILEQUEUESIZE) &&
+     (iLogC_snprintf(&ptagLog->pcLogFileQueueBuffer[ptagLog->szLogFileQueueCount*szEntrySize],
+                     szEntrySize,
+                     LOGC_TEXT_DROPPED,
+                     ptagLog->ullDroppedPending)>0))
+  {
+    vLogC_FileIndexAdd_m(ptagLog,0,strlen(&ptagLog->pcLogFileQueueBuffer[ptagLog->szLogFileQueueCount*szEntrySize]));
+    LOGC_FLUSHTIMER_ARM(ptagLog);
+    ++ptagLog->szLogFileQueueCount;
+    ptagLog->ullDroppedPending=0;
+  }
+  return(0);
+}
+
+/**
+ * Add a complete entry to the filequeue, write the queue first if it's full.
+ * May release the mutex while writing or syncing.
+ *
+ * @param szLength Length of the text without '\0', the text must end with '\n'.
+ * @param iLogType Logtype of the entry, for the index.
+ */
+INLINE_FCT int iLogC_FileQueueAdd_m(LogC ptagLog,
+                                    const char *pcText,
+                                    size_t szLength,
+                                    int iLogType)
+{
+  char *pcEntry;
+  while(ptagLog->szLogFileQueueCount>=LOGC_DEFAULT_FILEQUEUESIZE)
+  {
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+    if(ptagLog->iEngineAttached)
+    {
+      if(iLogC_EngineHandOver_m(ptagLog,1))
+        return(-1);
+    }
+    else
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+    if(iLogC_FileQueueSwap_m(ptagLog))
+      return(-1);
+  }
+  if(!ptagLog->pcLogFileQueueBuffer) /* Logfile disabled while syncing */
+    return(-1);
+  pcEntry=&ptagLog->pcLogFileQueueBuffer[ptagLog->szLogFileQueueCount*(ptagLog->szMaxEntryLength+2)];
+  memcpy(pcEntry,pcText,szLength);
+  pcEntry[szLength]='\0';
+  LOGC_FLUSHTIMER_ARM(ptagLog);
+  ++ptagLog->szLogFileQueueCount;
+  vLogC_FileIndexAdd_m(ptagLog,iLogType,szLength);
+  return(0);
+}
+
+/**
+ * Add the entries of a batch to the logfile in one piece: to the filequeue if they fit,
+ * otherwise the queue is written first and the batch is written directly behind it.
+ * May release the mutex before the batch is added, but not while it's added.
+ */
+INLINE_FCT int iLogC_FileQueueAddBatch_m(LogC ptagLog,
+                                         const TagLogCBatchEntry *ptagEntries,
+                                         const char *pcEntries,
+                                         size_t szCount)
+{
+  size_t szEntrySize=ptagLog->szMaxEntryLength+2;
+  size_t szIndex;
+
+  for(;;)
+  {
+    if(!ptagLog->pcLogFileQueueBuffer) /* Logfile disabled while syncing */
+      return(-1);
+    if(szCount<=LOGC_DEFAULT_FILEQUEUESIZE-ptagLog->szLogFileQueueCount)
+    {
+      memcpy(&ptagLog->pcLogFileQueueBuffer[ptagLog->szLogFileQueueCount*szEntrySize],pcEntries,szCount*szEntrySize);
+      LOGC_FLUSHTIMER_ARM(ptagLog);
+      ptagLog->szLogFileQueueCount+=szCount;
+      for(szIndex=0;szIndex<szCount;++szIndex)
+        vLogC_FileIndexAdd_m(ptagLog,ptagEntries[szIndex].ptagLogType->iLogType,ptagEntries[szIndex].szLength);
+      if(ptagLog->szLogFileQueueCount<LOGC_DEFAULT_FILEQUEUESIZE)
+        return(0);
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+      if(ptagLog->iEngineAttached)
+      {
+        iLogC_EngineHandOver_m(ptagLog,0); /* If it's still busy, the next entry waits for it */
+        return(0);
+      }
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+      return(iLogC_FileQueueSwap_m(ptagLog));
+    }
+#ifdef LOGC_FILEQUEUE_SWAP
+    /* The pending queue must not be written at the same time */
+    vLogC_FileQueueWaitWriter_m(ptagLog);
+    if((!ptagLog->szLogFileQueueCount) && (!ptagLog->pcFileQueuePending))
+      break;
+#else
+    if(!ptagLog->szLogFileQueueCount)
+      break;
+#endif /* LOGC_FILEQUEUE_SWAP */
+    if(iLogC_WriteEntriesToDisk_m(ptagLog))
+      return(-1);
+  }
+  if(iLogC_FileWrite_m(ptagLog,pcEntries,szCount))
+    return(-1);
+  for(szIndex=0;szIndex<szCount;++szIndex)
+    vLogC_FileIndexAdd_m(ptagLog,ptagEntries[szIndex].ptagLogType->iLogType,ptagEntries[szIndex].szLength);
+  return(iLogC_FileWritten_m(ptagLog));
+}
+
+INLINE_FCT int iLogC_WriteQueueToFile_m(const char *pcPath,
+                                        const char *pcQueueBuffer,
+                                        size_t szEntryCount,
+                                        size_t szEntrySize)
+{
+  FILE *fp;
+  size_t szIndex;
+#ifdef LOGC_FEATURE_ENABLE_FILECACHE
+  TagLogCFileCacheEntry *ptagEntry;
+  int iRc;
+
+  /* Without a free descriptor in the cache, the logfile is opened just for this write */
+  if((ptagEntry=ptagLogC_FileCacheAcquire_m(pcPath)))
+  {
+    iRc=iLogC_FileCacheWrite_m(ptagEntry->iFileFd,pcQueueBuffer,szEntryCount,szEntrySize);
+    vLogC_FileCacheRelease_m(ptagEntry,iRc);
+    return(iRc);
+  }
+#endif /* LOGC_FEATURE_ENABLE_FILECACHE */
+  if(!(fp=fopen(pcPath,"a")))
+  {
+    perror("Failed to Open LogFile: ");
+    return(-1);
+  }
+  for(szIndex=0;szIndex<szEntryCount;++szIndex)
+  {
+    fputs(&pcQueueBuffer[szIndex*szEntrySize],fp);
+  }
+  fclose(fp);
+  return(0);
+}
+
+/**
+ * Syncs the logfile to disk according to the current durability mode,
+ * must be called with the mutex locked, but releases it while syncing.
+ * Group commit: if another thread is already syncing, wait for it and check if
+ * our write was covered by that sync, otherwise sync everything written until now.
+ */
+INLINE_FCT int iLogC_FileSync_m(LogC ptagLog,
+                                int iForce)
+{
+  unsigned long long ullOwnSeq=ptagLog->ullFileWriteSeq;
+  unsigned long long ullSyncSeq;
+  unsigned long long ullStartNs;
+  unsigned long long ullTimeNs;
+  char caPath[LOGC_PATH_MAXLEN];
+  int iRc;
+  LOGC_PROFILE_VAR(ullProfileStart)
+
+  if(ptagLog->iFileSyncMode==LOGC_FILESYNC_NONE)
+    return(0);
+  if((!iForce) &&
+     (ptagLog->iFileSyncMode==LOGC_FILESYNC_INTERVAL) &&
+     (ullLogC_GetTimeNs_m()-ptagLog->ullFileLastSyncNs<ptagLog->uiFileSyncIntervalMs*1000000ULL))
+  {
+    /* Synced recently, will be covered by one of the next syncs or by the flush timer */
+    LOGC_FLUSHTIMER_ARM_SYNC(ptagLog);
+    return(0);
+  }
+  while(ptagLog->ullFileSyncedSeq<ullOwnSeq)
+  {
+    if(ptagLog->iFileSyncRunning)
+    {
+      LOGC_COND_WAIT(ptagLog,tFileSyncCond);
+      continue;
+    }
+    ullSyncSeq=ptagLog->ullFileWriteSeq;
+    strcpy(caPath,ptagLog->caLogPath);
+    ptagLog->iFileSyncRunning=1;
+    LOGC_MUTEX_UNLOCK(ptagLog);
+    ullStartNs=ullLogC_GetTimeNs_m();
+    LOGC_PROFILE_START(ullProfileStart);
+    iRc=iLogC_SyncFile_m(caPath,&ptagLog->iFileSyncFd);
+    LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_FILESYNC,ullProfileStart);
+    ullTimeNs=ullLogC_GetTimeNs_m()-ullStartNs;
+    LOGC_MUTEX_LOCK(ptagLog);
+    ptagLog->iFileSyncRunning=0;
+    LOGC_COND_BROADCAST(ptagLog,tFileSyncCond);
+    if(iRc)
+      return(-1);
+    if(ptagLog->ullFileSyncedSeq<ullSyncSeq)
+      ptagLog->ullFileSyncedSeq=ullSyncSeq;
+    ptagLog->ullFileLastSyncNs=ullStartNs;
+    ++ptagLog->tagStats.ullFileSyncCount;
+    ptagLog->tagStats.ullFileSyncTimeTotalNs+=ullTimeNs;
+    if(ullTimeNs>ptagLog->tagStats.ullFileSyncTimeMaxNs)
+      ptagLog->tagStats.ullFileSyncTimeMaxNs=ullTimeNs;
+  }
+  return(0);
+}
+
+/**
+ * Set up the writer backend for the current logfilepath and filemode.
+ * If an optional backend is not available, the logfile is written with normal writes.
+ *
+ * @return 0 on success, negative value if the filemode is not supported for this file.
+ */
+INLINE_FCT int iLogC_FileBackendOpen_m(LogC ptagLog)
+{
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+  if(ptagLog->iFileMode==LOGC_FILEMODE_DIRECT)
+  {
+    if(!(ptagLog->ptagDirect=ptagLogC_DirectNew_m(ptagLog->caLogPath,
+                                                  LOGC_DEFAULT_FILEQUEUESIZE*(ptagLog->szMaxEntryLength+2))))
+      return(-1);
+    return(0);
+  }
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+  if(ptagLog->iFileMode==LOGC_FILEMODE_APPEND)
+  {
+    if(!(ptagLog->ptagAppend=ptagLogC_AppendNew_m(ptagLog->caLogPath,ptagLog->szMaxEntryLength+2)))
+      return(-1);
+    return(0);
+  }
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+  ptagLog->ptagUring=ptagLogC_UringNew_m(ptagLog->caLogPath,
+                                         LOGC_DEFAULT_FILEQUEUESIZE*(ptagLog->szMaxEntryLength+2));
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+  (void)ptagLog;
+  return(0);
+}
+
+/**
+ * Wait until all writes of the writer backend are completed, also writes pending partial blocks.
+ */
+INLINE_FCT int iLogC_FileBackendComplete_m(LogC ptagLog)
+{
+#ifdef LOGC_FILEQUEUE_SWAP
+  vLogC_FileQueueWaitWriter_m(ptagLog);
+#endif /* LOGC_FILEQUEUE_SWAP */
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+  if(ptagLog->ptagDirect)
+    return(iLogC_DirectWriteBlocks_m(ptagLog->ptagDirect,1));
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+  if(ptagLog->ptagUring)
+    return(iLogC_UringComplete_m(ptagLog->ptagUring));
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+  (void)ptagLog;
+  return(0);
+}
+
+/**
+ * Complete all writes and release the writer backend.
+ */
+INLINE_FCT int iLogC_FileBackendClose_m(LogC ptagLog)
+{
+  int iRc=0;
+#ifdef LOGC_FILEQUEUE_SWAP
+  vLogC_FileQueueWaitWriter_m(ptagLog);
+#endif /* LOGC_FILEQUEUE_SWAP */
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+  if(ptagLog->ptagDirect)
+  {
+    iRc=iLogC_DirectEnd_m(ptagLog->ptagDirect);
+    ptagLog->ptagDirect=NULL;
+  }
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+  if(ptagLog->ptagAppend) /* Written completely by each write */
+  {
+    vLogC_AppendEnd_m(ptagLog->ptagAppend);
+    ptagLog->ptagAppend=NULL;
+  }
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+  if(ptagLog->ptagUring)
+  {
+    iRc=iLogC_UringEnd_m(ptagLog->ptagUring);
+    ptagLog->ptagUring=NULL;
+  }
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+  (void)ptagLog;
+  return(iRc);
+}
+
+/**
+ * Sync the logfile to disk. The descriptor is opened with the first sync and kept open for the next ones,
+ * it's closed again if the sync fails.
+ *
+ * @param piFd Descriptor of the logfile, -1 if it's not opened yet.
+ */
+INLINE_FCT int iLogC_SyncFile_m(const char *pcPath,
+                                int *piFd)
+{
+  int iRc;
+#ifdef _WIN32
+  if((*piFd<0) && ((*piFd=_open(pcPath,_O_WRONLY|_O_APPEND))<0))
+    return(-1);
+  iRc=_commit(*piFd);
+#else /* __unix__ */
+  if((*piFd<0) && ((*piFd=open(pcPath,O_WRONLY|O_APPEND|O_CLOEXEC))<0))
+    return(-1);
+  #if defined(_POSIX_SYNCHRONIZED_IO) && (_POSIX_SYNCHRONIZED_IO > 0)
+  iRc=fdatasync(*piFd);
+  #else
+  iRc=fsync(*piFd);
+  #endif /* _POSIX_SYNCHRONIZED_IO */
+#endif /* _WIN32 */
+  if(iRc)
+  {
+    perror("Failed to sync LogFile: ");
+    LOGC_FILE_CLOSE(*piFd);
+    *piFd=-1;
+    return(-1);
+  }
+  return(0);
+}
+
+/**
+ * Close the descriptor used for syncing, before the logfilepath changes.
+ * Must be called with the mutex locked, waits for a running sync.
+ */
+INLINE_FCT void vLogC_FileSyncClose_m(LogC ptagLog)
+{
+  while(ptagLog->iFileSyncRunning)
+  {
+    LOGC_COND_WAIT(ptagLog,tFileSyncCond);
+  }
+  if(ptagLog->iFileSyncFd>=0)
+  {
+    LOGC_FILE_CLOSE(ptagLog->iFileSyncFd);
+    ptagLog->iFileSyncFd=-1;
+  }
+}
+
+INLINE_FCT int iLogC_CheckFilePathValid_m(const char *pcPath)
+{
+  FILE *fp;
+
+  if(!pcPath)
+    return(-1);
+
+  if(strlen(pcPath)>LOGC_PATH_MAXLEN-1)
+    return(-1);
+
+  /* Check for valid file path and write permissions */
+  if(!(fp=fopen(pcPath,"a")))
+    return(-1);
+
+  fclose(fp);
+  return(0);
+}
+
+/**
+ * Check the routing table and allocate the routes with both queues of each route in one block.
+ *
+ * @return The routes, NULL if the table is invalid or on allocation failure.
+ */
+INLINE_FCT TagLogCFileRoute *ptagLogC_FileRoutesNew_m(size_t szMaxEntryLength,
+                                                      const LogCFileRoute *ptagRoutes,
+                                                      size_t szRouteCount)
+{
+  TagLogCFileRoute *ptagNewRoutes;
+  TagLogCFileRoute *ptagRoute;
+  char *pcQueue;
+  size_t szEntrySize=szMaxEntryLength+2;
+  size_t szQueueSize;
+  size_t szSize=szRouteCount*sizeof(TagLogCFileRoute);
+  size_t szIndex;
+
+  for(szIndex=0;szIndex<szRouteCount;++szIndex)
+  {
+    if((iLogC_CheckFilePathValid_m(ptagRoutes[szIndex].pcFilePath)) ||
+       (ptagRoutes[szIndex].iMinLogType>ptagRoutes[szIndex].iMaxLogType) ||
+       ((ptagRoutes[szIndex].iSyncMode!=LOGC_FILESYNC_NONE) &&
+        (ptagRoutes[szIndex].iSyncMode!=LOGC_FILESYNC_FLUSH) &&
+        (ptagRoutes[szIndex].iSyncMode!=LOGC_FILESYNC_INTERVAL)))
+      return(NULL);
+    szSize+=2*((ptagRoutes[szIndex].szQueueSize)?ptagRoutes[szIndex].szQueueSize:LOGC_DEFAULT_FILEQUEUESIZE)*szEntrySize;
+  }
+  if(!(ptagNewRoutes=malloc(szSize)))
+    return(NULL);
+  pcQueue=(char*)&ptagNewRoutes[szRouteCount];
+  for(szIndex=0;szIndex<szRouteCount;++szIndex)
+  {
+    ptagRoute=&ptagNewRoutes[szIndex];
+    szQueueSize=(ptagRoutes[szIndex].szQueueSize)?ptagRoutes[szIndex].szQueueSize:LOGC_DEFAULT_FILEQUEUESIZE;
+    ptagRoute->iMinLogType=ptagRoutes[szIndex].iMinLogType;
+    ptagRoute->iMaxLogType=ptagRoutes[szIndex].iMaxLogType;
+    ptagRoute->iSyncMode=ptagRoutes[szIndex].iSyncMode;
+    ptagRoute->uiSyncIntervalMs=ptagRoutes[szIndex].uiSyncIntervalMs;
+    ptagRoute->iUnsynced=0;
+    ptagRoute->iSyncFd=-1;
+    ptagRoute->ullLastSyncNs=0;
+    ptagRoute->ullDroppedPending=0;
+    ptagRoute->iWriting=0;
+    ptagRoute->szQueueSize=szQueueSize;
+    ptagRoute->szQueueCount=0;
+    ptagRoute->pcQueue=pcQueue;
+    ptagRoute->pcSpare=pcQueue+szQueueSize*szEntrySize;
+    ptagRoute->pcPending=NULL;
+    ptagRoute->szPendingCount=0;
+    pcQueue+=2*szQueueSize*szEntrySize;
+    strcpy(ptagRoute->caPath,ptagRoutes[szIndex].pcFilePath);
+  }
+  return(ptagNewRoutes);
+}
+
+/**
+ * Make space in the routes, which match the logtype, before an entry is formatted:
+ * If both queues of a route are full, the pending queue is written, unless another thread writes it already.
+ * Then just a blocking backpressure policy waits for the other thread. A route, which is still full,
+ * drops the entry in iLogC_FileRoutesAdd_m().
+ * May release the mutex, then all routes are checked again.
+ *
+ * @param piWriteFailed Set if a write failed, it isn't tried again then. Pass a pointer to 0 on the first call for an entry.
+ *
+ * @return 1 if the mutex was released, so other buffers may be full again, otherwise 0.
+ */
+INLINE_FCT int iLogC_FileRoutesReserve_m(LogC ptagLog,
+                                         int iLogType,
+                                         int *piWriteFailed)
+{
+  TagLogCFileRoute *ptagRoute;
+  size_t szIndex=0;
+  int iReleased=0;
+
+  /* The routes may be replaced while the mutex is released, so they are accessed by index */
+  while(szIndex<ptagLog->szFileRouteCount)
+  {
+    ptagRoute=&ptagLog->ptagFileRoutes[szIndex];
+    if((iLogType<ptagRoute->iMinLogType) ||
+       (iLogType>ptagRoute->iMaxLogType) ||
+       (ptagRoute->szQueueCount<ptagRoute->szQueueSize))
+    {
+      ++szIndex;
+      continue;
+    }
+    if(!ptagRoute->pcPending)
+    {
+      vLogC_FileRouteSwap_m(ptagRoute);
+      continue;
+    }
+    if((!ptagRoute->iWriting) && (!*piWriteFailed))
+    {
+      if(iLogC_FileRouteWrite_m(ptagLog,ptagRoute,0,0))
+        *piWriteFailed=1;
+    }
+    else if((ptagRoute->iWriting) &&
+            ((ptagLog->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK) || (iLogType>=ptagLog->iBackpressureKeepLevel)))
+      LOGC_COND_WAIT(ptagLog,tFileQueueCond);
+    else
+    {
+      ++szIndex;
+      continue;
+    }
+    iReleased=1;
+    szIndex=0;
+  }
+  return(iReleased);
+}
+
+/**
+ * Copy the entry into the queue of each route it matches, a full queue is swapped out for writing.
+ * If both queues of a route are full, the backpressure policy drops the entry or the oldest entry of the queue.
+ *
+ * @param szLength    Length of the text without '\0', the text must end with '\n'.
+ * @param iMayRelease If set, space is made with iLogC_FileRoutesReserve_m() before and the swapped out queues
+ *                    are written after the entry is added, which releases the mutex.
+ *                    Otherwise the mutex isn't released, so the text may be the buffer of the Log-Object,
+ *                    the caller writes the queues with iLogC_FileRoutesWrite_m() later.
+ *
+ * @return 0 on success, negative value if the entry was dropped for a route and the policy doesn't allow it,
+ *         or with iMayRelease if writing failed for LOGC_BACKPRESSURE_BLOCK.
+ */
+INLINE_FCT int iLogC_FileRoutesAdd_m(LogC ptagLog,
+                                     const char *pcText,
+                                     size_t szLength,
+                                     int iLogType,
+                                     int iMayRelease)
+{
+  TagLogCFileRoute *ptagRoute;
+  char *pcEntry;
+  size_t szEntrySize=ptagLog->szMaxEntryLength+2;
+  size_t szIndex;
+  int iWriteFailed=0;
+  int iRc=0;
+
+  if(iMayRelease)
+    iLogC_FileRoutesReserve_m(ptagLog,iLogType,&iWriteFailed);
+  for(szIndex=0;szIndex<ptagLog->szFileRouteCount;++szIndex)
+  {
+    ptagRoute=&ptagLog->ptagFileRoutes[szIndex];
+    if((iLogType<ptagRoute->iMinLogType) || (iLogType>ptagRoute->iMaxLogType))
+      continue;
+    if((ptagRoute->szQueueCount==ptagRoute->szQueueSize) && (!ptagRoute->pcPending))
+      vLogC_FileRouteSwap_m(ptagRoute);
+    if(ptagRoute->szQueueCount==ptagRoute->szQueueSize)
+    {
+      /* Both queues are full, a blocking policy waited in iLogC_FileRoutesReserve_m() already */
+      ++ptagLog->tagStats.ullDroppedCount;
+      ++ptagRoute->ullDroppedPending;
+      if((ptagLog->iBackpressurePolicy!=LOGC_BACKPRESSURE_DROP_OLDEST) || (iLogType>=ptagLog->iBackpressureKeepLevel))
+      {
+        if((ptagLog->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK) || (iLogType>=ptagLog->iBackpressureKeepLevel))
+          iRc=-1;
+        continue;
+      }
+      memmove(ptagRoute->pcQueue,&ptagRoute->pcQueue[szEntrySize],(--ptagRoute->szQueueCount)*szEntrySize);
+    }
+    else if((ptagRoute->ullDroppedPending) &&
+            (ptagRoute->szQueueCount+1<ptagRoute->szQueueSize) &&
+            (iLogC_snprintf(&ptagRoute->pcQueue[ptagRoute->szQueueCount*szEntrySize],
+                            szEntrySize,
+                            LOGC_TEXT_DROPPED,
+                            ptagRoute->ullDroppedPending)>0))
+    {
+      ++ptagRoute->szQueueCount;
+      ptagRoute->ullDroppedPending=0;
+    }
+    pcEntry=&ptagRoute->pcQueue[ptagRoute->szQueueCount*szEntrySize];
+    memcpy(pcEntry,pcText,szLength);
+    pcEntry[szLength]='\0';
+    if((++ptagRoute->szQueueCount==ptagRoute->szQueueSize) && (!ptagRoute->pcPending))
+      vLogC_FileRouteSwap_m(ptagRoute);
+  }
+  if((iMayRelease) &&
+     (iLogC_FileRoutesWrite_m(ptagLog)) &&
+     (ptagLog->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK))
+    iRc=-1;
+  return(iRc);
+}
+
+/**
+ * Swap the current queue of the route with the spare queue, it's pending then.
+ * There must not be a pending queue.
+ */
+INLINE_FCT void vLogC_FileRouteSwap_m(TagLogCFileRoute *ptagRoute)
+{
+  ptagRoute->pcPending=ptagRoute->pcQueue;
+  ptagRoute->szPendingCount=ptagRoute->szQueueCount;
+  ptagRoute->pcQueue=ptagRoute->pcSpare;
+  ptagRoute->pcSpare=NULL;
+  ptagRoute->szQueueCount=0;
+}
+
+/**
+ * Write the pending queue of the route without holding the mutex and sync the logfile according to its durability mode.
+ * Just one thread writes a route at a time, so it must not be written by another thread,
+ * the route isn't released until the write is done. A failed write is counted and stays pending.
+ * Releases the mutex.
+ *
+ * @param iAll       The current queue is swapped out and written too, if it has entries.
+ * @param iForceSync Sync pending writes, also if the interval isn't over yet.
+ */
+INLINE_FCT int iLogC_FileRouteWrite_m(LogC ptagLog,
+                                      TagLogCFileRoute *ptagRoute,
+                                      int iAll,
+                                      int iForceSync)
+{
+  unsigned long long ullStartNs;
+  unsigned long long ullTimeNs;
+  char *pcQueue;
+  int iRc=0;
+  LOGC_PROFILE_VAR(ullProfileStart)
+
+  ptagRoute->iWriting=1;
+  for(;;)
+  {
+    if((iAll) && (!ptagRoute->pcPending) && (ptagRoute->szQueueCount))
+    {
+      vLogC_FileRouteSwap_m(ptagRoute);
+      iAll=0;
+    }
+    if(!ptagRoute->pcPending)
+      break;
+    pcQueue=ptagRoute->pcPending;
+    LOGC_MUTEX_UNLOCK(ptagLog);
+    LOGC_PROFILE_START(ullProfileStart);
+    iRc=iLogC_WriteQueueToFile_m(ptagRoute->caPath,
+                                 pcQueue,
+                                 ptagRoute->szPendingCount,
+                                 ptagLog->szMaxEntryLength+2);
+    LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_FILEWRITE,ullProfileStart);
+    LOGC_MUTEX_LOCK(ptagLog);
+    if(iRc)
+      break;
+    ptagRoute->pcSpare=pcQueue;
+    ptagRoute->pcPending=NULL;
+    ptagRoute->iUnsynced=1;
+    ++ptagLog->tagStats.ullFileWriteCount;
+  }
+  ullStartNs=ullLogC_GetTimeNs_m();
+  if((!iRc) &&
+     (ptagRoute->iUnsynced) &&
+     (ptagRoute->iSyncMode!=LOGC_FILESYNC_NONE) &&
+     ((iForceSync) ||
+      (ptagRoute->iSyncMode!=LOGC_FILESYNC_INTERVAL) ||
+      (ullStartNs-ptagRoute->ullLastSyncNs>=ptagRoute->uiSyncIntervalMs*1000000ULL)))
+  {
+    LOGC_MUTEX_UNLOCK(ptagLog);
+    LOGC_PROFILE_START(ullProfileStart);
+    iRc=iLogC_SyncFile_m(ptagRoute->caPath,&ptagRoute->iSyncFd);
+    LOGC_PROFILE_END(ptagLog,LOGC_PROFILE_FILESYNC,ullProfileStart);
+    ullTimeNs=ullLogC_GetTimeNs_m()-ullStartNs;
+    LOGC_MUTEX_LOCK(ptagLog);
+    if(!iRc)
+    {
+      ptagRoute->iUnsynced=0;
+      ptagRoute->ullLastSyncNs=ullStartNs;
+      ++ptagLog->tagStats.ullFileSyncCount;
+      ptagLog->tagStats.ullFileSyncTimeTotalNs+=ullTimeNs;
+      if(ullTimeNs>ptagLog->tagStats.ullFileSyncTimeMaxNs)
+        ptagLog->tagStats.ullFileSyncTimeMaxNs=ullTimeNs;
+    }
+  }
+  ptagRoute->iWriting=0;
+  LOGC_COND_BROADCAST(ptagLog,tFileQueueCond);
+  if(iRc)
+  {
+    ++ptagLog->tagStats.ullFileRouteErrorCount;
+    return(-1);
+  }
+  return(0);
+}
+
+/**
+ * Write the pending queues of the routes, which aren't written by another thread.
+ * Releases the mutex, so the text of the last entry must not be needed anymore.
+ */
+INLINE_FCT int iLogC_FileRoutesWrite_m(LogC ptagLog)
+{
+  TagLogCFileRoute *ptagRoute;
+  size_t szIndex;
+  int iRc=0;
+
+  for(szIndex=0;szIndex<ptagLog->szFileRouteCount;++szIndex)
+  {
+    ptagRoute=&ptagLog->ptagFileRoutes[szIndex];
+    if((ptagRoute->pcPending) && (!ptagRoute->iWriting) && (iLogC_FileRouteWrite_m(ptagLog,ptagRoute,0,0)))
+      iRc=-1;
+  }
+  return(iRc);
+}
+
+/**
+ * Write both queues of all routes, waits for other threads writing a route.
+ * Releases the mutex.
+ *
+ * @param iForceSync Sync pending writes, also if the interval isn't over yet.
+ */
+INLINE_FCT int iLogC_FileRoutesFlush_m(LogC ptagLog,
+                                       int iForceSync)
+{
+  size_t szIndex=0;
+  int iRc=0;
+
+  while(szIndex<ptagLog->szFileRouteCount)
+  {
+    if(ptagLog->ptagFileRoutes[szIndex].iWriting)
+    {
+      LOGC_COND_WAIT(ptagLog,tFileQueueCond);
+      continue;
+    }
+    if(iLogC_FileRouteWrite_m(ptagLog,&ptagLog->ptagFileRoutes[szIndex],1,iForceSync))
+      iRc=-1;
+    ++szIndex;
+  }
+  return(iRc);
+}
+
+/**
+ * Write and sync all routes and release them, they are kept if one of them can't be written.
+ * Flushing releases the mutex, so it's repeated until no route has entries left.
+ */
+INLINE_FCT int iLogC_FileRoutesEnd_m(LogC ptagLog)
+{
+  TagLogCFileRoute *ptagRoute;
+  size_t szIndex=0;
+
+  while(szIndex<ptagLog->szFileRouteCount)
+  {
+    ptagRoute=&ptagLog->ptagFileRoutes[szIndex++];
+    if((ptagRoute->iWriting) ||
+       (ptagRoute->pcPending) ||
+       (ptagRoute->szQueueCount) ||
+       ((ptagRoute->iUnsynced) && (ptagRoute->iSyncMode!=LOGC_FILESYNC_NONE)))
+    {
+      if(iLogC_FileRoutesFlush_m(ptagLog,1))
+        return(-1);
+      szIndex=0;
+    }
+  }
+  for(szIndex=0;szIndex<ptagLog->szFileRouteCount;++szIndex)
+  {
+    if(ptagLog->ptagFileRoutes[szIndex].iSyncFd>=0)
+      LOGC_FILE_CLOSE(ptagLog->ptagFileRoutes[szIndex].iSyncFd);
+#ifdef LOGC_FEATURE_ENABLE_FILECACHE
+    vLogC_FileCacheDrop_m(ptagLog->ptagFileRoutes[szIndex].caPath);
+#endif /* LOGC_FEATURE_ENABLE_FILECACHE */
+  }
+  free(ptagLog->ptagFileRoutes);
+  ptagLog->ptagFileRoutes=NULL;
+  ptagLog->szFileRouteCount=0;
+  return(0);
+}
+
+/**
+ * Start the index for the current logfile. All entries are written first,
+ * so the position of the next entry is the size of the logfile.
+ * The index must be disabled, entries added while the mutex is released are just written without record.
+ * Not available with LOGC_FILEMODE_APPEND, other processes may append to the logfile then.
+ * May release the mutex.
+ */
+INLINE_FCT int iLogC_FileIndexOpen_m(LogC ptagLog)
+{
+  char caIndexPath[LOGC_PATH_MAXLEN];
+#ifdef _WIN32
+  struct _stati64 tagStat;
+#else /* __unix__ */
+  struct stat tagStat;
+#endif /* _WIN32 */
+
+  if((!ptagLog->pcLogFileQueueBuffer) ||
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+     (ptagLog->iFileMode==LOGC_FILEMODE_APPEND) ||
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+     (strlen(ptagLog->caLogPath)+sizeof(LOGC_INDEX_SUFFIX)>LOGC_PATH_MAXLEN))
+    return(-1);
+  for(;;)
+  {
+    if((iLogC_WriteEntriesToDisk_m(ptagLog)) ||
+       (iLogC_FileBackendComplete_m(ptagLog)) ||
+       (!ptagLog->pcLogFileQueueBuffer)) /* Logfile disabled while syncing */
+      return(-1);
+#ifdef LOGC_FILEQUEUE_SWAP
+    if(ptagLog->pcFileQueuePending)
+      continue;
+#endif /* LOGC_FILEQUEUE_SWAP */
+    if(!ptagLog->szLogFileQueueCount)
+      break;
+  }
+#ifdef _WIN32
+  if(_stati64(ptagLog->caLogPath,&tagStat))
+#else /* __unix__ */
+  if(stat(ptagLog->caLogPath,&tagStat))
+#endif /* _WIN32 */
+    return(-1);
+  vLogC_FileIndexClose_m(ptagLog); /* Started by another thread while the mutex was released */
+  strcpy(caIndexPath,ptagLog->caLogPath);
+  strcat(caIndexPath,LOGC_INDEX_SUFFIX);
+  /* The records of an old index don't fit to an empty logfile */
+  if(!(ptagLog->fpIndex=fopen(caIndexPath,(tagStat.st_size)?"ab":"wb")))
+    return(-1);
+  ptagLog->ullIndexOffset=(unsigned long long)tagStat.st_size;
+  ptagLog->tagIndexBlock.ullLength=0;
+  return(0);
+}
+
+/**
+ * Count an entry added to the filequeue for the index, the record is written when the block is complete.
+ */
+INLINE_FCT void vLogC_FileIndexAdd_m(LogC ptagLog,
+                                     int iLogType,
+                                     size_t szLength)
+{
+  LogCIndexRecord *ptagBlock=&ptagLog->tagIndexBlock;
+  const struct TagLogType *ptagLogType;
+  unsigned long long ullTimeMs;
+
+  if((!ptagLog->szIndexBlockSize) && (!ptagLog->uiIndexIntervalMs))
+    return;
+  ullTimeMs=ullLogC_GetRealTimeMs_m();
+  /* The block ends before this entry if it's too old */
+  if((ptagLog->uiIndexIntervalMs) &&
+     (ptagBlock->ullLength) &&
+     (ullTimeMs-ptagBlock->ullFirstTimeMs>=ptagLog->uiIndexIntervalMs))
+    vLogC_FileIndexWrite_m(ptagLog);
+  if(!ptagBlock->ullLength)
+  {
+    ptagBlock->uiLogTypes=0;
+    ptagBlock->ullOffset=ptagLog->ullIndexOffset;
+    ptagBlock->ullFirstTimeMs=ullTimeMs;
+  }
+  if((ptagLogType=ptagLogC_GetLogType_m(iLogType))) /* Not set for the marker of dropped entries */
+    ptagBlock->uiLogTypes|=1U<<(ptagLogType-tagLogTypes_m);
+  ptagBlock->ullLastTimeMs=ullTimeMs;
+  ptagBlock->ullLength+=szLength;
+  ptagLog->ullIndexOffset+=szLength;
+  if((ptagLog->szIndexBlockSize) && (ptagBlock->ullLength>=ptagLog->szIndexBlockSize))
+    vLogC_FileIndexWrite_m(ptagLog);
+}
+
+/**
+ * The oldest entry of the filequeue is dropped, so the entries behind it move to its position in the logfile.
+ * If it was counted for a record which is written already, that record is too long, but the next ones fit.
+ */
+INLINE_FCT void vLogC_FileIndexDrop_m(LogC ptagLog)
+{
+  size_t szEntrySize=ptagLog->szMaxEntryLength+2;
+  unsigned long long ullQueued=0;
+  size_t szLength;
+  size_t szIndex;
+
+  if((!ptagLog->szIndexBlockSize) && (!ptagLog->uiIndexIntervalMs))
+    return;
+  for(szIndex=0;szIndex<ptagLog->szLogFileQueueCount;++szIndex)
+    ullQueued+=strlen(&ptagLog->pcLogFileQueueBuffer[szIndex*szEntrySize]);
+  szLength=strlen(ptagLog->pcLogFileQueueBuffer);
+  if(ptagLog->tagIndexBlock.ullLength)
+  {
+    if(ptagLog->ullIndexOffset-ullQueued>=ptagLog->tagIndexBlock.ullOffset) /* Dropped from the current block */
+      ptagLog->tagIndexBlock.ullLength-=szLength;
+    else
+      ptagLog->tagIndexBlock.ullOffset-=szLength;
+  }
+  ptagLog->ullIndexOffset-=szLength;
+}
+
+/**
+ * Append the record of the current block to the index and start a new block.
+ * The index is just a hint for readers, so a failure doesn't fail adding the entries.
+ */
+INLINE_FCT void vLogC_FileIndexWrite_m(LogC ptagLog)
+{
+  if((!ptagLog->tagIndexBlock.ullLength) || (!ptagLog->fpIndex))
+    return;
+  ptagLog->tagIndexBlock.uiMagic=LOGC_INDEX_MAGIC;
+  /* Flushed, so readers see each record when it's complete */
+  if((fwrite(&ptagLog->tagIndexBlock,sizeof(LogCIndexRecord),1,ptagLog->fpIndex)!=1) ||
+     (fflush(ptagLog->fpIndex)))
+    perror("Failed to write index of LogFile: ");
+  ptagLog->tagIndexBlock.ullLength=0;
+}
+
+/**
+ * Write the record of the current block and stop the index.
+ */
+INLINE_FCT void vLogC_FileIndexClose_m(LogC ptagLog)
+{
+  vLogC_FileIndexWrite_m(ptagLog);
+  if(ptagLog->fpIndex)
+  {
+    fclose(ptagLog->fpIndex);
+    ptagLog->fpIndex=NULL;
+  }
+  ptagLog->szIndexBlockSize=0;
+  ptagLog->uiIndexIntervalMs=0;
+}
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+#ifdef _WIN32
+  #define LOGC_ENGINE_LOCK(mutex)   EnterCriticalSection(&tagEngine_m.mutex)
+  #define LOGC_ENGINE_UNLOCK(mutex) LeaveCriticalSection(&tagEngine_m.mutex)
+  #define LOGC_ENGINE_SIGNAL()      WakeConditionVariable(&tagEngine_m.tWakeCond)
+  #define LOGC_ENGINE_LIST_WAIT()   SleepConditionVariableCS(&tagEngine_m.tListCond,&tagEngine_m.tListMutex,INFINITE)
+  #define LOGC_ENGINE_LIST_SIGNAL() WakeAllConditionVariable(&tagEngine_m.tListCond)
+static INIT_ONCE tEngineInitOnce_m=INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK bLogC_EngineInitOnce_m(PINIT_ONCE ptInitOnce,
+                                            PVOID pvParam,
+                                            PVOID *ppvContext)
+{
+  (void)ptInitOnce;
+  (void)pvParam;
+  (void)ppvContext;
+  InitializeCriticalSection(&tagEngine_m.tListMutex);
+  InitializeConditionVariable(&tagEngine_m.tListCond);
+  tagEngine_m.iInitialized=1;
+  return(TRUE);
+}
+
+static DWORD WINAPI dwLogC_EngineThread_m(LPVOID pvArg)
+{
+  (void)pvArg;
+  vLogC_EngineRun_m();
+  return(0);
+}
+#else
+  #define LOGC_ENGINE_LOCK(mutex)   pthread_mutex_lock(&tagEngine_m.mutex)
+  #define LOGC_ENGINE_UNLOCK(mutex) pthread_mutex_unlock(&tagEngine_m.mutex)
+  #define LOGC_ENGINE_SIGNAL()      pthread_cond_signal(&tagEngine_m.tWakeCond)
+  #define LOGC_ENGINE_LIST_WAIT()   pthread_cond_wait(&tagEngine_m.tListCond,&tagEngine_m.tListMutex)
+  #define LOGC_ENGINE_LIST_SIGNAL() pthread_cond_broadcast(&tagEngine_m.tListCond)
+static pthread_once_t tEngineInitOnce_m=PTHREAD_ONCE_INIT;
+
+static void vLogC_EngineInitOnce_m(void)
+{
+  if(pthread_mutex_init(&tagEngine_m.tListMutex,NULL))
+    return; /* Not initialized, the engine can't be started */
+  if(pthread_cond_init(&tagEngine_m.tListCond,NULL))
+  {
+    pthread_mutex_destroy(&tagEngine_m.tListMutex);
+    return;
+  }
+  tagEngine_m.iInitialized=1;
+}
+
+static void *pvLogC_EngineThread_m(void *pvArg)
+{
+  (void)pvArg;
+  vLogC_EngineRun_m();
+  return(NULL);
+}
+#endif /* _WIN32 */
+
+int LogC_EngineStart(unsigned int flushIntervalMs)
+{
+  if(iLogC_EngineInit_m())
+    return(-1);
+  LOGC_ENGINE_LOCK(tListMutex);
+  if(tagEngine_m.iRunning)
+  {
+    LOGC_ENGINE_UNLOCK(tListMutex);
+    return(-1);
+  }
+  tagEngine_m.iStop=0;
+  tagEngine_m.iWake=0;
+  tagEngine_m.uiIntervalMs=(flushIntervalMs)?flushIntervalMs:LOGC_ENGINE_INTERVAL_DEFAULT;
+  tagEngine_m.ptagLogs=NULL;
+  tagEngine_m.szLogsCount=0;
+  tagEngine_m.szLogsSize=0;
+  tagEngine_m.szPassIndex=0;
+  tagEngine_m.ptagWriting=NULL;
+#ifdef _WIN32
+  InitializeCriticalSection(&tagEngine_m.tWakeMutex);
+  InitializeConditionVariable(&tagEngine_m.tWakeCond);
+  if(!(tagEngine_m.tThread=CreateThread(NULL,0,dwLogC_EngineThread_m,NULL,0,NULL)))
+  {
+    DeleteCriticalSection(&tagEngine_m.tWakeMutex);
+    LOGC_ENGINE_UNLOCK(tListMutex);
+    return(-1);
+  }
+#else
+  pthread_mutex_init(&tagEngine_m.tWakeMutex,NULL);
+  pthread_cond_init(&tagEngine_m.tWakeCond,NULL);
+  if(pthread_create(&tagEngine_m.tThread,NULL,pvLogC_EngineThread_m,NULL))
+  {
+    pthread_mutex_destroy(&tagEngine_m.tWakeMutex);
+    pthread_cond_destroy(&tagEngine_m.tWakeCond);
+    LOGC_ENGINE_UNLOCK(tListMutex);
+    return(-1);
+  }
+#endif /* _WIN32 */
+  tagEngine_m.iRunning=1;
+  LOGC_ENGINE_UNLOCK(tListMutex);
+  return(0);
+}
+
+int LogC_EngineStop(void)
+{
+  int iRc=0;
+  size_t szIndex;
+  LogC ptagLog;
+
+  if(iLogC_EngineInit_m())
+    return(-1);
+  LOGC_ENGINE_LOCK(tListMutex);
+  if(tagEngine_m.iRunning!=1)
+  {
+    LOGC_ENGINE_UNLOCK(tListMutex);
+    return(-1);
+  }
+  /* The thread takes the list mutex, so it's released until the thread is joined */
+  tagEngine_m.iRunning=2;
+  LOGC_ENGINE_UNLOCK(tListMutex);
+  LOGC_ENGINE_LOCK(tWakeMutex);
+  tagEngine_m.iStop=1;
+  LOGC_ENGINE_SIGNAL();
+  LOGC_ENGINE_UNLOCK(tWakeMutex);
+#ifdef _WIN32
+  WaitForSingleObject(tagEngine_m.tThread,INFINITE);
+  CloseHandle(tagEngine_m.tThread);
+#else
+  pthread_join(tagEngine_m.tThread,NULL);
+#endif /* _WIN32 */
+  /* The thread is gone, write the remaining entries synchronously */
+  LOGC_ENGINE_LOCK(tListMutex);
+  for(szIndex=0;szIndex<tagEngine_m.szLogsCount;++szIndex)
+  {
+    ptagLog=tagEngine_m.ptagLogs[szIndex];
+    LOGC_MUTEX_LOCK(ptagLog);
+    ptagLog->iEngineAttached=0;
+    if(iLogC_WriteEntriesToDisk_m(ptagLog))
+      iRc=-1;
+    LOGC_COND_BROADCAST(ptagLog,tFileQueueCond); /* Threads waiting for the engine write synchronously now */
+    LOGC_MUTEX_UNLOCK(ptagLog);
+  }
+  free(tagEngine_m.ptagLogs);
+  tagEngine_m.ptagLogs=NULL;
+  tagEngine_m.szLogsCount=0;
+  /* No Log-Object is attached anymore, so nobody wakes the engine */
+#ifdef _WIN32
+  DeleteCriticalSection(&tagEngine_m.tWakeMutex);
+#else
+  pthread_mutex_destroy(&tagEngine_m.tWakeMutex);
+  pthread_cond_destroy(&tagEngine_m.tWakeCond);
+#endif /* _WIN32 */
+  tagEngine_m.iRunning=0;
+  LOGC_ENGINE_UNLOCK(tListMutex);
+  return(iRc);
+}
+
+int LogC_EngineAttach(LogC log)
+{
+  LogC *ptagLogs;
+  size_t szNewSize;
+
+  if((!(log->uiLogOptions&LOGC_OPTION_THREADSAFE)) || (iLogC_EngineInit_m()))
+    return(-1);
+  LOGC_ENGINE_LOCK(tListMutex);
+  if(tagEngine_m.iRunning!=1)
+  {
+    LOGC_ENGINE_UNLOCK(tListMutex);
+    return(-1);
+  }
+  if(tagEngine_m.szLogsCount==tagEngine_m.szLogsSize)
+  {
+    szNewSize=(tagEngine_m.szLogsSize)?tagEngine_m.szLogsSize*2:16;
+    if(!(ptagLogs=realloc(tagEngine_m.ptagLogs,szNewSize*sizeof(LogC))))
+    {
+      LOGC_ENGINE_UNLOCK(tListMutex);
+      return(-1);
+    }
+    tagEngine_m.ptagLogs=ptagLogs;
+    tagEngine_m.szLogsSize=szNewSize;
+  }
+  LOGC_MUTEX_LOCK(log);
+  if((log->iEngineAttached) || (!log->pcLogFileQueueBuffer))
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    LOGC_ENGINE_UNLOCK(tListMutex);
+    return(-1);
+  }
+  if((!log->pcFileQueueSpare) &&
+     (!log->pcFileQueuePending) &&
+     (!(log->pcFileQueueSpare=malloc(LOGC_DEFAULT_FILEQUEUESIZE*(log->szMaxEntryLength+2)))))
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    LOGC_ENGINE_UNLOCK(tListMutex);
+    return(-1);
+  }
+  log->iEngineAttached=1;
+  LOGC_MUTEX_UNLOCK(log);
+  tagEngine_m.ptagLogs[tagEngine_m.szLogsCount++]=log;
+  LOGC_ENGINE_UNLOCK(tListMutex);
+  return(0);
+}
+
+int LogC_EngineDetach(LogC log)
+{
+  int iRc;
+
+  if((iRc=iLogC_EngineDetach_m(log))>0) /* Not attached */
+    return(-1);
+  return(iRc);
+}
+
+/**
+ * Initialize the list mutex of the engine once, it's kept until the process ends.
+ */
+INLINE_FCT int iLogC_EngineInit_m(void)
+{
+#ifdef _WIN32
+  if(!InitOnceExecuteOnce(&tEngineInitOnce_m,bLogC_EngineInitOnce_m,NULL,NULL))
+    return(-1);
+#else
+  if(pthread_once(&tEngineInitOnce_m,vLogC_EngineInitOnce_m))
+    return(-1);
+#endif /* _WIN32 */
+  return((tagEngine_m.iInitialized)?0:-1);
+}
+
+/**
+ * Detach the Log-Object and write its remaining entries, also while the engine is stopping.
+ * Returns 1 if it isn't attached.
+ */
+INLINE_FCT int iLogC_EngineDetach_m(LogC ptagLog)
+{
+  int iRc;
+  size_t szIndex;
+
+  if(iLogC_EngineInit_m())
+    return(-1);
+  /* The engine doesn't touch the Log-Object anymore, once it's removed from the list and not written anymore */
+  LOGC_ENGINE_LOCK(tListMutex);
+  for(szIndex=0;szIndex<tagEngine_m.szLogsCount;++szIndex)
+  {
+    if(tagEngine_m.ptagLogs[szIndex]==ptagLog)
+      break;
+  }
+  if(szIndex==tagEngine_m.szLogsCount)
+  {
+    LOGC_ENGINE_UNLOCK(tListMutex);
+    return(1);
+  }
+  /* Keep the order, so the current pass doesn't skip a Log-Object */
+  memmove(&tagEngine_m.ptagLogs[szIndex],
+          &tagEngine_m.ptagLogs[szIndex+1],
+          (--tagEngine_m.szLogsCount-szIndex)*sizeof(LogC));
+  if(szIndex<tagEngine_m.szPassIndex)
+    --tagEngine_m.szPassIndex;
+  while(tagEngine_m.ptagWriting==ptagLog)
+    LOGC_ENGINE_LIST_WAIT();
+  LOGC_ENGINE_UNLOCK(tListMutex);
+
+  LOGC_MUTEX_LOCK(ptagLog);
+  ptagLog->iEngineAttached=0;
+  iRc=iLogC_WriteEntriesToDisk_m(ptagLog);
+  LOGC_COND_BROADCAST(ptagLog,tFileQueueCond); /* Threads waiting for the engine write synchronously now */
+  LOGC_MUTEX_UNLOCK(ptagLog);
+  return(iRc);
+}
+
+/**
+ * Thread of the writer engine, writes the handed over queues of all attached Log-Objects when woken up,
+ * and also the partially filled queues once per interval.
+ */
+INLINE_FCT void vLogC_EngineRun_m(void)
+{
+  unsigned long long ullIntervalNs=tagEngine_m.uiIntervalMs*1000000ULL;
+  unsigned long long ullNextFlushNs=ullLogC_GetTimeNs_m()+ullIntervalNs;
+  unsigned long long ullTimeNs;
+  int iStop=0;
+  int iFlushPartial;
+  LogC ptagLog;
+
+  while(!iStop)
+  {
+    LOGC_ENGINE_LOCK(tWakeMutex);
+    ullTimeNs=ullLogC_GetTimeNs_m();
+    if((!tagEngine_m.iWake) && (!tagEngine_m.iStop) && (ullTimeNs<ullNextFlushNs))
+      vLogC_EngineWait_m((unsigned int)((ullNextFlushNs-ullTimeNs+999999)/1000000));
+    tagEngine_m.iWake=0;
+    iStop=tagEngine_m.iStop;
+    LOGC_ENGINE_UNLOCK(tWakeMutex);
+
+    ullTimeNs=ullLogC_GetTimeNs_m();
+    if((iFlushPartial=((iStop) || (ullTimeNs>=ullNextFlushNs))))
+      ullNextFlushNs=ullTimeNs+ullIntervalNs;
+    LOGC_ENGINE_LOCK(tListMutex);
+    for(tagEngine_m.szPassIndex=0;tagEngine_m.szPassIndex<tagEngine_m.szLogsCount;)
+    {
+      ptagLog=tagEngine_m.ptagLogs[tagEngine_m.szPassIndex++];
+      tagEngine_m.ptagWriting=ptagLog;
+      LOGC_ENGINE_UNLOCK(tListMutex);
+      vLogC_EngineWriteLog_m(ptagLog,iFlushPartial);
+      LOGC_ENGINE_LOCK(tListMutex);
+      tagEngine_m.ptagWriting=NULL;
+      LOGC_ENGINE_LIST_SIGNAL();
+    }
+    LOGC_ENGINE_UNLOCK(tListMutex);
+  }
+}
+
+/**
+ * Wait for the wake condition of the engine, the wake mutex must be locked.
+ */
+INLINE_FCT void vLogC_EngineWait_m(unsigned int uiMs)
+{
+#ifdef _WIN32
+  SleepConditionVariableCS(&tagEngine_m.tWakeCond,&tagEngine_m.tWakeMutex,uiMs);
+#else
+  struct timespec tagTime;
+  clock_gettime(CLOCK_REALTIME,&tagTime); /* pthread_cond_timedwait() uses the realtime clock by default */
+  tagTime.tv_sec+=uiMs/1000;
+  tagTime.tv_nsec+=(long)(uiMs%1000)*1000000L;
+  if(tagTime.tv_nsec>=1000000000L)
+  {
+    ++tagTime.tv_sec;
+    tagTime.tv_nsec-=1000000000L;
+  }
+  pthread_cond_timedwait(&tagEngine_m.tWakeCond,&tagEngine_m.tWakeMutex,&tagTime);
+#endif /* _WIN32 */
+}
+
+INLINE_FCT void vLogC_EngineWake_m(void)
+{
+  LOGC_ENGINE_LOCK(tWakeMutex);
+  tagEngine_m.iWake=1;
+  LOGC_ENGINE_SIGNAL();
+  LOGC_ENGINE_UNLOCK(tWakeMutex);
+}
+
+/**
+ * Write the pending queue of one Log-Object, the write itself is done without holding its mutex,
+ * so adding entries continues in the other queue meanwhile. A failed write is retried with the next pass.
+ */
+INLINE_FCT void vLogC_EngineWriteLog_m(LogC ptagLog,
+                                       int iFlushPartial)
+{
+  char *pcQueue;
+  int iRc;
+
+  LOGC_MUTEX_LOCK(ptagLog);
+  if((iFlushPartial) &&
+     (ptagLog->iEngineAttached) &&
+     (!ptagLog->pcFileQueuePending) &&
+     (ptagLog->pcLogFileQueueBuffer) &&
+     (ptagLog->szLogFileQueueCount))
+  {
+    ptagLog->pcFileQueuePending=ptagLog->pcLogFileQueueBuffer;
+    ptagLog->szFileQueuePendingCount=ptagLog->szLogFileQueueCount;
+    ptagLog->pcLogFileQueueBuffer=ptagLog->pcFileQueueSpare;
+    ptagLog->pcFileQueueSpare=NULL;
+    ptagLog->szLogFileQueueCount=0;
+  }
+  if((ptagLog->pcFileQueuePending) && (!ptagLog->iFileQueueWriting))
+  {
+    pcQueue=ptagLog->pcFileQueuePending;
+    ptagLog->iFileQueueWriting=1;
+    LOGC_MUTEX_UNLOCK(ptagLog);
+    iRc=iLogC_FileWrite_m(ptagLog,pcQueue,ptagLog->szFileQueuePendingCount);
+    LOGC_MUTEX_LOCK(ptagLog);
+    ptagLog->iFileQueueWriting=0;
+    ptagLog->iEngineFailed=(iRc!=0);
+    if(!iRc)
+    {
+      ptagLog->pcFileQueueSpare=pcQueue;
+      ptagLog->pcFileQueuePending=NULL;
+    }
+    LOGC_COND_BROADCAST(ptagLog,tFileQueueCond);
+    if(!iRc)
+      iLogC_FileWritten_m(ptagLog); /* A failed sync is reported with the next synchronous write */
+  }
+  LOGC_MUTEX_UNLOCK(ptagLog);
+}
+
+/**
+ * Hand the full filequeue over to the engine and continue with the spare queue.
+ *
+ * @param iWait Wait if the engine is still busy with the last queue, unless it failed to write it.
+ *
+ * @return 0 if the filequeue is free again, negative value if the engine is busy or failed.
+ */
+INLINE_FCT int iLogC_EngineHandOver_m(LogC ptagLog,
+                                      int iWait)
+{
+  while((ptagLog->iEngineAttached) && (ptagLog->pcFileQueuePending))
+  {
+    if((!iWait) || (ptagLog->iEngineFailed))
+      return(-1);
+    LOGC_COND_WAIT(ptagLog,tFileQueueCond);
+  }
+  /* Detached, logfile disabled or partial queue taken by the engine meanwhile */
+  if((!ptagLog->iEngineAttached) || (!ptagLog->pcLogFileQueueBuffer) || (!ptagLog->szLogFileQueueCount))
+    return(0);
+  ptagLog->pcFileQueuePending=ptagLog->pcLogFileQueueBuffer;
+  ptagLog->szFileQueuePendingCount=ptagLog->szLogFileQueueCount;
+  ptagLog->pcLogFileQueueBuffer=ptagLog->pcFileQueueSpare;
+  ptagLog->pcFileQueueSpare=NULL;
+  ptagLog->szLogFileQueueCount=0;
+  vLogC_EngineWake_m();
+  return(0);
+}
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+
+#ifdef LOGC_FILEQUEUE_SWAP
+/**
+ * Write the full filequeue without holding the mutex: it's swapped with the spare queue,
+ * so other threads continue adding entries while it's written. Just one queue is pending at a time
+ * and it's always written before the current filequeue, so the entries stay in order.
+ * Log-Objects without LOGC_OPTION_THREADSAFE and failed writes use iLogC_WriteEntriesToDisk_m().
+ * Releases the mutex, the filequeue may be full again on return.
+ */
+INLINE_FCT int iLogC_FileQueueSwap_m(LogC ptagLog)
+{
+  char *pcQueue;
+  int iRc;
+
+  if(!(ptagLog->uiLogOptions&LOGC_OPTION_THREADSAFE))
+    return(iLogC_WriteEntriesToDisk_m(ptagLog));
+  vLogC_FileQueueWaitWriter_m(ptagLog);
+  if((ptagLog->pcFileQueuePending) ||
+     ((!ptagLog->pcFileQueueSpare) &&
+      (!(ptagLog->pcFileQueueSpare=malloc(LOGC_DEFAULT_FILEQUEUESIZE*(ptagLog->szMaxEntryLength+2))))))
+    return(iLogC_WriteEntriesToDisk_m(ptagLog));
+  if((!ptagLog->pcLogFileQueueBuffer) || (!ptagLog->szLogFileQueueCount)) /* Written while waiting */
+    return(0);
+  pcQueue=ptagLog->pcFileQueuePending=ptagLog->pcLogFileQueueBuffer;
+  ptagLog->szFileQueuePendingCount=ptagLog->szLogFileQueueCount;
+  ptagLog->pcLogFileQueueBuffer=ptagLog->pcFileQueueSpare;
+  ptagLog->pcFileQueueSpare=NULL;
+  ptagLog->szLogFileQueueCount=0;
+  ptagLog->iFileQueueWriting=1;
+  LOGC_MUTEX_UNLOCK(ptagLog);
+  iRc=iLogC_FileWrite_m(ptagLog,pcQueue,ptagLog->szFileQueuePendingCount);
+  LOGC_MUTEX_LOCK(ptagLog);
+  ptagLog->iFileQueueWriting=0;
+  if(!iRc)
+  {
+    ptagLog->pcFileQueueSpare=pcQueue;
+    ptagLog->pcFileQueuePending=NULL;
+  }
+  LOGC_COND_BROADCAST(ptagLog,tFileQueueCond);
+  if(iRc) /* Stays pending, the next write tries again */
+    return(-1);
+  return(iLogC_FileWritten_m(ptagLog));
+}
+
+/**
+ * Wait until the pending queue is written, before the writer backend or the logfilepath are changed.
+ */
+INLINE_FCT void vLogC_FileQueueWaitWriter_m(LogC ptagLog)
+{
+  while(ptagLog->iFileQueueWriting)
+  {
+    LOGC_COND_WAIT(ptagLog,tFileQueueCond);
+  }
+}
+#endif /* LOGC_FILEQUEUE_SWAP */
+
+#ifdef LOGC_FEATURE_ENABLE_FLUSHTIMER
+#ifdef _WIN32
+  #define LOGC_FLUSHTIMER_LOCK(mutex)   EnterCriticalSection(&tagFlushTimer_m.mutex)
+  #define LOGC_FLUSHTIMER_UNLOCK(mutex) LeaveCriticalSection(&tagFlushTimer_m.mutex)
+  #define LOGC_FLUSHTIMER_SIGNAL()      WakeConditionVariable(&tagFlushTimer_m.tWakeCond)
+static INIT_ONCE tFlushTimerInitOnce_m=INIT_ONCE_STATIC_INIT;
+
+static BOOL CALLBACK bLogC_FlushTimerInitOnce_m(PINIT_ONCE ptInitOnce,
+                                               PVOID pvParam,
+                                               PVOID *ppvContext)
+{
+  (void)ptInitOnce;
+  (void)pvParam;
+  (void)ppvContext;
+  InitializeCriticalSection(&tagFlushTimer_m.tListMutex);
+  tagFlushTimer_m.iInitialized=1;
+  return(TRUE);
+}
+
+static DWORD WINAPI dwLogC_FlushTimerThread_m(LPVOID pvArg)
+{
+  (void)pvArg;
+  vLogC_FlushTimerRun_m();
+  return(0);
+}
+#else
+  #define LOGC_FLUSHTIMER_LOCK(mutex)   pthread_mutex_lock(&tagFlushTimer_m.mutex)
+  #define LOGC_FLUSHTIMER_UNLOCK(mutex) pthread_mutex_unlock(&tagFlushTimer_m.mutex)
+  #define LOGC_FLUSHTIMER_SIGNAL()      pthread_cond_signal(&tagFlushTimer_m.tWakeCond)
+static pthread_once_t tFlushTimerInitOnce_m=PTHREAD_ONCE_INIT;
+
+static void vLogC_FlushTimerInitOnce_m(void)
+{
+  if(pthread_mutex_init(&tagFlushTimer_m.tListMutex,NULL))
+    return; /* Not initialized, the flush timer can't be started */
+  tagFlushTimer_m.iInitialized=1;
+}
+
+static void *pvLogC_FlushTimerThread_m(void *pvArg)
+{
+  (void)pvArg;
+  vLogC_FlushTimerRun_m();
+  return(NULL);
+}
+#endif /* _WIN32 */
+
+int LogC_FlushTimerStart(void)
+{
+  if(iLogC_FlushTimerInit_m())
+    return(-1);
+  LOGC_FLUSHTIMER_LOCK(tListMutex);
+  if(tagFlushTimer_m.iRunning)
+  {
+    LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+    return(-1);
+  }
+  tagFlushTimer_m.iStop=0;
+  tagFlushTimer_m.ullNextNs=ULLONG_MAX;
+  tagFlushTimer_m.ptagLogs=NULL;
+  tagFlushTimer_m.szLogsCount=0;
+  tagFlushTimer_m.szLogsSize=0;
+#ifdef _WIN32
+  InitializeCriticalSection(&tagFlushTimer_m.tWakeMutex);
+  InitializeConditionVariable(&tagFlushTimer_m.tWakeCond);
+  if(!(tagFlushTimer_m.tThread=CreateThread(NULL,0,dwLogC_FlushTimerThread_m,NULL,0,NULL)))
+  {
+    DeleteCriticalSection(&tagFlushTimer_m.tWakeMutex);
+    LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+    return(-1);
+  }
+#else
+  pthread_mutex_init(&tagFlushTimer_m.tWakeMutex,NULL);
+  pthread_cond_init(&tagFlushTimer_m.tWakeCond,NULL);
+  if(pthread_create(&tagFlushTimer_m.tThread,NULL,pvLogC_FlushTimerThread_m,NULL))
+  {
+    pthread_mutex_destroy(&tagFlushTimer_m.tWakeMutex);
+    pthread_cond_destroy(&tagFlushTimer_m.tWakeCond);
+    LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+    return(-1);
+  }
+#endif /* _WIN32 */
+  tagFlushTimer_m.iRunning=1;
+  LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+  return(0);
+}
+
+int LogC_FlushTimerStop(void)
+{
+  size_t szIndex;
+  LogC ptagLog;
+
+  if(iLogC_FlushTimerInit_m())
+    return(-1);
+  LOGC_FLUSHTIMER_LOCK(tListMutex);
+  if(tagFlushTimer_m.iRunning!=1)
+  {
+    LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+    return(-1);
+  }
+  /* The thread takes the list mutex, so it's released until the thread is joined */
+  tagFlushTimer_m.iRunning=2;
+  LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+  LOGC_FLUSHTIMER_LOCK(tWakeMutex);
+  tagFlushTimer_m.iStop=1;
+  LOGC_FLUSHTIMER_SIGNAL();
+  LOGC_FLUSHTIMER_UNLOCK(tWakeMutex);
+#ifdef _WIN32
+  WaitForSingleObject(tagFlushTimer_m.tThread,INFINITE);
+  CloseHandle(tagFlushTimer_m.tThread);
+#else
+  pthread_join(tagFlushTimer_m.tThread,NULL);
+#endif /* _WIN32 */
+  /* Buffered entries stay in the filequeues, until they're full or written explicitly */
+  LOGC_FLUSHTIMER_LOCK(tListMutex);
+  for(szIndex=0;szIndex<tagFlushTimer_m.szLogsCount;++szIndex)
+  {
+    ptagLog=tagFlushTimer_m.ptagLogs[szIndex];
+    LOGC_MUTEX_LOCK(ptagLog);
+    ptagLog->uiFileMaxAgeMs=0;
+    LOGC_MUTEX_UNLOCK(ptagLog);
+  }
+  free(tagFlushTimer_m.ptagLogs);
+  tagFlushTimer_m.ptagLogs=NULL;
+  tagFlushTimer_m.szLogsCount=0;
+#ifdef _WIN32
+  DeleteCriticalSection(&tagFlushTimer_m.tWakeMutex);
+#else
+  pthread_mutex_destroy(&tagFlushTimer_m.tWakeMutex);
+  pthread_cond_destroy(&tagFlushTimer_m.tWakeCond);
+#endif /* _WIN32 */
+  tagFlushTimer_m.iRunning=0;
+  LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+  return(0);
+}
+
+int LogC_SetFileMaxAge(LogC log,
+                       unsigned int maxAgeMs)
+{
+  LogC *ptagLogs;
+  size_t szNewSize;
+  size_t szIndex;
+
+  if((!(log->uiLogOptions&LOGC_OPTION_THREADSAFE)) || (iLogC_FlushTimerInit_m()))
+    return(-1);
+  LOGC_FLUSHTIMER_LOCK(tListMutex);
+  /* Without the timer nothing is registered, while it's stopping Log-Objects can just be removed */
+  if((!tagFlushTimer_m.iRunning) || ((maxAgeMs) && (tagFlushTimer_m.iRunning!=1)))
+  {
+    LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+    return((maxAgeMs)?-1:0);
+  }
+  for(szIndex=0;szIndex<tagFlushTimer_m.szLogsCount;++szIndex)
+  {
+    if(tagFlushTimer_m.ptagLogs[szIndex]==log)
+      break;
+  }
+  if(!maxAgeMs)
+  {
+    /* The timer doesn't touch the Log-Object anymore, once it's removed from the list */
+    if(szIndex<tagFlushTimer_m.szLogsCount)
+      tagFlushTimer_m.ptagLogs[szIndex]=tagFlushTimer_m.ptagLogs[--tagFlushTimer_m.szLogsCount];
+  }
+  else if(szIndex==tagFlushTimer_m.szLogsCount)
+  {
+    if(tagFlushTimer_m.szLogsCount==tagFlushTimer_m.szLogsSize)
+    {
+      szNewSize=(tagFlushTimer_m.szLogsSize)?tagFlushTimer_m.szLogsSize*2:16;
+      if(!(ptagLogs=realloc(tagFlushTimer_m.ptagLogs,szNewSize*sizeof(LogC))))
+      {
+        LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+        return(-1);
+      }
+      tagFlushTimer_m.ptagLogs=ptagLogs;
+      tagFlushTimer_m.szLogsSize=szNewSize;
+    }
+    tagFlushTimer_m.ptagLogs[tagFlushTimer_m.szLogsCount++]=log;
+  }
+  LOGC_MUTEX_LOCK(log);
+  log->uiFileMaxAgeMs=maxAgeMs;
+  /* Entries already buffered get the full max age from now on */
+  if((maxAgeMs) && (log->szLogFileQueueCount))
+    vLogC_FlushTimerArm_m(log);
+  LOGC_MUTEX_UNLOCK(log);
+  LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+  return(0);
+}
+
+/**
+ * Initialize the list mutex of the flush timer once, it's kept until the process exits.
+ */
+INLINE_FCT int iLogC_FlushTimerInit_m(void)
+{
+#ifdef _WIN32
+  if(!InitOnceExecuteOnce(&tFlushTimerInitOnce_m,bLogC_FlushTimerInitOnce_m,NULL,NULL))
+    return(-1);
+#else
+  if(pthread_once(&tFlushTimerInitOnce_m,vLogC_FlushTimerInitOnce_m))
+    return(-1);
+#endif /* _WIN32 */
+  return((tagFlushTimer_m.iInitialized)?0:-1);
+}
+
+/**
+ * Thread of the flush timer, sleeps until the earliest deadline of the registered filequeues
+ * and writes the ones whose oldest entry reached the max age.
+ */
+INLINE_FCT void vLogC_FlushTimerRun_m(void)
+{
+  unsigned long long ullTimeNs;
+  unsigned long long ullNextNs;
+  unsigned long long ullDeadlineNs;
+  int iStop=0;
+  size_t szIndex;
+
+  while(!iStop)
+  {
+    LOGC_FLUSHTIMER_LOCK(tWakeMutex);
+    ullTimeNs=ullLogC_GetTimeNs_m();
+    if((!tagFlushTimer_m.iStop) && (ullTimeNs<tagFlushTimer_m.ullNextNs))
+      vLogC_FlushTimerWait_m((tagFlushTimer_m.ullNextNs==ULLONG_MAX)?ULLONG_MAX:tagFlushTimer_m.ullNextNs-ullTimeNs);
+    iStop=tagFlushTimer_m.iStop;
+    tagFlushTimer_m.ullNextNs=ULLONG_MAX; /* Each pass collects the deadlines again */
+    LOGC_FLUSHTIMER_UNLOCK(tWakeMutex);
+    if(iStop)
+      break;
+
+    ullNextNs=ULLONG_MAX;
+    LOGC_FLUSHTIMER_LOCK(tListMutex);
+    ullTimeNs=ullLogC_GetTimeNs_m();
+    for(szIndex=0;szIndex<tagFlushTimer_m.szLogsCount;++szIndex)
+    {
+      ullDeadlineNs=ullLogC_FlushTimerCheckLog_m(tagFlushTimer_m.ptagLogs[szIndex],ullTimeNs);
+      if(ullDeadlineNs<ullNextNs)
+        ullNextNs=ullDeadlineNs;
+    }
+    LOGC_FLUSHTIMER_UNLOCK(tListMutex);
+    LOGC_FLUSHTIMER_LOCK(tWakeMutex);
+    if(ullNextNs<tagFlushTimer_m.ullNextNs)
+      tagFlushTimer_m.ullNextNs=ullNextNs;
+    LOGC_FLUSHTIMER_UNLOCK(tWakeMutex);
+  }
+}
+
+/**
+ * Write the filequeue of one Log-Object, if its oldest entry reached the max age.
+ * With LOGC_FILESYNC_INTERVAL, writes which weren't synced because of the interval are synced
+ * once it expired, so they aren't left unsynced if no more entries are written.
+ *
+ * @return The earliest deadline of the filequeue or the sync afterwards, ULLONG_MAX if there's none.
+ */
+INLINE_FCT unsigned long long ullLogC_FlushTimerCheckLog_m(LogC ptagLog,
+                                                           unsigned long long ullTimeNs)
+{
+  unsigned long long ullDeadlineNs=ULLONG_MAX;
+  unsigned long long ullSyncNs;
+
+  LOGC_MUTEX_LOCK(ptagLog);
+  if((ptagLog->pcLogFileQueueBuffer) && (ptagLog->szLogFileQueueCount))
+  {
+    if(ptagLog->ullFileQueueSinceNs+ptagLog->uiFileMaxAgeMs*1000000ULL<=ullTimeNs)
+    {
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+      if(ptagLog->iEngineAttached)
+        iLogC_EngineHandOver_m(ptagLog,0);
+      else
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+      iLogC_FileQueueSwap_m(ptagLog);
+      /* Writing failed or the engine is busy, try again after the max age.
+         Entries added while the mutex was released for syncing armed the queue themselves. */
+      if((ptagLog->szLogFileQueueCount) && (ptagLog->ullFileQueueSinceNs<=ullTimeNs))
+        ptagLog->ullFileQueueSinceNs=ullLogC_GetTimeNs_m();
+    }
+    if((ptagLog->pcLogFileQueueBuffer) && (ptagLog->szLogFileQueueCount))
+      ullDeadlineNs=ptagLog->ullFileQueueSinceNs+ptagLog->uiFileMaxAgeMs*1000000ULL;
+  }
+  if((ptagLog->iFileSyncMode==LOGC_FILESYNC_INTERVAL) &&
+     (ptagLog->ullFileSyncedSeq<ptagLog->ullFileWriteSeq) &&
+     (!ptagLog->iFileSyncRunning))
+  {
+    ullSyncNs=ptagLog->ullFileLastSyncNs+ptagLog->uiFileSyncIntervalMs*1000000ULL;
+    if(ullSyncNs<=ullTimeNs)
+    {
+      /* The writes must be completed before they can be synced */
+      if((iLogC_FileBackendComplete_m(ptagLog)) || (iLogC_FileSync_m(ptagLog,1)))
+        ullSyncNs=ullLogC_GetTimeNs_m()+ptagLog->uiFileSyncIntervalMs*1000000ULL; /* Try again after the interval */
+      else
+        ullSyncNs=ULLONG_MAX;
+    }
+    if(ullSyncNs<ullDeadlineNs)
+      ullDeadlineNs=ullSyncNs;
+  }
+  LOGC_MUTEX_UNLOCK(ptagLog);
+  return(ullDeadlineNs);
+}
+
+/**
+ * Wait for the wake condition of the flush timer, the wake mutex must be locked.
+ *
+ * @param ullNs Time to wait, ULLONG_MAX to wait until woken up.
+ */
+INLINE_FCT void vLogC_FlushTimerWait_m(unsigned long long ullNs)
+{
+#ifdef _WIN32
+  SleepConditionVariableCS(&tagFlushTimer_m.tWakeCond,&tagFlushTimer_m.tWakeMutex,
+                           (ullNs==ULLONG_MAX)?INFINITE:(DWORD)((ullNs+999999)/1000000));
+#else
+  struct timespec tagTime;
+  if(ullNs==ULLONG_MAX)
+  {
+    pthread_cond_wait(&tagFlushTimer_m.tWakeCond,&tagFlushTimer_m.tWakeMutex);
+    return;
+  }
+  clock_gettime(CLOCK_REALTIME,&tagTime); /* pthread_cond_timedwait() uses the realtime clock by default */
+  tagTime.tv_sec+=(time_t)(ullNs/1000000000ULL);
+  tagTime.tv_nsec+=(long)(ullNs%1000000000ULL);
+  if(tagTime.tv_nsec>=1000000000L)
+  {
+    ++tagTime.tv_sec;
+    tagTime.tv_nsec-=1000000000L;
+  }
+  pthread_cond_timedwait(&tagFlushTimer_m.tWakeCond,&tagFlushTimer_m.tWakeMutex,&tagTime);
+#endif /* _WIN32 */
+}
+
+/**
+ * Start the max age of the filequeue, the mutex of the Log-Object must be locked.
+ * The timer thread is just woken up if it would sleep longer than this deadline.
+ */
+INLINE_FCT void vLogC_FlushTimerArm_m(LogC ptagLog)
+{
+  ptagLog->ullFileQueueSinceNs=ullLogC_GetTimeNs_m();
+  vLogC_FlushTimerWake_m(ptagLog->ullFileQueueSinceNs+ptagLog->uiFileMaxAgeMs*1000000ULL);
+}
+
+/**
+ * Wake up the timer thread, if it would sleep longer than the deadline.
+ */
+INLINE_FCT void vLogC_FlushTimerWake_m(unsigned long long ullDeadlineNs)
+{
+  LOGC_FLUSHTIMER_LOCK(tWakeMutex);
+  if(ullDeadlineNs<tagFlushTimer_m.ullNextNs)
+  {
+    tagFlushTimer_m.ullNextNs=ullDeadlineNs;
+    LOGC_FLUSHTIMER_SIGNAL();
+  }
+  LOGC_FLUSHTIMER_UNLOCK(tWakeMutex);
+}
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+
+#ifdef LOGC_FEATURE_ENABLE_TRACE
+#ifdef _WIN32
+  #define LOGC_TRACE_LOCK(mutex)     EnterCriticalSection(mutex)
+  #define LOGC_TRACE_UNLOCK(mutex)   LeaveCriticalSection(mutex)
+  /* Fiber local storage, unlike TlsAlloc() it calls a function for each exiting thread */
+  #define LOGC_TRACE_GET()           ((TagLogCTraceBuffer*)FlsGetValue(tagTrace_m.dwFlsIndex))
+  #define LOGC_TRACE_SET(buffer)     (!FlsSetValue(tagTrace_m.dwFlsIndex,(buffer))) /* Not 0 on Error */
+#else
+  #define LOGC_TRACE_LOCK(mutex)     pthread_mutex_lock(mutex)
+  #define LOGC_TRACE_UNLOCK(mutex)   pthread_mutex_unlock(mutex)
+  #define LOGC_TRACE_GET()           ((TagLogCTraceBuffer*)pthread_getspecific(tagTrace_m.tKey))
+  #define LOGC_TRACE_SET(buffer)     pthread_setspecific(tagTrace_m.tKey,(buffer))
+#endif /* _WIN32 */
+
+/**
+ * Called for each exiting thread which has a buffer, writes its remaining events and releases it.
+ * The thread is gone, so nobody else takes the mutex of the buffer after it's removed from the list.
+ */
+static void vLogC_TraceThreadExit_m(void *pvBuffer)
+{
+  TagLogCTraceBuffer *ptagBuffer=pvBuffer;
+  TagLogCTraceBuffer **pptagBuffer;
+
+  LOGC_TRACE_LOCK(&tagTrace_m.tListMutex);
+  for(pptagBuffer=&tagTrace_m.ptagBuffers;*pptagBuffer!=ptagBuffer;pptagBuffer=&(*pptagBuffer)->ptagNext)
+    ;
+  *pptagBuffer=ptagBuffer->ptagNext;
+  if(tagTrace_m.iRunning)
+    vLogC_TraceWriteBuffer_m(ptagBuffer);
+  LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+#ifdef _WIN32
+  DeleteCriticalSection(&ptagBuffer->tMutex);
+#else
+  pthread_mutex_destroy(&ptagBuffer->tMutex);
+#endif /* _WIN32 */
+  free(ptagBuffer);
+}
+
+#ifdef _WIN32
+static INIT_ONCE tTraceInitOnce_m=INIT_ONCE_STATIC_INIT;
+
+static VOID NTAPI vLogC_TraceFlsCallback_m(PVOID pvBuffer)
+{
+  vLogC_TraceThreadExit_m(pvBuffer);
+}
+
+static BOOL CALLBACK bLogC_TraceInitOnce_m(PINIT_ONCE ptInitOnce,
+                                          PVOID pvParam,
+                                          PVOID *ppvContext)
+{
+  (void)ptInitOnce;
+  (void)pvParam;
+  (void)ppvContext;
+  if((tagTrace_m.dwFlsIndex=FlsAlloc(vLogC_TraceFlsCallback_m))==FLS_OUT_OF_INDEXES)
+    return(FALSE); /* Tried again with the next trace */
+  InitializeCriticalSection(&tagTrace_m.tListMutex);
+  tagTrace_m.iInitialized=1;
+  return(TRUE);
+}
+#else
+static pthread_once_t tTraceInitOnce_m=PTHREAD_ONCE_INIT;
+
+static void vLogC_TraceInitOnce_m(void)
+{
+  if(pthread_key_create(&tagTrace_m.tKey,vLogC_TraceThreadExit_m))
+    return; /* Not initialized, no trace can be started */
+  pthread_mutex_init(&tagTrace_m.tListMutex,NULL);
+  tagTrace_m.iInitialized=1;
+}
+#endif /* _WIN32 */
+
+int LogC_TraceStart(const char *path,
+                    size_t eventsPerThread)
+{
+  if((!path) || (iLogC_TraceInit_m()))
+    return(-1);
+  LOGC_TRACE_LOCK(&tagTrace_m.tListMutex);
+  if(tagTrace_m.iRunning)
+  {
+    LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+    return(-1);
+  }
+  if(!(tagTrace_m.fpFile=fopen(path,"w")))
+  {
+    LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+    return(-1);
+  }
+  if(fputs("{\"traceEvents\":[",tagTrace_m.fpFile)<0)
+  {
+    fclose(tagTrace_m.fpFile);
+    LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+    return(-1);
+  }
+  tagTrace_m.iFirstEvent=1;
+  tagTrace_m.iFailed=0;
+  tagTrace_m.szEventsPerThread=(eventsPerThread)?eventsPerThread:LOGC_TRACE_EVENTS_DEFAULT;
+#ifdef _WIN32
+  tagTrace_m.ulPid=(unsigned long)GetCurrentProcessId();
+#else
+  tagTrace_m.ulPid=(unsigned long)getpid();
+#endif /* _WIN32 */
+  LOGC_TRACE_SET_GENERATION(tagTrace_m.uiGeneration+1);
+  LOGC_TRACE_SET_RUNNING(1);
+  LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+  return(0);
+}
+
+int LogC_TraceFlush(void)
+{
+  TagLogCTraceBuffer *ptagBuffer;
+  int iRc;
+
+  if(!LOGC_TRACE_RUNNING())
+    return(-1);
+  LOGC_TRACE_LOCK(&tagTrace_m.tListMutex);
+  if(!tagTrace_m.iRunning) /* Stopped meanwhile */
+  {
+    LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+    return(-1);
+  }
+  for(ptagBuffer=tagTrace_m.ptagBuffers;ptagBuffer;ptagBuffer=ptagBuffer->ptagNext)
+  {
+    LOGC_TRACE_LOCK(&ptagBuffer->tMutex);
+    vLogC_TraceWriteBuffer_m(ptagBuffer);
+    LOGC_TRACE_UNLOCK(&ptagBuffer->tMutex);
+  }
+  iRc=((fflush(tagTrace_m.fpFile)) || (tagTrace_m.iFailed))?-1:0;
+  LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+  return(iRc);
+}
+
+int LogC_TraceStop(void)
+{
+  TagLogCTraceBuffer *ptagBuffer;
+  int iRc;
+
+  if(iLogC_TraceInit_m())
+    return(-1);
+  LOGC_TRACE_LOCK(&tagTrace_m.tListMutex);
+  if(!tagTrace_m.iRunning)
+  {
+    LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+    return(-1);
+  }
+  for(ptagBuffer=tagTrace_m.ptagBuffers;ptagBuffer;ptagBuffer=ptagBuffer->ptagNext)
+  {
+    LOGC_TRACE_LOCK(&ptagBuffer->tMutex);
+    vLogC_TraceWriteBuffer_m(ptagBuffer);
+    LOGC_TRACE_UNLOCK(&ptagBuffer->tMutex);
+  }
+  fputs("\n],\"displayTimeUnit\":\"ns\"}\n",tagTrace_m.fpFile);
+  iRc=((ferror(tagTrace_m.fpFile)) || (tagTrace_m.iFailed))?-1:0;
+  if(fclose(tagTrace_m.fpFile))
+    iRc=-1;
+  tagTrace_m.fpFile=NULL;
+  LOGC_TRACE_SET_RUNNING(0);
+  LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+  return(iRc);
+}
+
+int LogC_SpanBegin(const char *name)
+{
+  unsigned int uiGeneration=LOGC_TRACE_GENERATION(); /* Before checking if it's running, it may be restarted meanwhile */
+  if(!LOGC_TRACE_RUNNING())
+    return(-1);
+  return(iLogC_TraceAdd_m((name)?name:LOGC_TEXT_UNKNOWN,uiGeneration));
+}
+
+int LogC_SpanEnd(void)
+{
+  unsigned int uiGeneration=LOGC_TRACE_GENERATION();
+  if(!LOGC_TRACE_RUNNING())
+    return(-1);
+  return(iLogC_TraceAdd_m(NULL,uiGeneration));
+}
+
+/**
+ * Create the thread local key and the list mutex once.
+ *
+ * @return 0 if they are created, negative value on Error.
+ */
+INLINE_FCT int iLogC_TraceInit_m(void)
+{
+#ifdef _WIN32
+  if(!InitOnceExecuteOnce(&tTraceInitOnce_m,bLogC_TraceInitOnce_m,NULL,NULL))
+    return(-1);
+#else
+  if(pthread_once(&tTraceInitOnce_m,vLogC_TraceInitOnce_m))
+    return(-1);
+#endif /* _WIN32 */
+  return((tagTrace_m.iInitialized)?0:-1);
+}
+
+/**
+ * Returns the buffer of the calling thread, it's created with the first span of the thread.
+ */
+INLINE_FCT TagLogCTraceBuffer *ptagLogC_TraceBuffer_m(unsigned int uiGeneration)
+{
+  TagLogCTraceBuffer *ptagBuffer;
+
+  if((ptagBuffer=LOGC_TRACE_GET()))
+    return(ptagBuffer);
+  LOGC_TRACE_LOCK(&tagTrace_m.tListMutex);
+  if(!(ptagBuffer=malloc(sizeof(TagLogCTraceBuffer)+(tagTrace_m.szEventsPerThread-1)*sizeof(TagLogCTraceEvent))))
+  {
+    LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+    return(NULL);
+  }
+  if(LOGC_TRACE_SET(ptagBuffer))
+  {
+    LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+    free(ptagBuffer);
+    return(NULL);
+  }
+#ifdef _WIN32
+  InitializeCriticalSection(&ptagBuffer->tMutex);
+#else
+  pthread_mutex_init(&ptagBuffer->tMutex,NULL);
+#endif /* _WIN32 */
+  ptagBuffer->ullThreadId=ullLogC_TraceThreadId_m();
+  ptagBuffer->uiGeneration=uiGeneration;
+  ptagBuffer->uiDepth=0;
+  ptagBuffer->szCount=0;
+  ptagBuffer->szSize=tagTrace_m.szEventsPerThread;
+  ptagBuffer->ptagNext=tagTrace_m.ptagBuffers;
+  tagTrace_m.ptagBuffers=ptagBuffer;
+  LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+  return(ptagBuffer);
+}
+
+/**
+ * Record the begin (pcName set) or end (pcName NULL) of a span in the buffer of the calling thread.
+ * A full buffer is written to the file first.
+ *
+ * @param uiGeneration Generation of the trace which was running when the span was begun or ended,
+ *                     the event is dropped if another trace was started meanwhile.
+ */
+INLINE_FCT int iLogC_TraceAdd_m(const char *pcName,
+                                unsigned int uiGeneration)
+{
+  TagLogCTraceBuffer *ptagBuffer;
+  unsigned long long ullTimeNs=ullLogC_GetTimeNs_m();
+  int iRunning=1;
+
+  if(!(ptagBuffer=ptagLogC_TraceBuffer_m(uiGeneration)))
+    return(-1);
+  LOGC_TRACE_LOCK(&ptagBuffer->tMutex);
+  if(uiGeneration!=LOGC_TRACE_GENERATION())
+  {
+    LOGC_TRACE_UNLOCK(&ptagBuffer->tMutex);
+    return(-1);
+  }
+  if(ptagBuffer->uiGeneration!=uiGeneration) /* Events and spans still open of the last trace don't belong to this one */
+  {
+    ptagBuffer->uiGeneration=uiGeneration;
+    ptagBuffer->szCount=0;
+    ptagBuffer->uiDepth=0;
+  }
+  if(ptagBuffer->szCount==ptagBuffer->szSize)
+  {
+    /* The list mutex must be taken first */
+    LOGC_TRACE_UNLOCK(&ptagBuffer->tMutex);
+    LOGC_TRACE_LOCK(&tagTrace_m.tListMutex);
+    LOGC_TRACE_LOCK(&ptagBuffer->tMutex);
+    if((iRunning=tagTrace_m.iRunning))
+      vLogC_TraceWriteBuffer_m(ptagBuffer);
+    LOGC_TRACE_UNLOCK(&tagTrace_m.tListMutex);
+  }
+  if((!iRunning) || ((!pcName) && (!ptagBuffer->uiDepth)))
+  {
+    LOGC_TRACE_UNLOCK(&ptagBuffer->tMutex);
+    return(-1);
+  }
+  if(pcName)
+    ++ptagBuffer->uiDepth;
+  else
+    --ptagBuffer->uiDepth;
+  ptagBuffer->tagaEvents[ptagBuffer->szCount].pcName=pcName;
+  ptagBuffer->tagaEvents[ptagBuffer->szCount].ullTimeNs=ullTimeNs;
+  ++ptagBuffer->szCount;
+  LOGC_TRACE_UNLOCK(&ptagBuffer->tMutex);
+  return(0);
+}
+
+/**
+ * Write the events of the buffer to the file and empty it, the list mutex must be locked.
+ * Events of an older trace, recorded after it was stopped, are dropped.
+ * The timestamps are written in microseconds, as expected by the trace-event format.
+ */
+INLINE_FCT void vLogC_TraceWriteBuffer_m(TagLogCTraceBuffer *ptagBuffer)
+{
+  const TagLogCTraceEvent *ptagEvent;
+  size_t szIndex;
+
+  if(ptagBuffer->uiGeneration!=tagTrace_m.uiGeneration)
+  {
+    ptagBuffer->szCount=0;
+    return;
+  }
+  for(szIndex=0;szIndex<ptagBuffer->szCount;++szIndex)
+  {
+    ptagEvent=&ptagBuffer->tagaEvents[szIndex];
+    fputs((tagTrace_m.iFirstEvent)?"\n":",\n",tagTrace_m.fpFile);
+    tagTrace_m.iFirstEvent=0;
+    if(ptagEvent->pcName)
+    {
+      fputs("{\"name\":",tagTrace_m.fpFile);
+      vLogC_TraceWriteString_m(ptagEvent->pcName);
+      fputs(",\"ph\":\"B\"",tagTrace_m.fpFile);
+    }
+    else
+      fputs("{\"ph\":\"E\"",tagTrace_m.fpFile);
+    fprintf(tagTrace_m.fpFile,",\"ts\":%llu.%03u,\"pid\":%lu,\"tid\":%llu}",
+            ptagEvent->ullTimeNs/1000,
+            (unsigned int)(ptagEvent->ullTimeNs%1000),
+            tagTrace_m.ulPid,
+            ptagBuffer->ullThreadId);
+  }
+  if(ferror(tagTrace_m.fpFile))
+    tagTrace_m.iFailed=1;
+  ptagBuffer->szCount=0;
+}
+
+/**
+ * Write the text as JSON string, with quotes and escaped.
+ */
+INLINE_FCT void vLogC_TraceWriteString_m(const char *pcText)
+{
+  fputc('"',tagTrace_m.fpFile);
+  for(;*pcText;++pcText)
+  {
+    if((*pcText=='"') || (*pcText=='\\'))
+    {
+      fputc('\\',tagTrace_m.fpFile);
+      fputc(*pcText,tagTrace_m.fpFile);
+    }
+    else if((unsigned char)*pcText<0x20)
+      fprintf(tagTrace_m.fpFile,"\\u%04x",(unsigned int)(unsigned char)*pcText);
+    else
+      fputc(*pcText,tagTrace_m.fpFile);
+  }
+  fputc('"',tagTrace_m.fpFile);
+}
+
+/**
+ * Returns the id of the calling thread as shown in the trace, the list mutex must be locked.
+ */
+INLINE_FCT unsigned long long ullLogC_TraceThreadId_m(void)
+{
+#ifdef _WIN32
+  return((unsigned long long)GetCurrentThreadId());
+#elif defined(__linux__)
+  return((unsigned long long)syscall(SYS_gettid));
+#else
+  static unsigned long long ullLastId;
+  return(++ullLastId);
+#endif /* _WIN32 */
+}
+#endif /* LOGC_FEATURE_ENABLE_TRACE */
+
+#ifdef LOGC_FEATURE_ENABLE_IOURING
+INLINE_FCT TagLogCUring *ptagLogC_UringNew_m(const char *pcPath,
+                                             size_t szBufferSize)
+{
+  TagLogCUring *ptagUring;
+  struct io_uring_params tagParams;
+  struct iovec taIoVecs[LOGC_IOURING_BUFFERS];
+  unsigned int uiBuffer;
+
+  if(!(ptagUring=calloc(1,sizeof(TagLogCUring))))
+    return(NULL);
+  ptagUring->iRingFd=-1;
+  memset(&tagParams,0,sizeof(tagParams));
+  if((ptagUring->iFileFd=open(pcPath,O_WRONLY|O_CREAT|O_APPEND|O_CLOEXEC,0666))<0)
+  {
+    free(ptagUring);
+    return(NULL);
+  }
+  if((ptagUring->iRingFd=(int)syscall(__NR_io_uring_setup,LOGC_IOURING_ENTRIES,&tagParams))<0)
+    goto uringnew_fallback; /* Not supported by the kernel or not permitted */
+
+  ptagUring->szSqRingSize=tagParams.sq_off.array+tagParams.sq_entries*sizeof(unsigned int);
+  ptagUring->szCqRingSize=tagParams.cq_off.cqes+tagParams.cq_entries*sizeof(struct io_uring_cqe);
+  if(tagParams.features&IORING_FEAT_SINGLE_MMAP)
+  {
+    if(ptagUring->szCqRingSize>ptagUring->szSqRingSize)
+      ptagUring->szSqRingSize=ptagUring->szCqRingSize;
+    ptagUring->szCqRingSize=ptagUring->szSqRingSize;
+  }
+  if((ptagUring->pvSqRing=mmap(NULL,ptagUring->szSqRingSize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,
+                               ptagUring->iRingFd,IORING_OFF_SQ_RING))==MAP_FAILED)
+  {
+    ptagUring->pvSqRing=NULL;
+    goto uringnew_fallback;
+  }
+  if(tagParams.features&IORING_FEAT_SINGLE_MMAP)
+    ptagUring->pvCqRing=ptagUring->pvSqRing;
+  else if((ptagUring->pvCqRing=mmap(NULL,ptagUring->szCqRingSize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,
+                                    ptagUring->iRingFd,IORING_OFF_CQ_RING))==MAP_FAILED)
+  {
+    ptagUring->pvCqRing=NULL;
+    goto uringnew_fallback;
+  }
+  ptagUring->szSqesSize=tagParams.sq_entries*sizeof(struct io_uring_sqe);
+  if((ptagUring->ptagSqes=mmap(NULL,ptagUring->szSqesSize,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_POPULATE,
+                               ptagUring->iRingFd,IORING_OFF_SQES))==MAP_FAILED)
+  {
+    ptagUring->ptagSqes=NULL;
+    goto uringnew_fallback;
+  }
+  ptagUring->puiSqHead =(unsigned int*)((char*)ptagUring->pvSqRing+tagParams.sq_off.head);
+  ptagUring->puiSqTail =(unsigned int*)((char*)ptagUring->pvSqRing+tagParams.sq_off.tail);
+  ptagUring->puiSqMask =(unsigned int*)((char*)ptagUring->pvSqRing+tagParams.sq_off.ring_mask);
+  ptagUring->puiSqArray=(unsigned int*)((char*)ptagUring->pvSqRing+tagParams.sq_off.array);
+  ptagUring->puiCqHead =(unsigned int*)((char*)ptagUring->pvCqRing+tagParams.cq_off.head);
+  ptagUring->puiCqTail =(unsigned int*)((char*)ptagUring->pvCqRing+tagParams.cq_off.tail);
+  ptagUring->puiCqMask =(unsigned int*)((char*)ptagUring->pvCqRing+tagParams.cq_off.ring_mask);
+  ptagUring->ptagCqes  =(struct io_uring_cqe*)((char*)ptagUring->pvCqRing+tagParams.cq_off.cqes);
+
+  /* Register the buffers, so the kernel doesn't need to map them for every write */
+  ptagUring->szBufferSize=szBufferSize;
+  if(!(ptagUring->pcaBuffers[0]=malloc(LOGC_IOURING_BUFFERS*szBufferSize)))
+    goto uringnew_fallback;
+  for(uiBuffer=0;uiBuffer<LOGC_IOURING_BUFFERS;++uiBuffer)
+  {
+    ptagUring->pcaBuffers[uiBuffer]=ptagUring->pcaBuffers[0]+uiBuffer*szBufferSize;
+    taIoVecs[uiBuffer].iov_base=ptagUring->pcaBuffers[uiBuffer];
+    taIoVecs[uiBuffer].iov_len=szBufferSize;
+  }
+  if(syscall(__NR_io_uring_register,ptagUring->iRingFd,IORING_REGISTER_BUFFERS,taIoVecs,LOGC_IOURING_BUFFERS))
+    goto uringnew_fallback;
+  return(ptagUring);
+
+uringnew_fallback:
+  iLogC_UringEnd_m(ptagUring);
+  return(NULL);
+}
+
+INLINE_FCT int iLogC_UringWrite_m(TagLogCUring *ptagUring,
+                                  const char *pcQueueBuffer,
+                                  size_t szEntryCount,
+                                  size_t szEntrySize)
+{
+  size_t szIndex;
+  size_t szLength=0;
+  size_t szEntryLength;
+  unsigned int uiTail;
+  unsigned int uiBuffer=ptagUring->uiNextBuffer;
+  struct io_uring_sqe *ptagSqe;
+  char *pcBuffer=ptagUring->pcaBuffers[uiBuffer];
+
+  /* The last write must be completed, appends in flight at the same time aren't ordered */
+  while(ptagUring->uiInFlight)
+  {
+    if(iLogC_UringReap_m(ptagUring,1))
+      return(-1);
+  }
+  /* Copy the entries contiguously to the free buffer, without the '\0' */
+  for(szIndex=0;szIndex<szEntryCount;++szIndex)
+  {
+    szEntryLength=strlen(&pcQueueBuffer[szIndex*szEntrySize]);
+    memcpy(&pcBuffer[szLength],&pcQueueBuffer[szIndex*szEntrySize],szEntryLength);
+    szLength+=szEntryLength;
+  }
+  if(!szLength)
+    return(0);
+  uiTail=*ptagUring->puiSqTail;
+  ptagSqe=&ptagUring->ptagSqes[uiTail&*ptagUring->puiSqMask];
+  memset(ptagSqe,0,sizeof(struct io_uring_sqe));
+  ptagSqe->opcode=IORING_OP_WRITE_FIXED;
+  ptagSqe->fd=ptagUring->iFileFd;
+  ptagSqe->addr=(unsigned long)pcBuffer;
+  ptagSqe->len=(unsigned int)szLength;
+  ptagSqe->off=0; /* Ignored, O_APPEND writes at the end of the file */
+  ptagSqe->buf_index=(unsigned short)uiBuffer;
+  ptagSqe->user_data=uiBuffer;
+  ptagUring->puiSqArray[uiTail&*ptagUring->puiSqMask]=uiTail&*ptagUring->puiSqMask;
+  __atomic_store_n(ptagUring->puiSqTail,uiTail+1,__ATOMIC_RELEASE);
+  if(syscall(__NR_io_uring_enter,ptagUring->iRingFd,1,0,0,NULL,0)!=1)
+  {
+    perror("Failed to submit write to LogFile: ");
+    return(-1);
+  }
+  ++ptagUring->uiInFlight;
+  ptagUring->szaLengths[uiBuffer]=szLength;
+  ptagUring->uiNextBuffer=(uiBuffer+1)%LOGC_IOURING_BUFFERS;
+  return(0);
+}
+
+/**
+ * Reap the completed writes and check their results, the rest of a short write is appended synchronously.
+ *
+ * @param iWait If set, wait for a completion if none is available.
+ *
+ * @return 0 on success, -1 if a write failed or waiting failed.
+ */
+INLINE_FCT int iLogC_UringReap_m(TagLogCUring *ptagUring,
+                                 int iWait)
+{
+  unsigned int uiHead=*ptagUring->puiCqHead;
+  unsigned int uiBuffer;
+  int iRes;
+  int iRc=0;
+  size_t szLength;
+  const char *pcBuffer;
+  ssize_t sRc;
+
+  while((iWait) && (uiHead==__atomic_load_n(ptagUring->puiCqTail,__ATOMIC_ACQUIRE)))
+  {
+    if((syscall(__NR_io_uring_enter,ptagUring->iRingFd,0,1,IORING_ENTER_GETEVENTS,NULL,0)<0) &&
+       (errno!=EINTR))
+    {
+      perror("Failed to wait for write to LogFile: ");
+      return(-1);
+    }
+  }
+  for(;uiHead!=__atomic_load_n(ptagUring->puiCqTail,__ATOMIC_ACQUIRE);++uiHead)
+  {
+    uiBuffer=(unsigned int)ptagUring->ptagCqes[uiHead&*ptagUring->puiCqMask].user_data;
+    iRes=ptagUring->ptagCqes[uiHead&*ptagUring->puiCqMask].res;
+    __atomic_store_n(ptagUring->puiCqHead,uiHead+1,__ATOMIC_RELEASE);
+    --ptagUring->uiInFlight;
+    szLength=ptagUring->szaLengths[uiBuffer];
+    ptagUring->szaLengths[uiBuffer]=0;
+    if(iRes<0)
+    {
+      errno=-iRes;
+      perror("Failed to write LogFile: ");
+      iRc=-1;
+      continue;
+    }
+    pcBuffer=ptagUring->pcaBuffers[uiBuffer];
+    while((size_t)iRes<szLength)
+    {
+      if((sRc=write(ptagUring->iFileFd,&pcBuffer[iRes],szLength-(size_t)iRes))<0)
+      {
+        if(errno==EINTR)
+          continue;
+        perror("Failed to write LogFile: ");
+        iRc=-1;
+        break;
+      }
+      iRes+=(int)sRc;
+    }
+  }
+  return(iRc);
+}
+
+/**
+ * Wait for all writes in flight and check their results.
+ */
+INLINE_FCT int iLogC_UringComplete_m(TagLogCUring *ptagUring)
+{
+  unsigned int uiInFlight;
+  int iRc=0;
+
+  while((uiInFlight=ptagUring->uiInFlight))
+  {
+    if(iLogC_UringReap_m(ptagUring,1))
+    {
+      iRc=-1;
+      if(ptagUring->uiInFlight==uiInFlight)
+        break; /* Waiting failed, the writes in flight can't be reaped */
+    }
+  }
+  return(iRc);
+}
+
+INLINE_FCT int iLogC_UringEnd_m(TagLogCUring *ptagUring)
+{
+  int iRc=0;
+  if(ptagUring->iRingFd>=0)
+    iRc=iLogC_UringComplete_m(ptagUring);
+  if(ptagUring->ptagSqes)
+    munmap(ptagUring->ptagSqes,ptagUring->szSqesSize);
+  if((ptagUring->pvCqRing) && (ptagUring->pvCqRing!=ptagUring->pvSqRing))
+    munmap(ptagUring->pvCqRing,ptagUring->szCqRingSize);
+  if(ptagUring->pvSqRing)
+    munmap(ptagUring->pvSqRing,ptagUring->szSqRingSize);
+  if(ptagUring->iRingFd>=0)
+    close(ptagUring->iRingFd);
+  close(ptagUring->iFileFd);
+  free(ptagUring->pcaBuffers[0]);
+  free(ptagUring);
+  return(iRc);
+}
+#endif /* LOGC_FEATURE_ENABLE_IOURING */
+
+#ifdef LOGC_FILEMODE_DIRECT_AVAILABLE
+INLINE_FCT TagLogCDirect *ptagLogC_DirectNew_m(const char *pcPath,
+                                               size_t szQueueSize)
+{
+  TagLogCDirect *ptagDirect;
+  struct stat tagStat;
+  void *pvBuffer;
+  ssize_t sRc;
+
+  if(!(ptagDirect=malloc(sizeof(TagLogCDirect))))
+    return(NULL);
+  /* One full queue must fit into the buffer in addition to a partial block */
+  ptagDirect->szBufferSize=(szQueueSize+2*LOGC_DIRECT_BLOCKSIZE-1)&~((size_t)LOGC_DIRECT_BLOCKSIZE-1);
+  if(ptagDirect->szBufferSize<LOGC_DIRECT_BUFFERSIZE)
+    ptagDirect->szBufferSize=LOGC_DIRECT_BUFFERSIZE;
+  if(posix_memalign(&pvBuffer,LOGC_DIRECT_BLOCKSIZE,ptagDirect->szBufferSize))
+  {
+    free(ptagDirect);
+    return(NULL);
+  }
+  ptagDirect->pcBuffer=pvBuffer;
+  /* O_RDWR, because a partial block at the end of an existing file must be read back */
+  if(((ptagDirect->iFileFd=open(pcPath,O_RDWR|O_CREAT|O_DIRECT|O_CLOEXEC,0666))<0) ||
+     (fstat(ptagDirect->iFileFd,&tagStat)))
+  {
+    perror("Failed to Open LogFile with O_DIRECT: ");
+    goto directnew_error;
+  }
+  ptagDirect->tFileOffset=tagStat.st_size&~((off_t)LOGC_DIRECT_BLOCKSIZE-1);
+  ptagDirect->szBufferLength=(size_t)(tagStat.st_size-ptagDirect->tFileOffset);
+  if(ptagDirect->szBufferLength)
+  {
+    sRc=pread(ptagDirect->iFileFd,ptagDirect->pcBuffer,LOGC_DIRECT_BLOCKSIZE,ptagDirect->tFileOffset);
+    if((sRc<0) || ((size_t)sRc<ptagDirect->szBufferLength))
+    {
+      perror("Failed to read LogFile with O_DIRECT: ");
+      goto directnew_error;
+    }
+  }
+  return(ptagDirect);
+
+directnew_error:
+  if(ptagDirect->iFileFd>=0)
+    close(ptagDirect->iFileFd);
+  free(ptagDirect->pcBuffer);
+  free(ptagDirect);
+  return(NULL);
+}
+
+INLINE_FCT int iLogC_DirectWrite_m(TagLogCDirect *ptagDirect,
+                                   const char *pcQueueBuffer,
+                                   size_t szEntryCount,
+                                   size_t szEntrySize)
+{
+  size_t szIndex;
+  size_t szEntryLength;
+
+  for(szIndex=0;szIndex<szEntryCount;++szIndex)
+  {
+    szEntryLength=strlen(&pcQueueBuffer[szIndex*szEntrySize]);
+    /* Write the full blocks, if the buffer is full */
+    if((ptagDirect->szBufferLength+szEntryLength>ptagDirect->szBufferSize) &&
+       (iLogC_DirectWriteBlocks_m(ptagDirect,0)))
+      return(-1);
+    memcpy(&ptagDirect->pcBuffer[ptagDirect->szBufferLength],&pcQueueBuffer[szIndex*szEntrySize],szEntryLength);
+    ptagDirect->szBufferLength+=szEntryLength;
+  }
+  return(0);
+}
+
+/**
+ * Writes all full blocks of the buffer, the remaining partial block is moved to the start of the buffer.
+ * If iPartial is set, the partial block is also written, padded with zeros,
+ * and the file is truncated to its real size afterwards. It stays in the buffer to be completed later.
+ */
+INLINE_FCT int iLogC_DirectWriteBlocks_m(TagLogCDirect *ptagDirect,
+                                         int iPartial)
+{
+  size_t szFullLength=ptagDirect->szBufferLength&~((size_t)LOGC_DIRECT_BLOCKSIZE-1);
+  size_t szWriteLength=szFullLength;
+  size_t szWritten=0;
+  ssize_t sRc;
+
+  if((iPartial) && (szFullLength<ptagDirect->szBufferLength))
+  {
+    szWriteLength=szFullLength+LOGC_DIRECT_BLOCKSIZE;
+    memset(&ptagDirect->pcBuffer[ptagDirect->szBufferLength],0,szWriteLength-ptagDirect->szBufferLength);
+  }
+  while(szWritten<szWriteLength)
+  {
+    if((sRc=pwrite(ptagDirect->iFileFd,
+                   &ptagDirect->pcBuffer[szWritten],
+                   szWriteLength-szWritten,
+                   ptagDirect->tFileOffset+(off_t)szWritten))<0)
+    {
+      if(errno==EINTR)
+        continue;
+      perror("Failed to write LogFile with O_DIRECT: ");
+      return(-1);
+    }
+    if(sRc<LOGC_DIRECT_BLOCKSIZE) /* Not even one block was written, retrying won't help */
+    {
+      errno=EIO;
+      perror("Failed to write LogFile with O_DIRECT: ");
+      return(-1);
+    }
+    /* O_DIRECT needs aligned offsets, the rest of a partially written block is written again */
+    szWritten+=(size_t)sRc&~((size_t)LOGC_DIRECT_BLOCKSIZE-1);
+  }
+  if(szWriteLength>szFullLength) /* Remove the padding from the file */
+  {
+    if(ftruncate(ptagDirect->iFileFd,ptagDirect->tFileOffset+(off_t)ptagDirect->szBufferLength))
+    {
+      perror("Failed to truncate LogFile: ");
+      return(-1);
+    }
+  }
+  ptagDirect->tFileOffset+=(off_t)szFullLength;
+  ptagDirect->szBufferLength-=szFullLength;
+  if(ptagDirect->szBufferLength)
+    memmove(ptagDirect->pcBuffer,&ptagDirect->pcBuffer[szFullLength],ptagDirect->szBufferLength);
+  return(0);
+}
+
+INLINE_FCT int iLogC_DirectEnd_m(TagLogCDirect *ptagDirect)
+{
+  int iRc;
+  iRc=iLogC_DirectWriteBlocks_m(ptagDirect,1);
+  close(ptagDirect->iFileFd);
+  free(ptagDirect->pcBuffer);
+  free(ptagDirect);
+  return(iRc);
+}
+#endif /* LOGC_FILEMODE_DIRECT_AVAILABLE */
+
+#ifdef LOGC_FILEMODE_APPEND_AVAILABLE
+INLINE_FCT TagLogCAppend *ptagLogC_AppendNew_m(const char *pcPath,
+                                               size_t szEntrySize)
+{
+  TagLogCAppend *ptagAppend;
+
+  if(!(ptagAppend=malloc(sizeof(TagLogCAppend))))
+    return(NULL);
+  /* An entry longer than LOGC_APPEND_WRITESIZE is still written with one write() */
+  ptagAppend->szBufferSize=(szEntrySize>LOGC_APPEND_WRITESIZE)?szEntrySize:LOGC_APPEND_WRITESIZE;
+  if(!(ptagAppend->pcBuffer=malloc(ptagAppend->szBufferSize)))
+  {
+    free(ptagAppend);
+    return(NULL);
+  }
+  if((ptagAppend->iFileFd=open(pcPath,O_WRONLY|O_CREAT|O_APPEND|O_CLOEXEC,0666))<0)
+  {
+    perror("Failed to Open LogFile with O_APPEND: ");
+    free(ptagAppend->pcBuffer);
+    free(ptagAppend);
+    return(NULL);
+  }
+  return(ptagAppend);
+}
+
+/**
+ * Write the entries with as few write() calls as possible, without splitting an entry.
+ * Each call adds up to LOGC_APPEND_WRITESIZE bytes at the current end of the logfile.
+ */
+INLINE_FCT int iLogC_AppendWrite_m(TagLogCAppend *ptagAppend,
+                                   const char *pcQueueBuffer,
+                                   size_t szEntryCount,
+                                   size_t szEntrySize)
+{
+  size_t szLength=0;
+  size_t szIndex;
+  size_t szEntryLength;
+
+  for(szIndex=0;szIndex<szEntryCount;++szIndex)
+  {
+    szEntryLength=strlen(&pcQueueBuffer[szIndex*szEntrySize]);
+    if(szLength+szEntryLength>ptagAppend->szBufferSize)
+    {
+      if(iLogC_AppendWriteBuffer_m(ptagAppend,szLength))
+        return(-1);
+      szLength=0;
+    }
+    memcpy(&ptagAppend->pcBuffer[szLength],&pcQueueBuffer[szIndex*szEntrySize],szEntryLength);
+    szLength+=szEntryLength;
+  }
+  return(iLogC_AppendWriteBuffer_m(ptagAppend,szLength));
+}
+
+INLINE_FCT int iLogC_AppendWriteBuffer_m(TagLogCAppend *ptagAppend,
+                                         size_t szLength)
+{
+  size_t szWritten=0;
+  ssize_t sRc;
+
+  /* A short write (e.g. disk full) continues with the rest, it's the only case an entry may be split */
+  while(szWritten<szLength)
+  {
+    if((sRc=write(ptagAppend->iFileFd,&ptagAppend->pcBuffer[szWritten],szLength-szWritten))<0)
+    {
+      if(errno==EINTR)
+        continue;
+      perror("Failed to write LogFile with O_APPEND: ");
+      return(-1);
+    }
+    szWritten+=(size_t)sRc;
+  }
+  return(0);
+}
+
+INLINE_FCT void vLogC_AppendEnd_m(TagLogCAppend *ptagAppend)
+{
+  close(ptagAppend->iFileFd);
+  free(ptagAppend->pcBuffer);
+  free(ptagAppend);
+}
+#endif /* LOGC_FILEMODE_APPEND_AVAILABLE */
+
+#ifdef LOGC_FEATURE_ENABLE_FILECACHE
+int LogC_SetFileCache(size_t maxFiles)
+{
+  TagLogCFileCacheEntry **pptagBuckets;
+  TagLogCFileCacheEntry *ptagEntry;
+  TagLogCFileCacheEntry *ptagPrev;
+  size_t szBuckets=LOGC_FILECACHE_BUCKETS_MIN;
+
+  /* Stops before the size of the table overflows, the chains just get longer then */
+  while((szBuckets<maxFiles) && (szBuckets<=((size_t)-1)/2/sizeof(TagLogCFileCacheEntry*)))
+  {
+    szBuckets*=2;
+  }
+  LOGC_FILECACHE_LOCK();
+  if((maxFiles) || (tagFileCache_m.szCount))
+  {
+    if(!(pptagBuckets=calloc(szBuckets,sizeof(TagLogCFileCacheEntry*))))
+    {
+      LOGC_FILECACHE_UNLOCK();
+      return(-1);
+    }
+  }
+  else
+  {
+    pptagBuckets=NULL;
+    szBuckets=0;
+  }
+  /* Start over with an empty cache, descriptors in use are closed when their write is done */
+  for(ptagEntry=tagFileCache_m.ptagLast;ptagEntry;ptagEntry=ptagPrev)
+  {
+    ptagPrev=ptagEntry->ptagPrev;
+    if(!ptagEntry->szUsers)
+    {
+      vLogC_FileCacheRemove_m(ptagEntry);
+      close(ptagEntry->iFileFd);
+      free(ptagEntry);
+    }
+  }
+  free(tagFileCache_m.pptagBuckets);
+  tagFileCache_m.pptagBuckets=pptagBuckets;
+  tagFileCache_m.szBuckets=szBuckets;
+  tagFileCache_m.szMaxFiles=maxFiles;
+  for(ptagEntry=tagFileCache_m.ptagFirst;ptagEntry;ptagEntry=ptagEntry->ptagNext)
+  {
+    ptagEntry->ptagHashNext=pptagBuckets[ptagEntry->szHash&(szBuckets-1)];
+    pptagBuckets[ptagEntry->szHash&(szBuckets-1)]=ptagEntry;
+  }
+  LOGC_FILECACHE_UNLOCK();
+  return(0);
+}
+
+/**
+ * Get the cached descriptor of the path, it's opened if needed, evicting the least recently used
+ * descriptor which isn't in use, if the cache is full.
+ *
+ * @return The entry, to be released after the write, NULL if the cache is disabled or all descriptors are in use.
+ */
+INLINE_FCT TagLogCFileCacheEntry *ptagLogC_FileCacheAcquire_m(const char *pcPath)
+{
+  TagLogCFileCacheEntry *ptagEntry;
+  size_t szHash;
+
+  if(strlen(pcPath)>=LOGC_PATH_MAXLEN)
+    return(NULL);
+  szHash=szLogC_FileCacheHash_m(pcPath);
+  LOGC_FILECACHE_LOCK();
+  if(!tagFileCache_m.szMaxFiles)
+  {
+    LOGC_FILECACHE_UNLOCK();
+    return(NULL);
+  }
+  if((ptagEntry=ptagLogC_FileCacheFind_m(pcPath,szHash)))
+  {
+    vLogC_FileCacheRemove_m(ptagEntry);
+  }
+  else
+  {
+    if(tagFileCache_m.szCount>=tagFileCache_m.szMaxFiles)
+    {
+      for(ptagEntry=tagFileCache_m.ptagLast;(ptagEntry) && (ptagEntry->szUsers);ptagEntry=ptagEntry->ptagPrev)
+        ;
+      if(!ptagEntry)
+      {
+        LOGC_FILECACHE_UNLOCK();
+        return(NULL);
+      }
+      /* The writes go directly to the descriptor, so there's nothing to flush before it's closed */
+      vLogC_FileCacheRemove_m(ptagEntry);
+      close(ptagEntry->iFileFd);
+    }
+    else if(!(ptagEntry=malloc(sizeof(TagLogCFileCacheEntry))))
+    {
+      LOGC_FILECACHE_UNLOCK();
+      return(NULL);
+    }
+    if((ptagEntry->iFileFd=open(pcPath,O_WRONLY|O_CREAT|O_APPEND|O_CLOEXEC,0666))<0)
+    {
+      LOGC_FILECACHE_UNLOCK();
+      free(ptagEntry);
+      return(NULL);
+    }
+    strcpy(ptagEntry->caPath,pcPath);
+    ptagEntry->szHash=szHash;
+    ptagEntry->szUsers=0;
+    ptagEntry->iDropped=0;
+  }
+  ++ptagEntry->szUsers;
+  vLogC_FileCacheInsert_m(ptagEntry);
+  LOGC_FILECACHE_UNLOCK();
+  return(ptagEntry);
+}
+
+/**
+ * Release the descriptor after a write. It's closed if the write failed, so the next write opens the path again,
+ * if the cache was shrunk or disabled while it was in use, or if it was dropped.
+ */
+INLINE_FCT void vLogC_FileCacheRelease_m(TagLogCFileCacheEntry *ptagEntry,
+                                         int iFailed)
+{
+  LOGC_FILECACHE_LOCK();
+  if((!--ptagEntry->szUsers) &&
+     ((ptagEntry->iDropped) || (iFailed) || (tagFileCache_m.szCount>tagFileCache_m.szMaxFiles)))
+  {
+    if(!ptagEntry->iDropped)
+      vLogC_FileCacheRemove_m(ptagEntry);
+    close(ptagEntry->iFileFd);
+    free(ptagEntry);
+  }
+  LOGC_FILECACHE_UNLOCK();
+}
+
+/**
+ * Close the cached descriptor of the path, if there's one, e.g. when a Log-Object stops writing the path.
+ * A descriptor in use is removed from the cache and closed when its write is done.
+ */
+INLINE_FCT void vLogC_FileCacheDrop_m(const char *pcPath)
+{
+  TagLogCFileCacheEntry *ptagEntry;
+  size_t szHash=szLogC_FileCacheHash_m(pcPath);
+
+  LOGC_FILECACHE_LOCK();
+  if((!tagFileCache_m.szBuckets) || (!(ptagEntry=ptagLogC_FileCacheFind_m(pcPath,szHash))))
+  {
+    LOGC_FILECACHE_UNLOCK();
+    return;
+  }
+  vLogC_FileCacheRemove_m(ptagEntry);
+  if(ptagEntry->szUsers)
+    ptagEntry->iDropped=1;
+  else
+  {
+    close(ptagEntry->iFileFd);
+    free(ptagEntry);
+  }
+  LOGC_FILECACHE_UNLOCK();
+}
+
+/**
+ * FNV-1a hash of the path.
+ */
+INLINE_FCT size_t szLogC_FileCacheHash_m(const char *pcPath)
+{
+  size_t szHash=2166136261U;
+
+  for(;*pcPath;++pcPath)
+  {
+    szHash=(szHash^(unsigned char)*pcPath)*16777619U;
+  }
+  return(szHash);
+}
+
+/**
+ * Look up the entry of the path, the mutex must be locked and the cache must have a table.
+ *
+ * @return The entry, NULL if the path isn't cached.
+ */
+INLINE_FCT TagLogCFileCacheEntry *ptagLogC_FileCacheFind_m(const char *pcPath,
+                                                           size_t szHash)
+{
+  TagLogCFileCacheEntry *ptagEntry;
+
+  for(ptagEntry=tagFileCache_m.pptagBuckets[szHash&(tagFileCache_m.szBuckets-1)];ptagEntry;ptagEntry=ptagEntry->ptagHashNext)
+  {
+    if((ptagEntry->szHash==szHash) && (!strcmp(ptagEntry->caPath,pcPath)))
+      break;
+  }
+  return(ptagEntry);
+}
+
+/**
+ * Remove the entry from the hash table and the LRU list, the mutex must be locked.
+ */
+INLINE_FCT void vLogC_FileCacheRemove_m(TagLogCFileCacheEntry *ptagEntry)
+{
+  TagLogCFileCacheEntry **pptagEntry=&tagFileCache_m.pptagBuckets[ptagEntry->szHash&(tagFileCache_m.szBuckets-1)];
+
+  while(*pptagEntry!=ptagEntry)
+  {
+    pptagEntry=&(*pptagEntry)->ptagHashNext;
+  }
+  *pptagEntry=ptagEntry->ptagHashNext;
+  if(ptagEntry->ptagPrev)
+    ptagEntry->ptagPrev->ptagNext=ptagEntry->ptagNext;
+  else
+    tagFileCache_m.ptagFirst=ptagEntry->ptagNext;
+  if(ptagEntry->ptagNext)
+    ptagEntry->ptagNext->ptagPrev=ptagEntry->ptagPrev;
+  else
+    tagFileCache_m.ptagLast=ptagEntry->ptagPrev;
+  --tagFileCache_m.szCount;
+}
+
+/**
+ * Add the entry to the hash table and as most recently used to the LRU list, the mutex must be locked.
+ */
+INLINE_FCT void vLogC_FileCacheInsert_m(TagLogCFileCacheEntry *ptagEntry)
+{
+  TagLogCFileCacheEntry **pptagBucket=&tagFileCache_m.pptagBuckets[ptagEntry->szHash&(tagFileCache_m.szBuckets-1)];
+
+  ptagEntry->ptagHashNext=*pptagBucket;
+  *pptagBucket=ptagEntry;
+  ptagEntry->ptagPrev=NULL;
+  ptagEntry->ptagNext=tagFileCache_m.ptagFirst;
+  if(tagFileCache_m.ptagFirst)
+    tagFileCache_m.ptagFirst->ptagPrev=ptagEntry;
+  else
+    tagFileCache_m.ptagLast=ptagEntry;
+  tagFileCache_m.ptagFirst=ptagEntry;
+  ++tagFileCache_m.szCount;
+}
+
+/**
+ * Write the entries with one writev() call per LOGC_FILECACHE_IOVECS entries.
+ */
+INLINE_FCT int iLogC_FileCacheWrite_m(int iFileFd,
+                                      const char *pcQueueBuffer,
+                                      size_t szEntryCount,
+                                      size_t szEntrySize)
+{
+  struct iovec tagaVecs[LOGC_FILECACHE_IOVECS];
+  struct iovec *ptagVec;
+  size_t szVecs;
+  size_t szIndex=0;
+  ssize_t sRc;
+
+  while(szIndex<szEntryCount)
+  {
+    for(szVecs=0;(szVecs<LOGC_FILECACHE_IOVECS) && (szIndex<szEntryCount);++szIndex)
+    {
+      tagaVecs[szVecs].iov_base=(void*)&pcQueueBuffer[szIndex*szEntrySize];
+      if((tagaVecs[szVecs].iov_len=strlen(tagaVecs[szVecs].iov_base)))
+        ++szVecs;
+    }
+    ptagVec=tagaVecs;
+    while(szVecs)
+    {
+      if((sRc=writev(iFileFd,ptagVec,(int)szVecs))<0)
+      {
+        if(errno==EINTR)
+          continue;
+        perror("Failed to write LogFile: ");
+        return(-1);
+      }
+      /* Continue behind a short write */
+      for(;(szVecs) && ((size_t)sRc>=ptagVec->iov_len);++ptagVec,--szVecs)
+      {
+        sRc-=(ssize_t)ptagVec->iov_len;
+      }
+      if(szVecs)
+      {
+        ptagVec->iov_base=(char*)ptagVec->iov_base+sRc;
+        ptagVec->iov_len-=(size_t)sRc;
+      }
+    }
+  }
+  return(0);
+}
+#endif /* LOGC_FEATURE_ENABLE_FILECACHE */
+
+#ifdef LOGC_FEATURE_ENABLE_SHM
+int LogC_SetShmRing(LogC log,
+                    const char *name,
+                    size_t size)
+{
+  int iRc=0;
+  if((name) && ((name[0]!='/') || (size/2<log->szMaxEntryLength+1)))
+    return(-1);
+  LOGC_MUTEX_LOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  if((name) && (log->iPerCpuEnabled)) /* Entries in the slots don't reach the ring */
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    return(-1);
+  }
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  vLogC_ShmClose_m(log);
+  if(name)
+    iRc=iLogC_ShmOpen_m(log,name,size);
+  LOGC_MUTEX_UNLOCK(log);
+  return(iRc);
+}
+
+INLINE_FCT int iLogC_ShmOpen_m(LogC ptagLog,
+                               const char *pcName,
+                               size_t szSize)
+{
+  size_t szDataSize=1;
+  void *pvMap;
+  int iFd;
+
+  while(szDataSize<szSize)
+  {
+    if(szDataSize>(((size_t)-1)-sizeof(LogCShmHeader))/2)
+      return(-1);
+    szDataSize<<=1;
+  }
+  while((iFd=shm_open(pcName,O_RDWR|O_CREAT|O_EXCL,0600))<0)
+  {
+    if((errno!=EEXIST) || (iLogC_ShmRemoveStale_m(pcName)))
+      return(-1);
+  }
+  if(ftruncate(iFd,(off_t)(sizeof(LogCShmHeader)+szDataSize)))
+  {
+    close(iFd);
+    shm_unlink(pcName);
+    return(-1);
+  }
+  pvMap=mmap(NULL,sizeof(LogCShmHeader)+szDataSize,PROT_READ|PROT_WRITE,MAP_SHARED,iFd,0);
+  close(iFd);
+  if(pvMap==MAP_FAILED)
+  {
+    shm_unlink(pcName);
+    return(-1);
+  }
+  ptagLog->ptagShm=pvMap;
+  ptagLog->pcShmData=((char*)pvMap)+sizeof(LogCShmHeader);
+  ptagLog->szShmDataSize=szDataSize;
+  ptagLog->ullShmDroppedPending=0;
+  /* The object is zero-filled, the magic is set last, so the reader just sees complete headers */
+  ptagLog->ptagShm->uiVersion=LOGC_SHM_VERSION;
+  ptagLog->ptagShm->ullDataSize=szDataSize;
+  ptagLog->ptagShm->ullPid=(unsigned long long)getpid();
+  LOGC_SHM_STORE_RELEASE(&ptagLog->ptagShm->uiMagic,LOGC_SHM_MAGIC);
+  return(0);
+}
+
+/**
+ * Remove an existing ring of a process which is gone, e.g. a former process with the same name.
+ * A ring of a running process or one which isn't initialized yet is kept, errno is EEXIST then.
+ *
+ * @return 0 if the ring is removed or gone meanwhile, negative value if it's kept.
+ */
+INLINE_FCT int iLogC_ShmRemoveStale_m(const char *pcName)
+{
+  LogCShmHeader *ptagHeader;
+  struct stat tagStat;
+  int iStale=0;
+  int iFd;
+
+  if((iFd=shm_open(pcName,O_RDONLY,0))<0)
+    return((errno==ENOENT)?0:-1); /* Removed meanwhile, e.g. by the collector */
+  if((!fstat(iFd,&tagStat)) &&
+     ((size_t)tagStat.st_size>=sizeof(LogCShmHeader)) &&
+     ((ptagHeader=mmap(NULL,sizeof(LogCShmHeader),PROT_READ,MAP_SHARED,iFd,0))!=MAP_FAILED))
+  {
+    iStale=((LOGC_SHM_LOAD_ACQUIRE(&ptagHeader->uiMagic)==LOGC_SHM_MAGIC) &&
+            (kill((pid_t)ptagHeader->ullPid,0)) &&
+            (errno==ESRCH));
+    munmap(ptagHeader,sizeof(LogCShmHeader));
+  }
+  close(iFd);
+  if(!iStale)
+  {
+    errno=EEXIST;
+    return(-1);
+  }
+  if((shm_unlink(pcName)) && (errno!=ENOENT))
+    return(-1);
+  return(0);
+}
+
+/**
+ * Marks the ring as closed for the reader and unmaps it, the reader removes it after draining.
+ */
+INLINE_FCT void vLogC_ShmClose_m(LogC ptagLog)
+{
+  if(!ptagLog->ptagShm)
+    return;
+  LOGC_SHM_STORE_RELEASE(&ptagLog->ptagShm->ullClosed,1ULL);
+  munmap(ptagLog->ptagShm,sizeof(LogCShmHeader)+ptagLog->szShmDataSize);
+  ptagLog->ptagShm=NULL;
+}
+
+/**
+ * Make sure there's space for szLength bytes in the ring, apply the backpressure policy if it's full.
+ * Adds the marker for dropped entries if there's space for it too.
+ *
+ * @param szEntrySize Space needed, the maximum length of an entry without '\0' or the length of a batch.
+ *
+ * @return 0 if the entry can be added, 1 if it's dropped.
+ */
+INLINE_FCT int iLogC_ShmReserve_m(LogC ptagLog,
+                                  int iLogType,
+                                  size_t szEntrySize)
+{
+  unsigned long long ullDeadlineNs=0;
+  unsigned int uiWaitMs=0;
+  unsigned long long ullFree;
+  char caMarker[64];
+  int iMarkerLength;
+
+  if(szEntrySize>ptagLog->szShmDataSize) /* Never fits, drop it without waiting */
+    ullDeadlineNs=1;
+  while((ullFree=ptagLog->szShmDataSize-(ptagLog->ptagShm->ullHead-LOGC_SHM_LOAD_ACQUIRE(&ptagLog->ptagShm->ullTail)))<szEntrySize)
+  {
+    /* Drop the new entry for LOGC_BACKPRESSURE_DROP_OLDEST too, the buffered ones belong to the reader */
+    if(iLogC_BackpressureDrop_m(ptagLog,iLogType,&ullDeadlineNs,&uiWaitMs,&ptagLog->ullShmDroppedPending))
+      return(1);
+    if(!ptagLog->ptagShm) /* Closed while waiting */
+      return(0);
+  }
+  if(ptagLog->ullShmDroppedPending)
+  {
+    iMarkerLength=iLogC_snprintf(caMarker,sizeof(caMarker),LOGC_TEXT_DROPPED,ptagLog->ullShmDroppedPending);
+    if((iMarkerLength>0) && (ullFree>=szEntrySize+(size_t)iMarkerLength))
+    {
+      vLogC_ShmWrite_m(ptagLog,caMarker,(size_t)iMarkerLength);
+      ptagLog->ullShmDroppedPending=0;
+    }
+  }
+  return(0);
+}
+
+/**
+ * Copy the text into the ring and publish it to the reader, the space must be reserved before.
+ */
+INLINE_FCT void vLogC_ShmWrite_m(LogC ptagLog,
+                                 const char *pcText,
+                                 size_t szLength)
+{
+  unsigned long long ullHead=ptagLog->ptagShm->ullHead; /* Just changed by this writer */
+  size_t szPos=(size_t)ullHead&(ptagLog->szShmDataSize-1);
+  size_t szFirst=ptagLog->szShmDataSize-szPos;
+
+  if(szFirst>szLength)
+    szFirst=szLength;
+  memcpy(&ptagLog->pcShmData[szPos],pcText,szFirst);
+  memcpy(ptagLog->pcShmData,&pcText[szFirst],szLength-szFirst);
+  LOGC_SHM_STORE_RELEASE(&ptagLog->ptagShm->ullHead,ullHead+szLength);
+}
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+int LogC_SetSocket(LogC log,
+                   const char *path,
+                   int socketType,
+                   int fallback)
+{
+  if((socketType!=LOGC_SOCKET_DGRAM) &&
+     (socketType!=LOGC_SOCKET_STREAM) &&
+     (socketType!=LOGC_SOCKET_SYSLOG))
+    return(-1);
+  if((path) && (strlen(path)>=sizeof(log->caSocketPath)))
+    return(-1);
+  LOGC_MUTEX_LOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+  if((path) && (log->iPerCpuEnabled)) /* Entries in the slots don't reach the socket */
+  {
+    LOGC_MUTEX_UNLOCK(log);
+    return(-1);
+  }
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  /* Send pending entries to the old socket first */
+  iLogC_SocketFlush_m(log);
+  vLogC_SocketFallback_m(log,0,1);
+  if(path)
+  {
+    if(!(log->ptagSocketEntries=malloc(LOGC_SOCKET_BATCHSIZE*(sizeof(TagLogCSocketEntry)+log->szMaxEntryLength+1))))
+    {
+      LOGC_MUTEX_UNLOCK(log);
+      return(-1);
+    }
+    log->pcSocketBuffer=(char*)&log->ptagSocketEntries[LOGC_SOCKET_BATCHSIZE];
+    log->szSocketEntryCount=0;
+    log->szSocketBufferLength=0;
+    strcpy(log->caSocketPath,path);
+    log->iSocketType=socketType;
+    log->iSocketFallback=fallback;
+    log->iSocketPartial=0;
+    log->ullSocketLastConnectNs=0;
+    iLogC_SocketReady_m(log); /* Retried later, if the receiver is not available yet */
+  }
+  LOGC_MUTEX_UNLOCK(log);
+  return(0);
+}
+
+int LogC_SocketFlush(LogC log)
+{
+  int iRc;
+  LOGC_MUTEX_LOCK(log);
+  iRc=iLogC_SocketFlush_m(log);
+  LOGC_MUTEX_UNLOCK(log);
+  return(iRc);
+}
+
+/**
+ * Check if the socket is connected, try to connect if it's not and the last attempt is long enough ago.
+ * The socket is non-blocking, connecting a unix domain socket doesn't wait for the receiver.
+ *
+ * @return 1 if the socket is connected, 0 if not.
+ */
+INLINE_FCT int iLogC_SocketReady_m(LogC ptagLog)
+{
+  struct sockaddr_un tagAddr;
+  unsigned long long ullNowNs;
+  int iFd;
+
+  if(ptagLog->iSocketFd>=0)
+    return(1);
+  ullNowNs=ullLogC_GetTimeNs_m();
+  if((ptagLog->ullSocketLastConnectNs) &&
+     (ullNowNs-ptagLog->ullSocketLastConnectNs<LOGC_SOCKET_RECONNECT_MS*1000000ULL))
+    return(0);
+  ptagLog->ullSocketLastConnectNs=ullNowNs;
+  if((iFd=socket(AF_UNIX,(ptagLog->iSocketType==LOGC_SOCKET_STREAM)?SOCK_STREAM:SOCK_DGRAM,0))<0)
+    return(0);
+  fcntl(iFd,F_SETFL,fcntl(iFd,F_GETFL)|O_NONBLOCK);
+  fcntl(iFd,F_SETFD,FD_CLOEXEC);
+  memset(&tagAddr,0,sizeof(tagAddr));
+  tagAddr.sun_family=AF_UNIX;
+  strcpy(tagAddr.sun_path,ptagLog->caSocketPath);
+  if(connect(iFd,(struct sockaddr*)&tagAddr,sizeof(tagAddr)))
+  {
+    close(iFd);
+    return(0);
+  }
+  ptagLog->iSocketFd=iFd;
+  ptagLog->iSocketPartial=0;
+  return(1);
+}
+
+/**
+ * Add an entry to the batch, there must be space for it.
+ *
+ * @param szLength Length of the text without '\0'.
+ *
+ * @return 1 if the batch is full and must be sent, otherwise 0.
+ */
+INLINE_FCT int iLogC_SocketAdd_m(LogC ptagLog,
+                                 const char *pcText,
+                                 size_t szLength,
+                                 int iLogType)
+{
+  TagLogCSocketEntry *ptagEntry;
+
+  assert(ptagLog->szSocketEntryCount<LOGC_SOCKET_BATCHSIZE);
+  if((ptagLog->iSocketType==LOGC_SOCKET_SYSLOG) && (szLength) && (pcText[szLength-1]=='\n'))
+    --szLength;
+  ptagEntry=&ptagLog->ptagSocketEntries[ptagLog->szSocketEntryCount++];
+  ptagEntry->szOffset=ptagLog->szSocketBufferLength;
+  ptagEntry->szLength=szLength;
+  ptagEntry->iLogType=iLogType;
+  memcpy(&ptagLog->pcSocketBuffer[ptagEntry->szOffset],pcText,szLength);
+  ptagLog->szSocketBufferLength+=szLength;
+  return(ptagLog->szSocketEntryCount>=LOGC_SOCKET_BATCHSIZE);
+}
+
+/**
+ * Send the batch with one syscall: sendmmsg() for datagrams, one message per entry,
+ * and a gathering sendmsg() for streams. Never waits for the receiver.
+ * If the socket is gone, all entries are passed to the fallback and the socket is reconnected later.
+ * If the receiver is too slow and the batch stays full, the unsent entries are passed to the fallback.
+ *
+ * @return 0 on success, -1 if entries were passed to the fallback.
+ */
+INLINE_FCT int iLogC_SocketFlush_m(LogC ptagLog)
+{
+  struct iovec taIov[2*LOGC_SOCKET_BATCHSIZE];
+  struct msghdr tagMsg;
+#ifdef __linux__
+  struct mmsghdr taMsgs[LOGC_SOCKET_BATCHSIZE];
+#endif /* __linux__ */
+  const char *pcPriority;
+  size_t szIndex;
+  size_t szSent=0;
+  ssize_t sszRc;
+
+  if((!ptagLog->ptagSocketEntries) || (!ptagLog->szSocketEntryCount))
+    return(0);
+  if(!iLogC_SocketReady_m(ptagLog))
+  {
+    vLogC_SocketFallback_m(ptagLog,0,0);
+    return(-1);
+  }
+  memset(&tagMsg,0,sizeof(tagMsg));
+  for(szIndex=0;szIndex<ptagLog->szSocketEntryCount;++szIndex)
+  {
+    if(ptagLog->iSocketType==LOGC_SOCKET_SYSLOG) /* Priority in front of each datagram */
+    {
+      pcPriority=pcLogC_SyslogPriority_m(ptagLog->ptagSocketEntries[szIndex].iLogType);
+      taIov[2*szIndex].iov_base=(void*)pcPriority;
+      taIov[2*szIndex].iov_len=strlen(pcPriority);
+      taIov[2*szIndex+1].iov_base=&ptagLog->pcSocketBuffer[ptagLog->ptagSocketEntries[szIndex].szOffset];
+      taIov[2*szIndex+1].iov_len=ptagLog->ptagSocketEntries[szIndex].szLength;
+    }
+    else
+    {
+      taIov[szIndex].iov_base=&ptagLog->pcSocketBuffer[ptagLog->ptagSocketEntries[szIndex].szOffset];
+      taIov[szIndex].iov_len=ptagLog->ptagSocketEntries[szIndex].szLength;
+    }
+  }
+  if(ptagLog->iSocketType==LOGC_SOCKET_STREAM)
+  {
+    tagMsg.msg_iov=taIov;
+    tagMsg.msg_iovlen=ptagLog->szSocketEntryCount;
+    if((sszRc=sendmsg(ptagLog->iSocketFd,&tagMsg,MSG_DONTWAIT|MSG_NOSIGNAL))>0)
+    {
+      /* Remove the complete entries, keep the rest of a partially sent one */
+      while((szSent<ptagLog->szSocketEntryCount) && ((size_t)sszRc>=ptagLog->ptagSocketEntries[szSent].szLength))
+        sszRc-=(ssize_t)ptagLog->ptagSocketEntries[szSent++].szLength;
+      vLogC_SocketRemove_m(ptagLog,szSent);
+      if((ptagLog->iSocketPartial=(sszRc>0)))
+      {
+        ptagLog->ptagSocketEntries[0].szOffset+=(size_t)sszRc;
+        ptagLog->ptagSocketEntries[0].szLength-=(size_t)sszRc;
+      }
+    }
+  }
+  else
+  {
+#ifdef __linux__
+    for(szIndex=0;szIndex<ptagLog->szSocketEntryCount;++szIndex)
+    {
+      taMsgs[szIndex].msg_hdr=tagMsg;
+      if(ptagLog->iSocketType==LOGC_SOCKET_SYSLOG)
+      {
+        taMsgs[szIndex].msg_hdr.msg_iov=&taIov[2*szIndex];
+        taMsgs[szIndex].msg_hdr.msg_iovlen=2;
+      }
+      else
+      {
+        taMsgs[szIndex].msg_hdr.msg_iov=&taIov[szIndex];
+        taMsgs[szIndex].msg_hdr.msg_iovlen=1;
+      }
+    }
+    if((sszRc=sendmmsg(ptagLog->iSocketFd,taMsgs,(unsigned int)ptagLog->szSocketEntryCount,MSG_DONTWAIT|MSG_NOSIGNAL))>0)
+      szSent=(size_t)sszRc;
+#else /* No sendmmsg(), one syscall per entry */
+    for(sszRc=0;szSent<ptagLog->szSocketEntryCount;++szSent)
+    {
+      tagMsg.msg_iov=(ptagLog->iSocketType==LOGC_SOCKET_SYSLOG)?&taIov[2*szSent]:&taIov[szSent];
+      tagMsg.msg_iovlen=(ptagLog->iSocketType==LOGC_SOCKET_SYSLOG)?2:1;
+      if((sszRc=sendmsg(ptagLog->iSocketFd,&tagMsg,MSG_DONTWAIT|MSG_NOSIGNAL))<0)
+        break;
+    }
+    if(szSent)
+      sszRc=(ssize_t)szSent;
+#endif /* __linux__ */
+    vLogC_SocketRemove_m(ptagLog,szSent);
+  }
+  ++ptagLog->tagStats.ullSocketSendCount;
+  if((sszRc<0) && (errno!=EAGAIN) && (errno!=EWOULDBLOCK) && (errno!=EINTR) && (errno!=ENOBUFS))
+  {
+    /* Socket is gone, e.g. the receiver was restarted */
+    close(ptagLog->iSocketFd);
+    ptagLog->iSocketFd=-1;
+    vLogC_SocketFallback_m(ptagLog,0,0);
+    return(-1);
+  }
+  if(ptagLog->szSocketEntryCount>=LOGC_SOCKET_BATCHSIZE)
+  {
+    /* Receiver is too slow, make space for new entries, the rest of a partial entry must be sent first */
+    vLogC_SocketFallback_m(ptagLog,(size_t)ptagLog->iSocketPartial,0);
+    return(-1);
+  }
+  return(0);
+}
+
+/**
+ * Remove the first entries from the batch.
+ */
+INLINE_FCT void vLogC_SocketRemove_m(LogC ptagLog,
+                                     size_t szCount)
+{
+  size_t szIndex;
+  size_t szStart;
+
+  if(szCount>=ptagLog->szSocketEntryCount)
+  {
+    ptagLog->szSocketEntryCount=0;
+    ptagLog->szSocketBufferLength=0;
+    return;
+  }
+  if(!szCount)
+    return;
+  szStart=ptagLog->ptagSocketEntries[szCount].szOffset;
+  ptagLog->szSocketEntryCount-=szCount;
+  ptagLog->szSocketBufferLength-=szStart;
+  memmove(ptagLog->pcSocketBuffer,&ptagLog->pcSocketBuffer[szStart],ptagLog->szSocketBufferLength);
+  memmove(ptagLog->ptagSocketEntries,
+          &ptagLog->ptagSocketEntries[szCount],
+          ptagLog->szSocketEntryCount*sizeof(TagLogCSocketEntry));
+  for(szIndex=0;szIndex<ptagLog->szSocketEntryCount;++szIndex)
+    ptagLog->ptagSocketEntries[szIndex].szOffset-=szStart;
+}
+
+/**
+ * Pass the entries from szFirst on to the logfile and storage, if the fallback is enabled, otherwise drop them.
+ * The entries are removed from the batch before, because adding them to the logfile may release the mutex.
+ *
+ * @param iClose If set, the socket is closed and released too.
+ */
+INLINE_FCT void vLogC_SocketFallback_m(LogC ptagLog,
+                                       size_t szFirst,
+                                       int iClose)
+{
+  TagLogCSocketEntry *ptagEntry;
+  size_t szCount;
+  size_t szIndex;
+  size_t szLength;
+  size_t szCopyLength=0;
+  char *pcCopy=NULL;
+  const char *pcText;
+  int iLogType;
+
+  if(!ptagLog->ptagSocketEntries)
+    return;
+  szCount=(szFirst<ptagLog->szSocketEntryCount)?ptagLog->szSocketEntryCount-szFirst:0;
+  ptagLog->tagStats.ullSocketUnsentCount+=szCount;
+  /* Copy the entries with their logtype as complete lines, syslog entries are stored without '\n' */
+  if((szCount) &&
+     (ptagLog->iSocketFallback) &&
+     (pcCopy=malloc(ptagLog->szSocketBufferLength-ptagLog->ptagSocketEntries[szFirst].szOffset+szCount*(2+sizeof(int)))))
+  {
+    for(szIndex=szFirst;szIndex<ptagLog->szSocketEntryCount;++szIndex)
+    {
+      ptagEntry=&ptagLog->ptagSocketEntries[szIndex];
+      memcpy(&pcCopy[szCopyLength],&ptagEntry->iLogType,sizeof(int));
+      szCopyLength+=sizeof(int);
+      memcpy(&pcCopy[szCopyLength],&ptagLog->pcSocketBuffer[ptagEntry->szOffset],ptagEntry->szLength);
+      szCopyLength+=ptagEntry->szLength;
+      if((!ptagEntry->szLength) || (pcCopy[szCopyLength-1]!='\n'))
+        pcCopy[szCopyLength++]='\n';
+      pcCopy[szCopyLength++]='\0';
+    }
+  }
+  if(szFirst<ptagLog->szSocketEntryCount)
+  {
+    ptagLog->szSocketEntryCount=szFirst;
+    ptagLog->szSocketBufferLength=(szFirst)?ptagLog->ptagSocketEntries[szFirst-1].szOffset+ptagLog->ptagSocketEntries[szFirst-1].szLength:0;
+  }
+  if(iClose)
+  {
+    if(ptagLog->iSocketFd>=0)
+      close(ptagLog->iSocketFd);
+    ptagLog->iSocketFd=-1;
+    free(ptagLog->ptagSocketEntries);
+    ptagLog->ptagSocketEntries=NULL;
+  }
+  for(szIndex=0;szIndex<szCopyLength;szIndex+=sizeof(int)+szLength+1)
+  {
+    memcpy(&iLogType,&pcCopy[szIndex],sizeof(int));
+    pcText=&pcCopy[szIndex+sizeof(int)];
+    szLength=strlen(pcText);
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    if((ptagLog->pcLogFileQueueBuffer) && (iLogC_FileQueueAdd_m(ptagLog,pcText,szLength,iLogType)))
+      ++ptagLog->tagStats.ullDroppedCount;
+    if(ptagLog->ptagFileRoutes)
+      iLogC_FileRoutesAdd_m(ptagLog,pcText,szLength,iLogType,1);
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+    if((ptagLog->szMaxStorageCount) && (iLogC_StorageAdd_m(ptagLog,pcText,szLength,iLogType)))
+      ++ptagLog->tagStats.ullDroppedCount;
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+  }
+  free(pcCopy);
+}
+
+/**
+ * Syslog priority with facility user for the logtype, see RFC 3164.
+ */
+INLINE_FCT const char *pcLogC_SyslogPriority_m(int iLogType)
+{
+  if(iLogType>=LOGC_FATAL)
+    return("<10>"); /* Critical */
+  if(iLogType>=LOGC_ERROR)
+    return("<11>"); /* Error */
+  if(iLogType>=LOGC_WARNING)
+    return("<12>"); /* Warning */
+  if(iLogType>=LOGC_INFO)
+    return("<14>"); /* Informational */
+  return("<15>");   /* Debug */
+}
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+static __thread unsigned long long ullPerCpuLastNs_m; /* Last time used by this thread, see TagLogCPerCpuSlot */
+
+int LogC_SetPerCpuBuffers(LogC log,
+                          size_t entriesPerCpu)
+{
+  int iRc=0;
+
+  if(!(log->uiLogOptions&LOGC_OPTION_THREADSAFE))
+    return(-1);
+  LOGC_MUTEX_LOCK(log);
+  if((!log->pptagPerCpuSlots) && (entriesPerCpu) && (iLogC_PerCpuNew_m(log)))
+    iRc=-1;
+  LOGC_MUTEX_UNLOCK(log);
+  if((iRc) || (!log->pptagPerCpuSlots))
+    return(iRc);
+
+  vLogC_PerCpuLock_m(log,1);
+  LOGC_MUTEX_LOCK(log);
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  if((entriesPerCpu) && (log->ptagShm))
+    iRc=-1;
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  if((entriesPerCpu) && (log->ptagSocketEntries))
+    iRc=-1;
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+  if((!iRc) && (entriesPerCpu!=log->szPerCpuEntries))
+  {
+    /* The next entries are added to the filequeue directly or to new buffers, so the staged ones must be there before */
+    iRc=iLogC_PerCpuMerge_m(log);
+    vLogC_PerCpuUnmap_m(log);
+    if((entriesPerCpu) && (iLogC_PerCpuMap_m(log,entriesPerCpu)))
+    {
+      vLogC_PerCpuUnmap_m(log);
+      iRc=-1;
+    }
+    __atomic_store_n(&log->iPerCpuEnabled,(log->szPerCpuEntries!=0),__ATOMIC_RELEASE);
+  }
+  LOGC_MUTEX_UNLOCK(log);
+  vLogC_PerCpuLock_m(log,0);
+  return(iRc);
+}
+
+/**
+ * Map the header of one slot for each configured CPU, the mutex must be locked.
+ * The slots are disabled until their entries are mapped.
+ */
+INLINE_FCT int iLogC_PerCpuNew_m(LogC ptagLog)
+{
+  TagLogCPerCpuSlot **pptagSlots;
+  TagLogCPerCpuSlot *ptagSlot;
+  long lCpus=sysconf(_SC_NPROCESSORS_CONF);
+  size_t szPageSize=(size_t)sysconf(_SC_PAGESIZE);
+  size_t szSlots;
+  size_t szIndex;
+  void *pvMap;
+
+  szSlots=(lCpus<1)?1:(lCpus>LOGC_PERCPU_MAXSLOTS)?LOGC_PERCPU_MAXSLOTS:(size_t)lCpus;
+  if(!(pptagSlots=calloc(szSlots,sizeof(TagLogCPerCpuSlot*))))
+    return(-1);
+  for(szIndex=0;szIndex<szSlots;++szIndex)
+  {
+    if((pvMap=mmap(NULL,szPageSize,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0))==MAP_FAILED)
+    {
+      while(szIndex--)
+      {
+        pthread_mutex_destroy(&pptagSlots[szIndex]->tMutex);
+        munmap(pptagSlots[szIndex],szPageSize);
+      }
+      free(pptagSlots);
+      return(-1);
+    }
+    ptagSlot=pvMap;
+    pthread_mutex_init(&ptagSlot->tMutex,NULL);
+    ptagSlot->szCount=0;
+    ptagSlot->szMergePos=0;
+    ptagSlot->tagTimeCache.uiOptions=0;
+    ptagSlot->szMapSize=0;
+    pptagSlots[szIndex]=ptagSlot;
+  }
+  ptagLog->szPerCpuSlots=szSlots;
+  ptagLog->szPerCpuEntries=0;
+  __atomic_store_n(&ptagLog->pptagPerCpuSlots,pptagSlots,__ATOMIC_RELEASE);
+  return(0);
+}
+
+/**
+ * Map the entries of all slots, all slots and the Log-Object must be locked.
+ * On failure, the slots mapped before stay mapped, @see vLogC_PerCpuUnmap_m().
+ */
+INLINE_FCT int iLogC_PerCpuMap_m(LogC ptagLog,
+                                 size_t szEntries)
+{
+  TagLogCPerCpuSlot *ptagSlot;
+  size_t szPageSize=(size_t)sysconf(_SC_PAGESIZE);
+  size_t szEntrySize=sizeof(unsigned long long)+sizeof(size_t)+sizeof(int)+ptagLog->szMaxEntryLength+2;
+  size_t szMapSize;
+  size_t szIndex;
+  void *pvMap;
+
+  if(szEntries>(((size_t)-1)-szPageSize)/szEntrySize)
+    return(-1);
+  szMapSize=(szEntries*szEntrySize+szPageSize-1)/szPageSize*szPageSize;
+  for(szIndex=0;szIndex<ptagLog->szPerCpuSlots;++szIndex)
+  {
+    ptagSlot=ptagLog->pptagPerCpuSlots[szIndex];
+    if((pvMap=mmap(NULL,szMapSize,PROT_READ|PROT_WRITE,MAP_PRIVATE|MAP_ANONYMOUS,-1,0))==MAP_FAILED)
+      return(-1);
+    ptagSlot->szMapSize=szMapSize;
+    ptagSlot->pullTimes=pvMap; /* Not touched before the first entry */
+    ptagSlot->pszLengths=(size_t*)&ptagSlot->pullTimes[szEntries];
+    ptagSlot->piLogTypes=(int*)&ptagSlot->pszLengths[szEntries];
+    ptagSlot->pcEntries=(char*)&ptagSlot->piLogTypes[szEntries];
+  }
+  ptagLog->szPerCpuEntries=szEntries;
+  return(0);
+}
+
+/**
+ * Unmap the entries of all slots, which disables them. All slots and the Log-Object must be locked,
+ * except in LogC_End(), the slots must be empty.
+ */
+INLINE_FCT void vLogC_PerCpuUnmap_m(LogC ptagLog)
+{
+  TagLogCPerCpuSlot *ptagSlot;
+  size_t szIndex;
+
+  for(szIndex=0;szIndex<ptagLog->szPerCpuSlots;++szIndex)
+  {
+    ptagSlot=ptagLog->pptagPerCpuSlots[szIndex];
+    if(ptagSlot->szMapSize)
+      munmap(ptagSlot->pullTimes,ptagSlot->szMapSize);
+    ptagSlot->szMapSize=0;
+  }
+  ptagLog->szPerCpuEntries=0;
+}
+
+INLINE_FCT void vLogC_PerCpuFree_m(LogC ptagLog)
+{
+  size_t szPageSize=(size_t)sysconf(_SC_PAGESIZE);
+  size_t szIndex;
+  if(!ptagLog->pptagPerCpuSlots)
+    return;
+  vLogC_PerCpuUnmap_m(ptagLog);
+  for(szIndex=0;szIndex<ptagLog->szPerCpuSlots;++szIndex)
+  {
+    pthread_mutex_destroy(&ptagLog->pptagPerCpuSlots[szIndex]->tMutex);
+    munmap(ptagLog->pptagPerCpuSlots[szIndex],szPageSize);
+  }
+  free(ptagLog->pptagPerCpuSlots);
+  ptagLog->pptagPerCpuSlots=NULL;
+}
+
+/**
+ * Lock or unlock the mutexes of all slots, always in the same order and before the mutex of the Log-Object.
+ */
+INLINE_FCT void vLogC_PerCpuLock_m(LogC ptagLog,
+                                   int iLock)
+{
+  TagLogCPerCpuSlot **pptagSlots=LOGC_PERCPU_SLOTS(ptagLog);
+  size_t szIndex;
+
+  if(!pptagSlots)
+    return;
+  for(szIndex=0;szIndex<ptagLog->szPerCpuSlots;++szIndex)
+  {
+    if(iLock)
+      pthread_mutex_lock(&pptagSlots[szIndex]->tMutex);
+    else
+      pthread_mutex_unlock(&pptagSlots[szIndex]->tMutex);
+  }
+}
+
+/**
+ * Format the entry into the slot of the current CPU, without locking the Log-Object.
+ * If the slot is full, all slots are drained to the logfile first.
+ *
+ * @return 0 on success, 1 if the per-CPU buffers are disabled, negative value on Error.
+ */
+INLINE_FCT int iLogC_PerCpuAdd_m(LogC ptagLog,
+                                 const struct TagLogType *ptagLogType,
+                                 const char *pcFileName,
+                                 int iLineNr,
+                                 const char *pcFunction,
+                                 TagLogCMessage *ptagMessage)
+{
+  TagLogCPerCpuSlot *ptagSlot;
+  char *pcEntry;
+  size_t szLength;
+  unsigned long long ullTimeNs;
+  int iCpu;
+
+  for(;;)
+  {
+    iCpu=sched_getcpu();
+    ptagSlot=ptagLog->pptagPerCpuSlots[(iCpu<0)?0:(size_t)iCpu%ptagLog->szPerCpuSlots];
+    pthread_mutex_lock(&ptagSlot->tMutex);
+    if(!ptagLog->iPerCpuEnabled)
+    {
+      pthread_mutex_unlock(&ptagSlot->tMutex);
+      return(1);
+    }
+    if(ptagSlot->szCount<ptagLog->szPerCpuEntries)
+      break;
+    pthread_mutex_unlock(&ptagSlot->tMutex);
+    if(iLogC_PerCpuDrain_m(ptagLog))
+      return(-1);
+  }
+  pcEntry=&ptagSlot->pcEntries[ptagSlot->szCount*(ptagLog->szMaxEntryLength+2)];
+  if(iLogC_FormatEntry_m(ptagLog,pcEntry,&ptagSlot->tagTimeCache,ptagLogType,pcFileName,iLineNr,pcFunction,ptagMessage,&szLength))
+  {
+    pthread_mutex_unlock(&ptagSlot->tMutex);
+    return(-1);
+  }
+  if((ullTimeNs=ullLogC_GetTimeNs_m())<=ullPerCpuLastNs_m)
+    ullTimeNs=ullPerCpuLastNs_m+1;
+  ullPerCpuLastNs_m=ullTimeNs;
+  ptagSlot->pullTimes[ptagSlot->szCount]=ullTimeNs;
+  ptagSlot->pszLengths[ptagSlot->szCount]=szLength;
+  ptagSlot->piLogTypes[ptagSlot->szCount]=ptagLogType->iLogType;
+  ++ptagSlot->szCount;
+  vLogC_PrintEntry_m(ptagLog,pcEntry,ptagLogType);
+  pthread_mutex_unlock(&ptagSlot->tMutex);
+  return(0);
+}
+
+INLINE_FCT int iLogC_PerCpuDrain_m(LogC ptagLog)
+{
+  int iRc;
+  vLogC_PerCpuLock_m(ptagLog,1);
+  LOGC_MUTEX_LOCK(ptagLog);
+  iRc=iLogC_PerCpuMerge_m(ptagLog);
+  LOGC_MUTEX_UNLOCK(ptagLog);
+  vLogC_PerCpuLock_m(ptagLog,0);
+  return(iRc);
+}
+
+/**
+ * Move the entries of all slots to the filequeue and storage, oldest first.
+ * All slots and the Log-Object must be locked. Entries which can't be added are dropped.
+ */
+INLINE_FCT int iLogC_PerCpuMerge_m(LogC ptagLog)
+{
+  TagLogCPerCpuSlot *ptagaSlots[LOGC_PERCPU_MAXSLOTS]; /* Slots with entries left */
+  TagLogCPerCpuSlot *ptagSlot;
+  size_t szSlots=0;
+  size_t szIndex;
+  size_t szNext;
+  size_t szPos;
+  int iRc=0;
+
+  for(szIndex=0;szIndex<ptagLog->szPerCpuSlots;++szIndex)
+  {
+    if(ptagLog->pptagPerCpuSlots[szIndex]->szCount)
+      ptagaSlots[szSlots++]=ptagLog->pptagPerCpuSlots[szIndex];
+  }
+  while(szSlots)
+  {
+    szNext=0;
+    for(szIndex=1;szIndex<szSlots;++szIndex)
+    {
+      if(ptagaSlots[szIndex]->pullTimes[ptagaSlots[szIndex]->szMergePos]<ptagaSlots[szNext]->pullTimes[ptagaSlots[szNext]->szMergePos])
+        szNext=szIndex;
+    }
+    ptagSlot=ptagaSlots[szNext];
+    szPos=ptagSlot->szMergePos;
+    if(++ptagSlot->szMergePos==ptagSlot->szCount)
+    {
+      ptagSlot->szCount=0;
+      ptagSlot->szMergePos=0;
+      ptagaSlots[szNext]=ptagaSlots[--szSlots];
+    }
+    if(iRc)
+    {
+      ++ptagLog->tagStats.ullDroppedCount;
+      continue;
+    }
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    if((ptagLog->pcLogFileQueueBuffer) &&
+       (iLogC_FileQueueAdd_m(ptagLog,
+                             &ptagSlot->pcEntries[szPos*(ptagLog->szMaxEntryLength+2)],
+                             ptagSlot->pszLengths[szPos],
+                             ptagSlot->piLogTypes[szPos])))
+      iRc=-1;
+    if((!iRc) && (ptagLog->ptagFileRoutes)) /* Entries dropped for a route are counted there */
+      iLogC_FileRoutesAdd_m(ptagLog,
+                            &ptagSlot->pcEntries[szPos*(ptagLog->szMaxEntryLength+2)],
+                            ptagSlot->pszLengths[szPos],
+                            ptagSlot->piLogTypes[szPos],
+                            1);
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+    if((!iRc) &&
+       (ptagLog->szMaxStorageCount) &&
+       (iLogC_StorageAdd_m(ptagLog,
+                           &ptagSlot->pcEntries[szPos*(ptagLog->szMaxEntryLength+2)],
+                           ptagSlot->pszLengths[szPos],
+                           ptagSlot->piLogTypes[szPos])))
+      iRc=-1;
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+    (void)szPos; /* Not needed without logfile and storage */
+    if(iRc)
+      ++ptagLog->tagStats.ullDroppedCount;
+    else
+      ++ptagLog->tagStats.ullEntryCount;
+  }
+  return(iRc);
+}
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+/**
+ * Called for each exiting thread which has a ring, the recorded entries are dropped.
+ */
+static void vLogC_RecorderThreadExit_m(void *pvRing)
+{
+  TagLogCRecorderRing *ptagRing=pvRing;
+  TagLogCRecorderRing **pptagRing;
+  LogC ptagLog=ptagRing->ptagLog;
+
+  LOGC_MUTEX_LOCK(ptagLog);
+  for(pptagRing=&ptagLog->ptagRecorder->ptagRings;*pptagRing!=ptagRing;pptagRing=&(*pptagRing)->ptagNext)
+    ;
+  *pptagRing=ptagRing->ptagNext;
+  LOGC_MUTEX_UNLOCK(ptagLog);
+  free(ptagRing);
+}
+
+#ifdef _WIN32
+static VOID NTAPI vLogC_RecorderFlsCallback_m(PVOID pvRing)
+{
+  vLogC_RecorderThreadExit_m(pvRing);
+}
+#endif /* _WIN32 */
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+
+int LogC_SetFlightRecorder(LogC log,
+                           int minLogType,
+                           int triggerLogType,
+                           size_t entriesPerThread)
+{
+  TagLogCRecorder *ptagRecorder;
+
+  if((log->ptagRecorder) || (!entriesPerThread))
+    return(-1);
+  if(!(ptagRecorder=malloc(sizeof(TagLogCRecorder))))
+    return(-1);
+  ptagRecorder->iMinLogType=minLogType;
+  ptagRecorder->iTriggerLogType=triggerLogType;
+  ptagRecorder->szEntries=entriesPerThread;
+  ptagRecorder->szArgsSize=log->szMaxEntryLength+1; /* Also fits the text, if it's formatted immediately */
+  ptagRecorder->szSlotSize=(sizeof(TagLogCRecord)+ptagRecorder->szArgsSize+sizeof(unsigned long long)-1)&
+                           ~(sizeof(unsigned long long)-1);
+  ptagRecorder->ptagRings=NULL;
+  /* Check for Overflow of size_t */
+  if(entriesPerThread>(((size_t)-1)-sizeof(TagLogCRecorderRing)-log->szMaxEntryLength-2)/ptagRecorder->szSlotSize)
+  {
+    free(ptagRecorder);
+    return(-1);
+  }
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+  if(log->uiLogOptions&LOGC_OPTION_THREADSAFE)
+  {
+  #ifdef _WIN32
+    if((ptagRecorder->dwFlsIndex=FlsAlloc(vLogC_RecorderFlsCallback_m))==FLS_OUT_OF_INDEXES)
+  #else
+    if(pthread_key_create(&ptagRecorder->tKey,vLogC_RecorderThreadExit_m))
+  #endif /* _WIN32 */
+    {
+      free(ptagRecorder);
+      return(-1);
+    }
+    log->ptagRecorder=ptagRecorder;
+    return(0);
+  }
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+  if(!(ptagRecorder->ptagRings=ptagLogC_RecorderRingNew_m(log,ptagRecorder)))
+  {
+    free(ptagRecorder);
+    return(-1);
+  }
+  log->ptagRecorder=ptagRecorder;
+  return(0);
+}
+
+INLINE_FCT TagLogCRecorderRing *ptagLogC_RecorderRingNew_m(LogC ptagLog,
+                                                          TagLogCRecorder *ptagRecorder)
+{
+  TagLogCRecorderRing *ptagRing;
+
+  if(!(ptagRing=malloc(sizeof(TagLogCRecorderRing)+
+                       ptagRecorder->szEntries*ptagRecorder->szSlotSize+
+                       ptagLog->szMaxEntryLength+2)))
+    return(NULL);
+  ptagRing->ptagNext=NULL;
+  ptagRing->ptagLog=ptagLog;
+  ptagRing->szNext=0;
+  ptagRing->szCount=0;
+  ptagRing->pucSlots=(unsigned char*)(ptagRing+1);
+  ptagRing->pcText=(char*)&ptagRing->pucSlots[ptagRecorder->szEntries*ptagRecorder->szSlotSize];
+  return(ptagRing);
+}
+
+/**
+ * Get the ring of the calling thread, if iCreate is set, it's created if the thread has none yet.
+ */
+INLINE_FCT TagLogCRecorderRing *ptagLogC_RecorderRing_m(LogC ptagLog,
+                                                       int iCreate)
+{
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+  TagLogCRecorder *ptagRecorder=ptagLog->ptagRecorder;
+  TagLogCRecorderRing *ptagRing;
+
+  if(ptagLog->uiLogOptions&LOGC_OPTION_THREADSAFE)
+  {
+    if((ptagRing=LOGC_RECORDER_GET(ptagRecorder)) || (!iCreate))
+      return(ptagRing);
+    if(!(ptagRing=ptagLogC_RecorderRingNew_m(ptagLog,ptagRecorder)))
+      return(NULL);
+    if(LOGC_RECORDER_SET(ptagRecorder,ptagRing))
+    {
+      free(ptagRing);
+      return(NULL);
+    }
+    LOGC_MUTEX_LOCK(ptagLog);
+    ptagRing->ptagNext=ptagRecorder->ptagRings;
+    ptagRecorder->ptagRings=ptagRing;
+    LOGC_MUTEX_UNLOCK(ptagLog);
+    return(ptagRing);
+  }
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+  (void)iCreate;
+  return(ptagLog->ptagRecorder->ptagRings);
+}
+
+/**
+ * Record an entry in the ring of the calling thread, overwriting the oldest one if it's full.
+ * Either pcFormat with its arguments or the formatted pcText is passed.
+ */
+INLINE_FCT int iLogC_RecorderAdd_m(LogC ptagLog,
+                                   int iLogType,
+                                   const char *pcFileName,
+                                   int iLineNr,
+                                   const char *pcFunction,
+                                   const char *pcFormat,
+                                   va_list *pvaArgs,
+                                   const char *pcText,
+                                   size_t szTextLength)
+{
+  TagLogCRecorder *ptagRecorder=ptagLog->ptagRecorder;
+  TagLogCRecorderRing *ptagRing;
+  TagLogCRecord *ptagRecord;
+  unsigned char *pucArgs;
+  va_list vaArgs;
+  int iRc;
+
+  if(!(ptagRing=ptagLogC_RecorderRing_m(ptagLog,1)))
+    return(-1);
+  ptagRecord=(TagLogCRecord*)&ptagRing->pucSlots[ptagRing->szNext*ptagRecorder->szSlotSize];
+  pucArgs=(unsigned char*)(ptagRecord+1);
+  ptagRecord->pcFormat=pcFormat;
+  ptagRecord->pcFileName=pcFileName;
+  ptagRecord->pcFunction=pcFunction;
+  ptagRecord->ullTimeNs=ullLogC_GetEntryTimeNs_m(ptagLog);
+  ptagRecord->iLogType=iLogType;
+  ptagRecord->iLineNr=iLineNr;
+  if(pcFormat)
+  {
+    va_copy(vaArgs,*pvaArgs);
+    iRc=iLogC_RecorderPack_m(pcFormat,&vaArgs,pucArgs,ptagRecorder->szArgsSize,&ptagRecord->szArgsLength);
+    va_end(vaArgs);
+    if(iRc)
+    {
+      /* Can't be packed, so it's formatted now */
+      ptagRecord->pcFormat=NULL;
+      errno=0;
+      iRc=iLogC_vsnprintf((char*)pucArgs,ptagRecorder->szArgsSize,pcFormat,*pvaArgs);
+      if(errno==EINVAL)
+        return(-1);
+      ptagRecord->szArgsLength=(iRc<0)?ptagRecorder->szArgsSize-1:(size_t)iRc; /* Truncated, like it would be in the entry */
+    }
+  }
+  else
+  {
+    ptagRecord->szArgsLength=(szTextLength<ptagRecorder->szArgsSize)?szTextLength:ptagRecorder->szArgsSize-1;
+    memcpy(pucArgs,pcText,ptagRecord->szArgsLength);
+  }
+  ptagRing->szNext=(ptagRing->szNext+1)%ptagRecorder->szEntries;
+  if(ptagRing->szCount<ptagRecorder->szEntries)
+    ++ptagRing->szCount;
+  return(0);
+}
+
+/**
+ * Parse the conversion at pcFormat ('%'), returns the character behind it
+ * or NULL if it can't be packed.
+ */
+INLINE_FCT const char *pcLogC_RecorderSpec_m(const char *pcFormat,
+                                             TagLogCRecorderSpec *ptagSpec)
+{
+  const char *pcSpec=pcFormat+1;
+
+  while((*pcSpec) && (strchr("-+ #0",*pcSpec)))
+    ++pcSpec;
+  if(*pcSpec=='*')
+    ++pcSpec;
+  else
+    while((*pcSpec>='0') && (*pcSpec<='9'))
+      ++pcSpec;
+  ptagSpec->iPrecision=-1;
+  if(*pcSpec=='.')
+  {
+    if(*(++pcSpec)=='*')
+      ++pcSpec;
+    else
+      for(ptagSpec->iPrecision=0;(*pcSpec>='0') && (*pcSpec<='9');++pcSpec)
+        ptagSpec->iPrecision=ptagSpec->iPrecision*10+(*pcSpec-'0'); /* Can't overflow, the spec is short */
+  }
+  if(pcSpec-pcFormat>LOGC_RECORDER_SPEC_MAXLEN)
+    return(NULL);
+  ptagSpec->pcLength=pcSpec;
+  ptagSpec->iLength=LOGC_RECORDER_LENGTH_NONE;
+  switch(*pcSpec)
+  {
+    case 'h':
+      ptagSpec->iLength=(pcSpec[1]=='h')?LOGC_RECORDER_LENGTH_HH:LOGC_RECORDER_LENGTH_H;
+      break;
+    case 'l':
+      ptagSpec->iLength=(pcSpec[1]=='l')?LOGC_RECORDER_LENGTH_LL:LOGC_RECORDER_LENGTH_L;
+      break;
+    case 'z':
+      ptagSpec->iLength=LOGC_RECORDER_LENGTH_Z;
+      break;
+    case 't':
+      ptagSpec->iLength=LOGC_RECORDER_LENGTH_T;
+      break;
+    case 'L':
+      ptagSpec->iLength=LOGC_RECORDER_LENGTH_LD;
+      break;
+    default:
+      break;
+  }
+  if((ptagSpec->iLength==LOGC_RECORDER_LENGTH_HH) || (ptagSpec->iLength==LOGC_RECORDER_LENGTH_LL))
+    pcSpec+=2;
+  else if(ptagSpec->iLength!=LOGC_RECORDER_LENGTH_NONE)
+    ++pcSpec;
+  if(!(ptagSpec->cConversion=*pcSpec))
+    return(NULL);
+  return(pcSpec+1);
+}
+
+/**
+ * Copy the arguments of pcFormat to pucArgs, returns -1 if there's a conversion which
+ * can't be packed or the arguments don't fit, the format must be formatted immediately then.
+ */
+INLINE_FCT int iLogC_RecorderPack_m(const char *pcFormat,
+                                    va_list *pvaArgs,
+                                    unsigned char *pucArgs,
+                                    size_t szArgsSize,
+                                    size_t *pszLength)
+{
+  TagLogCRecorderSpec tagSpec;
+  const char *pcSpec;
+  size_t szPos=0;
+  size_t szLength;
+  long long llValue;
+  unsigned long long ullValue;
+  int iValue;
+  double dValue;
+  long double ldValue;
+  const void *pvValue;
+  const char *pcValue;
+
+  for(;*pcFormat;)
+  {
+    if(*pcFormat!='%')
+    {
+      ++pcFormat;
+      continue;
+    }
+    if(pcFormat[1]=='%')
+    {
+      pcFormat+=2;
+      continue;
+    }
+    if(!(pcSpec=pcLogC_RecorderSpec_m(pcFormat,&tagSpec)))
+      return(-1);
+    /* '*' for width and precision */
+    for(;pcFormat<tagSpec.pcLength;++pcFormat)
+    {
+      if(*pcFormat!='*')
+        continue;
+      iValue=va_arg(*pvaArgs,int);
+      if(iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,&iValue,sizeof(int)))
+        return(-1);
+      if(pcFormat[-1]=='.')
+        tagSpec.iPrecision=(iValue<0)?-1:iValue; /* A negative precision is ignored */
+    }
+    switch(tagSpec.cConversion)
+    {
+      case 'd':
+      case 'i':
+        switch(tagSpec.iLength)
+        {
+          case LOGC_RECORDER_LENGTH_NONE: llValue=va_arg(*pvaArgs,int);                       break;
+          case LOGC_RECORDER_LENGTH_HH:   llValue=(signed char)va_arg(*pvaArgs,int);          break;
+          case LOGC_RECORDER_LENGTH_H:    llValue=(short)va_arg(*pvaArgs,int);                break;
+          case LOGC_RECORDER_LENGTH_L:    llValue=va_arg(*pvaArgs,long);                      break;
+          case LOGC_RECORDER_LENGTH_LL:   llValue=va_arg(*pvaArgs,long long);                 break;
+          case LOGC_RECORDER_LENGTH_Z:    llValue=(long long)(ptrdiff_t)va_arg(*pvaArgs,size_t); break;
+          case LOGC_RECORDER_LENGTH_T:    llValue=va_arg(*pvaArgs,ptrdiff_t);                 break;
+          default:                        return(-1);
+        }
+        if(iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,&llValue,sizeof(long long)))
+          return(-1);
+        break;
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+        switch(tagSpec.iLength)
+        {
+          case LOGC_RECORDER_LENGTH_NONE: ullValue=va_arg(*pvaArgs,unsigned int);               break;
+          case LOGC_RECORDER_LENGTH_HH:   ullValue=(unsigned char)va_arg(*pvaArgs,unsigned int);  break;
+          case LOGC_RECORDER_LENGTH_H:    ullValue=(unsigned short)va_arg(*pvaArgs,unsigned int); break;
+          case LOGC_RECORDER_LENGTH_L:    ullValue=va_arg(*pvaArgs,unsigned long);              break;
+          case LOGC_RECORDER_LENGTH_LL:   ullValue=va_arg(*pvaArgs,unsigned long long);         break;
+          case LOGC_RECORDER_LENGTH_Z:    ullValue=va_arg(*pvaArgs,size_t);                     break;
+          case LOGC_RECORDER_LENGTH_T:    ullValue=(size_t)va_arg(*pvaArgs,ptrdiff_t);          break;
+          default:                        return(-1);
+        }
+        if(iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,&ullValue,sizeof(unsigned long long)))
+          return(-1);
+        break;
+      case 'c':
+        if(tagSpec.iLength!=LOGC_RECORDER_LENGTH_NONE)
+          return(-1);
+        iValue=va_arg(*pvaArgs,int);
+        if(iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,&iValue,sizeof(int)))
+          return(-1);
+        break;
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        if(tagSpec.iLength==LOGC_RECORDER_LENGTH_LD)
+        {
+          ldValue=va_arg(*pvaArgs,long double);
+          if(iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,&ldValue,sizeof(long double)))
+            return(-1);
+        }
+        else if((tagSpec.iLength==LOGC_RECORDER_LENGTH_NONE) || (tagSpec.iLength==LOGC_RECORDER_LENGTH_L))
+        {
+          dValue=va_arg(*pvaArgs,double);
+          if(iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,&dValue,sizeof(double)))
+            return(-1);
+        }
+        else
+          return(-1);
+        break;
+      case 's':
+        if(tagSpec.iLength!=LOGC_RECORDER_LENGTH_NONE)
+          return(-1);
+        /* Copied, the string may be gone when the entry is formatted.
+           Like printf(), not more than the precision is read, the string doesn't need a '\0' then. */
+        if(!(pcValue=va_arg(*pvaArgs,const char*)))
+          pcValue="(null)";
+        if(tagSpec.iPrecision<0)
+          szLength=strlen(pcValue);
+        else
+          for(szLength=0;(szLength<(size_t)tagSpec.iPrecision) && (pcValue[szLength]);++szLength)
+            ;
+        if((iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,pcValue,szLength)) ||
+           (iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,"",1)))
+          return(-1);
+        break;
+      case 'p':
+        if(tagSpec.iLength!=LOGC_RECORDER_LENGTH_NONE)
+          return(-1);
+        pvValue=va_arg(*pvaArgs,const void*);
+        if(iLogC_RecorderPut_m(pucArgs,szArgsSize,&szPos,&pvValue,sizeof(const void*)))
+          return(-1);
+        break;
+      default: /* e.g. %n */
+        return(-1);
+    }
+    pcFormat=pcSpec;
+  }
+  *pszLength=szPos;
+  return(0);
+}
+
+INLINE_FCT int iLogC_RecorderPut_m(unsigned char *pucArgs,
+                                   size_t szArgsSize,
+                                   size_t *pszPos,
+                                   const void *pvValue,
+                                   size_t szSize)
+{
+  if(szSize>szArgsSize-*pszPos)
+    return(-1);
+  memcpy(&pucArgs[*pszPos],pvValue,szSize);
+  *pszPos+=szSize;
+  return(0);
+}
+
+/**
+ * Format a packed record into pcText, one conversion at a time. If the text doesn't fit,
+ * it's truncated to szTextSize-1, which is longer than an entry, so it's truncated like a formatted entry.
+ * Returns the length of the text.
+ */
+INLINE_FCT size_t szLogC_RecorderFormat_m(const TagLogCRecord *ptagRecord,
+                                          char *pcText,
+                                          size_t szTextSize)
+{
+  const unsigned char *pucArgs=(const unsigned char*)(ptagRecord+1);
+  const char *pcFormat=ptagRecord->pcFormat;
+  TagLogCRecorderSpec tagSpec;
+  const char *pcSpec;
+  char caSpec[LOGC_RECORDER_SPEC_MAXLEN+24];
+  size_t szSpecPos;
+  size_t szArgPos=0;
+  size_t szPos=0;
+  long long llValue;
+  unsigned long long ullValue;
+  int iValue;
+  double dValue;
+  long double ldValue;
+  const void *pvValue;
+  int iRc;
+
+  while(*pcFormat)
+  {
+    if(szPos+1>=szTextSize)
+      break;
+    if((*pcFormat!='%') || (pcFormat[1]=='%'))
+    {
+      pcText[szPos++]=*pcFormat;
+      pcFormat+=(*pcFormat=='%')?2:1;
+      continue;
+    }
+    pcSpec=pcLogC_RecorderSpec_m(pcFormat,&tagSpec); /* Parsed when packed already */
+    /* Flags, width and precision, each '*' is replaced by its value */
+    for(szSpecPos=0;pcFormat<tagSpec.pcLength;++pcFormat)
+    {
+      if(*pcFormat!='*')
+      {
+        caSpec[szSpecPos++]=*pcFormat;
+        continue;
+      }
+      memcpy(&iValue,&pucArgs[szArgPos],sizeof(int));
+      szArgPos+=sizeof(int);
+      if((iValue<0) && (caSpec[szSpecPos-1]=='.')) /* A negative precision is ignored */
+        --szSpecPos;
+      else
+        szSpecPos+=(size_t)sprintf(&caSpec[szSpecPos],"%d",iValue); /* A negative width is the '-' flag */
+    }
+    switch(tagSpec.cConversion)
+    {
+      case 'd':
+      case 'i':
+        memcpy(&llValue,&pucArgs[szArgPos],sizeof(long long));
+        szArgPos+=sizeof(long long);
+        sprintf(&caSpec[szSpecPos],"ll%c",tagSpec.cConversion);
+        iRc=iLogC_snprintf(&pcText[szPos],szTextSize-szPos,caSpec,llValue);
+        break;
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+        memcpy(&ullValue,&pucArgs[szArgPos],sizeof(unsigned long long));
+        szArgPos+=sizeof(unsigned long long);
+        sprintf(&caSpec[szSpecPos],"ll%c",tagSpec.cConversion);
+        iRc=iLogC_snprintf(&pcText[szPos],szTextSize-szPos,caSpec,ullValue);
+        break;
+      case 'c':
+        memcpy(&iValue,&pucArgs[szArgPos],sizeof(int));
+        szArgPos+=sizeof(int);
+        sprintf(&caSpec[szSpecPos],"c");
+        iRc=iLogC_snprintf(&pcText[szPos],szTextSize-szPos,caSpec,iValue);
+        break;
+      case 's':
+        sprintf(&caSpec[szSpecPos],"s");
+        iRc=iLogC_snprintf(&pcText[szPos],szTextSize-szPos,caSpec,(const char*)&pucArgs[szArgPos]);
+        szArgPos+=strlen((const char*)&pucArgs[szArgPos])+1;
+        break;
+      case 'p':
+        memcpy(&pvValue,&pucArgs[szArgPos],sizeof(const void*));
+        szArgPos+=sizeof(const void*);
+        sprintf(&caSpec[szSpecPos],"p");
+        iRc=iLogC_snprintf(&pcText[szPos],szTextSize-szPos,caSpec,pvValue);
+        break;
+      default: /* Floating point */
+        if(tagSpec.iLength==LOGC_RECORDER_LENGTH_LD)
+        {
+          memcpy(&ldValue,&pucArgs[szArgPos],sizeof(long double));
+          szArgPos+=sizeof(long double);
+          sprintf(&caSpec[szSpecPos],"L%c",tagSpec.cConversion);
+          iRc=iLogC_snprintf(&pcText[szPos],szTextSize-szPos,caSpec,ldValue);
+        }
+        else
+        {
+          memcpy(&dValue,&pucArgs[szArgPos],sizeof(double));
+          szArgPos+=sizeof(double);
+          sprintf(&caSpec[szSpecPos],"%c",tagSpec.cConversion);
+          iRc=iLogC_snprintf(&pcText[szPos],szTextSize-szPos,caSpec,dValue);
+        }
+        break;
+    }
+    if(iRc<0)
+    {
+      szPos=szTextSize-1;
+      break;
+    }
+    szPos+=(size_t)iRc;
+    pcFormat=pcSpec;
+  }
+  pcText[szPos]='\0';
+  return(szPos);
+}
+
+/**
+ * Add the recorded entries of the calling thread, oldest first, to the batch and empty its ring.
+ * Without a batch, they are added to the outputs one by one.
+ */
+INLINE_FCT int iLogC_RecorderDump_m(LogC ptagLog,
+                                    LogCBatch ptagBatch)
+{
+  TagLogCRecorder *ptagRecorder=ptagLog->ptagRecorder;
+  TagLogCRecorderRing *ptagRing;
+  TagLogCRecord *ptagRecord;
+  TagLogCMessage tagMessage;
+  const struct TagLogType *ptagLogType;
+  size_t szSlot;
+  int iRc=0;
+
+  if((!(ptagRing=ptagLogC_RecorderRing_m(ptagLog,0))) || (!ptagRing->szCount))
+    return(0);
+  tagMessage.pcFormat=NULL;
+  tagMessage.pucData=NULL;
+  szSlot=(ptagRing->szNext+ptagRecorder->szEntries-ptagRing->szCount)%ptagRecorder->szEntries;
+  for(;ptagRing->szCount;--ptagRing->szCount)
+  {
+    ptagRecord=(TagLogCRecord*)&ptagRing->pucSlots[szSlot*ptagRecorder->szSlotSize];
+    if(ptagRecord->pcFormat)
+    {
+      tagMessage.pcText=ptagRing->pcText;
+      tagMessage.szTextLength=szLogC_RecorderFormat_m(ptagRecord,ptagRing->pcText,ptagLog->szMaxEntryLength+2);
+    }
+    else
+    {
+      tagMessage.pcText=(const char*)(ptagRecord+1);
+      tagMessage.szTextLength=ptagRecord->szArgsLength;
+    }
+    tagMessage.ullTimeNs=ptagRecord->ullTimeNs;
+    if(ptagBatch)
+    {
+      if((!(ptagLogType=ptagLogC_GetLogType_m(ptagRecord->iLogType))) ||
+         (iLogC_BatchAddMessage_m(ptagBatch,ptagLogType,ptagRecord->pcFileName,ptagRecord->iLineNr,ptagRecord->pcFunction,&tagMessage)))
+        iRc=-1;
+    }
+    else if(iLogC_AddEntry_m(ptagLog,ptagRecord->iLogType,ptagRecord->pcFileName,ptagRecord->iLineNr,ptagRecord->pcFunction,&tagMessage))
+      iRc=-1;
+    szSlot=(szSlot+1)%ptagRecorder->szEntries;
+  }
+  return(iRc);
+}
+
+/**
+ * Add the recorded entries of the calling thread and the entry which triggered them as one batch,
+ * so no entries of other threads get in between. A hexdump may take more than one entry.
+ * Without memory for the batch, the entries are added one by one.
+ */
+INLINE_FCT int iLogC_RecorderTrigger_m(LogC ptagLog,
+                                       int iLogType,
+                                       const char *pcFileName,
+                                       int iLineNr,
+                                       const char *pcFunction,
+                                       TagLogCMessage *ptagMessage)
+{
+  TagLogCRecorderRing *ptagRing;
+  const struct TagLogType *ptagLogType;
+  LogCBatch ptagBatch=NULL;
+  int iRc=0;
+  int iRcAdd;
+
+  if(!(ptagLogType=ptagLogC_GetLogType_m(iLogType)))
+    return(-1);
+  if((ptagRing=ptagLogC_RecorderRing_m(ptagLog,0)) && (ptagRing->szCount))
+  {
+    ptagBatch=LogC_BatchBegin(ptagLog,ptagRing->szCount+1);
+    iRc=iLogC_RecorderDump_m(ptagLog,ptagBatch);
+  }
+  do
+  {
+    if(ptagBatch)
+      iRcAdd=iLogC_BatchAddMessage_m(ptagBatch,ptagLogType,pcFileName,iLineNr,pcFunction,ptagMessage);
+    else
+      iRcAdd=iLogC_AddEntry_m(ptagLog,iLogType,pcFileName,iLineNr,pcFunction,ptagMessage);
+    if((iRcAdd) || (!ptagMessage->pucData))
+      break;
+    ptagMessage->pucData+=ptagMessage->szDataAdded;
+    ptagMessage->szDataLength-=ptagMessage->szDataAdded;
+    ptagMessage->szDataOffset+=ptagMessage->szDataAdded;
+  }while(ptagMessage->szDataLength);
+  if(iRcAdd)
+    iRc=-1;
+  if((ptagBatch) && (LogC_BatchCommit(ptagBatch)))
+    iRc=-1;
+  return(iRc);
+}
+
+/**
+ * Release the flight recorder with all rings, the mutex must be locked.
+ */
+INLINE_FCT void vLogC_RecorderFree_m(LogC ptagLog)
+{
+  TagLogCRecorder *ptagRecorder=ptagLog->ptagRecorder;
+  TagLogCRecorderRing *ptagRing;
+
+  if(!ptagRecorder)
+    return;
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+  if(ptagLog->uiLogOptions&LOGC_OPTION_THREADSAFE)
+  {
+  #ifdef _WIN32
+    FlsFree(ptagRecorder->dwFlsIndex); /* Calls the callback for the ring of each thread, the mutex is recursive here */
+  #else
+    pthread_key_delete(ptagRecorder->tKey); /* The rings of running threads are released here, not on their exit */
+  #endif /* _WIN32 */
+  }
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+  while((ptagRing=ptagRecorder->ptagRings))
+  {
+    ptagRecorder->ptagRings=ptagRing->ptagNext;
+    free(ptagRing);
+  }
+  free(ptagRecorder);
+  ptagLog->ptagRecorder=NULL;
+}
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+
+#ifdef LOGC_FEATURE_ENABLE_CONTEXT
+int LogC_ContextPush(const char *key,
+                     const char *value)
+{
+  TagLogCContext *ptagContext=&tagContext_m;
+  size_t szPos=ptagContext->szLength;
+  int iRc;
+
+  if((!key) || (!*key) || (!value) || (ptagContext->szDepth>=LOGC_CONTEXT_MAXDEPTH))
+    return(-1);
+  iRc=iLogC_snprintf(&ptagContext->caText[szPos],
+                     sizeof(ptagContext->caText)-szPos,
+                     (szPos)?" %s=%s":"%s=%s",
+                     key,
+                     value);
+  if((iRc<0) || ((size_t)iRc>=sizeof(ptagContext->caText)-szPos))
+  {
+    ptagContext->caText[szPos]='\0';
+    return(-1);
+  }
+  ptagContext->szaStart[ptagContext->szDepth++]=szPos;
+  ptagContext->szLength=szPos+(size_t)iRc;
+  return(0);
+}
+
+int LogC_ContextPop(void)
+{
+  TagLogCContext *ptagContext=&tagContext_m;
+
+  if(!ptagContext->szDepth)
+    return(-1);
+  ptagContext->szLength=ptagContext->szaStart[--ptagContext->szDepth];
+  ptagContext->caText[ptagContext->szLength]='\0';
+  return(0);
+}
+
+void LogC_ContextClear(void)
+{
+  tagContext_m.szDepth=0;
+  tagContext_m.szLength=0;
+  tagContext_m.caText[0]='\0';
+}
+
+#ifndef _WIN32
+/**
+ * The child of fork() runs in a new thread, so the id cached by the forking thread is rendered again.
+ */
+static void vLogC_ContextForkChild_m(void)
+{
+  tagContext_m.szThreadIdLength=0;
+}
+
+static void vLogC_ContextAtFork_m(void)
+{
+  pthread_atfork(NULL,NULL,vLogC_ContextForkChild_m);
+}
+#endif /* _WIN32 */
+
+/**
+ * Render the id of the calling thread for LOGC_OPTION_PREFIX_THREADID, once per thread.
+ */
+INLINE_FCT void vLogC_ContextThreadId_m(TagLogCContext *ptagContext)
+{
+  unsigned long long ullThreadId;
+#ifdef _WIN32
+  ullThreadId=(unsigned long long)GetCurrentThreadId();
+#else
+  static pthread_once_t tOnce=PTHREAD_ONCE_INIT;
+  #ifndef __linux__
+  static unsigned long long ullLastId;
+  #endif /* __linux__ */
+
+  pthread_once(&tOnce,vLogC_ContextAtFork_m);
+  #ifdef __linux__
+  ullThreadId=(unsigned long long)syscall(SYS_gettid);
+  #else
+  ullThreadId=__atomic_add_fetch(&ullLastId,1,__ATOMIC_RELAXED); /* Numbered in the order of the first entry */
+  #endif /* __linux__ */
+#endif /* _WIN32 */
+  ptagContext->szThreadIdLength=(size_t)sprintf(ptagContext->caThreadId,LOGC_PREFIX_FORMAT_THREADID,ullThreadId);
+}
+#endif /* LOGC_FEATURE_ENABLE_CONTEXT */
 
 #ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
 char *LogC_StorageGetNextLog(LogC ptagLog,
@@ -770,35 +7362,184 @@ char *LogC_StorageGetNextLog(LogC ptagLog,
 {
   char *pcTmp;
   LOGC_MUTEX_LOCK(ptagLog);
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  /* Send the pending batch, entries which can't be sent reach the storage as fallback */
+  iLogC_SocketFlush_m(ptagLog);
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
   pcTmp=pcLogC_StoragePop_m(ptagLog,pszEntryLength);
   LOGC_MUTEX_UNLOCK(ptagLog);
   return(pcTmp);
 }
 
-INLINE_FCT void vLogC_StoragePush_m(LogC ptagLog,
-                                    TagLogCEntry *ptagEntry)
+int LogC_StorageAddBinary(LogC log,
+                          int logType,
+                          const void *data,
+                          size_t dataLength)
 {
-  ptagEntry->ptagNext=NULL;
-  /* Check if first entry in queue */
-  if(!ptagLog->ptagSavedLogFirst)
+  int iRc=-1;
+
+  if(logType<log->iLogLevel)
+    return(0);
+  if((!ptagLogC_GetLogType_m(logType)) || ((!data) && (dataLength)))
+    return(-1);
+  LOGC_MUTEX_LOCK(log);
+  if((log->szMaxStorageCount) &&
+     (!(iRc=iLogC_StorageAdd_m(log,(data)?data:(const void*)"",dataLength,logType))))
+    ++log->tagStats.ullEntryCount;
+  LOGC_MUTEX_UNLOCK(log);
+  return(iRc);
+}
+
+LogCStorageEntry *LogC_StorageQuery(LogC log,
+                                    const LogCStorageQuery *query,
+                                    size_t *count)
+{
+  size_t szFirst;
+  size_t szIndex;
+  size_t szCount=0;
+  size_t szTextSize=0;
+  const TagLogCIndex *ptagIndex;
+  LogCStorageEntry *ptagResult=NULL;
+  char *pcText;
+
+  *count=0;
+  LOGC_MUTEX_LOCK(log);
+  /* Find the first entry in time range and after the cursor */
+  szFirst=szLogC_StorageIndexSearch_m(log,query->ullTimeFromMs,query->ullAfterCursor+1);
+  /* Count matching entries and size of their texts */
+  for(szIndex=szFirst;szIndex<log->szStoredLogsCount;++szIndex)
   {
-    ptagLog->ptagSavedLogFirst=ptagEntry;
-    ptagLog->ptagSavedLogLast=ptagEntry;
-    ptagLog->szStoredLogsCount=1;
-    return;
+    ptagIndex=&log->ptagStorageIndex[(log->szStorageIndexFirst+szIndex)%log->szStorageIndexSize];
+    if((query->ullTimeToMs) && (ptagIndex->ullTimeMs>query->ullTimeToMs))
+      break;
+    if(ptagIndex->iLogType<query->iMinLogType)
+      continue;
+    szTextSize+=ptagIndex->ptagEntry->szTextLength;
+    if(++szCount==query->szMaxCount)
+      break;
   }
-  ptagLog->ptagSavedLogLast->ptagNext=ptagEntry;
-  ptagLog->ptagSavedLogLast=ptagEntry;
-  if(ptagLog->szStoredLogsCount>=ptagLog->szMaxStorageCount)
+  if((szCount) && ((ptagResult=malloc(szCount*sizeof(LogCStorageEntry)+szTextSize))))
+  {
+    pcText=(char*)&ptagResult[szCount];
+    for(szIndex=szFirst;*count<szCount;++szIndex)
+    {
+      ptagIndex=&log->ptagStorageIndex[(log->szStorageIndexFirst+szIndex)%log->szStorageIndexSize];
+      if(ptagIndex->iLogType<query->iMinLogType)
+        continue;
+      ptagResult[*count].ullCursor=ptagIndex->ullSeq;
+      ptagResult[*count].ullTimeMs=ptagIndex->ullTimeMs;
+      ptagResult[*count].iLogType=ptagIndex->iLogType;
+      ptagResult[*count].szTextLength=ptagIndex->ptagEntry->szTextLength;
+      ptagResult[*count].pcText=pcText;
+      memcpy(pcText,ptagIndex->ptagEntry->pcText,ptagIndex->ptagEntry->szTextLength);
+      pcText+=ptagIndex->ptagEntry->szTextLength;
+      ++*count;
+    }
+  }
+  LOGC_MUTEX_UNLOCK(log);
+  return(ptagResult);
+}
+
+/**
+ * Copy the text into a new entry of the storage.
+ *
+ * @param szLength Length of the text without '\0'.
+ */
+INLINE_FCT int iLogC_StorageAdd_m(LogC ptagLog,
+                                  const char *pcText,
+                                  size_t szLength,
+                                  int iLogType)
+{
+  char *pcTmp;
+  TagLogCEntry *ptagEntry;
+  /* The text must be at the start of the allocation, align the entry behind it */
+  size_t szEntryOffset=(szLength+1+sizeof(void*)-1)&~(sizeof(void*)-1);
+  if(!(pcTmp=malloc(szEntryOffset+sizeof(TagLogCEntry))))
+    return(-1);
+  ptagEntry=(TagLogCEntry*)(pcTmp+szEntryOffset);
+  ptagEntry->pcText=pcTmp;
+  ptagEntry->szTextLength=szLength+1;
+  memcpy(pcTmp,pcText,szLength);
+  pcTmp[szLength]='\0';
+  if(iLogC_StoragePush_m(ptagLog,ptagEntry,iLogType))
+  {
+    free(pcTmp);
+    return(-1);
+  }
+  return(0);
+}
+
+/**
+ * Binary search in the index for the first entry at or after the given time and sequence number.
+ *
+ * @return Position of the entry, relative to the first stored entry, szStoredLogsCount if there's none.
+ */
+INLINE_FCT size_t szLogC_StorageIndexSearch_m(LogC ptagLog,
+                                              unsigned long long ullTimeMs,
+                                              unsigned long long ullSeq)
+{
+  size_t szLow=0;
+  size_t szHigh=ptagLog->szStoredLogsCount;
+  size_t szMid;
+  const TagLogCIndex *ptagIndex;
+
+  while(szLow<szHigh)
+  {
+    szMid=szLow+(szHigh-szLow)/2;
+    ptagIndex=&ptagLog->ptagStorageIndex[(ptagLog->szStorageIndexFirst+szMid)%ptagLog->szStorageIndexSize];
+    /* Time and sequence number are both never decreasing */
+    if((ptagIndex->ullTimeMs<ullTimeMs) || (ptagIndex->ullSeq<ullSeq))
+      szLow=szMid+1;
+    else
+      szHigh=szMid;
+  }
+  return(szLow);
+}
+
+INLINE_FCT int iLogC_StoragePush_m(LogC ptagLog,
+                                   TagLogCEntry *ptagEntry,
+                                   int iLogType)
+{
+  TagLogCIndex *ptagIndex;
+  unsigned long long ullTimeMs;
+  size_t szIndex;
+
+  /* Grow the index, if it's full and more entries may be stored */
+  if((ptagLog->szStoredLogsCount==ptagLog->szStorageIndexSize) &&
+     (ptagLog->szStoredLogsCount<ptagLog->szMaxStorageCount))
   {
-    TagLogCEntry *ptagTmp;
-    ptagTmp=ptagLog->ptagSavedLogFirst;
-    ptagLog->ptagSavedLogFirst=ptagLog->ptagSavedLogFirst->ptagNext;
-    free(ptagTmp->pcText);
+    size_t szNewSize=(ptagLog->szStorageIndexSize)?2*ptagLog->szStorageIndexSize:LOGC_STORAGE_INDEX_MINSIZE;
+    if(szNewSize>ptagLog->szMaxStorageCount)
+      szNewSize=ptagLog->szMaxStorageCount;
+    if(!(ptagIndex=malloc(szNewSize*sizeof(TagLogCIndex))))
+      return(-1);
+    for(szIndex=0;szIndex<ptagLog->szStoredLogsCount;++szIndex)
+      ptagIndex[szIndex]=ptagLog->ptagStorageIndex[(ptagLog->szStorageIndexFirst+szIndex)%ptagLog->szStorageIndexSize];
+    free(ptagLog->ptagStorageIndex);
+    ptagLog->ptagStorageIndex=ptagIndex;
+    ptagLog->szStorageIndexSize=szNewSize;
+    ptagLog->szStorageIndexFirst=0;
   }
+  ullTimeMs=ullLogC_GetRealTimeMs_m();
+  if((ptagLog->szStoredLogsCount) && (ullTimeMs<ptagLog->ptagStorageIndex[(ptagLog->szStorageIndexFirst+ptagLog->szStoredLogsCount-1)%ptagLog->szStorageIndexSize].ullTimeMs))
+    ullTimeMs=ptagLog->ptagStorageIndex[(ptagLog->szStorageIndexFirst+ptagLog->szStoredLogsCount-1)%ptagLog->szStorageIndexSize].ullTimeMs; /* Clock went back */
+  /* Storage is full, drop the oldest entry */
+  if(ptagLog->szStoredLogsCount>=ptagLog->szMaxStorageCount)
+    free(pcLogC_StoragePop_m(ptagLog,NULL));
+
+  ptagEntry->ptagNext=NULL;
+  if(!ptagLog->ptagSavedLogFirst)
+    ptagLog->ptagSavedLogFirst=ptagEntry;
   else
-    ++ptagLog->szStoredLogsCount;
-  return;
+    ptagLog->ptagSavedLogLast->ptagNext=ptagEntry;
+  ptagLog->ptagSavedLogLast=ptagEntry;
+  ptagIndex=&ptagLog->ptagStorageIndex[(ptagLog->szStorageIndexFirst+ptagLog->szStoredLogsCount)%ptagLog->szStorageIndexSize];
+  ptagIndex->ullTimeMs=ullTimeMs;
+  ptagIndex->ullSeq=++ptagLog->ullStorageSeq;
+  ptagIndex->iLogType=iLogType;
+  ptagIndex->ptagEntry=ptagEntry;
+  ++ptagLog->szStoredLogsCount;
+  return(0);
 }
 
 INLINE_FCT char *pcLogC_StoragePop_m(LogC ptagLog,
@@ -814,10 +7555,245 @@ INLINE_FCT char *pcLogC_StoragePop_m(LogC ptagLog,
   if(pszEntryLength)
     *pszEntryLength=ptagTmp->szTextLength;
   --ptagLog->szStoredLogsCount;
+  ptagLog->szStorageIndexFirst=(ptagLog->szStorageIndexFirst+1)%ptagLog->szStorageIndexSize;
   return(ptagTmp->pcText);
 }
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
 
+/**
+ * Apply the backpressure policy for an entry, which can't be buffered at the moment.
+ * Must be called with the mutex locked, releases it while blocking.
+ * Drops are counted here, also one entry dropped by LOGC_BACKPRESSURE_DROP_OLDEST.
+ *
+ * @param pullDeadlineNs Deadline for blocking, pass a pointer to 0 on the first call for an entry.
+ * @param puiWaitMs      Last wait before retrying, pass a pointer to 0 on the first call for an entry.
+ *                       The wait is doubled with every retry, up to LOGC_BACKPRESSURE_WAIT_MAX_MS.
+ * @param pullDroppedPending
+ *                       Counter of dropped entries for the marker entry of the buffer.
+ *
+ * @return 0 if the caller should retry, 1 if the new entry is dropped,
+ *         2 if the oldest buffered entry should be dropped by the caller.
+ */
+INLINE_FCT int iLogC_BackpressureDrop_m(LogC ptagLog,
+                                        int iLogType,
+                                        unsigned long long *pullDeadlineNs,
+                                        unsigned int *puiWaitMs,
+                                        unsigned long long *pullDroppedPending)
+{
+  unsigned long long ullNowNs;
+  unsigned long long ullLeftMs;
+  if((ptagLog->iBackpressurePolicy==LOGC_BACKPRESSURE_BLOCK) ||
+     (iLogType>=ptagLog->iBackpressureKeepLevel))
+  {
+    ullNowNs=ullLogC_GetTimeNs_m();
+    if(!*pullDeadlineNs)
+      *pullDeadlineNs=(ptagLog->uiBackpressureTimeoutMs==LOGC_BACKPRESSURE_TIMEOUT_INFINITE)?
+                      ~0ULL:ullNowNs+ptagLog->uiBackpressureTimeoutMs*1000000ULL;
+    if(ullNowNs<*pullDeadlineNs)
+    {
+      /* Nobody signals free space, the queue is drained by retrying the write or by the reader process */
+      *puiWaitMs=(!*puiWaitMs)?1:
+                 (*puiWaitMs>=LOGC_BACKPRESSURE_WAIT_MAX_MS/2)?LOGC_BACKPRESSURE_WAIT_MAX_MS:*puiWaitMs*2;
+      ullLeftMs=(*pullDeadlineNs-ullNowNs+999999ULL)/1000000ULL;
+      LOGC_MUTEX_UNLOCK(ptagLog);
+      vLogC_SleepMs_m((ullLeftMs<*puiWaitMs)?(unsigned int)ullLeftMs:*puiWaitMs);
+      LOGC_MUTEX_LOCK(ptagLog);
+      return(0);
+    }
+  }
+  ++*pullDroppedPending;
+  ++ptagLog->tagStats.ullDroppedCount;
+  if((ptagLog->iBackpressurePolicy==LOGC_BACKPRESSURE_DROP_OLDEST) &&
+     (iLogType<ptagLog->iBackpressureKeepLevel))
+    return(2);
+  return(1);
+}
+
+INLINE_FCT unsigned long long ullLogC_GetRealTimeNs_m(void)
+{
+#ifdef _WIN32
+  FILETIME tagTime;
+  ULARGE_INTEGER tagTime100ns;
+  GetSystemTimeAsFileTime(&tagTime);
+  tagTime100ns.LowPart=tagTime.dwLowDateTime;
+  tagTime100ns.HighPart=tagTime.dwHighDateTime;
+  return((tagTime100ns.QuadPart-116444736000000000ULL)*100ULL); /* FILETIME starts 1601-01-01 */
+#else /* __unix__ */
+  struct timespec tagTime;
+  clock_gettime(CLOCK_REALTIME,&tagTime);
+  return((unsigned long long)tagTime.tv_sec*1000000000ULL+(unsigned long long)tagTime.tv_nsec);
+#endif /* _WIN32 */
+}
+
+#if defined(LOGC_FEATURE_ENABLE_LOG_STORAGE) || defined(LOGC_FEATURE_ENABLE_LOGFILE)
+INLINE_FCT unsigned long long ullLogC_GetRealTimeMs_m(void)
+{
+  return(ullLogC_GetRealTimeNs_m()/1000000ULL);
+}
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE || LOGC_FEATURE_ENABLE_LOGFILE */
+
+/**
+ * Take the offsets to convert iTimeSource to the wall clock.
+ */
+INLINE_FCT int iLogC_TimeBaseNew_m(TagLogCTimeBase *ptagTimeBase,
+                                   int iTimeSource)
+{
+  unsigned long long ullStartNs;
+  unsigned long long ullRealNs;
+
+  switch(iTimeSource)
+  {
+    case LOGC_TIMESOURCE_REALTIME:
+    case LOGC_TIMESOURCE_REALTIME_COARSE:
+      break;
+    case LOGC_TIMESOURCE_MONOTONIC:
+      /* Take the wall clock between two readings of the monotonic clock */
+      ullStartNs=ullLogC_GetTimeNs_m();
+      ullRealNs=ullLogC_GetRealTimeNs_m();
+      ullStartNs+=(ullLogC_GetTimeNs_m()-ullStartNs)/2;
+      ptagTimeBase->llOffsetNs=(long long)(ullRealNs-ullStartNs);
+      break;
+#ifdef LOGC_TSC_AVAILABLE
+    case LOGC_TIMESOURCE_TSC:
+    {
+      unsigned long long ullStartTsc;
+      unsigned int uiaRegs[4]={0,0,0,0};
+  #ifdef _MSC_VER
+      int iaRegs[4];
+      __cpuid(iaRegs,0x80000000);
+      if((unsigned int)iaRegs[0]>=0x80000007)
+      {
+        __cpuid(iaRegs,0x80000007);
+        uiaRegs[3]=(unsigned int)iaRegs[3];
+      }
+  #else /* __GNUC__ */
+      if(__get_cpuid_max(0x80000000,NULL)>=0x80000007)
+        __get_cpuid(0x80000007,&uiaRegs[0],&uiaRegs[1],&uiaRegs[2],&uiaRegs[3]);
+  #endif /* _MSC_VER */
+      if(!(uiaRegs[3]&(1U<<8))) /* Invariant TSC, runs at a constant rate in all power states */
+        return(-1);
+      ullStartNs=ullLogC_GetTimeNs_m();
+      ullStartTsc=__rdtsc();
+      vLogC_SleepMs_m(LOGC_TIMESTAMP_TSC_CALIBRATE_MS);
+      ptagTimeBase->ullTscBase=__rdtsc();
+      ullRealNs=ullLogC_GetRealTimeNs_m();
+      if(ptagTimeBase->ullTscBase<=ullStartTsc)
+        return(-1);
+      ptagTimeBase->dTscNsPerTick=(double)(ullLogC_GetTimeNs_m()-ullStartNs)/(double)(ptagTimeBase->ullTscBase-ullStartTsc);
+      ptagTimeBase->ullTscBaseNs=ullRealNs;
+      break;
+    }
+#endif /* LOGC_TSC_AVAILABLE */
+    default:
+      return(-1);
+  }
+  ptagTimeBase->iTimeSource=iTimeSource;
+  return(0);
+}
+
+/**
+ * Read the selected time source and convert it to nanoseconds since the epoch.
+ */
+INLINE_FCT unsigned long long ullLogC_GetEntryTimeNs_m(LogC ptagLog)
+{
+  switch(ptagLog->tagTimeBase.iTimeSource)
+  {
+#if defined(__unix__) && defined(CLOCK_REALTIME_COARSE)
+    case LOGC_TIMESOURCE_REALTIME_COARSE:
+    {
+      struct timespec tagTime;
+      clock_gettime(CLOCK_REALTIME_COARSE,&tagTime);
+      return((unsigned long long)tagTime.tv_sec*1000000000ULL+(unsigned long long)tagTime.tv_nsec);
+    }
+#endif /* __unix__ && CLOCK_REALTIME_COARSE */
+    case LOGC_TIMESOURCE_MONOTONIC:
+      return(ullLogC_GetTimeNs_m()+(unsigned long long)ptagLog->tagTimeBase.llOffsetNs);
+#ifdef LOGC_TSC_AVAILABLE
+    case LOGC_TIMESOURCE_TSC:
+      /* Signed, the TSC of another CPU may be slightly behind the base */
+      return(ptagLog->tagTimeBase.ullTscBaseNs+
+             (unsigned long long)(long long)((double)(long long)(__rdtsc()-ptagLog->tagTimeBase.ullTscBase)*ptagLog->tagTimeBase.dTscNsPerTick));
+#endif /* LOGC_TSC_AVAILABLE */
+    default:
+      return(ullLogC_GetRealTimeNs_m());
+  }
+}
+
+INLINE_FCT void vLogC_SleepMs_m(unsigned int uiMs)
+{
+#ifdef _WIN32
+  Sleep(uiMs);
+#else /* __unix__ */
+  struct timespec tagTime;
+  tagTime.tv_sec=uiMs/1000;
+  tagTime.tv_nsec=(long)(uiMs%1000)*1000000L;
+  nanosleep(&tagTime,NULL);
+#endif /* _WIN32 */
+}
+
+INLINE_FCT unsigned long long ullLogC_GetTimeNs_m(void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER tagCounter;
+  LARGE_INTEGER tagFrequency;
+  QueryPerformanceCounter(&tagCounter);
+  QueryPerformanceFrequency(&tagFrequency);
+  return((unsigned long long)(tagCounter.QuadPart/tagFrequency.QuadPart)*1000000000ULL+
+         (unsigned long long)(tagCounter.QuadPart%tagFrequency.QuadPart)*1000000000ULL/(unsigned long long)tagFrequency.QuadPart);
+#else /* __unix__ */
+  struct timespec tagTime;
+  clock_gettime(CLOCK_MONOTONIC,&tagTime);
+  return((unsigned long long)tagTime.tv_sec*1000000000ULL+(unsigned long long)tagTime.tv_nsec);
+#endif /* _WIN32 */
+}
+
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+INLINE_FCT unsigned long long ullLogC_ProfileTicks_m(void)
+{
+#ifdef LOGC_TSC_AVAILABLE
+  return(__rdtsc());
+#else
+  return(ullLogC_GetTimeNs_m());
+#endif /* LOGC_TSC_AVAILABLE */
+}
+
+INLINE_FCT void vLogC_ProfileAdd_m(LogC ptagLog,
+                                   int iStage,
+                                   unsigned long long ullTicks)
+{
+  TagLogCProfile *ptagProfile=&ptagLog->tagaProfile[iStage];
+  size_t szBucket;
+  int iMsb=0;
+
+  if(ullTicks<(1U<<LOGC_PROFILE_SUBBITS))
+  {
+    szBucket=(size_t)ullTicks;
+  }
+  else
+  {
+#ifdef __GNUC__
+    iMsb=63-__builtin_clzll(ullTicks);
+#else
+    while(ullTicks>>(iMsb+1))
+      ++iMsb;
+#endif /* __GNUC__ */
+    /* Power of 2 and the next LOGC_PROFILE_SUBBITS bits below the highest one */
+    szBucket=((size_t)(iMsb-LOGC_PROFILE_SUBBITS+1)<<LOGC_PROFILE_SUBBITS)+
+             (size_t)((ullTicks>>(iMsb-LOGC_PROFILE_SUBBITS))&((1U<<LOGC_PROFILE_SUBBITS)-1));
+  }
+  LOGC_PROFILE_ADD(&ptagProfile->ullTotal,ullTicks);
+  LOGC_PROFILE_ADD(&ptagProfile->ullaBuckets[szBucket],1);
+}
+
+INLINE_FCT unsigned long long ullLogC_ProfileBucketStart_m(size_t szBucket)
+{
+  if(szBucket<(1U<<LOGC_PROFILE_SUBBITS))
+    return(szBucket);
+  return((unsigned long long)((1U<<LOGC_PROFILE_SUBBITS)|(szBucket&((1U<<LOGC_PROFILE_SUBBITS)-1)))<<
+         ((szBucket>>LOGC_PROFILE_SUBBITS)-1));
+}
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
+
 INLINE_FCT const struct TagLogType *ptagLogC_GetLogType_m(int iLogType)
 {
   size_t szIndex;
@@ -2,14 +2,30 @@
   #define LOGC_H_INCLUDED
 
 #include <stdarg.h>
+#include <stddef.h> /* For size_t */
 #include <limits.h>
 
 #define LOGC_FEATURE_ENABLE_LOGFILE       /* Enable this option if you want to log to a file */
-/* #define LOGC_FEATURE_ENABLE_LOG_STORAGE   /* Enable this option if you want to store logs */
+/* #define LOGC_FEATURE_ENABLE_LOG_STORAGE */  /* Enable this option if you want to store logs */
 #define LOGC_FEATURE_ENABLE_THREADSAFETY  /* Enable this for making safe for use within multithreaded Applications */
+/* #define LOGC_FEATURE_ENABLE_IOURING */     /* Linux only: Write the logfile asynchronously using io_uring, falls back to normal writes if io_uring is not available */
+/* #define LOGC_FEATURE_ENABLE_SHM */         /* POSIX only: Add entries to a shared memory ring, which is drained by logc-collector */
+/* #define LOGC_FEATURE_ENABLE_SOCKET */      /* POSIX only: Send entries in batches to a unix domain socket, e.g. a local syslog daemon */
+/* #define LOGC_FEATURE_ENABLE_ENGINE */      /* One background thread writes the logfiles of all attached Log-Objects, needs LOGFILE and THREADSAFETY */
+/* #define LOGC_FEATURE_ENABLE_FLUSHTIMER */  /* One background thread writes filequeues whose oldest entry reached a max age, see LogC_SetFileMaxAge(), needs LOGFILE and THREADSAFETY */
+/* #define LOGC_FEATURE_ENABLE_FILECACHE */   /* POSIX only: Keep logfiles open in a process-wide LRU cache of descriptors, see LogC_SetFileCache() */
+/* #define LOGC_FEATURE_ENABLE_PERCPU */      /* Linux only: Stage entries in buffers per CPU, placed on its NUMA node, needs THREADSAFETY */
+/* #define LOGC_FEATURE_ENABLE_PROFILE */     /* Measure the time of each stage of adding and writing entries, see LogC_DumpProfile() */
+/* #define LOGC_FEATURE_ENABLE_TRACE */       /* Record spans per thread with LOGC_SPAN_BEGIN()/LOGC_SPAN_END() into a Chrome trace-event file, needs THREADSAFETY */
+/* #define LOGC_FEATURE_ENABLE_RECORDER */    /* Keep entries below the loglevel in a ring per thread, written ahead of an error, see LogC_SetFlightRecorder() */
+/* #define LOGC_FEATURE_ENABLE_CONTEXT */     /* Thread id and key=value fields per thread in the prefix, see LogC_ContextPush() */
 
 #define LOGC_LIBRARY_DEBUG
 
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+  #include <stdio.h> /* For LogC_DumpProfile() */
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
+
 /**
  * This are the available logtypes for each entry.
  * Edit as you need, also in LogC.c!
@@ -37,18 +53,29 @@ enum LogCOptions
   LOGC_OPTION_PREFIX_TIMESTAMP_TIME           =0x2,
   /* Current Milliseconds, e.g. .0123 */
   LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MILLISECS =0x4,
+  /* Current Microseconds, e.g. .012345, can't be combined with milli- or nanoseconds */
+  LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MICROSECS =0x8,
   /* Add the logtype as text prefix, e.g. [Error] */
   LOGC_OPTION_PREFIX_LOGTYPETEXT              =0x10,
   /* Adds Fileinfo to the Prefix of each entry, e.g. myfile.c@line 11 */
   LOGC_OPTION_PREFIX_FILEINFO                 =0x20,
   /* Add Functionname for each entry using the __func__ macro. */
   LOGC_OPTION_PREFIX_FUNCTIONNAME             =0x40,
+  /* Current Nanoseconds, e.g. .012345678, can't be combined with milli- or microseconds */
+  LOGC_OPTION_PREFIX_TIMESTAMP_TIME_NANOSECS  =0x80,
 
   /* Keeps the logs timestamp in UTC (this is the default behaviour if nothing is specified) */
   LOGC_OPTION_TIMESTAMP_UTC                   =0x100,
   /* Sets the timestamp to localtime */
   LOGC_OPTION_TIMESTAMP_LOCALTIME             =0x200,
 
+#ifdef LOGC_FEATURE_ENABLE_CONTEXT
+  /* Id of the calling thread, e.g. tid=1234 */
+  LOGC_OPTION_PREFIX_THREADID                 =0x400,
+  /* Context fields of the calling thread, e.g. request=17 tenant=acme, see LogC_ContextPush() */
+  LOGC_OPTION_PREFIX_CONTEXT                  =0x800,
+#endif /* LOGC_FEATURE_ENABLE_CONTEXT */
+
   /* Don't print logtypes which are linked to stdout, see TagLogTypes in LogC.h */
   LOGC_OPTION_IGNORE_STDOUT                   =0x1000,
   /* Don't print logtypes which are linked to stderr, see TagLogTypes in LogC.h */
@@ -85,21 +112,155 @@ enum LogCOptions
   #define LOGC_FUNCTIONNAME NULL
 #endif /* __STDC_VERSION__ */
 
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
 typedef struct TagLog_t* LogC;
 
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
 /**
- * Struct for Logfile options
+ * One route of the routing table, @see LogCFile.
+ */
+typedef struct
+{
+  /* The logfile of this route */
+  const char *pcFilePath;
+  /* Entries with a logtype from iMinLogType to iMaxLogType (both included) are written to this logfile */
+  int iMinLogType;
+  int iMaxLogType;
+  /* Count of entries collected before they are written, 0 for the default of the filequeue (10), 1 writes each entry */
+  size_t szQueueSize;
+  /* Durability of this logfile, @see enum LogCFileSync */
+  int iSyncMode;
+  unsigned int uiSyncIntervalMs;
+}LogCFileRoute;
+
+/**
+ * Struct for Logfile options, initialize it with zeros (e.g. LogCFile logFile={0};), so new options keep their default.
  */
 typedef struct
 {
   /**
-   * The Path for logging.
+   * The Path for logging, NULL to just write the routes.
    */
   const char *pcFilePath;
+  /**
+   * Optional routing table, which writes the entries to additional logfiles depending on their logtype,
+   * e.g. errors to "errors.log" and debug entries to "debug.log", @see LogC_SetFileRoutes().
+   * The table is copied by LogC_New(), NULL or a count of 0 for no routes.
+   */
+  const LogCFileRoute *ptagRoutes;
+  size_t szRouteCount;
 }LogCFile;
+
+/**
+ * Durability modes for the logfile, @see LogC_SetFileSync().
+ */
+enum LogCFileSync
+{
+  /* Don't sync the logfile, it's up to the OS when the data reaches the disk (default) */
+  LOGC_FILESYNC_NONE     =0,
+  /* Sync the logfile to disk after every write of the filequeue */
+  LOGC_FILESYNC_FLUSH    =1,
+  /* Sync the logfile to disk at most every N milliseconds */
+  LOGC_FILESYNC_INTERVAL =2
+};
+
+/**
+ * Modes for writing the logfile, @see LogC_SetFileMode().
+ */
+enum LogCFileMode
+{
+  /* Append the entries through the page cache (default) */
+  LOGC_FILEMODE_DEFAULT =0,
+  /**
+   * Linux only: Collect the entries in aligned blocks of 4 KiB and write them with O_DIRECT,
+   * bypassing the page cache. Full blocks are written when the buffer is full,
+   * the final partial block is written on LogC_WriteEntriesToDisk(), syncing and LogC_End().
+   */
+  LOGC_FILEMODE_DIRECT  =1,
+  /**
+   * POSIX only: Keep the logfile open with O_APPEND and write the entries with single write() calls of
+   * up to PIPE_BUF bytes, which never split an entry (a longer entry gets a call of its own).
+   * So entries of several processes appending to the same logfile don't interleave within a line.
+   */
+  LOGC_FILEMODE_APPEND  =2
+};
 #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
 
+/**
+ * Behaviour if an entry can't be buffered, because the buffer is full, @see LogC_SetBackpressure().
+ */
+enum LogCBackpressure
+{
+  /* Wait until there's space in the buffer again, with an optional timeout (default) */
+  LOGC_BACKPRESSURE_BLOCK       =0,
+  /* Drop the new entry */
+  LOGC_BACKPRESSURE_DROP_NEWEST =1,
+  /* Drop the oldest buffered entry to make space for the new one */
+  LOGC_BACKPRESSURE_DROP_OLDEST =2
+};
+#define LOGC_BACKPRESSURE_TIMEOUT_INFINITE UINT_MAX
+
+/**
+ * Clocks for the timestamp of the entries, @see LogC_SetTimeSource().
+ */
+enum LogCTimeSource
+{
+  /* Wall clock, read for each entry (default) */
+  LOGC_TIMESOURCE_REALTIME        =0,
+  /* Wall clock in the resolution of the kernel tick (CLOCK_REALTIME_COARSE), cheapest but just precise to a few milliseconds */
+  LOGC_TIMESOURCE_REALTIME_COARSE =1,
+  /* Monotonic clock, converted to the wall clock with the offset taken by LogC_SetTimeSource() */
+  LOGC_TIMESOURCE_MONOTONIC       =2,
+  /* x86 invariant TSC read with rdtsc, calibrated against the monotonic clock by LogC_SetTimeSource() */
+  LOGC_TIMESOURCE_TSC             =3
+};
+
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+/**
+ * Types of sockets, @see LogC_SetSocket().
+ */
+enum LogCSocketType
+{
+  /* Datagram socket, one datagram per entry */
+  LOGC_SOCKET_DGRAM  =0,
+  /* Stream socket, the entries are separated by '\n' */
+  LOGC_SOCKET_STREAM =1,
+  /* Local syslog daemon, e.g. /dev/log, one datagram per entry with the syslog priority as prefix and without '\n' */
+  LOGC_SOCKET_SYSLOG =2
+};
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+
+/**
+ * Statistics of a Log-Object, @see LogC_GetStats().
+ */
+typedef struct
+{
+  /* Count of entries added to the log (filtered ones not included) */
+  unsigned long long ullEntryCount;
+  /* Count of entries dropped because of a full buffer, @see LogC_SetBackpressure() */
+  unsigned long long ullDroppedCount;
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  /* Count of writes of the filequeue to the logfile */
+  unsigned long long ullFileWriteCount;
+  /* Count of syncs of the logfile to disk, one sync may cover several writes */
+  unsigned long long ullFileSyncCount;
+  /* Total and maximum time spent for syncing in nanoseconds */
+  unsigned long long ullFileSyncTimeTotalNs;
+  unsigned long long ullFileSyncTimeMaxNs;
+  /* Count of failed writes and syncs of the logfiles of the routes, the entries are kept for the next write */
+  unsigned long long ullFileRouteErrorCount;
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  /* Count of syscalls for sending batches of entries to the socket */
+  unsigned long long ullSocketSendCount;
+  /* Count of entries which couldn't be sent to the socket, passed to the fallback or dropped */
+  unsigned long long ullSocketUnsentCount;
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+}LogCStats;
+
 /**
  * Creates a new Log-Object
  *
@@ -133,9 +294,11 @@ extern LogC LogC_New(int logLevel,
                      );
 
 #ifdef __GNUC__
-  #define PRINTF_FORMAT_CHECK __attribute__ ((format (printf, 6, 7)))
+  #define PRINTF_FORMAT_CHECK         __attribute__ ((format (printf, 6, 7)))
+  #define PRINTF_FORMAT_CHECK_HEXDUMP __attribute__ ((format (printf, 8, 9)))
 #else
   #define PRINTF_FORMAT_CHECK
+  #define PRINTF_FORMAT_CHECK_HEXDUMP
 #endif
 
 /**
@@ -161,13 +324,155 @@ extern int LogC_AddEntry_Text(LogC log,
                               ...)PRINTF_FORMAT_CHECK;
 
 #if LOGC_OPTVARARG == 1 /* GNUC optional Variadic macro (##__VA_ARGS__) */
-  #define LOG_TEXT(log,logtype,txt,...) LogC_AddEntry_Text(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,txt,##__VA_ARGS__)
+  #ifdef __GNUC__
+    /* 1 at compile time for a string literal without '%' and arguments, it's added without formatting then.
+       It relies on __builtin_constant_p(), which depends on the compiler and the optimization level: GCC folds it
+       for literals also with -O0, but if it isn't folded, the text is just formatted like before.
+       Both ways give the same entry, so the result never depends on the optimization. */
+    #define LOGC_PLAIN_LITERAL(txt,...) (__builtin_constant_p(__builtin_strchr(txt,'%')) && (!__builtin_strchr(txt,'%')) && (sizeof(#__VA_ARGS__)==1))
+    #define LOG_TEXT(log,logtype,txt,...) (LOGC_PLAIN_LITERAL(txt,__VA_ARGS__)? \
+                                           LogC_AddEntry_Message(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,txt,__builtin_strlen(txt)): \
+                                           LogC_AddEntry_Text(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,txt,##__VA_ARGS__))
+  #else
+    #define LOG_TEXT(log,logtype,txt,...) LogC_AddEntry_Text(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,txt,##__VA_ARGS__)
+  #endif /* __GNUC__ */
 #elif LOGC_OPTVARARG == 2 /* MS-Specific optional Variadic macro (Just __VA_ARGS__) */
   #define LOG_TEXT(log,logtype,txt,...) LogC_AddEntry_Text(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,txt,__VA_ARGS__)
 #else /* No optional varArgs available */
   #define LOG_TEXT(log,logtype,...) LogC_AddEntry_Text(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,__VA_ARGS__)
 #endif /* LOGC_OPTVARARG */
 
+/**
+ * Adds an already formatted text to the current log, e.g. from the C++ layer in LogC.hpp.
+ * With GCC and clang, LOG_TEXT() calls it for string literals without '%' and arguments, so they aren't formatted.
+ * This is decided with __builtin_constant_p(), so it may depend on the optimization level, see LOGC_PLAIN_LITERAL().
+ * The entry gets the same prefix, '\n' and truncation as an entry of LogC_AddEntry_Text() with the same text.
+ *
+ * @param log          The current Log-Object.
+ * @param logType      The Type for this entry, @see enum ELogType.
+ * @param fileName     Used for Prefixing the entry.
+ * @param lineNr       Used for Prefixing the entry.
+ * @param functionName Used for Prefixing the entry.
+ * @param text         The text, it's not interpreted as format and needs no '\0'.
+ * @param textLength   Length of the text.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_AddEntry_Message(LogC log,
+                                 int logType,
+                                 const char *fileName,
+                                 int lineNr,
+                                 const char *functionName,
+                                 const char *text,
+                                 size_t textLength);
+
+/**
+ * Check if entries of the logtype are added to the log, so formatting can be skipped otherwise.
+ *
+ * @param log     The current Log-Object.
+ * @param logType The Type to check, @see enum ELogType.
+ *
+ * @return 1 if the entries are added, 0 if they are filtered by the loglevel.
+ */
+extern int LogC_IsLogTypeEnabled(LogC log,
+                                 int logType);
+
+/**
+ * Adds a Logtext followed by a binary payload as hex, e.g. "Packet [0/1500] 4500...".
+ * Each entry gets the offset of its part and the total length of the payload,
+ * if the payload doesn't fit into one entry, it's continued in the next entries with the same text.
+ * The text is formatted once without allocating, it's truncated to 255 characters.
+ * Entries of other threads may be added between the continuation entries.
+ * It's recommended not to use this function directly, use the LOG_HEXDUMP() Macro instead.
+ *
+ * @param log        The current Log-Object.
+ * @param logType    The Type for this entry, @see enum ELogType.
+ * @param fileName   Used for Prefixing the entry.
+ * @param lineNr     Used for Prefixing the entry.
+ * @param functionName
+ *                   Used for Prefixing the entry.
+ * @param data       The payload.
+ * @param dataLength Size of the payload in bytes.
+ * @param logText    The Text, printf-like, the prefix and text must leave space for the payload in each entry.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_AddEntry_HexDump(LogC log,
+                                 int logType,
+                                 const char *fileName,
+                                 int lineNr,
+                                 const char *functionName,
+                                 const void *data,
+                                 size_t dataLength,
+                                 const char *logText,
+                                 ...)PRINTF_FORMAT_CHECK_HEXDUMP;
+
+#if LOGC_OPTVARARG == 1 /* GNUC optional Variadic macro (##__VA_ARGS__) */
+  #define LOG_HEXDUMP(log,logtype,data,length,txt,...) LogC_AddEntry_HexDump(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,data,length,txt,##__VA_ARGS__)
+#elif LOGC_OPTVARARG == 2 /* MS-Specific optional Variadic macro (Just __VA_ARGS__) */
+  #define LOG_HEXDUMP(log,logtype,data,length,txt,...) LogC_AddEntry_HexDump(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,data,length,txt,__VA_ARGS__)
+#else /* No optional varArgs available */
+  #define LOG_HEXDUMP(log,logtype,data,length,...) LogC_AddEntry_HexDump(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,data,length,__VA_ARGS__)
+#endif /* LOGC_OPTVARARG */
+
+typedef struct TagLogCBatch_t* LogCBatch;
+
+/**
+ * Starts a batch of related entries, e.g. a state dump, which are added to all outputs at once
+ * with LogC_BatchCommit(). The entries are formatted into a buffer of the batch when they are added,
+ * so the Log-Object is just locked once for all of them and they appear without entries of other threads in between.
+ * A batch belongs to the thread which created it.
+ *
+ * @param log     The Log-Object.
+ * @param entries Expected count of entries, the batch grows if more are added. Pass 0 for a default size.
+ *
+ * @return The new batch, or NULL on Error.
+ */
+extern LogCBatch LogC_BatchBegin(LogC log,
+                                 size_t entries);
+
+/**
+ * Formats an entry into the batch, like LogC_AddEntry_Text() does. Entries below the loglevel are skipped.
+ * It's recommended not to use this function directly, use the LOG_BATCH_TEXT() Macro instead.
+ *
+ * @param batch    The batch, @see LogC_BatchBegin().
+ * @param logType  The Type for this entry, @see enum ELogType.
+ * @param fileName Used for Prefixing the entry.
+ * @param lineNr   Used for Prefixing the entry.
+ * @param functionName
+ *                 Used for Prefixing the entry.
+ * @param logText  The Logtext including format specifiers, @see printf().
+ *
+ * @return 0 on success, negative value on Error, the batch can still be used then.
+ */
+extern int LogC_BatchAdd(LogCBatch batch,
+                         int logType,
+                         const char *fileName,
+                         int lineNr,
+                         const char *functionName,
+                         const char *logText,
+                         ...)PRINTF_FORMAT_CHECK;
+
+#if LOGC_OPTVARARG == 1 /* GNUC optional Variadic macro (##__VA_ARGS__) */
+  #define LOG_BATCH_TEXT(batch,logtype,txt,...) LogC_BatchAdd(batch,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,txt,##__VA_ARGS__)
+#elif LOGC_OPTVARARG == 2 /* MS-Specific optional Variadic macro (Just __VA_ARGS__) */
+  #define LOG_BATCH_TEXT(batch,logtype,txt,...) LogC_BatchAdd(batch,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,txt,__VA_ARGS__)
+#else /* No optional varArgs available */
+  #define LOG_BATCH_TEXT(batch,logtype,...) LogC_BatchAdd(batch,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,__VA_ARGS__)
+#endif /* LOGC_OPTVARARG */
+
+/**
+ * Adds all entries of the batch to the outputs of its Log-Object with one lock of the mutex and releases the batch.
+ * In the logfile the batch is added to the filequeue at once if it fits, otherwise the queue is written first and
+ * the batch is written with one write behind it. The backpressure policy of the logfile doesn't drop entries of a batch,
+ * the shared memory ring takes the whole batch or drops it. Per-CPU buffers are drained before.
+ *
+ * @param batch The batch, it's released also on Error.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_BatchCommit(LogCBatch batch);
+
 /**
  * Writes pending logs to File if needed and cleans up the Log-Object.
  *
@@ -203,12 +508,64 @@ extern int LogC_SetLogOptions(LogC log,
                               unsigned int newOptions);
 
 
+/**
+ * Get the current statistics of the Log-Object.
+ *
+ * @param log   The Log-Object
+ * @param stats Returns the statistics.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_GetStats(LogC log,
+                         LogCStats *stats);
+
+/**
+ * Set the behaviour if an entry can't be buffered, because the buffer is full.
+ * The filequeue is full if it couldn't be written, e.g. because the logfile is not accessible.
+ * Dropped entries are counted, the next entry after a drop is preceeded by a marker entry
+ * with the count of dropped entries.
+ * The default is LOGC_BACKPRESSURE_BLOCK without timeout, which fails with an error
+ * if the filequeue couldn't be written.
+ *
+ * @param log       The Log-Object.
+ * @param policy    The new policy, @see enum LogCBackpressure.
+ * @param keepLevel Entries of this logtype and above are never dropped, they block like
+ *                  LOGC_BACKPRESSURE_BLOCK. Pass LOGC_NONE to allow dropping all entries.
+ * @param timeoutMs Maximum time to block in milliseconds, if the buffer is still full afterwards,
+ *                  the entry is dropped and an error is returned.
+ *                  Pass 0 to fail immediately or LOGC_BACKPRESSURE_TIMEOUT_INFINITE to block until there's space.
+ *                  While blocking, the write is retried with a growing wait, up to 64 milliseconds.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_SetBackpressure(LogC log,
+                                int policy,
+                                int keepLevel,
+                                unsigned int timeoutMs);
+
+/**
+ * Set the clock used for the timestamps of the entries.
+ * The clock is read once per entry, the date and time text is just rebuilt when the second changes.
+ * The monotonic clock and the TSC are converted to the wall clock with an offset taken here,
+ * so later steps of the wall clock (e.g. by settimeofday()) are not followed,
+ * call this function again to take a new offset.
+ * Setting LOGC_TIMESOURCE_TSC blocks about 10ms for the calibration.
+ *
+ * @param log        The Log-Object.
+ * @param timeSource The new clock, @see enum LogCTimeSource.
+ *
+ * @return 0 on success, negative value on Error, e.g. if the TSC isn't invariant or not available.
+ */
+extern int LogC_SetTimeSource(LogC log,
+                              int timeSource);
+
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
 /**
  * This Function is just available if LOGC_FEATURE_ENABLE_LOGFILE is defined.
  * Force Writing pending Entries to the LogFile,
  * just use this function if you passed 0 as szMaxFileQueueSize.
  * This function will be called on iLogC_End_g() anyway.
+ * Writes left unsynced by LOGC_FILESYNC_INTERVAL are synced too, @see LogC_SetFileSync().
  *
  * @param log The Log-Object
  *
@@ -220,6 +577,8 @@ extern int LogC_WriteEntriesToDisk(LogC log);
  * This Function is just available if LOGC_FEATURE_ENABLE_LOGFILE is defined.
  * Change the Logfilepath after creating of the Log-Object.
  * If you pass NULL, no logfile will be written anymore.
+ * If the filemode can't be used with the new logfile (e.g. LOGC_FILEMODE_DIRECT on a filesystem without O_DIRECT),
+ * the old logfile is kept and a negative value is returned.
  *
  * @param log       The Log-Object.
  * @param newPath Path for the new Logfile, Length should not exceed 260 Characters.
@@ -229,8 +588,426 @@ extern int LogC_WriteEntriesToDisk(LogC log);
  */
 extern int LogC_SetFilePath(LogC log,
                             const char *newPath);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_LOGFILE is defined.
+ * Set the durability of the logfile, by default the logfile is never synced to disk.
+ * If several threads need a sync at the same time, one sync will cover all of them.
+ * Pending data is always synced in LogC_End() and before changing the logfilepath,
+ * if a mode other than LOGC_FILESYNC_NONE is set.
+ * The logfile is kept open for syncing, if it's rotated by someone else, set the logfilepath again.
+ * With LOGC_FILESYNC_INTERVAL, writes within the interval are synced by the next write after it
+ * or by LogC_WriteEntriesToDisk(). So if nothing is written for a while, the last writes stay unsynced,
+ * unless LogC_WriteEntriesToDisk() is called or the Log-Object has a max age at the flush timer
+ * (@see LogC_SetFileMaxAge()), which syncs them when the interval expires.
+ *
+ * @param log        The Log-Object.
+ * @param syncMode   The new durability mode, @see enum LogCFileSync.
+ * @param intervalMs Just used for LOGC_FILESYNC_INTERVAL, minimum time between two syncs in milliseconds.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_SetFileSync(LogC log,
+                            int syncMode,
+                            unsigned int intervalMs);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_LOGFILE is defined.
+ * Set the mode for writing the logfile, pending entries are written with the old mode first.
+ *
+ * @param log      The Log-Object.
+ * @param fileMode The new mode, @see enum LogCFileMode.
+ *
+ * @return 0 on success, negative value on Error, e.g. if the mode is not supported
+ *         on this platform or for the current logfile, or LOGC_FILEMODE_APPEND while an index is written.
+ */
+extern int LogC_SetFileMode(LogC log,
+                            int fileMode);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_LOGFILE is defined.
+ * Replace the routing table of LogCFile, which writes the entries to additional logfiles depending on their logtype.
+ * Each entry is formatted once and copied into the queue of each route it matches, the ranges of the routes may overlap.
+ * The logfile of the Log-Object still gets all entries, so it stays the complete log with the order of all entries,
+ * while the routes are extracts of it. Pass a LogCFile without pcFilePath to LogC_New() to just write the routes.
+ * Each route has its own queue and durability. Like the filequeue, each route has a second queue,
+ * so a full queue is swapped out and written by the thread which filled it without holding the mutex,
+ * also if the Log-Object is attached to the writer engine. The backpressure policy applies, if both queues are full.
+ * A failed write is counted in ullFileRouteErrorCount of LogC_GetStats(), the entries stay queued and are written
+ * with the next write, adding entries returns an error for LOGC_BACKPRESSURE_BLOCK like for the logfile.
+ * The routes are written and synced on LogC_WriteEntriesToDisk() and LogC_End() too. The entries of a batch stay together in the
+ * logfile of the Log-Object, but may be interleaved with entries of other threads in a route, if its queues run full.
+ * The current routes are written and synced before they are replaced.
+ *
+ * @param log        The Log-Object.
+ * @param routes     The routing table, copied by the Log-Object. NULL removes all routes.
+ * @param routeCount Count of routes in the table.
+ *
+ * @return 0 on success, negative value on Error, e.g. if a path is invalid.
+ */
+extern int LogC_SetFileRoutes(LogC log,
+                              const LogCFileRoute *routes,
+                              size_t routeCount);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_LOGFILE is defined.
+ * Write a sparse index of the logfile to a sidecar file with the path of the logfile and ".idx",
+ * so readers like logc-read can seek to a timerange and skip the blocks without entries of a logtype.
+ * One record with the position, the time of the first and last entry and the logtypes is appended
+ * for each block of entries, see LogC_Index.h for the format.
+ * The index follows the logfile when it's changed with LogC_SetFilePath(), an old index of an empty logfile is removed.
+ * The index file is kept open until the index is stopped. The offsets are just valid with a single writing process,
+ * so the index is not available with LOGC_FILEMODE_APPEND.
+ *
+ * @param log        The Log-Object.
+ * @param blockSize  A block ends after this count of bytes in the logfile, 0 to end the blocks just by time.
+ * @param intervalMs A block ends if its first entry is older than this, 0 to end the blocks just by size.
+ *                   Pass 0 for both to stop the index.
+ *
+ * @return 0 on success, negative value on Error, e.g. if no logfile is set, the path is too long for the suffix
+ *         or the filemode is LOGC_FILEMODE_APPEND.
+ */
+extern int LogC_SetFileIndex(LogC log,
+                             size_t blockSize,
+                             unsigned int intervalMs);
 #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
 
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_ENGINE is defined.
+ * Start the writer engine, a single background thread which writes the logfiles of all attached Log-Objects,
+ * @see LogC_EngineAttach(). Each Log-Object keeps its own logfile, filemode and durability settings.
+ * There's just one engine per process.
+ *
+ * @param flushIntervalMs Partially filled filequeues of the attached Log-Objects are written at least this often,
+ *                        so an entry doesn't wait longer than this for the logfile. Pass 0 to use 100ms.
+ *
+ * @return 0 on success, negative value on Error, e.g. if the engine is already running.
+ */
+extern int LogC_EngineStart(unsigned int flushIntervalMs);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_ENGINE is defined.
+ * Stop the writer engine, the Log-Objects still attached are detached and their pending entries written.
+ * It may be called from any thread, a concurrent LogC_EngineStart() or LogC_EngineStop() fails,
+ * Log-Objects may still be detached or ended while the engine stops.
+ *
+ * @return 0 on success, negative value on Error, e.g. if pending entries couldn't be written.
+ */
+extern int LogC_EngineStop(void);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_ENGINE is defined.
+ * Attach the Log-Object to the running writer engine. A full filequeue is handed over to the engine
+ * and filling continues in a second queue, so adding entries doesn't wait for the logfile.
+ * If the engine is still busy with the last queue when the second one is full,
+ * the backpressure policy is applied, @see LogC_SetBackpressure(), but LOGC_BACKPRESSURE_BLOCK
+ * always waits for the engine, the timeout just applies if the engine failed to write the logfile.
+ * LogC_WriteEntriesToDisk() still writes all pending entries synchronously.
+ * The Log-Object must be created with LOGC_OPTION_THREADSAFE and a logfile.
+ *
+ * @param log The Log-Object.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_EngineAttach(LogC log);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_ENGINE is defined.
+ * Detach the Log-Object from the writer engine and write its pending entries,
+ * the logfile is written synchronously afterwards again. Called by LogC_End() if needed.
+ *
+ * @param log The Log-Object.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_EngineDetach(LogC log);
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+
+#ifdef LOGC_FEATURE_ENABLE_FLUSHTIMER
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_FLUSHTIMER is defined.
+ * Start the flush timer, a single background thread which writes the filequeues of the Log-Objects
+ * with a max age, @see LogC_SetFileMaxAge(). The thread just wakes up for the earliest deadline of a non-empty queue.
+ * There's just one flush timer per process.
+ *
+ * @return 0 on success, negative value on Error, e.g. if the flush timer is already running.
+ */
+extern int LogC_FlushTimerStart(void);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_FLUSHTIMER is defined.
+ * Stop the flush timer, the max age of all Log-Objects is removed.
+ * Buffered entries are written when the filequeue is full, or by LogC_WriteEntriesToDisk() and LogC_End().
+ *
+ * @return 0 on success, negative value on Error, e.g. if the flush timer isn't running.
+ */
+extern int LogC_FlushTimerStop(void);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_FLUSHTIMER is defined.
+ * Set the max time an entry stays in the filequeue before it's written, so entries of a Log-Object
+ * with little traffic reach the logfile in time, even if the filequeue isn't filled.
+ * The age counts from the first entry added to the empty filequeue, entries already buffered
+ * get the full max age from the call on. If the Log-Object is attached to the writer engine,
+ * the filequeue is handed over to it instead. Entries still in per-CPU buffers aren't covered.
+ * The flush timer must be running and the Log-Object must be created with LOGC_OPTION_THREADSAFE,
+ * removing the max age also succeeds without the flush timer. Called by LogC_End(), it may run at the same time
+ * as LogC_FlushTimerStop().
+ *
+ * @param log      The Log-Object.
+ * @param maxAgeMs Max age of the entries in the filequeue in ms, 0 to remove the max age.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_SetFileMaxAge(LogC log,
+                              unsigned int maxAgeMs);
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+
+#ifdef LOGC_FEATURE_ENABLE_FILECACHE
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_FILECACHE is defined.
+ * Set the max number of logfiles kept open by the descriptor cache, which is shared by all Log-Objects of the process.
+ * Logfiles written in the default filemode and the routes of a Log-Object are opened once with O_APPEND and kept open,
+ * instead of being opened for each write of the filequeue. If the cache is full, the least recently written logfile is closed.
+ * The other filemodes and the io_uring backend keep their own descriptor and don't use the cache.
+ * Each call closes all cached logfiles which aren't written at the moment. A cached descriptor keeps writing to the
+ * renamed file after an external rotation, so call this after the logfiles were rotated.
+ * LogC_SetFilePath() and LogC_End() close the descriptors of the logfile and the routes they stop writing.
+ * The cache is disabled by default.
+ *
+ * @param maxFiles Max number of open logfiles, 0 to disable the cache.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_SetFileCache(size_t maxFiles);
+#endif /* LOGC_FEATURE_ENABLE_FILECACHE */
+
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_PERCPU is defined.
+ * Add the entries to staging buffers per CPU instead of the shared filequeue, so threads on
+ * different CPUs don't contend for the mutex and the buffer of the Log-Object.
+ * Each buffer is placed on the NUMA node of its CPU (first touch), the CPU is determined with sched_getcpu().
+ * When a buffer is full, the buffers of all CPUs are drained to the filequeue and storage, ordered by the time
+ * the entries were added, so the entries of each thread keep their order, even if the thread moved to another CPU.
+ * The buffers are also drained on LogC_WriteEntriesToDisk(), before the logfile is changed and on LogC_End().
+ * Entries count in LogCStats when they are drained. Can't be used together with a shared memory ring or socket.
+ * The Log-Object must be created with LOGC_OPTION_THREADSAFE.
+ *
+ * @param log           The Log-Object.
+ * @param entriesPerCpu Count of entries each buffer can hold, changing it drains the buffers first.
+ *                      Pass 0 to drain and free the buffers and add entries to the filequeue directly again.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_SetPerCpuBuffers(LogC log,
+                                 size_t entriesPerCpu);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+
+#ifdef LOGC_FEATURE_ENABLE_RECORDER
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_RECORDER is defined.
+ * Flight recorder: entries from minLogType up to the loglevel are not dropped, but kept in a ring of the
+ * calling thread, which overwrites the oldest entry when it's full. Just the format and the raw arguments
+ * are copied (strings by value), they are formatted when an entry of triggerLogType or above is added
+ * by the same thread: then the recorded entries are added first, with their own logtype and time, and the ring is emptied.
+ * They are added with the triggering entry as one batch (@see LogC_BatchCommit()), without entries of other threads in between.
+ * Strings with a precision (e.g. "%.*s") are just read up to the precision, so they don't need a terminating '\0'.
+ * The format must stay valid (e.g. a string literal), like the file- and functionname of each entry.
+ * Formats which can't be recorded raw (e.g. '%n', wide characters or too many arguments) are formatted immediately.
+ * With LOGC_OPTION_THREADSAFE each thread gets its own ring, which is released when the thread exits,
+ * otherwise there's one ring. LogC_IsLogTypeEnabled() is true for the recorded logtypes.
+ * Must be set before the Log-Object is used by other threads, it can just be set once, LogC_End() releases the rings.
+ *
+ * @param log              The Log-Object.
+ * @param minLogType       Lowest logtype which is recorded, must be below the loglevel to record anything.
+ * @param triggerLogType   Entries of this logtype and above write the recorded entries of the thread.
+ * @param entriesPerThread Size of each ring.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_SetFlightRecorder(LogC log,
+                                  int minLogType,
+                                  int triggerLogType,
+                                  size_t entriesPerThread);
+#endif /* LOGC_FEATURE_ENABLE_RECORDER */
+
+#ifdef LOGC_FEATURE_ENABLE_CONTEXT
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_CONTEXT is defined.
+ * Adds a key=value field to the context of the calling thread, which is added to the prefix of each entry
+ * of the thread by Log-Objects with LOGC_OPTION_PREFIX_CONTEXT, e.g. "request=17 tenant=acme".
+ * The context belongs to the thread, not to a Log-Object. The fields are rendered once here,
+ * so adding an entry just copies the text. Up to 16 fields with 255 characters in total are kept per thread.
+ * Entries of the flight recorder get the context of the thread at the time they are written.
+ *
+ * @param key   Name of the field, must not be empty.
+ * @param value Value of the field.
+ *
+ * @return 0 on success, negative value on Error (e.g. the context is full).
+ */
+extern int LogC_ContextPush(const char *key,
+                            const char *value);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_CONTEXT is defined.
+ * Removes the last field added with LogC_ContextPush() by the calling thread.
+ *
+ * @return 0 on success, negative value if the context is empty.
+ */
+extern int LogC_ContextPop(void);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_CONTEXT is defined.
+ * Removes all fields of the calling thread, e.g. before a pooled thread starts the next request.
+ */
+extern void LogC_ContextClear(void);
+#endif /* LOGC_FEATURE_ENABLE_CONTEXT */
+
+#ifdef LOGC_FEATURE_ENABLE_SHM
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_SHM is defined.
+ * Add the entries to a POSIX shared memory ring additionally, adding an entry needs no syscall then.
+ * logc-collector drains the rings of all processes with the same name prefix into one output,
+ * so use a name like "/myapp.<pid>" for each process. The collector removes the ring after
+ * it's closed and drained, see LogC_Shm.h for the layout.
+ * If the ring is full, the backpressure policy is applied, @see LogC_SetBackpressure(),
+ * LOGC_BACKPRESSURE_DROP_OLDEST drops the new entry here, the buffered entries belong to the collector.
+ * An existing ring with the same name is just replaced if its process is gone,
+ * the ring of a running process is never taken over, errno is EEXIST then.
+ *
+ * @param log  The Log-Object.
+ * @param name Name of the shared memory object, must start with '/', see shm_open().
+ *             NULL closes the current ring.
+ * @param size Size of the ring in bytes, rounded up to a power of 2,
+ *             must be at least two times the maximum entry length.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_SetShmRing(LogC log,
+                           const char *name,
+                           size_t size);
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_SOCKET is defined.
+ * Send the entries to a unix domain socket additionally, e.g. to a local syslog daemon or collector.
+ * The entries are collected and sent in batches with one syscall, when the batch is full,
+ * on LogC_SocketFlush(), LogC_StorageGetNextLog() and on LogC_End(). The socket is non-blocking, if it's not connected,
+ * connecting is retried at most once per second while adding entries, so adding entries never waits for the receiver.
+ * Entries which can't be sent, because the socket is gone or the receiver is too slow, are passed to the
+ * fallback if enabled, otherwise they are dropped and counted in LogCStats.
+ *
+ * @param log        The Log-Object.
+ * @param path       Path of the socket, e.g. "/dev/log". NULL closes the current socket.
+ * @param socketType Type of the socket, @see enum LogCSocketType.
+ * @param fallback   If not 0, the logfile and storage of the Log-Object just get the entries which couldn't
+ *                   be sent to the socket. Otherwise the socket is used in addition to them.
+ *
+ * @return 0 on success, also if the socket is not connected yet, negative value on Error.
+ */
+extern int LogC_SetSocket(LogC log,
+                          const char *path,
+                          int socketType,
+                          int fallback);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_SOCKET is defined.
+ * Send the pending entries to the socket.
+ *
+ * @param log The Log-Object.
+ *
+ * @return 0 on success, negative value if entries couldn't be sent and were passed to the fallback or dropped.
+ */
+extern int LogC_SocketFlush(LogC log);
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_PROFILE is defined.
+ * Writes the time spent in each stage of the Log-Object as text:
+ * count, total, percentiles and a log-linear histogram per stage.
+ * The stages are waiting for the mutex, timestamp, prefix, formatting the text, printing to the console,
+ * writing and syncing the logfile, and the whole LOG_TEXT() call.
+ * The times are measured in CPU cycles (TSC) on x86, otherwise in nanoseconds, the unit is written too.
+ *
+ * @param log    The Log-Object
+ * @param stream The stream to write to, e.g. stderr.
+ * @param reset  Pass 1 to clear the measurements afterwards, 0 to keep them.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_DumpProfile(LogC log,
+                            FILE *stream,
+                            int reset);
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
+
+#ifdef LOGC_FEATURE_ENABLE_TRACE
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_TRACE is defined.
+ * Start recording spans into a file in the Chrome trace-event JSON format,
+ * which can be opened with chrome://tracing or https://ui.perfetto.dev.
+ * Each thread records its spans into its own buffer, which is written to the file when it's full,
+ * on LogC_TraceFlush(), LogC_TraceStop() and when the thread exits.
+ * There's just one trace per process, it's independent of the Log-Objects.
+ *
+ * @param path            Path of the trace file, an existing file is replaced.
+ * @param eventsPerThread Count of begin and end events each thread can buffer. The buffer of a thread is
+ *                        kept for the next trace, so the count just applies to threads without one yet.
+ *                        Pass 0 to use 4096.
+ *
+ * @return 0 on success, negative value on Error, e.g. if a trace is already running.
+ */
+extern int LogC_TraceStart(const char *path,
+                           size_t eventsPerThread);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_TRACE is defined.
+ * Write the buffered events of all threads to the trace file.
+ *
+ * @return 0 on success, negative value on Error.
+ */
+extern int LogC_TraceFlush(void);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_TRACE is defined.
+ * Write the buffered events of all threads and close the trace file. Spans recorded afterwards are ignored,
+ * also if they end while the next trace is running.
+ *
+ * @return 0 on success, negative value on Error, e.g. if the file couldn't be written.
+ */
+extern int LogC_TraceStop(void);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_TRACE is defined.
+ * Begin a span in the calling thread, spans of one thread are nested, use LOGC_SPAN_BEGIN().
+ *
+ * @param name Name of the span. Just the pointer is recorded, so it must be valid
+ *             until the trace is written, e.g. a string literal or LOGC_FUNCTIONNAME.
+ *
+ * @return 0 on success, negative value if no trace is running or on Error.
+ */
+extern int LogC_SpanBegin(const char *name);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_TRACE is defined.
+ * End the innermost span of the calling thread, use LOGC_SPAN_END().
+ *
+ * @return 0 on success, negative value if no trace is running or no span was begun.
+ */
+extern int LogC_SpanEnd(void);
+
+  #define LOGC_SPAN_BEGIN(name)      LogC_SpanBegin(name)
+  #define LOGC_SPAN_BEGIN_FUNCTION() LogC_SpanBegin(LOGC_FUNCTIONNAME)
+  #define LOGC_SPAN_END()            LogC_SpanEnd()
+#else /* Compiled out completely */
+  #define LOGC_SPAN_BEGIN(name)      ((void)0)
+  #define LOGC_SPAN_BEGIN_FUNCTION() ((void)0)
+  #define LOGC_SPAN_END()            ((void)0)
+#endif /* LOGC_FEATURE_ENABLE_TRACE */
+
 #ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
 /**
  * This Function is just available if LOGC_FEATURE_ENABLE_ENTRIES_STORAGE is defined.
@@ -245,8 +1022,78 @@ extern int LogC_SetFilePath(LogC log,
  */
 extern char *LogC_StorageGetNextLog(LogC log,
                                     size_t *entryLength);
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_LOG_STORAGE is defined.
+ * Stores a binary payload as it is, without prefix and encoding, e.g. for a later dump by the application.
+ * It's just added to the storage, not to the logfile or other outputs.
+ * The stored text is the payload followed by a '\0', so its length is dataLength+1.
+ *
+ * @param log        The Log-Object
+ * @param logType    The Type for this entry, @see enum ELogType.
+ * @param data       The payload.
+ * @param dataLength Size of the payload in bytes.
+ *
+ * @return 0 on success, negative value on Error, e.g. if the Log-Object has no storage.
+ */
+extern int LogC_StorageAddBinary(LogC log,
+                                 int logType,
+                                 const void *data,
+                                 size_t dataLength);
+
+/**
+ * Filter for LogC_StorageQuery(), all conditions must match.
+ */
+typedef struct
+{
+  /* Just entries of this logtype and above, @see enum LogCType */
+  int iMinLogType;
+  /* Just entries in this timerange, milliseconds since the epoch (UTC), pass 0 for no limit */
+  unsigned long long ullTimeFromMs;
+  unsigned long long ullTimeToMs;
+  /* Just entries after this cursor, @see LogCStorageEntry, pass 0 for no limit */
+  unsigned long long ullAfterCursor;
+  /* Maximum count of entries to return, pass 0 for no limit */
+  size_t szMaxCount;
+}LogCStorageQuery;
+
+/**
+ * Entry returned by LogC_StorageQuery().
+ */
+typedef struct
+{
+  /* Unique and increasing number of the entry, can be passed as ullAfterCursor to continue a query */
+  unsigned long long ullCursor;
+  /* Time when the entry was added, milliseconds since the epoch (UTC) */
+  unsigned long long ullTimeMs;
+  int iLogType;
+  /* Length of the text, equivalent to strlen()+1 */
+  size_t szTextLength;
+  char *pcText;
+}LogCStorageEntry;
+
+/**
+ * This Function is just available if LOGC_FEATURE_ENABLE_LOG_STORAGE is defined.
+ * Returns copies of the stored entries matching the query, in the order they were added.
+ * The entries stay in the storage. The storage keeps a time-ordered index of the entries,
+ * so just the matching range is examined while the Log-Object is locked.
+ *
+ * @param log   The Log-Object
+ * @param query The filter for the entries.
+ * @param count Returns the count of returned entries.
+ *
+ * @return Array of matching entries, free the array after use, the texts are freed with it.
+ *         NULL if there are no matching entries or on Error.
+ */
+extern LogCStorageEntry *LogC_StorageQuery(LogC log,
+                                           const LogCStorageQuery *query,
+                                           size_t *count);
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
 
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
 #endif /* LOGC_H_INCLUDED */
 
 
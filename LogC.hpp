@@ -0,0 +1,554 @@
+#ifndef LOGC_HPP_INCLUDED
+  #define LOGC_HPP_INCLUDED
+
+/**
+ * Header-only C++17 layer over the Log-Object, use LOG_TEXT_CPP() like LOG_TEXT().
+ * The format is parsed at compile time, the count and types of the arguments are checked with static_assert,
+ * and each argument is appended by a serializer for its type instead of vsnprintf().
+ * The text is added with LogC_AddEntry_Message(), so prefix, outputs and truncation are the same as with LOG_TEXT(),
+ * and the text is byte-identical to the one of LOG_TEXT() with the same format and arguments.
+ *
+ * Conversions: d i u o x X c s p f F e E g G a A and %%, with flags, width, precision and length modifiers,
+ * '*' for width or precision and wide characters with %lc or %ls are not supported.
+ * Integers, characters and strings are appended directly, with flags or precision the integers use snprintf()
+ * for just this argument, like the floating point and pointer conversions, so the output matches printf().
+ * %s takes const char*, std::string, std::string_view and user types with a specialization of logc::Formatter.
+ */
+
+#if (__cplusplus < 201703L) && (!defined(_MSVC_LANG) || (_MSVC_LANG < 201703L))
+  #error LogC.hpp needs C++17 or newer!
+#endif /* __cplusplus */
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "LogC.h"
+
+namespace logc
+{
+/**
+ * Appends text to the entry, @see Formatter.
+ */
+class Appender
+{
+public:
+  explicit Appender(std::string &strBuffer) : strBuffer_m(strBuffer) {}
+  void Append(const char *pcText,
+              std::size_t szLength) { strBuffer_m.append(pcText,szLength); }
+  void Append(std::string_view svText) { strBuffer_m.append(svText.data(),svText.size()); }
+  void Append(char cChar) { strBuffer_m.push_back(cChar); }
+
+private:
+  std::string &strBuffer_m;
+};
+
+/**
+ * Specialize this for user types to pass them to %s, width and precision are applied to the appended text:
+ *
+ * template<> struct logc::Formatter<Point>
+ * {
+ *   static void Append(logc::Appender &appender, const Point &point) { ... }
+ * };
+ */
+template<class T>
+struct Formatter;
+
+namespace detail
+{
+enum : unsigned int
+{
+  FLAG_MINUS =0x1,
+  FLAG_PLUS  =0x2,
+  FLAG_SPACE =0x4,
+  FLAG_HASH  =0x8,
+  FLAG_ZERO  =0x10
+};
+
+enum
+{
+  LENGTH_NONE,
+  LENGTH_HH,   /* Integers are converted to char like printf() does */
+  LENGTH_H,    /* Integers are converted to short like printf() does */
+  LENGTH_OTHER /* The type of the argument is used */
+};
+
+/**
+ * One conversion and the literal text in front of it.
+ */
+struct Spec
+{
+  std::size_t szLiteralStart=0; /* In caText of Format */
+  std::size_t szLiteralLength=0;
+  unsigned int uiFlags=0;
+  int iWidth=-1;
+  int iPrecision=-1;
+  int iLength=LENGTH_NONE;
+  char cConversion='\0';
+};
+
+/**
+ * The parsed format, caText holds the literal text with "%%" unescaped.
+ */
+template<std::size_t COUNT,std::size_t SIZE>
+struct Format
+{
+  Spec tagaSpecs[(COUNT)?COUNT:1]={};
+  char caText[SIZE]={};
+  std::size_t szTailStart=0;
+  std::size_t szTailLength=0;
+  bool bInvalid=false;
+  bool bStar=false;
+  bool bWide=false;
+};
+
+constexpr bool IsDigit(char cChar)
+{
+  return((cChar>='0') && (cChar<='9'));
+}
+
+constexpr std::size_t CountSpecs(std::string_view svFormat)
+{
+  std::size_t szCount=0;
+  std::size_t szPos=0;
+
+  for(szPos=0;szPos<svFormat.size();++szPos)
+  {
+    if(svFormat[szPos]!='%')
+      continue;
+    if((szPos+1<svFormat.size()) && (svFormat[szPos+1]=='%'))
+      ++szPos;
+    else
+      ++szCount;
+  }
+  return(szCount);
+}
+
+template<std::size_t COUNT,std::size_t SIZE>
+constexpr Format<COUNT,SIZE> Parse(std::string_view svFormat)
+{
+  Format<COUNT,SIZE> tagFormat{};
+  std::size_t szPos=0;
+  std::size_t szText=0;
+  std::size_t szSpec=0;
+  std::size_t szLiteralStart=0;
+  char cChar='\0';
+  bool bLong=false;
+
+  while(szPos<svFormat.size())
+  {
+    cChar=svFormat[szPos++];
+    if(cChar!='%')
+    {
+      tagFormat.caText[szText++]=cChar;
+      continue;
+    }
+    if((szPos<svFormat.size()) && (svFormat[szPos]=='%'))
+    {
+      tagFormat.caText[szText++]='%';
+      ++szPos;
+      continue;
+    }
+    if(szSpec>=COUNT)
+    {
+      tagFormat.bInvalid=true;
+      return(tagFormat);
+    }
+    Spec &tagSpec=tagFormat.tagaSpecs[szSpec++];
+    tagSpec.szLiteralStart=szLiteralStart;
+    tagSpec.szLiteralLength=szText-szLiteralStart;
+    for(;szPos<svFormat.size();++szPos)
+    {
+      if(svFormat[szPos]=='-')
+        tagSpec.uiFlags|=FLAG_MINUS;
+      else if(svFormat[szPos]=='+')
+        tagSpec.uiFlags|=FLAG_PLUS;
+      else if(svFormat[szPos]==' ')
+        tagSpec.uiFlags|=FLAG_SPACE;
+      else if(svFormat[szPos]=='#')
+        tagSpec.uiFlags|=FLAG_HASH;
+      else if(svFormat[szPos]=='0')
+        tagSpec.uiFlags|=FLAG_ZERO;
+      else
+        break;
+    }
+    if((szPos<svFormat.size()) && (svFormat[szPos]=='*'))
+    {
+      tagFormat.bStar=true;
+      return(tagFormat);
+    }
+    for(;(szPos<svFormat.size()) && (IsDigit(svFormat[szPos]));++szPos)
+      tagSpec.iWidth=((tagSpec.iWidth<0)?0:tagSpec.iWidth*10)+(svFormat[szPos]-'0');
+    if((szPos<svFormat.size()) && (svFormat[szPos]=='.'))
+    {
+      tagSpec.iPrecision=0;
+      if((++szPos<svFormat.size()) && (svFormat[szPos]=='*'))
+      {
+        tagFormat.bStar=true;
+        return(tagFormat);
+      }
+      for(;(szPos<svFormat.size()) && (IsDigit(svFormat[szPos]));++szPos)
+        tagSpec.iPrecision=tagSpec.iPrecision*10+(svFormat[szPos]-'0');
+    }
+    if((szPos+1<svFormat.size()) && (svFormat[szPos]=='h') && (svFormat[szPos+1]=='h'))
+    {
+      tagSpec.iLength=LENGTH_HH;
+      szPos+=2;
+    }
+    else if((szPos+1<svFormat.size()) && (svFormat[szPos]=='l') && (svFormat[szPos+1]=='l'))
+    {
+      tagSpec.iLength=LENGTH_OTHER;
+      szPos+=2;
+    }
+    else if((szPos<svFormat.size()) && (svFormat[szPos]=='h'))
+    {
+      tagSpec.iLength=LENGTH_H;
+      ++szPos;
+    }
+    else if((szPos<svFormat.size()) && (std::string_view("ljztL").find(svFormat[szPos])!=std::string_view::npos))
+    {
+      tagSpec.iLength=LENGTH_OTHER;
+      bLong=(svFormat[szPos++]=='l');
+    }
+    if((szPos>=svFormat.size()) || (std::string_view("diuoxXcspfFeEgGaA").find(svFormat[szPos])==std::string_view::npos))
+    {
+      tagFormat.bInvalid=true;
+      return(tagFormat);
+    }
+    tagSpec.cConversion=svFormat[szPos++];
+    if(((tagSpec.cConversion=='c') || (tagSpec.cConversion=='s')) && (tagSpec.iLength!=LENGTH_NONE))
+    {
+      /* printf() converts %lc and %ls from wide characters, the others are undefined */
+      tagFormat.bWide=bLong;
+      tagFormat.bInvalid=!bLong;
+      return(tagFormat);
+    }
+    szLiteralStart=szText;
+  }
+  tagFormat.szTailStart=szLiteralStart;
+  tagFormat.szTailLength=szText-szLiteralStart;
+  return(tagFormat);
+}
+
+template<class T>
+constexpr bool IsString=std::is_same_v<T,const char*> ||
+                        std::is_same_v<T,char*> ||
+                        std::is_same_v<T,std::string> ||
+                        std::is_same_v<T,std::string_view>;
+
+template<class T,class Enable=void>
+struct HasFormatter : std::false_type {};
+template<class T>
+struct HasFormatter<T,std::void_t<decltype(Formatter<T>::Append(std::declval<Appender&>(),std::declval<const T&>()))>> : std::true_type {};
+
+/**
+ * Check if the argument type fits the conversion, like the format check of the compiler for LOG_TEXT().
+ */
+template<class T>
+constexpr bool Matches(char cConversion)
+{
+  using D=std::decay_t<T>;
+  switch(cConversion)
+  {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+      return(std::is_integral_v<D>);
+    case 's':
+      return((IsString<D>) || (HasFormatter<D>::value));
+    case 'p':
+      return((std::is_pointer_v<D>) || (std::is_null_pointer_v<D>));
+    default:
+      return(std::is_floating_point_v<D>);
+  }
+}
+
+template<class... Args,class F,std::size_t... I>
+constexpr bool CheckArgs(const F &tagFormat,
+                         std::index_sequence<I...>)
+{
+  return((Matches<Args>(tagFormat.tagaSpecs[I].cConversion) && ... && true));
+}
+
+/* Just checked if the count is right, so the specs are not accessed out of range */
+template<std::size_t COUNT,class... Args,class F>
+constexpr bool CheckTypes(const F &tagFormat)
+{
+  if constexpr(COUNT!=sizeof...(Args))
+    return(true);
+  else
+    return(CheckArgs<Args...>(tagFormat,std::index_sequence_for<Args...>{}));
+}
+
+#if defined(__GNUC__)
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wformat-nonliteral" /* The format is built from the parsed spec */
+#endif /* __GNUC__ */
+/**
+ * Append one argument with snprintf(), width and precision are passed as '*' arguments.
+ */
+template<class V>
+inline void AppendPrintf(std::string &strBuffer,
+                         const Spec &tagSpec,
+                         const char *pcLength,
+                         V value)
+{
+  char caSpec[16];
+  char caText[64];
+  std::size_t szSpec=0;
+  std::size_t szOld;
+  int iLength;
+
+  caSpec[szSpec++]='%';
+  if(tagSpec.uiFlags&FLAG_MINUS)
+    caSpec[szSpec++]='-';
+  if(tagSpec.uiFlags&FLAG_PLUS)
+    caSpec[szSpec++]='+';
+  if(tagSpec.uiFlags&FLAG_SPACE)
+    caSpec[szSpec++]=' ';
+  if(tagSpec.uiFlags&FLAG_HASH)
+    caSpec[szSpec++]='#';
+  if(tagSpec.uiFlags&FLAG_ZERO)
+    caSpec[szSpec++]='0';
+  caSpec[szSpec++]='*';
+  caSpec[szSpec++]='.';
+  caSpec[szSpec++]='*';
+  for(;*pcLength;++pcLength)
+    caSpec[szSpec++]=*pcLength;
+  caSpec[szSpec++]=tagSpec.cConversion;
+  caSpec[szSpec]='\0';
+  /* A negative width is ignored like a missing one, a negative precision too */
+  if((iLength=std::snprintf(caText,sizeof(caText),caSpec,(tagSpec.iWidth<0)?0:tagSpec.iWidth,tagSpec.iPrecision,value))<0)
+    return;
+  if(static_cast<std::size_t>(iLength)<sizeof(caText))
+  {
+    strBuffer.append(caText,static_cast<std::size_t>(iLength));
+    return;
+  }
+  szOld=strBuffer.size();
+  strBuffer.resize(szOld+static_cast<std::size_t>(iLength)+1);
+  std::snprintf(&strBuffer[szOld],static_cast<std::size_t>(iLength)+1,caSpec,
+                (tagSpec.iWidth<0)?0:tagSpec.iWidth,tagSpec.iPrecision,value);
+  strBuffer.resize(szOld+static_cast<std::size_t>(iLength));
+}
+#if defined(__GNUC__)
+  #pragma GCC diagnostic pop
+#endif /* __GNUC__ */
+
+/**
+ * Apply precision and width of %s or %c to the text appended since szStart.
+ */
+inline void ApplyWidth(std::string &strBuffer,
+                       const Spec &tagSpec,
+                       std::size_t szStart)
+{
+  std::size_t szLength;
+
+  if((tagSpec.cConversion=='s') && (tagSpec.iPrecision>=0) && (strBuffer.size()-szStart>static_cast<std::size_t>(tagSpec.iPrecision)))
+    strBuffer.resize(szStart+static_cast<std::size_t>(tagSpec.iPrecision));
+  szLength=strBuffer.size()-szStart;
+  if((tagSpec.iWidth<0) || (szLength>=static_cast<std::size_t>(tagSpec.iWidth)))
+    return;
+  if(tagSpec.uiFlags&FLAG_MINUS)
+    strBuffer.append(static_cast<std::size_t>(tagSpec.iWidth)-szLength,' ');
+  else
+    strBuffer.insert(szStart,static_cast<std::size_t>(tagSpec.iWidth)-szLength,' ');
+}
+
+template<class U>
+inline void AppendDigits(std::string &strBuffer,
+                         U uValue,
+                         unsigned int uiBase,
+                         const char *pcDigits)
+{
+  char caDigits[3*sizeof(U)+1];
+  std::size_t szPos=sizeof(caDigits);
+
+  do
+  {
+    caDigits[--szPos]=pcDigits[uValue%uiBase];
+    uValue/=uiBase;
+  }while(uValue);
+  strBuffer.append(&caDigits[szPos],sizeof(caDigits)-szPos);
+}
+
+template<class T>
+inline void AppendInteger(std::string &strBuffer,
+                          const Spec &tagSpec,
+                          T value)
+{
+  using P=decltype(+value); /* Promoted like a vararg */
+  using S=std::make_signed_t<P>;
+  using U=std::make_unsigned_t<P>;
+  std::size_t szStart;
+  long long llValue;
+  unsigned long long ullValue;
+
+  if(tagSpec.cConversion=='c')
+  {
+    szStart=strBuffer.size();
+    strBuffer.push_back(static_cast<char>(static_cast<unsigned char>(value)));
+    ApplyWidth(strBuffer,tagSpec,szStart);
+    return;
+  }
+  if((tagSpec.cConversion=='d') || (tagSpec.cConversion=='i'))
+  {
+    if(tagSpec.iLength==LENGTH_HH)
+      llValue=static_cast<signed char>(value);
+    else if(tagSpec.iLength==LENGTH_H)
+      llValue=static_cast<short>(value);
+    else
+      llValue=static_cast<S>(value);
+    if((tagSpec.uiFlags) || (tagSpec.iWidth>=0) || (tagSpec.iPrecision>=0))
+    {
+      AppendPrintf(strBuffer,tagSpec,"ll",llValue);
+      return;
+    }
+    if(llValue<0)
+    {
+      strBuffer.push_back('-');
+      AppendDigits(strBuffer,0ULL-static_cast<unsigned long long>(llValue),10,"0123456789");
+    }
+    else
+      AppendDigits(strBuffer,static_cast<unsigned long long>(llValue),10,"0123456789");
+    return;
+  }
+  if(tagSpec.iLength==LENGTH_HH)
+    ullValue=static_cast<unsigned char>(value);
+  else if(tagSpec.iLength==LENGTH_H)
+    ullValue=static_cast<unsigned short>(value);
+  else
+    ullValue=static_cast<U>(value);
+  if((tagSpec.uiFlags) || (tagSpec.iWidth>=0) || (tagSpec.iPrecision>=0))
+    AppendPrintf(strBuffer,tagSpec,"ll",ullValue);
+  else if(tagSpec.cConversion=='u')
+    AppendDigits(strBuffer,ullValue,10,"0123456789");
+  else if(tagSpec.cConversion=='o')
+    AppendDigits(strBuffer,ullValue,8,"01234567");
+  else if(tagSpec.cConversion=='x')
+    AppendDigits(strBuffer,ullValue,16,"0123456789abcdef");
+  else
+    AppendDigits(strBuffer,ullValue,16,"0123456789ABCDEF");
+}
+
+template<class T>
+inline void AppendArg(std::string &strBuffer,
+                      const Spec &tagSpec,
+                      const T &value)
+{
+  using D=std::decay_t<T>;
+  std::size_t szStart=strBuffer.size();
+
+  if constexpr(std::is_integral_v<D>)
+    AppendInteger(strBuffer,tagSpec,value);
+  else if constexpr(std::is_floating_point_v<D>)
+  {
+    if constexpr(std::is_same_v<D,long double>)
+      AppendPrintf(strBuffer,tagSpec,"L",value);
+    else
+      AppendPrintf(strBuffer,tagSpec,"",static_cast<double>(value));
+  }
+  else if constexpr((std::is_pointer_v<D>) || (std::is_null_pointer_v<D>))
+  {
+    if constexpr((std::is_same_v<D,const char*>) || (std::is_same_v<D,char*>))
+    {
+      if(tagSpec.cConversion=='s')
+      {
+        const char *pcValue=value;
+        std::size_t szLength=0;
+        if constexpr(!std::is_array_v<T>)
+        {
+          /* Like glibc for NULL */
+          if((!pcValue) && ((tagSpec.iPrecision<0) || (tagSpec.iPrecision>=6)))
+            pcValue="(null)";
+          else if(!pcValue)
+            pcValue="";
+        }
+        /* Like printf(), not more than the precision is read, the text doesn't need a '\0' then */
+        if(tagSpec.iPrecision<0)
+          szLength=std::strlen(pcValue);
+        else
+        {
+          while((szLength<static_cast<std::size_t>(tagSpec.iPrecision)) && (pcValue[szLength]))
+            ++szLength;
+        }
+        strBuffer.append(pcValue,szLength);
+        ApplyWidth(strBuffer,tagSpec,szStart);
+        return;
+      }
+    }
+    AppendPrintf(strBuffer,tagSpec,"",static_cast<const void*>(value));
+  }
+  else if constexpr(IsString<D>)
+  {
+    strBuffer.append(value.data(),value.size());
+    ApplyWidth(strBuffer,tagSpec,szStart);
+  }
+  else
+  {
+    Appender tagAppender(strBuffer);
+    Formatter<D>::Append(tagAppender,value);
+    ApplyWidth(strBuffer,tagSpec,szStart);
+  }
+}
+
+template<class F,class... Args,std::size_t... I>
+inline void AppendAll(std::string &strBuffer,
+                      const F &tagFormat,
+                      std::index_sequence<I...>,
+                      const Args&... args)
+{
+  ((strBuffer.append(&tagFormat.caText[tagFormat.tagaSpecs[I].szLiteralStart],tagFormat.tagaSpecs[I].szLiteralLength),
+    AppendArg(strBuffer,tagFormat.tagaSpecs[I],args)),...);
+  strBuffer.append(&tagFormat.caText[tagFormat.szTailStart],tagFormat.szTailLength);
+}
+} /* namespace detail */
+
+/**
+ * Adds a new entry, it's recommended to use the LOG_TEXT_CPP() Macro instead.
+ * The text is built in a buffer per thread, which keeps its size, so there's no allocation once it's large enough.
+ *
+ * @param FormatType Returns the format with a constexpr Get(), made by LOGC_FORMAT_CPP().
+ *
+ * @return 0 on success, negative value on Error.
+ */
+template<class FormatType,class... Args>
+inline int AddEntry(LogC log,
+                    int logType,
+                    const char *fileName,
+                    int lineNr,
+                    const char *functionName,
+                    FormatType,
+                    const Args&... args)
+{
+  static constexpr std::string_view svFormat=FormatType::Get();
+  static constexpr std::size_t szCount=detail::CountSpecs(svFormat);
+  static constexpr auto tagFormat=detail::Parse<szCount,svFormat.size()+1>(svFormat);
+  static_assert(!tagFormat.bInvalid,"LogC: Invalid conversion in the format");
+  static_assert(!tagFormat.bStar,"LogC: '*' for width or precision is not supported");
+  static_assert(!tagFormat.bWide,"LogC: Wide characters with %lc or %ls are not supported");
+  static_assert(szCount==sizeof...(Args),"LogC: Count of arguments doesn't match the format");
+  static_assert(detail::CheckTypes<szCount,Args...>(tagFormat),"LogC: Type of an argument doesn't match its conversion");
+  thread_local std::string strBuffer;
+
+  if(!LogC_IsLogTypeEnabled(log,logType))
+    return(0);
+  strBuffer.clear();
+  detail::AppendAll(strBuffer,tagFormat,std::index_sequence_for<Args...>{},args...);
+  return(LogC_AddEntry_Message(log,logType,fileName,lineNr,functionName,strBuffer.data(),strBuffer.size()));
+}
+} /* namespace logc */
+
+/* Wraps the format literal into a type, so it can be parsed at compile time */
+#define LOGC_FORMAT_CPP(txt) []{ struct LogCFormat { static constexpr std::string_view Get() { return(txt); } }; return(LogCFormat{}); }()
+
+#if LOGC_OPTVARARG == 1 /* GNUC optional Variadic macro (##__VA_ARGS__) */
+  #define LOG_TEXT_CPP(log,logtype,txt,...) logc::AddEntry(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,LOGC_FORMAT_CPP(txt),##__VA_ARGS__)
+#elif LOGC_OPTVARARG == 2 /* MS-Specific optional Variadic macro (Just __VA_ARGS__) */
+  #define LOG_TEXT_CPP(log,logtype,txt,...) logc::AddEntry(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,LOGC_FORMAT_CPP(txt),__VA_ARGS__)
+#else /* C++20 __VA_OPT__ */
+  #define LOG_TEXT_CPP(log,logtype,txt,...) logc::AddEntry(log,logtype,__FILE__,__LINE__,LOGC_FUNCTIONNAME,LOGC_FORMAT_CPP(txt) __VA_OPT__(,) __VA_ARGS__)
+#endif /* LOGC_OPTVARARG */
+
+#endif /* LOGC_HPP_INCLUDED */
@@ -0,0 +1,207 @@
+/**
+ * logc-bench: Measures the latency of LOG_TEXT() with several threads logging to one Log-Object.
+ *
+ * Each thread adds its entries as fast as possible and records the time of each call,
+ * afterwards the percentiles over all calls and the throughput are printed.
+ * Compare the shared filequeue (default) with the per-CPU buffers (-p, needs LOGC_FEATURE_ENABLE_PERCPU).
+ * For the cross-node traffic on NUMA machines, run both modes under
+ * `perf stat -e node-loads,node-load-misses,node-stores,node-store-misses` or `perf c2c record`.
+ *
+ * Usage: logc-bench [-t threads] [-n entries] [-p entriesPerCpu] [-s timeSource] [-o file]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "LogC.h"
+
+#if !defined(LOGC_FEATURE_ENABLE_LOGFILE) || !defined(LOGC_FEATURE_ENABLE_THREADSAFETY)
+  #error logc-bench needs LOGC_FEATURE_ENABLE_LOGFILE and LOGC_FEATURE_ENABLE_THREADSAFETY!
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE && LOGC_FEATURE_ENABLE_THREADSAFETY */
+
+#define LOGC_BENCH_THREADS 4
+#define LOGC_BENCH_ENTRIES 100000
+#define LOGC_BENCH_FILE    "logc-bench.log"
+
+typedef struct
+{
+  LogC log;
+  int iThread;
+  size_t szEntries;
+  unsigned long long *pullLatencies;
+  int iFailed;
+}TagLogCBenchThread;
+
+static unsigned long long ullLogCBench_GetTimeNs_m(void);
+static void *pvLogCBench_Thread_m(void *pvArg);
+static int iLogCBench_Compare_m(const void *pvA,
+                                const void *pvB);
+
+int main(int argc, char *argv[])
+{
+  LogC log;
+  LogCFile tagFile={0};
+  TagLogCBenchThread *ptagThreads;
+  pthread_t *ptThreads;
+  unsigned long long *pullLatencies;
+  unsigned long long ullStartNs;
+  unsigned long long ullTimeNs;
+  size_t szThreads=LOGC_BENCH_THREADS;
+  size_t szEntries=LOGC_BENCH_ENTRIES;
+  size_t szPerCpu=0;
+  int iTimeSource=LOGC_TIMESOURCE_REALTIME;
+  size_t szTotal;
+  size_t szIndex;
+  int iOpt;
+
+  tagFile.pcFilePath=LOGC_BENCH_FILE;
+  while((iOpt=getopt(argc,argv,"t:n:p:s:o:"))!=-1)
+  {
+    switch(iOpt)
+    {
+      case 't':
+        szThreads=(size_t)strtoul(optarg,NULL,10);
+        break;
+      case 'n':
+        szEntries=(size_t)strtoul(optarg,NULL,10);
+        break;
+      case 'p':
+        szPerCpu=(size_t)strtoul(optarg,NULL,10);
+        break;
+      case 's':
+        iTimeSource=atoi(optarg);
+        break;
+      case 'o':
+        tagFile.pcFilePath=optarg;
+        break;
+      default:
+        optind=argc+1;
+        break;
+    }
+  }
+  if((optind!=argc) || (!szThreads) || (!szEntries))
+  {
+    fprintf(stderr,"Usage: %s [-t threads] [-n entries] [-p entriesPerCpu] [-s timeSource] [-o file]\n"
+                   "  -t threads        Count of logging threads, default %d\n"
+                   "  -n entries        Entries per thread, default %d\n"
+                   "  -p entriesPerCpu  Use per-CPU buffers of this size, default 0 (shared filequeue)\n"
+                   "  -s timeSource     Clock for the timestamps, see enum LogCTimeSource, default 0 (realtime)\n"
+                   "  -o file           Logfile, default %s\n",
+            argv[0],LOGC_BENCH_THREADS,LOGC_BENCH_ENTRIES,LOGC_BENCH_FILE);
+    return(EXIT_FAILURE);
+  }
+  remove(tagFile.pcFilePath);
+  if(!(log=LogC_New(LOGC_ALL,
+                    200,
+                    LOGC_OPTION_PREFIX_TIMESTAMP_TIME|LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MILLISECS|LOGC_OPTION_PREFIX_LOGTYPETEXT|
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR|LOGC_OPTION_THREADSAFE
+                    ,&tagFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    fputs("LogC_New() failed\n",stderr);
+    return(EXIT_FAILURE);
+  }
+  if(LogC_SetTimeSource(log,iTimeSource))
+  {
+    fputs("LogC_SetTimeSource() failed\n",stderr);
+    return(EXIT_FAILURE);
+  }
+  if(szPerCpu)
+  {
+#ifdef LOGC_FEATURE_ENABLE_PERCPU
+    if(LogC_SetPerCpuBuffers(log,szPerCpu))
+    {
+      fputs("LogC_SetPerCpuBuffers() failed\n",stderr);
+      return(EXIT_FAILURE);
+    }
+#else
+    fputs("-p needs LOGC_FEATURE_ENABLE_PERCPU\n",stderr);
+    return(EXIT_FAILURE);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU */
+  }
+  szTotal=szThreads*szEntries;
+  ptagThreads=calloc(szThreads,sizeof(TagLogCBenchThread));
+  ptThreads=calloc(szThreads,sizeof(pthread_t));
+  pullLatencies=malloc(szTotal*sizeof(unsigned long long));
+  if((!ptagThreads) || (!ptThreads) || (!pullLatencies))
+  {
+    fputs("Out of memory\n",stderr);
+    return(EXIT_FAILURE);
+  }
+
+  ullStartNs=ullLogCBench_GetTimeNs_m();
+  for(szIndex=0;szIndex<szThreads;++szIndex)
+  {
+    ptagThreads[szIndex].log=log;
+    ptagThreads[szIndex].iThread=(int)szIndex;
+    ptagThreads[szIndex].szEntries=szEntries;
+    ptagThreads[szIndex].pullLatencies=&pullLatencies[szIndex*szEntries];
+    if(pthread_create(&ptThreads[szIndex],NULL,pvLogCBench_Thread_m,&ptagThreads[szIndex]))
+    {
+      fputs("pthread_create() failed\n",stderr);
+      return(EXIT_FAILURE);
+    }
+  }
+  for(szIndex=0;szIndex<szThreads;++szIndex)
+  {
+    pthread_join(ptThreads[szIndex],NULL);
+    if(ptagThreads[szIndex].iFailed)
+      fprintf(stderr,"Thread %d: LOG_TEXT() failed\n",ptagThreads[szIndex].iThread);
+  }
+  ullTimeNs=ullLogCBench_GetTimeNs_m()-ullStartNs;
+  if(LogC_End(log))
+    fputs("LogC_End() failed\n",stderr);
+
+  qsort(pullLatencies,szTotal,sizeof(unsigned long long),iLogCBench_Compare_m);
+  printf("mode=%s threads=%lu entries=%lu\n",
+         (szPerCpu)?"per-cpu":"shared",(unsigned long)szThreads,(unsigned long)szTotal);
+  printf("time=%.3fs throughput=%.0f entries/s\n",
+         ullTimeNs/1e9,szTotal/(ullTimeNs/1e9));
+  printf("latency ns: p50=%llu p90=%llu p99=%llu p99.9=%llu max=%llu\n",
+         pullLatencies[szTotal*50/100],
+         pullLatencies[szTotal*90/100],
+         pullLatencies[szTotal*99/100],
+         pullLatencies[szTotal*999/1000],
+         pullLatencies[szTotal-1]);
+  free(pullLatencies);
+  free(ptThreads);
+  free(ptagThreads);
+  return(EXIT_SUCCESS);
+}
+
+static unsigned long long ullLogCBench_GetTimeNs_m(void)
+{
+  struct timespec tagTime;
+  clock_gettime(CLOCK_MONOTONIC,&tagTime);
+  return((unsigned long long)tagTime.tv_sec*1000000000ULL+(unsigned long long)tagTime.tv_nsec);
+}
+
+static void *pvLogCBench_Thread_m(void *pvArg)
+{
+  TagLogCBenchThread *ptagThread=pvArg;
+  unsigned long long ullStartNs;
+  size_t szIndex;
+
+  for(szIndex=0;szIndex<ptagThread->szEntries;++szIndex)
+  {
+    ullStartNs=ullLogCBench_GetTimeNs_m();
+    if(LOG_TEXT(ptagThread->log,LOGC_INFO,"Thread %d, entry %lu, value %f",
+                ptagThread->iThread,(unsigned long)szIndex,szIndex*0.5))
+      ptagThread->iFailed=1;
+    ptagThread->pullLatencies[szIndex]=ullLogCBench_GetTimeNs_m()-ullStartNs;
+  }
+  return(NULL);
+}
+
+static int iLogCBench_Compare_m(const void *pvA,
+                                const void *pvB)
+{
+  unsigned long long ullA=*(const unsigned long long*)pvA;
+  unsigned long long ullB=*(const unsigned long long*)pvB;
+  return((ullA>ullB)-(ullA<ullB));
+}
@@ -0,0 +1,395 @@
+/**
+ * logc-collector: Drains the shared memory rings written by LogC (LOGC_FEATURE_ENABLE_SHM) into one output.
+ *
+ * The rings are found by their name prefix in /dev/shm, see LogC_SetShmRing() in LogC.h.
+ * Each pass writes the available entries of all rings with one writev() call, directly from the shared memory,
+ * the ring space is released to the writers after the write. The rings just contain complete entries,
+ * so entries of diffrent processes are never mixed up within a line.
+ * A ring is removed after it's drained and its writer closed it or the writer process is gone.
+ *
+ * Usage: logc-collector [-o file] [-i pollMs] [-r rescanMs] [-e] prefix
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include "LogC_Shm.h"
+
+#define LOGC_COLLECTOR_SHMDIR         "/dev/shm"
+#define LOGC_COLLECTOR_POLL_MS        5    /* Sleep if the rings are empty, longer sleeps give bigger batches */
+#define LOGC_COLLECTOR_RESCAN_MS      1000 /* Look for new rings */
+#define LOGC_COLLECTOR_IOV_MAX        1024 /* Iovecs per writev(), 2 per ring if the data wraps */
+
+/**
+ * A ring of one writer, mapped by the collector.
+ */
+struct TagLogCCollectorRing_t
+{
+  char caName[NAME_MAX+2]; /* Including the leading '/' */
+  LogCShmHeader *ptagHeader;
+  const char *pcData;
+  size_t szDataSize;
+  dev_t tDev;              /* Identifies the object, the name may be reused by a new ring */
+  ino_t tIno;
+  unsigned long long ullPending; /* Bytes added to the current writev() */
+  struct TagLogCCollectorRing_t *ptagNext;
+};
+typedef struct TagLogCCollectorRing_t TagLogCCollectorRing;
+
+static volatile sig_atomic_t iStop_m;
+
+static void vLogCCollector_Signal_m(int iSignal);
+static unsigned long long ullLogCCollector_GetTimeMs_m(void);
+static int iLogCCollector_Scan_m(const char *pcPrefix,
+                                 TagLogCCollectorRing **pptagRings);
+static TagLogCCollectorRing *ptagLogCCollector_Open_m(const char *pcName);
+static int iLogCCollector_Drain_m(int iFd,
+                                  TagLogCCollectorRing *ptagRings,
+                                  size_t *pszBytes);
+static int iLogCCollector_Commit_m(int iFd,
+                                   struct iovec *ptagIov,
+                                   int iIovCount,
+                                   TagLogCCollectorRing *ptagRings);
+static int iLogCCollector_Finished_m(const TagLogCCollectorRing *ptagRing);
+static void vLogCCollector_Close_m(TagLogCCollectorRing *ptagRing,
+                                   int iRemove);
+
+int main(int argc, char *argv[])
+{
+  TagLogCCollectorRing *ptagRings=NULL;
+  TagLogCCollectorRing **pptagRing;
+  TagLogCCollectorRing *ptagTmp;
+  struct sigaction tagAction;
+  struct timespec tagSleep;
+  unsigned long long ullLastScanMs=0;
+  unsigned int uiPollMs=LOGC_COLLECTOR_POLL_MS;
+  unsigned int uiRescanMs=LOGC_COLLECTOR_RESCAN_MS;
+  const char *pcPrefix;
+  size_t szBytes;
+  int iExitIfIdle=0;
+  int iRingsFound=0;
+  int iFd=STDOUT_FILENO;
+  int iOpt;
+
+  while((iOpt=getopt(argc,argv,"o:i:r:e"))!=-1)
+  {
+    switch(iOpt)
+    {
+      case 'o':
+        if((iFd=open(optarg,O_WRONLY|O_CREAT|O_APPEND,0644))<0)
+        {
+          perror(optarg);
+          return(EXIT_FAILURE);
+        }
+        break;
+      case 'i':
+        uiPollMs=(unsigned int)strtoul(optarg,NULL,10);
+        break;
+      case 'r':
+        uiRescanMs=(unsigned int)strtoul(optarg,NULL,10);
+        break;
+      case 'e':
+        iExitIfIdle=1;
+        break;
+      default:
+        optind=argc+1;
+        break;
+    }
+  }
+  if(optind!=argc-1)
+  {
+    fprintf(stderr,"Usage: %s [-o file] [-i pollMs] [-r rescanMs] [-e] prefix\n"
+                   "  -o file       Append the entries to this file, default is stdout\n"
+                   "  -i pollMs     Sleep time if all rings are empty, default %u\n"
+                   "  -r rescanMs   Interval for looking for new rings, default %u\n"
+                   "  -e            Exit if all rings are removed, after at least one ring was found\n"
+                   "  prefix        Collect all rings with a name starting with this prefix, e.g. /myapp.\n",
+            argv[0],LOGC_COLLECTOR_POLL_MS,LOGC_COLLECTOR_RESCAN_MS);
+    return(EXIT_FAILURE);
+  }
+  pcPrefix=argv[optind];
+  if(*pcPrefix=='/')
+    ++pcPrefix;
+
+  memset(&tagAction,0,sizeof(tagAction));
+  tagAction.sa_handler=vLogCCollector_Signal_m;
+  sigaction(SIGINT,&tagAction,NULL);
+  sigaction(SIGTERM,&tagAction,NULL);
+
+  tagSleep.tv_sec=uiPollMs/1000;
+  tagSleep.tv_nsec=(long)(uiPollMs%1000)*1000000L;
+  for(;;)
+  {
+    if((!ullLastScanMs) || (ullLogCCollector_GetTimeMs_m()-ullLastScanMs>=uiRescanMs))
+    {
+      if(iLogCCollector_Scan_m(pcPrefix,&ptagRings))
+        return(EXIT_FAILURE);
+      ullLastScanMs=ullLogCCollector_GetTimeMs_m();
+    }
+    if(iLogCCollector_Drain_m(iFd,ptagRings,&szBytes))
+    {
+      perror("writev");
+      return(EXIT_FAILURE);
+    }
+    if(iStop_m) /* Drained a last time after the signal */
+      break;
+    /* Remove the finished rings */
+    pptagRing=&ptagRings;
+    while(*pptagRing)
+    {
+      if(iLogCCollector_Finished_m(*pptagRing))
+      {
+        ptagTmp=*pptagRing;
+        *pptagRing=ptagTmp->ptagNext;
+        vLogCCollector_Close_m(ptagTmp,1);
+      }
+      else
+      {
+        pptagRing=&(*pptagRing)->ptagNext;
+      }
+    }
+    if(ptagRings)
+      iRingsFound=1;
+    else if((iExitIfIdle) && (iRingsFound))
+      break;
+    if(!szBytes)
+      nanosleep(&tagSleep,NULL);
+  }
+  while(ptagRings)
+  {
+    ptagTmp=ptagRings;
+    ptagRings=ptagRings->ptagNext;
+    vLogCCollector_Close_m(ptagTmp,0);
+  }
+  if(iFd!=STDOUT_FILENO)
+    close(iFd);
+  return(EXIT_SUCCESS);
+}
+
+static void vLogCCollector_Signal_m(int iSignal)
+{
+  (void)iSignal;
+  iStop_m=1;
+}
+
+static unsigned long long ullLogCCollector_GetTimeMs_m(void)
+{
+  struct timespec tagTime;
+  clock_gettime(CLOCK_MONOTONIC,&tagTime);
+  return((unsigned long long)tagTime.tv_sec*1000ULL+(unsigned long long)tagTime.tv_nsec/1000000ULL);
+}
+
+/**
+ * Map all new rings with the prefix.
+ */
+static int iLogCCollector_Scan_m(const char *pcPrefix,
+                                 TagLogCCollectorRing **pptagRings)
+{
+  DIR *ptagDir;
+  struct dirent *ptagDirEntry;
+  TagLogCCollectorRing *ptagRing;
+  size_t szPrefixLength=strlen(pcPrefix);
+  char caName[NAME_MAX+2];
+
+  if(!(ptagDir=opendir(LOGC_COLLECTOR_SHMDIR)))
+  {
+    perror(LOGC_COLLECTOR_SHMDIR);
+    return(-1);
+  }
+  while((ptagDirEntry=readdir(ptagDir)))
+  {
+    if(strncmp(ptagDirEntry->d_name,pcPrefix,szPrefixLength))
+      continue;
+    caName[0]='/';
+    strcpy(&caName[1],ptagDirEntry->d_name);
+    for(ptagRing=*pptagRings;ptagRing;ptagRing=ptagRing->ptagNext)
+    {
+      if(!strcmp(ptagRing->caName,caName))
+        break;
+    }
+    if(ptagRing) /* Already mapped */
+      continue;
+    /* Not mapped if it's not a ring or still initialized, tried again with the next scan */
+    if((ptagRing=ptagLogCCollector_Open_m(caName)))
+    {
+      ptagRing->ptagNext=*pptagRings;
+      *pptagRings=ptagRing;
+    }
+  }
+  closedir(ptagDir);
+  return(0);
+}
+
+static TagLogCCollectorRing *ptagLogCCollector_Open_m(const char *pcName)
+{
+  TagLogCCollectorRing *ptagRing;
+  LogCShmHeader *ptagHeader;
+  struct stat tagStat;
+  int iFd;
+
+  if((iFd=shm_open(pcName,O_RDWR,0))<0)
+    return(NULL);
+  if((fstat(iFd,&tagStat)) ||
+     ((size_t)tagStat.st_size<sizeof(LogCShmHeader)) ||
+     ((ptagHeader=mmap(NULL,(size_t)tagStat.st_size,PROT_READ|PROT_WRITE,MAP_SHARED,iFd,0))==MAP_FAILED))
+  {
+    close(iFd);
+    return(NULL);
+  }
+  close(iFd);
+  if((LOGC_SHM_LOAD_ACQUIRE(&ptagHeader->uiMagic)!=LOGC_SHM_MAGIC) ||
+     (ptagHeader->uiVersion!=LOGC_SHM_VERSION) ||
+     (ptagHeader->ullDataSize&(ptagHeader->ullDataSize-1)) ||
+     (sizeof(LogCShmHeader)+ptagHeader->ullDataSize!=(unsigned long long)tagStat.st_size) ||
+     (!(ptagRing=malloc(sizeof(TagLogCCollectorRing)))))
+  {
+    munmap(ptagHeader,(size_t)tagStat.st_size);
+    return(NULL);
+  }
+  strcpy(ptagRing->caName,pcName);
+  ptagRing->ptagHeader=ptagHeader;
+  ptagRing->pcData=((const char*)ptagHeader)+sizeof(LogCShmHeader);
+  ptagRing->szDataSize=(size_t)ptagHeader->ullDataSize;
+  ptagRing->tDev=tagStat.st_dev;
+  ptagRing->tIno=tagStat.st_ino;
+  ptagRing->ullPending=0;
+  ptagRing->ptagNext=NULL;
+  return(ptagRing);
+}
+
+/**
+ * Write the available entries of all rings, with one writev() for up to LOGC_COLLECTOR_IOV_MAX/2 rings.
+ *
+ * @param pszBytes Returns the count of written bytes.
+ */
+static int iLogCCollector_Drain_m(int iFd,
+                                  TagLogCCollectorRing *ptagRings,
+                                  size_t *pszBytes)
+{
+  struct iovec taIov[LOGC_COLLECTOR_IOV_MAX];
+  TagLogCCollectorRing *ptagRing;
+  TagLogCCollectorRing *ptagFirst=ptagRings;
+  unsigned long long ullHead;
+  unsigned long long ullTail;
+  size_t szPos;
+  size_t szLength;
+  int iIovCount=0;
+
+  *pszBytes=0;
+  for(ptagRing=ptagRings;ptagRing;ptagRing=ptagRing->ptagNext)
+  {
+    ullHead=LOGC_SHM_LOAD_ACQUIRE(&ptagRing->ptagHeader->ullHead);
+    ullTail=ptagRing->ptagHeader->ullTail; /* Just changed by this reader */
+    if((ullHead==ullTail) || (ullHead-ullTail>ptagRing->szDataSize)) /* Empty or broken */
+      continue;
+    if(iIovCount>LOGC_COLLECTOR_IOV_MAX-2)
+    {
+      if(iLogCCollector_Commit_m(iFd,taIov,iIovCount,ptagFirst))
+        return(-1);
+      iIovCount=0;
+      ptagFirst=ptagRing;
+    }
+    ptagRing->ullPending=ullHead-ullTail;
+    *pszBytes+=(size_t)ptagRing->ullPending;
+    szPos=(size_t)ullTail&(ptagRing->szDataSize-1);
+    szLength=ptagRing->szDataSize-szPos;
+    if(szLength>ptagRing->ullPending)
+      szLength=(size_t)ptagRing->ullPending;
+    taIov[iIovCount].iov_base=(void*)&ptagRing->pcData[szPos];
+    taIov[iIovCount++].iov_len=szLength;
+    if(szLength<ptagRing->ullPending) /* Wrapped around */
+    {
+      taIov[iIovCount].iov_base=(void*)ptagRing->pcData;
+      taIov[iIovCount++].iov_len=(size_t)ptagRing->ullPending-szLength;
+    }
+  }
+  if(iIovCount)
+    return(iLogCCollector_Commit_m(iFd,taIov,iIovCount,ptagFirst));
+  return(0);
+}
+
+/**
+ * Write the iovecs completely and release the written data of the rings to their writers.
+ */
+static int iLogCCollector_Commit_m(int iFd,
+                                   struct iovec *ptagIov,
+                                   int iIovCount,
+                                   TagLogCCollectorRing *ptagRings)
+{
+  TagLogCCollectorRing *ptagRing;
+  ssize_t sszWritten;
+
+  while(iIovCount)
+  {
+    if((sszWritten=writev(iFd,ptagIov,iIovCount))<0)
+    {
+      if(errno==EINTR)
+        continue;
+      return(-1);
+    }
+    while((iIovCount) && ((size_t)sszWritten>=ptagIov->iov_len))
+    {
+      sszWritten-=(ssize_t)ptagIov->iov_len;
+      ++ptagIov;
+      --iIovCount;
+    }
+    if(iIovCount)
+    {
+      ptagIov->iov_base=(char*)ptagIov->iov_base+sszWritten;
+      ptagIov->iov_len-=(size_t)sszWritten;
+    }
+  }
+  for(ptagRing=ptagRings;ptagRing;ptagRing=ptagRing->ptagNext)
+  {
+    if(ptagRing->ullPending)
+    {
+      LOGC_SHM_STORE_RELEASE(&ptagRing->ptagHeader->ullTail,ptagRing->ptagHeader->ullTail+ptagRing->ullPending);
+      ptagRing->ullPending=0;
+    }
+  }
+  return(0);
+}
+
+/**
+ * Check if the ring is drained and no more entries are added.
+ */
+static int iLogCCollector_Finished_m(const TagLogCCollectorRing *ptagRing)
+{
+  int iClosed=(LOGC_SHM_LOAD_ACQUIRE(&ptagRing->ptagHeader->ullClosed)!=0);
+  /* The writer process may be gone without closing the ring */
+  if((!iClosed) &&
+     (kill((pid_t)ptagRing->ptagHeader->ullPid,0)) &&
+     (errno==ESRCH))
+    iClosed=1;
+  /* Check the head after the closed state, entries may be added until it's closed */
+  return((iClosed) &&
+         (LOGC_SHM_LOAD_ACQUIRE(&ptagRing->ptagHeader->ullHead)==ptagRing->ptagHeader->ullTail));
+}
+
+/**
+ * Unmap the ring, remove the shared memory object too if it's not replaced by a new ring meanwhile.
+ */
+static void vLogCCollector_Close_m(TagLogCCollectorRing *ptagRing,
+                                   int iRemove)
+{
+  struct stat tagStat;
+  int iFd;
+
+  if((iRemove) && ((iFd=shm_open(ptagRing->caName,O_RDONLY,0))>=0))
+  {
+    if((!fstat(iFd,&tagStat)) && (tagStat.st_dev==ptagRing->tDev) && (tagStat.st_ino==ptagRing->tIno))
+      shm_unlink(ptagRing->caName);
+    close(iFd);
+  }
+  munmap(ptagRing->ptagHeader,sizeof(LogCShmHeader)+ptagRing->szDataSize);
+  free(ptagRing);
+}
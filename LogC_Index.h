@@ -0,0 +1,29 @@
+#ifndef LOGC_INDEX_H_INCLUDED
+  #define LOGC_INDEX_H_INCLUDED
+
+/**
+ * Layout of the sparse time index written next to the logfile by LogC (see LogC_SetFileIndex())
+ * and used by logc-read to skip the parts of the logfile which can't match the filter.
+ *
+ * The index is a file with the path of the logfile and LOGC_INDEX_SUFFIX, it's just an array of records
+ * in the byte order of the writer. Each record describes one block of entries, the blocks follow each other
+ * in the logfile, so the offsets never decrease. Bytes of the logfile without a record (written before the index
+ * was started, or the last block which isn't complete yet) must be read anyway.
+ * The times are taken when the entries reach the filequeue, entries added later than they were formatted
+ * (e.g. dumps of the flight recorder) are indexed with that later time.
+ */
+
+#define LOGC_INDEX_MAGIC  0x78644943U /* "CIdx" */
+#define LOGC_INDEX_SUFFIX ".idx"
+
+typedef struct
+{
+  unsigned int uiMagic;
+  unsigned int uiLogTypes;           /* Bit n is set if the block has an entry of the n-th logtype: Debug++, Debug, Info, Warning, Error, Fatal */
+  unsigned long long ullOffset;      /* Position of the first entry of the block in the logfile */
+  unsigned long long ullLength;      /* Length of all entries of the block */
+  unsigned long long ullFirstTimeMs; /* Wall clock time of the first and the last entry, ms since the epoch */
+  unsigned long long ullLastTimeMs;
+}LogCIndexRecord;
+
+#endif /* LOGC_INDEX_H_INCLUDED */
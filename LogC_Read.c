@@ -0,0 +1,792 @@
+/**
+ * logc-read: Fast reader and filter for logfiles written by LogC.
+ *
+ * The file is mapped into memory and split into chunks at line boundaries,
+ * each chunk is filtered by its own thread, the output keeps the order of the file.
+ * The prefixes are parsed as written by iLogC_AddTimeStamp_m() and iLogC_AddPrefix_m() in LogC.c,
+ * e.g. 2018-10-03_12:34:56.789 [Error]"myfile.c"@line 123, in function "main()": Text
+ * If the file has an index (see LogC_SetFileIndex() and LogC_Index.h), just the blocks which can match
+ * the logtype and the timerange are read.
+ *
+ * Usage: logc-read [-l level] [-f from] [-t to] [-L] [-s sourcefile] [-g text] [-j threads] [-c] file
+ */
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE /* For memrchr(), memmem() */
+#endif /* __linux__ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h> /* For strncasecmp() */
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "LogC_Index.h"
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif /* __SSE2__ */
+
+#define LOGC_READ_MAX_THREADS   64
+#define LOGC_READ_MIN_CHUNKSIZE (1024*1024) /* Smaller files are not split */
+#define LOGC_READ_OUTBUFFERSIZE (64*1024)
+#define LOGC_READ_INDEX_SLACKMS 1000 /* Timestamps of the entries may differ a bit from the times in the index */
+
+/**
+ * Logtypes as printed by LogC, keep in sync with tagLogTypes_m in LogC.c
+ */
+static const struct
+{
+  int iLogType;
+  const char *pcText;
+}tagLogTypes_m[]=
+{
+  {100,  "Debug++"},
+  {200,  "Debug"},
+  {300,  "Info"},
+  {1000, "Warning"},
+  {1100, "Error"},
+  {1200, "Fatal"},
+};
+
+/**
+ * The filter options, set from the commandline.
+ */
+typedef struct
+{
+  int iMinLogType;           /* 0 if not set */
+  const char *pcTimeFrom;    /* Compared with the part of the timestamp of each entry with the same layout */
+  size_t szTimeFromLength;
+  const char *pcTimeTo;
+  size_t szTimeToLength;
+  const char *pcSourceFile;  /* Substring of the filename in the fileinfo prefix */
+  size_t szSourceFileLength;
+  const char *pcText;        /* Substring of the whole line */
+  size_t szTextLength;
+  int iCountOnly;
+  int iLocalTime;                  /* The timestamps are in localtime, not UTC */
+  unsigned long long ullIndexFromMs; /* Timerange for the index, just set if the filter has a date */
+  unsigned long long ullIndexToMs;
+}TagLogCReadFilter;
+
+/**
+ * Part of the file which has to be read, starts and ends at line boundaries.
+ */
+typedef struct
+{
+  const char *pcStart;
+  const char *pcEnd;
+}TagLogCReadRange;
+
+/**
+ * A chunk of the file, processed by one thread.
+ */
+typedef struct
+{
+  const TagLogCReadFilter *ptagFilter;
+  const TagLogCReadRange *ptagRanges; /* Just the parts of the chunk in these ranges are read */
+  size_t szRangeCount;
+  const char *pcStart;
+  const char *pcEnd;
+  char *pcOut;           /* Matching lines */
+  size_t szOutLength;
+  size_t szOutSize;
+  unsigned long ulMatches;
+  int iError;
+}TagLogCReadChunk;
+
+static int iLogCRead_ParseArgs_m(int argc,
+                                 char *argv[],
+                                 TagLogCReadFilter *ptagFilter,
+                                 unsigned int *puiThreads,
+                                 const char **ppcPath);
+static int iLogCRead_ParseTime_m(const char *pcText,
+                                 int iLocalTime,
+                                 unsigned long long *pullFromMs,
+                                 unsigned long long *pullToMs);
+static int iLogCRead_CheckTime_m(const char *pcText,
+                                 size_t szLength);
+static int iLogCRead_SameLayout_m(const char *pcText1,
+                                  const char *pcText2,
+                                  size_t szLength);
+static int iLogCRead_IndexRanges_m(const char *pcPath,
+                                   const TagLogCReadFilter *ptagFilter,
+                                   const char *pcData,
+                                   size_t szSize,
+                                   TagLogCReadRange **pptagRanges,
+                                   size_t *pszRangeCount);
+static void vLogCRead_AddRange_m(TagLogCReadRange *ptagRanges,
+                                 size_t *pszRangeCount,
+                                 const char *pcData,
+                                 size_t szSize,
+                                 unsigned long long ullStart,
+                                 unsigned long long ullEnd);
+static void *pvLogCRead_ChunkThread_m(void *pvChunk);
+static int iLogCRead_ScanRange_m(TagLogCReadChunk *ptagChunk,
+                                 const char *pcPos,
+                                 const char *pcEnd);
+static int iLogCRead_LineMatches_m(const TagLogCReadFilter *ptagFilter,
+                                   const char *pcLine,
+                                   const char *pcLineEnd);
+static const char *pcLogCRead_TimePart_m(const char *pcTime,
+                                         size_t szTimeLength,
+                                         const char *pcFilter,
+                                         size_t szFilterLength);
+static int iLogCRead_AddLine_m(TagLogCReadChunk *ptagChunk,
+                               const char *pcLine,
+                               const char *pcLineEnd);
+static const char *pcLogCRead_Find_m(const char *pcHaystack,
+                                     size_t szHaystackLength,
+                                     const char *pcNeedle,
+                                     size_t szNeedleLength);
+static int iLogCRead_GetLogType_m(const char *pcText,
+                                  size_t szLength);
+
+int main(int argc, char *argv[])
+{
+  TagLogCReadFilter tagFilter;
+  TagLogCReadChunk taChunks[LOGC_READ_MAX_THREADS];
+  pthread_t taThreads[LOGC_READ_MAX_THREADS];
+  TagLogCReadRange tagWholeFile;
+  TagLogCReadRange *ptagRanges=NULL;
+  size_t szRangeCount;
+  unsigned int uiThreads;
+  unsigned int uiStarted;
+  unsigned int uiIndex;
+  unsigned long ulMatches=0;
+  const char *pcPath;
+  const char *pcData;
+  const char *pcChunkStart;
+  const char *pcChunkEnd;
+  struct stat tagStat;
+  size_t szChunkSize;
+  int iFd;
+  int iRc=EXIT_SUCCESS;
+
+  if(iLogCRead_ParseArgs_m(argc,argv,&tagFilter,&uiThreads,&pcPath))
+  {
+    fprintf(stderr,"Usage: %s [-l level] [-f from] [-t to] [-L] [-s sourcefile] [-g text] [-j threads] [-c] file\n"
+                   "  -l level      Just entries of this logtype and above, e.g. Warning\n"
+                   "  -f/-t time    Just entries in this timerange, compared with the part of the timestamp prefix\n"
+                   "                with the same layout, e.g. 2018-10-03_12:34, or 12:34:56 for the time of each day\n"
+                   "  -L            The timestamps are in localtime (default UTC), for the index of the file\n"
+                   "  -s sourcefile Just entries with this text in the filename of the fileinfo prefix\n"
+                   "  -g text       Just entries containing this text\n"
+                   "  -j threads    Count of threads, default is the count of online CPUs\n"
+                   "  -c            Just print the count of matching entries\n",
+            argv[0]);
+    return(EXIT_FAILURE);
+  }
+  if(((iFd=open(pcPath,O_RDONLY))<0) || (fstat(iFd,&tagStat)))
+  {
+    perror(pcPath);
+    return(EXIT_FAILURE);
+  }
+  if(!tagStat.st_size)
+  {
+    close(iFd);
+    if(tagFilter.iCountOnly)
+      puts("0");
+    return(EXIT_SUCCESS);
+  }
+  if((pcData=mmap(NULL,(size_t)tagStat.st_size,PROT_READ,MAP_PRIVATE,iFd,0))==MAP_FAILED)
+  {
+    perror("mmap");
+    close(iFd);
+    return(EXIT_FAILURE);
+  }
+  close(iFd);
+  if(iLogCRead_IndexRanges_m(pcPath,&tagFilter,pcData,(size_t)tagStat.st_size,&ptagRanges,&szRangeCount))
+  {
+    /* No index which can be used for the filter, read the whole file */
+    madvise((void*)pcData,(size_t)tagStat.st_size,MADV_SEQUENTIAL);
+    tagWholeFile.pcStart=pcData;
+    tagWholeFile.pcEnd=pcData+tagStat.st_size;
+    ptagRanges=&tagWholeFile;
+    szRangeCount=1;
+  }
+
+  /* Split into chunks at line boundaries */
+  szChunkSize=(size_t)tagStat.st_size/uiThreads;
+  if(szChunkSize<LOGC_READ_MIN_CHUNKSIZE)
+  {
+    szChunkSize=LOGC_READ_MIN_CHUNKSIZE;
+    uiThreads=(unsigned int)((size_t)tagStat.st_size/szChunkSize+1);
+  }
+  pcChunkStart=pcData;
+  for(uiIndex=0;(uiIndex<uiThreads) && (pcChunkStart<pcData+tagStat.st_size);++uiIndex)
+  {
+    if((uiIndex==uiThreads-1) || ((size_t)(pcData+tagStat.st_size-pcChunkStart)<=szChunkSize))
+      pcChunkEnd=pcData+tagStat.st_size;
+    else if((pcChunkEnd=memchr(pcChunkStart+szChunkSize,'\n',(size_t)(pcData+tagStat.st_size-pcChunkStart)-szChunkSize)))
+      ++pcChunkEnd;
+    else
+      pcChunkEnd=pcData+tagStat.st_size;
+    memset(&taChunks[uiIndex],0,sizeof(TagLogCReadChunk));
+    taChunks[uiIndex].ptagFilter=&tagFilter;
+    taChunks[uiIndex].ptagRanges=ptagRanges;
+    taChunks[uiIndex].szRangeCount=szRangeCount;
+    taChunks[uiIndex].pcStart=pcChunkStart;
+    taChunks[uiIndex].pcEnd=pcChunkEnd;
+    pcChunkStart=pcChunkEnd;
+  }
+  uiThreads=uiIndex;
+  for(uiStarted=1;uiStarted<uiThreads;++uiStarted)
+  {
+    if(pthread_create(&taThreads[uiStarted],NULL,pvLogCRead_ChunkThread_m,&taChunks[uiStarted]))
+      break;
+  }
+  /* Chunks without a thread, if no more threads could be created, are filtered here */
+  pvLogCRead_ChunkThread_m(&taChunks[0]);
+  for(uiIndex=uiStarted;uiIndex<uiThreads;++uiIndex)
+    pvLogCRead_ChunkThread_m(&taChunks[uiIndex]);
+  /* Write the output in order of the chunks */
+  for(uiIndex=0;uiIndex<uiThreads;++uiIndex)
+  {
+    if((uiIndex) && (uiIndex<uiStarted))
+      pthread_join(taThreads[uiIndex],NULL);
+    if(taChunks[uiIndex].iError)
+      iRc=EXIT_FAILURE;
+    ulMatches+=taChunks[uiIndex].ulMatches;
+    if((taChunks[uiIndex].szOutLength) &&
+       (fwrite(taChunks[uiIndex].pcOut,1,taChunks[uiIndex].szOutLength,stdout)!=taChunks[uiIndex].szOutLength))
+      iRc=EXIT_FAILURE;
+    free(taChunks[uiIndex].pcOut);
+  }
+  if(tagFilter.iCountOnly)
+    printf("%lu\n",ulMatches);
+  if(ptagRanges!=&tagWholeFile)
+    free(ptagRanges);
+  munmap((void*)pcData,(size_t)tagStat.st_size);
+  return(iRc);
+}
+
+static int iLogCRead_ParseArgs_m(int argc,
+                                 char *argv[],
+                                 TagLogCReadFilter *ptagFilter,
+                                 unsigned int *puiThreads,
+                                 const char **ppcPath)
+{
+  unsigned long long ullFromMs;
+  unsigned long long ullToMs;
+  int iOpt;
+  long lCpus;
+
+  memset(ptagFilter,0,sizeof(TagLogCReadFilter));
+  lCpus=sysconf(_SC_NPROCESSORS_ONLN);
+  *puiThreads=(lCpus>0)?(unsigned int)lCpus:1;
+  while((iOpt=getopt(argc,argv,"l:f:t:Ls:g:j:c"))!=-1)
+  {
+    switch(iOpt)
+    {
+      case 'l':
+        if(!(ptagFilter->iMinLogType=iLogCRead_GetLogType_m(optarg,strlen(optarg))))
+        {
+          fprintf(stderr,"Unknown logtype: %s\n",optarg);
+          return(-1);
+        }
+        break;
+      case 'f':
+        ptagFilter->pcTimeFrom=optarg;
+        ptagFilter->szTimeFromLength=strlen(optarg);
+        break;
+      case 't':
+        ptagFilter->pcTimeTo=optarg;
+        ptagFilter->szTimeToLength=strlen(optarg);
+        break;
+      case 's':
+        ptagFilter->pcSourceFile=optarg;
+        ptagFilter->szSourceFileLength=strlen(optarg);
+        break;
+      case 'g':
+        ptagFilter->pcText=optarg;
+        ptagFilter->szTextLength=strlen(optarg);
+        break;
+      case 'j':
+        *puiThreads=(unsigned int)strtoul(optarg,NULL,10);
+        if((!*puiThreads) || (*puiThreads>LOGC_READ_MAX_THREADS))
+          *puiThreads=LOGC_READ_MAX_THREADS;
+        break;
+      case 'c':
+        ptagFilter->iCountOnly=1;
+        break;
+      case 'L':
+        ptagFilter->iLocalTime=1;
+        break;
+      default:
+        return(-1);
+    }
+  }
+  if(*puiThreads>LOGC_READ_MAX_THREADS)
+    *puiThreads=LOGC_READ_MAX_THREADS;
+  if(optind!=argc-1)
+    return(-1);
+  *ppcPath=argv[optind];
+  if(((ptagFilter->pcTimeFrom) && (iLogCRead_CheckTime_m(ptagFilter->pcTimeFrom,ptagFilter->szTimeFromLength))) ||
+     ((ptagFilter->pcTimeTo) && (iLogCRead_CheckTime_m(ptagFilter->pcTimeTo,ptagFilter->szTimeToLength))))
+  {
+    fprintf(stderr,"Unknown timestamp layout: %s\n",(iLogCRead_CheckTime_m(ptagFilter->pcTimeFrom,ptagFilter->szTimeFromLength))?
+                                                      ptagFilter->pcTimeFrom:ptagFilter->pcTimeTo);
+    return(-1);
+  }
+  /* Without a date, the times can't be compared with the index */
+  if(ptagFilter->pcTimeFrom)
+    iLogCRead_ParseTime_m(ptagFilter->pcTimeFrom,ptagFilter->iLocalTime,&ptagFilter->ullIndexFromMs,&ullToMs);
+  if(ptagFilter->pcTimeTo)
+    iLogCRead_ParseTime_m(ptagFilter->pcTimeTo,ptagFilter->iLocalTime,&ullFromMs,&ptagFilter->ullIndexToMs);
+  return(0);
+}
+
+/**
+ * Convert a timestamp filter with a date to the milliseconds since the epoch it stands for,
+ * e.g. 2018-10-03_14:03 is the range from 14:03:00.000 to 14:03:59.999.
+ *
+ * @return 0 on success, -1 if the text doesn't start with a date.
+ */
+static int iLogCRead_ParseTime_m(const char *pcText,
+                                 int iLocalTime,
+                                 unsigned long long *pullFromMs,
+                                 unsigned long long *pullToMs)
+{
+  static const size_t szaWidths[]={4,2,2,2,2,2};
+  static const char caSeparators[]="\0--_::";
+  static const unsigned long long ullaSpansMs[]={0,0,0,86400000ULL,3600000ULL,60000ULL,1000ULL};
+  int iaFields[6]={0,1,1,0,0,0};
+  unsigned long long ullSpanMs;
+  unsigned long long ullMs=0;
+  struct tm tagTime;
+  time_t tTime;
+  size_t szFields;
+  size_t szIndex;
+
+  for(szFields=0;szFields<6;++szFields)
+  {
+    if((szFields) && (*pcText++!=caSeparators[szFields]))
+      break;
+    for(szIndex=0;szIndex<szaWidths[szFields];++szIndex)
+    {
+      if((pcText[szIndex]<'0') || (pcText[szIndex]>'9'))
+        break;
+    }
+    if(szIndex<szaWidths[szFields])
+      break;
+    iaFields[szFields]=atoi(pcText); /* Stops at the separator */
+    pcText+=szIndex;
+  }
+  if(szFields<3)
+    return(-1);
+  ullSpanMs=ullaSpansMs[szFields];
+  if((szFields==6) && (*pcText=='.'))
+  {
+    for(++pcText;(*pcText>='0') && (*pcText<='9') && (ullSpanMs>1);++pcText)
+    {
+      ullSpanMs/=10;
+      ullMs+=(unsigned long long)(*pcText-'0')*ullSpanMs;
+    }
+  }
+  memset(&tagTime,0,sizeof(tagTime));
+  tagTime.tm_year=iaFields[0]-1900;
+  tagTime.tm_mon=iaFields[1]-1;
+  tagTime.tm_mday=iaFields[2];
+  tagTime.tm_hour=iaFields[3];
+  tagTime.tm_min=iaFields[4];
+  tagTime.tm_sec=iaFields[5];
+  tagTime.tm_isdst=-1;
+  if(((tTime=(iLocalTime)?mktime(&tagTime):timegm(&tagTime))==(time_t)-1) || (tTime<0))
+    return(-1);
+  *pullFromMs=(unsigned long long)tTime*1000ULL+ullMs;
+  *pullToMs=*pullFromMs+ullSpanMs-1;
+  return(0);
+}
+
+/**
+ * Check that the time filter has the layout of a timestamp written by LogC or the beginning of it,
+ * e.g. 2018-10-03_12:34, 12:34:56.7 or .123
+ *
+ * @return 0 if the layout is known, -1 otherwise.
+ */
+static int iLogCRead_CheckTime_m(const char *pcText,
+                                 size_t szLength)
+{
+  static const char *const pcaLayouts[]={"0000-00-00_00:00:00.000000000",
+                                         "0000-00-00 .000000000",
+                                         "00:00:00.000000000",
+                                         ".000000000"};
+  size_t szIndex;
+
+  if(!pcText)
+    return(0);
+  for(szIndex=0;szIndex<sizeof(pcaLayouts)/sizeof(pcaLayouts[0]);++szIndex)
+  {
+    if((szLength) && (szLength<=strlen(pcaLayouts[szIndex])) && (iLogCRead_SameLayout_m(pcText,pcaLayouts[szIndex],szLength)))
+      return(0);
+  }
+  return(-1);
+}
+
+/**
+ * Check if both texts have digits and the same separators at the same positions.
+ */
+static int iLogCRead_SameLayout_m(const char *pcText1,
+                                  const char *pcText2,
+                                  size_t szLength)
+{
+  size_t szIndex;
+  int iDigit;
+
+  for(szIndex=0;szIndex<szLength;++szIndex)
+  {
+    iDigit=((pcText1[szIndex]>='0') && (pcText1[szIndex]<='9'));
+    if(iDigit!=((pcText2[szIndex]>='0') && (pcText2[szIndex]<='9')))
+      return(0);
+    if((!iDigit) && (pcText1[szIndex]!=pcText2[szIndex]))
+      return(0);
+  }
+  return(1);
+}
+
+/**
+ * Select the parts of the file which can match the logtype and the timerange with the index of the file.
+ * Parts without a record (e.g. the last block, which isn't complete yet) are always selected.
+ *
+ * @return 0 on success, -1 if there's no usable index, the whole file has to be read then.
+ */
+static int iLogCRead_IndexRanges_m(const char *pcPath,
+                                   const TagLogCReadFilter *ptagFilter,
+                                   const char *pcData,
+                                   size_t szSize,
+                                   TagLogCReadRange **pptagRanges,
+                                   size_t *pszRangeCount)
+{
+  char caIndexPath[4096];
+  LogCIndexRecord *ptagRecords=NULL;
+  const LogCIndexRecord *ptagRecord;
+  struct stat tagStat;
+  unsigned int uiLogTypes=0;
+  unsigned long long ullPos=0;
+  size_t szRecords;
+  size_t szIndex;
+  FILE *fp;
+  int iRc=-1;
+
+  if(ptagFilter->iMinLogType)
+  {
+    for(szIndex=0;szIndex<sizeof(tagLogTypes_m)/sizeof(tagLogTypes_m[0]);++szIndex)
+    {
+      if(tagLogTypes_m[szIndex].iLogType>=ptagFilter->iMinLogType)
+        uiLogTypes|=1U<<szIndex;
+    }
+  }
+  if(((!uiLogTypes) && (!ptagFilter->ullIndexFromMs) && (!ptagFilter->ullIndexToMs)) ||
+     (snprintf(caIndexPath,sizeof(caIndexPath),"%s" LOGC_INDEX_SUFFIX,pcPath)>=(int)sizeof(caIndexPath)) ||
+     (!(fp=fopen(caIndexPath,"rb"))))
+    return(-1);
+  if((!fstat(fileno(fp),&tagStat)) &&
+     ((szRecords=(size_t)tagStat.st_size/sizeof(LogCIndexRecord))) && /* A record may be written right now */
+     (ptagRecords=malloc(szRecords*sizeof(LogCIndexRecord))) &&
+     (fread(ptagRecords,sizeof(LogCIndexRecord),szRecords,fp)==szRecords) &&
+     /* Worst case: each record and each gap between them is a range */
+     ((*pptagRanges=malloc((2*szRecords+1)*sizeof(TagLogCReadRange)))))
+  {
+    iRc=0;
+    *pszRangeCount=0;
+    for(szIndex=0;szIndex<szRecords;++szIndex)
+    {
+      ptagRecord=&ptagRecords[szIndex];
+      if((ptagRecord->uiMagic!=LOGC_INDEX_MAGIC) || ((szIndex) && (ptagRecord->ullOffset<ptagRecords[szIndex-1].ullOffset)))
+      {
+        /* Not written by LogC or doesn't fit to the file */
+        free(*pptagRanges);
+        iRc=-1;
+        break;
+      }
+      if(ptagRecord->ullOffset>ullPos) /* Written without index */
+        vLogCRead_AddRange_m(*pptagRanges,pszRangeCount,pcData,szSize,ullPos,ptagRecord->ullOffset);
+      if(((!uiLogTypes) || (ptagRecord->uiLogTypes&uiLogTypes)) &&
+         ((!ptagFilter->ullIndexFromMs) || (ptagRecord->ullLastTimeMs+LOGC_READ_INDEX_SLACKMS>=ptagFilter->ullIndexFromMs)) &&
+         ((!ptagFilter->ullIndexToMs) || (ptagRecord->ullFirstTimeMs<=ptagFilter->ullIndexToMs+LOGC_READ_INDEX_SLACKMS)))
+        vLogCRead_AddRange_m(*pptagRanges,pszRangeCount,pcData,szSize,
+                             ptagRecord->ullOffset,ptagRecord->ullOffset+ptagRecord->ullLength);
+      if(ptagRecord->ullOffset+ptagRecord->ullLength>ullPos)
+        ullPos=ptagRecord->ullOffset+ptagRecord->ullLength;
+    }
+    if((!iRc) && (ullPos<szSize))
+      vLogCRead_AddRange_m(*pptagRanges,pszRangeCount,pcData,szSize,ullPos,szSize);
+  }
+  free(ptagRecords);
+  fclose(fp);
+  return(iRc);
+}
+
+/**
+ * Add the range of the file, extended to line boundaries, merged with the last range if they touch.
+ */
+static void vLogCRead_AddRange_m(TagLogCReadRange *ptagRanges,
+                                 size_t *pszRangeCount,
+                                 const char *pcData,
+                                 size_t szSize,
+                                 unsigned long long ullStart,
+                                 unsigned long long ullEnd)
+{
+  const char *pcStart;
+  const char *pcEnd;
+
+  if(ullEnd>szSize)
+    ullEnd=szSize;
+  if(ullStart>=ullEnd)
+    return;
+  /* The offsets may be a bit off, e.g. after entries were dropped */
+  pcStart=&pcData[ullStart];
+  if((pcStart>pcData) && (pcStart[-1]!='\n'))
+    pcStart=((pcStart=memrchr(pcData,'\n',(size_t)(pcStart-pcData))))?pcStart+1:pcData;
+  pcEnd=&pcData[ullEnd];
+  if((pcEnd[-1]!='\n') && (pcEnd<pcData+szSize))
+    pcEnd=((pcEnd=memchr(pcEnd,'\n',(size_t)(pcData+szSize-pcEnd))))?pcEnd+1:pcData+szSize;
+  if((*pszRangeCount) && (pcStart<=ptagRanges[*pszRangeCount-1].pcEnd))
+  {
+    if(pcEnd>ptagRanges[*pszRangeCount-1].pcEnd)
+      ptagRanges[*pszRangeCount-1].pcEnd=pcEnd;
+    return;
+  }
+  ptagRanges[*pszRangeCount].pcStart=pcStart;
+  ptagRanges[*pszRangeCount].pcEnd=pcEnd;
+  ++*pszRangeCount;
+}
+
+static void *pvLogCRead_ChunkThread_m(void *pvChunk)
+{
+  TagLogCReadChunk *ptagChunk=pvChunk;
+  const char *pcStart;
+  const char *pcEnd;
+  size_t szIndex;
+
+  for(szIndex=0;szIndex<ptagChunk->szRangeCount;++szIndex)
+  {
+    pcStart=(ptagChunk->ptagRanges[szIndex].pcStart>ptagChunk->pcStart)?ptagChunk->ptagRanges[szIndex].pcStart:ptagChunk->pcStart;
+    pcEnd=(ptagChunk->ptagRanges[szIndex].pcEnd<ptagChunk->pcEnd)?ptagChunk->ptagRanges[szIndex].pcEnd:ptagChunk->pcEnd;
+    if((pcStart<pcEnd) && (iLogCRead_ScanRange_m(ptagChunk,pcStart,pcEnd)))
+    {
+      ptagChunk->iError=1;
+      break;
+    }
+  }
+  return(NULL);
+}
+
+/**
+ * Filter the lines from pcPos to pcEnd, both at line boundaries.
+ */
+static int iLogCRead_ScanRange_m(TagLogCReadChunk *ptagChunk,
+                                 const char *pcPos,
+                                 const char *pcEnd)
+{
+  const TagLogCReadFilter *ptagFilter=ptagChunk->ptagFilter;
+  const char *pcLine;
+  const char *pcLineEnd;
+
+  while(pcPos<pcEnd)
+  {
+    if(ptagFilter->szTextLength)
+    {
+      /* Search the text in the whole range first, most lines don't need to be parsed then */
+      if(!(pcLineEnd=pcLogCRead_Find_m(pcPos,(size_t)(pcEnd-pcPos),ptagFilter->pcText,ptagFilter->szTextLength)))
+        break;
+      if((pcLine=memrchr(pcPos,'\n',(size_t)(pcLineEnd-pcPos))))
+        ++pcLine;
+      else
+        pcLine=pcPos;
+    }
+    else
+    {
+      pcLine=pcPos;
+      pcLineEnd=pcPos;
+    }
+    if((pcLineEnd=memchr(pcLineEnd,'\n',(size_t)(pcEnd-pcLineEnd))))
+      ++pcLineEnd;
+    else
+      pcLineEnd=pcEnd;
+    if(iLogCRead_LineMatches_m(ptagFilter,pcLine,pcLineEnd))
+    {
+      ++ptagChunk->ulMatches;
+      if((!ptagFilter->iCountOnly) && (iLogCRead_AddLine_m(ptagChunk,pcLine,pcLineEnd)))
+        return(-1);
+    }
+    pcPos=pcLineEnd;
+  }
+  return(0);
+}
+
+/**
+ * Parses the prefix of the line and checks the filters.
+ * The substring filter is already checked by the caller.
+ */
+static int iLogCRead_LineMatches_m(const TagLogCReadFilter *ptagFilter,
+                                   const char *pcLine,
+                                   const char *pcLineEnd)
+{
+  const char *pcPos=pcLine;
+  const char *pcTime=NULL;
+  const char *pcTmp;
+  size_t szTimeLength=0;
+  size_t szLength=(size_t)(pcLineEnd-pcLine);
+
+  /* Timestamp: [YYYY-MM-DD][_][HH:MM:SS][.mmm] */
+  if((szLength>=10) && (pcPos[4]=='-') && (pcPos[7]=='-') && (pcPos[0]>='0') && (pcPos[0]<='9'))
+  {
+    pcTime=pcPos;
+    pcPos+=10;
+    if((pcPos+9<=pcLineEnd) && (*pcPos=='_'))
+      pcPos+=9;
+  }
+  else if((szLength>=8) && (pcPos[2]==':') && (pcPos[5]==':') && (pcPos[0]>='0') && (pcPos[0]<='9'))
+  {
+    pcTime=pcPos;
+    pcPos+=8;
+  }
+  if(pcTime)
+    szTimeLength=(size_t)(pcPos-pcTime);
+  if((pcPos<pcLineEnd) && (*pcPos==' ') && (pcPos+1<pcLineEnd) && (pcPos[1]=='.'))
+    ++pcPos; /* Date + milliseconds */
+  if((pcPos<pcLineEnd) && (*pcPos=='.'))
+  {
+    if(!pcTime)
+      pcTime=pcPos;
+    for(++pcPos;(pcPos<pcLineEnd) && (*pcPos>='0') && (*pcPos<='9');++pcPos);
+    szTimeLength=(size_t)(pcPos-pcTime);
+  }
+  /* With the same layout, comparing the texts compares the times */
+  if((ptagFilter->pcTimeFrom) &&
+     ((!(pcTmp=pcLogCRead_TimePart_m(pcTime,szTimeLength,ptagFilter->pcTimeFrom,ptagFilter->szTimeFromLength))) ||
+      (memcmp(pcTmp,ptagFilter->pcTimeFrom,ptagFilter->szTimeFromLength)<0)))
+    return(0);
+  if((ptagFilter->pcTimeTo) &&
+     ((!(pcTmp=pcLogCRead_TimePart_m(pcTime,szTimeLength,ptagFilter->pcTimeTo,ptagFilter->szTimeToLength))) ||
+      (memcmp(pcTmp,ptagFilter->pcTimeTo,ptagFilter->szTimeToLength)>0)))
+    return(0);
+  if((pcPos<pcLineEnd) && (*pcPos==' '))
+    ++pcPos;
+
+  /* Logtype: [Text] */
+  if(ptagFilter->iMinLogType)
+  {
+    if((pcPos>=pcLineEnd) || (*pcPos!='[') ||
+       (!(pcTmp=memchr(pcPos,']',(size_t)(pcLineEnd-pcPos)))) ||
+       (iLogCRead_GetLogType_m(pcPos+1,(size_t)(pcTmp-pcPos-1))<ptagFilter->iMinLogType))
+      return(0);
+    pcPos=pcTmp+1;
+  }
+  else if((pcPos<pcLineEnd) && (*pcPos=='[') && ((pcTmp=memchr(pcPos,']',(size_t)(pcLineEnd-pcPos)))))
+    pcPos=pcTmp+1;
+
+  /* Fileinfo: "file"@line N */
+  if(ptagFilter->pcSourceFile)
+  {
+    if((pcPos>=pcLineEnd) || (*pcPos!='"') ||
+       (!(pcTmp=memchr(pcPos+1,'"',(size_t)(pcLineEnd-pcPos-1)))) ||
+       (!pcLogCRead_Find_m(pcPos+1,(size_t)(pcTmp-pcPos-1),ptagFilter->pcSourceFile,ptagFilter->szSourceFileLength)))
+      return(0);
+  }
+  return(1);
+}
+
+/**
+ * Find the part of the timestamp with the layout of the time filter: the whole timestamp,
+ * its time after the date or its fraction, e.g. 12:34:56 of 2018-10-03_12:34:56.789 for the filter 12:34.
+ *
+ * @return The part, NULL if the timestamp has no part with this layout, the entry can't match then.
+ */
+static const char *pcLogCRead_TimePart_m(const char *pcTime,
+                                         size_t szTimeLength,
+                                         const char *pcFilter,
+                                         size_t szFilterLength)
+{
+  size_t szStart;
+
+  if(!pcTime)
+    return(NULL);
+  for(szStart=0;szStart+szFilterLength<=szTimeLength;++szStart)
+  {
+    if(((!szStart) || (pcTime[szStart-1]=='_') || (pcTime[szStart]=='.')) &&
+       (iLogCRead_SameLayout_m(&pcTime[szStart],pcFilter,szFilterLength)))
+      return(&pcTime[szStart]);
+  }
+  return(NULL);
+}
+
+static int iLogCRead_AddLine_m(TagLogCReadChunk *ptagChunk,
+                               const char *pcLine,
+                               const char *pcLineEnd)
+{
+  size_t szLength=(size_t)(pcLineEnd-pcLine);
+  char *pcTmp;
+
+  if(ptagChunk->szOutLength+szLength+1>ptagChunk->szOutSize)
+  {
+    size_t szNewSize=(ptagChunk->szOutSize)?2*ptagChunk->szOutSize:LOGC_READ_OUTBUFFERSIZE;
+    while(szNewSize<ptagChunk->szOutLength+szLength+1)
+      szNewSize*=2;
+    if(!(pcTmp=realloc(ptagChunk->pcOut,szNewSize)))
+      return(-1);
+    ptagChunk->pcOut=pcTmp;
+    ptagChunk->szOutSize=szNewSize;
+  }
+  memcpy(&ptagChunk->pcOut[ptagChunk->szOutLength],pcLine,szLength);
+  ptagChunk->szOutLength+=szLength;
+  if(pcLine[szLength-1]!='\n') /* Last line of the file without newline */
+    ptagChunk->pcOut[ptagChunk->szOutLength++]='\n';
+  return(0);
+}
+
+/**
+ * Substring search, with SSE2 the first and last character of the needle are compared
+ * for 16 positions at once and just the candidates are compared completely.
+ */
+static const char *pcLogCRead_Find_m(const char *pcHaystack,
+                                     size_t szHaystackLength,
+                                     const char *pcNeedle,
+                                     size_t szNeedleLength)
+{
+#ifdef __SSE2__
+  size_t szPos=0;
+  unsigned int uiMask;
+  int iBit;
+  __m128i tFirst;
+  __m128i tLast;
+
+  if((!szNeedleLength) || (szNeedleLength>szHaystackLength))
+    return((szNeedleLength)?NULL:pcHaystack);
+  tFirst=_mm_set1_epi8(pcNeedle[0]);
+  tLast=_mm_set1_epi8(pcNeedle[szNeedleLength-1]);
+  for(;szPos+16+szNeedleLength-1<=szHaystackLength;szPos+=16)
+  {
+    uiMask=(unsigned int)_mm_movemask_epi8(_mm_and_si128(
+             _mm_cmpeq_epi8(tFirst,_mm_loadu_si128((const __m128i*)&pcHaystack[szPos])),
+             _mm_cmpeq_epi8(tLast,_mm_loadu_si128((const __m128i*)&pcHaystack[szPos+szNeedleLength-1]))));
+    while(uiMask)
+    {
+      iBit=__builtin_ctz(uiMask);
+      if(!memcmp(&pcHaystack[szPos+(size_t)iBit+1],pcNeedle+1,szNeedleLength-1))
+        return(&pcHaystack[szPos+(size_t)iBit]);
+      uiMask&=uiMask-1;
+    }
+  }
+  /* Remaining positions */
+  pcHaystack+=szPos;
+  szHaystackLength-=szPos;
+#endif /* __SSE2__ */
+  return(memmem(pcHaystack,szHaystackLength,pcNeedle,szNeedleLength));
+}
+
+static int iLogCRead_GetLogType_m(const char *pcText,
+                                  size_t szLength)
+{
+  size_t szIndex;
+  for(szIndex=0;szIndex<sizeof(tagLogTypes_m)/sizeof(tagLogTypes_m[0]);++szIndex)
+  {
+    if((strlen(tagLogTypes_m[szIndex].pcText)==szLength) &&
+       (!strncasecmp(tagLogTypes_m[szIndex].pcText,pcText,szLength)))
+      return(tagLogTypes_m[szIndex].iLogType);
+  }
+  return(0);
+}
@@ -0,0 +1,41 @@
+#ifndef LOGC_SHM_H_INCLUDED
+  #define LOGC_SHM_H_INCLUDED
+
+/**
+ * Layout of the shared memory ring written by LogC (LOGC_FEATURE_ENABLE_SHM)
+ * and drained by logc-collector, see LogC_SetShmRing().
+ *
+ * The ring is a POSIX shared memory object: this header, followed by ullDataSize bytes of data.
+ * Each ring has exactly one writer (the Log-Object, serialized by its mutex) and one reader (the collector).
+ * ullHead and ullTail count the bytes written and read since the ring was created,
+ * the position in the data is the counter modulo ullDataSize, so the data may wrap around.
+ * The writer copies complete entries (text with '\n', without '\0') and publishes them by
+ * storing ullHead with release semantics, the reader consumes them by storing ullTail.
+ * Both live in their own cachelines, so writer and reader don't disturb each other.
+ */
+
+#if !defined(__GNUC__) || !defined(__GCC_ATOMIC_LLONG_LOCK_FREE) || (__GCC_ATOMIC_LLONG_LOCK_FREE!=2)
+  #error The shared memory ring needs lock-free 64 bit atomics (GCC __atomic builtins)!
+#endif /* __GCC_ATOMIC_LLONG_LOCK_FREE */
+
+#define LOGC_SHM_MAGIC   0x43676F4CU /* "LogC" */
+#define LOGC_SHM_VERSION 1
+
+#define LOGC_SHM_LOAD_ACQUIRE(ptr)      __atomic_load_n((ptr),__ATOMIC_ACQUIRE)
+#define LOGC_SHM_STORE_RELEASE(ptr,val) __atomic_store_n((ptr),(val),__ATOMIC_RELEASE)
+
+typedef struct
+{
+  unsigned int uiMagic;
+  unsigned int uiVersion;
+  unsigned long long ullDataSize;     /* Size of the data behind the header, always a power of 2 */
+  unsigned long long ullPid;          /* Process of the writer */
+  unsigned long long ullClosed;       /* Set by the writer, when no more entries are added */
+  unsigned long long ullaReserved[4]; /* Fill up the cacheline */
+  unsigned long long ullHead;         /* Just changed by the writer */
+  unsigned long long ullaPadHead[7];
+  unsigned long long ullTail;         /* Just changed by the reader */
+  unsigned long long ullaPadTail[7];
+}LogCShmHeader;
+
+#endif /* LOGC_SHM_H_INCLUDED */
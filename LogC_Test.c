@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #define __STDC_FORMAT_MACROS
 #include <inttypes.h>
@@ -52,14 +53,159 @@
   #define LOG_MAX_STORAGE_COUNT 5
 #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
 
+#define LOGC_TEST_ENTRIES_COUNT 5 /* Entries added by LogCTest_AddTestEntrys_m() */
+
 #ifdef LOGFILE_PATH
   int LogTest_File_g(LogC log);
+  long LogTest_CountFileLines_m(const char *pcPath);
+  /* Needs a logfile which becomes unavailable, the io_uring backend keeps it open */
+  #if defined(__unix__) && !defined(LOGC_FEATURE_ENABLE_IOURING)
+    #include <unistd.h>
+    #include <sys/stat.h>
+    #define LOGFILE_BACKPRESSURE_DIR  "Test_Backpressure"
+    #define LOGFILE_BACKPRESSURE_PATH LOGFILE_BACKPRESSURE_DIR "/Test.log"
+    int LogTest_Backpressure_g(void);
+  #endif /* __unix__ && !LOGC_FEATURE_ENABLE_IOURING */
+  #define LOGFILE_SHARED_PATH "Test_Shared.log"
+  #define LOGC_TEST_SHARED_ENTRIES 25 /* Per Log-Object, not a multiple of the filequeue */
+  int LogTest_SharedFile_g(void);
+  #define LOGFILE_TIMESOURCE_PATH "Test_TimeSource.log"
+  int LogTest_TimeSource_g(void);
+  #define LOGFILE_HEXDUMP_PATH "Test_HexDump.log"
+  #define LOGC_TEST_HEXDUMP_SIZE 100
+  int LogTest_HexDump_g(void);
+  #define LOGFILE_LITERAL_PATH "Test_Literal.log"
+  #define LOGC_TEST_LITERAL_MAX_ENTRY_LENGTH 80 /* Small, so the truncation is checked too */
+  int LogTest_PlainLiteral_g(void);
+  #define LOGFILE_ROUTE_ERRORS_PATH "Test_RouteErrors.log"
+  #define LOGFILE_ROUTE_APP_PATH    "Test_RouteApp.log"
+  #define LOGFILE_ROUTE_DEBUG_PATH  "Test_RouteDebug.log"
+  int LogTest_FileRoutes_g(void);
+  #ifdef LOGC_FEATURE_ENABLE_RECORDER
+    #define LOGFILE_RECORDER_PATH "Test_Recorder.log"
+    #define LOGC_TEST_RECORDER_FORMAT "Debug %d: %s|%-4s|%.1f|%llx|%c|%*d|%.*s|%%"
+    int LogTest_FlightRecorder_g(void);
+  #endif /* LOGC_FEATURE_ENABLE_RECORDER */
+  #ifdef LOGC_FEATURE_ENABLE_CONTEXT
+    #define LOGFILE_CONTEXT_PATH "Test_Context.log"
+    int LogTest_Context_g(void);
+  #endif /* LOGC_FEATURE_ENABLE_CONTEXT */
+  #define LOGFILE_BATCH_PATH "Test_Batch.log"
+  #define LOGC_TEST_BATCH_THREADS 4
+  #define LOGC_TEST_BATCH_COUNT   20 /* Batches per thread, alternating smaller and larger than the filequeue */
+  int LogTest_Batch_g(void);
+  void *pvLogTest_BatchThread_m(void *pvArg);
+  #include "LogC_Index.h"
+  #define LOGFILE_INDEX_PATH  "Test_Index1.log"
+  #define LOGFILE_INDEX_PATH2 "Test_Index2.log"
+  #define LOGC_TEST_INDEX_BLOCKSIZE 256
+  int LogTest_FileIndex_g(void);
+  int LogTest_CheckFileIndex_m(const char *pcPath,
+                               const char *pcIndexPath,
+                               size_t szIndexStart);
+  #if defined(LOGC_TEST_THREADS) && defined(__unix__)
+    #define LOGFILE_SWAP_PATH      "Test_Swap.log"
+    #define LOGC_TEST_SWAP_THREADS 4
+    #define LOGC_TEST_SWAP_ENTRIES 2000
+    int LogTest_FileQueueSwap_g(void);
+    void *pvLogTest_FileQueueSwapThread_m(void *pvArg);
+  #endif /* LOGC_TEST_THREADS && __unix__ */
+  #ifdef __unix__
+    #include <unistd.h>
+    #include <sys/wait.h>
+    #define LOGFILE_APPEND_PATH        "Test_Append.log"
+    #define LOGC_TEST_APPEND_PROCESSES 4
+    #define LOGC_TEST_APPEND_ENTRIES   20000
+    #define LOGC_TEST_APPEND_PADDING   400 /* Max length of the padding, the entries have different lengths */
+    int LogTest_AppendProcesses_g(void);
+    int LogTest_AppendChild_m(int iProcess);
+  #endif /* __unix__ */
+  #ifdef LOGC_FEATURE_ENABLE_FILECACHE
+    #define LOGFILE_CACHE_FORMAT    "Test_Cache%d.log"
+    #define LOGC_TEST_CACHE_LOGS    10
+    #define LOGC_TEST_CACHE_MAX     4
+    #define LOGC_TEST_CACHE_ENTRIES 55 /* Per Log-Object, not a multiple of the filequeue */
+    int LogTest_FileCache_g(void);
+    /* The io_uring backend keeps its logfile open, without using the cache */
+    #if defined(__linux__) && !defined(LOGC_FEATURE_ENABLE_IOURING)
+      #include <dirent.h>
+      #define LOGC_TEST_CACHE_COUNT_FILES
+      int LogTest_CountOpenFiles_m(void);
+    #endif /* __linux__ && !LOGC_FEATURE_ENABLE_IOURING */
+  #endif /* LOGC_FEATURE_ENABLE_FILECACHE */
 #endif /* LOGFILE_PATH */
 
 #ifdef LOG_MAX_STORAGE_COUNT
   int LogTest_Storage_g(LogC log);
 #endif /* LOG_MAX_STORAGE_COUNT */
 
+#ifdef LOGC_FEATURE_ENABLE_PROFILE
+  #define LOGC_TEST_PROFILE_ENTRIES 20
+  int LogTest_Profile_g(void);
+#endif /* LOGC_FEATURE_ENABLE_PROFILE */
+
+#ifdef LOGC_FEATURE_ENABLE_TRACE
+  #define LOGC_TEST_SPAN_PATH "Test_Trace.json"
+  #define LOGC_TEST_SPAN_LOOPS 10
+  int LogTest_Span_g(void);
+#endif /* LOGC_FEATURE_ENABLE_TRACE */
+
+#ifdef LOGC_FEATURE_ENABLE_SHM
+  #include <errno.h>
+  #include <unistd.h>
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/wait.h>
+  #include "LogC_Shm.h"
+  #define LOGC_TEST_SHM_NAME "/LogC_Test_Shm"
+  #define LOGC_TEST_SHM_SIZE 4096
+  int LogTest_Shm_g(void);
+  long LogTest_ShmConsume_m(LogCShmHeader *ptagHeader);
+#endif /* LOGC_FEATURE_ENABLE_SHM */
+
+#ifdef LOGC_FEATURE_ENABLE_SOCKET
+  #include <unistd.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #define LOGC_TEST_SOCKET_PATH "LogC_Test.sock"
+  #ifdef LOGC_FEATURE_ENABLE_LOGFILE
+    #define LOGFILE_SOCKET_PATH "Test_Socket.log"
+  #endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+  int LogTest_Socket_g(void);
+  long LogTest_SocketReceive_m(int iFd,
+                               char *pcFirst,
+                               size_t szFirstSize);
+#endif /* LOGC_FEATURE_ENABLE_SOCKET */
+
+#ifdef LOGC_FEATURE_ENABLE_ENGINE
+  #define LOGC_TEST_ENGINE_LOGS    3
+  #define LOGC_TEST_ENGINE_ENTRIES 25 /* Two full queues and a partial one */
+  int LogTest_Engine_g(void);
+#endif /* LOGC_FEATURE_ENABLE_ENGINE */
+
+#ifdef LOGC_FEATURE_ENABLE_FLUSHTIMER
+  #define LOGFILE_FLUSHTIMER_PATH1 "Test_FlushTimer1.log"
+  #define LOGFILE_FLUSHTIMER_PATH2 "Test_FlushTimer2.log"
+  int LogTest_FlushTimer_g(void);
+#endif /* LOGC_FEATURE_ENABLE_FLUSHTIMER */
+
+#if defined(LOGC_FEATURE_ENABLE_ENGINE) || defined(LOGC_FEATURE_ENABLE_FLUSHTIMER)
+  #ifdef _WIN32
+    #define LogTest_SleepMs_m(ms) Sleep(ms)
+  #else
+    #include <unistd.h>
+    #define LogTest_SleepMs_m(ms) usleep((ms)*1000)
+  #endif /* _WIN32 */
+#endif /* LOGC_FEATURE_ENABLE_ENGINE || LOGC_FEATURE_ENABLE_FLUSHTIMER */
+
+#if defined(LOGC_FEATURE_ENABLE_PERCPU) && defined(LOGC_FEATURE_ENABLE_LOGFILE)
+  #define LOGFILE_PERCPU_PATH      "Test_PerCpu.log"
+  #define LOGC_TEST_PERCPU_THREADS 4
+  #define LOGC_TEST_PERCPU_ENTRIES 500
+  int LogTest_PerCpu_g(void);
+  void *pvLogTest_PerCpuThread_m(void *pvArg);
+#endif /* LOGC_FEATURE_ENABLE_PERCPU && LOGC_FEATURE_ENABLE_LOGFILE */
+
 #define LOGTEST_EXIT_FAILURE(log) if(LogC_End(log)){ \
                                     LOGC_TEST_TRACE("LOGTEST_EXIT_FAILURE(): LogC_End() failed!"); exit(EXIT_FAILURE); \
                                   }
@@ -104,7 +250,7 @@ void LogCTest_AddTestEntrys_m(LogC log,
   LOGC_TEST_TEXT(log,LOGC_INFO,"---Adding Logentries: %s---",pcInfo);
   LOGC_TEST_TEXT(log,LOGC_DEBUG_MORE,"1st entry...");
   LOGC_TEST_TEXT(log,LOGC_DEBUG,"another entry");
-  LOGC_TEST_TEXT(log,LOGC_ERROR,"And %s arguments! time() is: %"PRIi64"","variadic",(long long)time(NULL));
+  LOGC_TEST_TEXT(log,LOGC_ERROR,"And %s arguments! time() is: %lld","variadic",(long long)time(NULL));
   LOGC_TEST_TEXT(log,LOGC_FATAL,"Also Test a very long string, 123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ");
 }
 
@@ -114,7 +260,7 @@ int main(void)
   unsigned int index;
   unsigned int indexB;
 #ifdef LOGC_FEATURE_ENABLE_LOGFILE
-  LogCFile logFile;
+  LogCFile logFile={0};
   logFile.pcFilePath=LOGFILE_PATH;
 #endif
   LOGC_TEST_TRACE("Creating Log-Object...");
@@ -173,6 +319,166 @@ int main(void)
   }
 #endif /* LOGFILE_PATH */
 
+#ifdef LOGFILE_BACKPRESSURE_PATH
+  if(LogTest_Backpressure_g())
+  {
+    LOGC_TEST_TRACE("LogTest_Backpressure_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_BACKPRESSURE_PATH */
+
+#ifdef LOGFILE_TIMESOURCE_PATH
+  if(LogTest_TimeSource_g())
+  {
+    LOGC_TEST_TRACE("LogTest_TimeSource_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_TIMESOURCE_PATH */
+
+#ifdef LOGFILE_HEXDUMP_PATH
+  if(LogTest_HexDump_g())
+  {
+    LOGC_TEST_TRACE("LogTest_HexDump_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_HEXDUMP_PATH */
+
+#ifdef LOGFILE_LITERAL_PATH
+  if(LogTest_PlainLiteral_g())
+  {
+    LOGC_TEST_TRACE("LogTest_PlainLiteral_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_LITERAL_PATH */
+
+#ifdef LOGFILE_ROUTE_ERRORS_PATH
+  if(LogTest_FileRoutes_g())
+  {
+    LOGC_TEST_TRACE("LogTest_FileRoutes_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_ROUTE_ERRORS_PATH */
+
+#ifdef LOGFILE_RECORDER_PATH
+  if(LogTest_FlightRecorder_g())
+  {
+    LOGC_TEST_TRACE("LogTest_FlightRecorder_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_RECORDER_PATH */
+
+#ifdef LOGFILE_CONTEXT_PATH
+  if(LogTest_Context_g())
+  {
+    LOGC_TEST_TRACE("LogTest_Context_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_CONTEXT_PATH */
+
+#ifdef LOGFILE_BATCH_PATH
+  if(LogTest_Batch_g())
+  {
+    LOGC_TEST_TRACE("LogTest_Batch_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_BATCH_PATH */
+
+#ifdef LOGFILE_INDEX_PATH
+  if(LogTest_FileIndex_g())
+  {
+    LOGC_TEST_TRACE("LogTest_FileIndex_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_INDEX_PATH */
+
+#ifdef LOGFILE_SWAP_PATH
+  if(LogTest_FileQueueSwap_g())
+  {
+    LOGC_TEST_TRACE("LogTest_FileQueueSwap_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_SWAP_PATH */
+
+#ifdef LOGFILE_APPEND_PATH
+  if(LogTest_AppendProcesses_g())
+  {
+    LOGC_TEST_TRACE("LogTest_AppendProcesses_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_APPEND_PATH */
+
+#ifdef LOGFILE_CACHE_FORMAT
+  if(LogTest_FileCache_g())
+  {
+    LOGC_TEST_TRACE("LogTest_FileCache_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_CACHE_FORMAT */
+
+#ifdef LOGC_TEST_PROFILE_ENTRIES
+  if(LogTest_Profile_g())
+  {
+    LOGC_TEST_TRACE("LogTest_Profile_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGC_TEST_PROFILE_ENTRIES */
+
+#ifdef LOGC_TEST_SPAN_PATH
+  if(LogTest_Span_g())
+  {
+    LOGC_TEST_TRACE("LogTest_Span_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGC_TEST_SPAN_PATH */
+
+#ifdef LOGC_TEST_SHM_NAME
+  if(LogTest_Shm_g())
+  {
+    LOGC_TEST_TRACE("LogTest_Shm_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGC_TEST_SHM_NAME */
+
+#ifdef LOGC_TEST_SOCKET_PATH
+  if(LogTest_Socket_g())
+  {
+    LOGC_TEST_TRACE("LogTest_Socket_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGC_TEST_SOCKET_PATH */
+
+#ifdef LOGC_TEST_ENGINE_LOGS
+  if(LogTest_Engine_g())
+  {
+    LOGC_TEST_TRACE("LogTest_Engine_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGC_TEST_ENGINE_LOGS */
+
+#ifdef LOGFILE_FLUSHTIMER_PATH1
+  if(LogTest_FlushTimer_g())
+  {
+    LOGC_TEST_TRACE("LogTest_FlushTimer_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_FLUSHTIMER_PATH1 */
+
+#ifdef LOGFILE_PERCPU_PATH
+  if(LogTest_PerCpu_g())
+  {
+    LOGC_TEST_TRACE("LogTest_PerCpu_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_PERCPU_PATH */
+
+#ifdef LOGFILE_SHARED_PATH
+  if(LogTest_SharedFile_g())
+  {
+    LOGC_TEST_TRACE("LogTest_SharedFile_g() failed");
+    LOGTEST_EXIT_FAILURE(logCTest_m);
+  }
+#endif /* LOGFILE_SHARED_PATH */
+
 #ifdef LOG_MAX_STORAGE_COUNT
   if(LogTest_Storage_g(logCTest_m))
   {
@@ -209,6 +515,9 @@ int main(void)
 #ifdef LOGFILE_PATH
 int LogTest_File_g(LogC log)
 {
+  LogCStats stats;
+  unsigned long long ullSyncCount;
+  long lEntriesCount=3*LOGC_TEST_ENTRIES_COUNT;
   LOGC_TEST_TRACE("Testing: LOGC_FEATURE_ENABLE_LOGFILE");
   if(LogC_SetPrefixFormat(log,logPrefixFormat_m[4].options))
   {
@@ -216,29 +525,2214 @@ int LogTest_File_g(LogC log)
     return(-1);
   }
   LOGC_TEST_TRACE("Changing logfilepath from \"" LOGFILE_PATH "\" to \"" LOGFILE_PATH2 "\"...");
+  remove(LOGFILE_PATH2);
   if(LogC_SetFilePath(log,LOGFILE_PATH2))
   {
     printf("iLogC_SetFilePath_g() failed\n");
     return(-1);
   }
   LogCTest_AddTestEntrys_m(log,"Testing LogFile...");
+  LOGC_TEST_TRACE("Testing LogFile sync...");
+  if(LogC_SetFileSync(log,LOGC_FILESYNC_FLUSH,0))
+  {
+    printf("LogC_SetFileSync() failed\n");
+    return(-1);
+  }
+  LogCTest_AddTestEntrys_m(log,"Testing LogFile sync...");
+  if((LogC_WriteEntriesToDisk(log)) || (LogC_GetStats(log,&stats)))
+  {
+    printf("LogC_WriteEntriesToDisk() or LogC_GetStats() failed\n");
+    return(-1);
+  }
+  printf("Logfile writes: %llu, syncs: %llu, sync time total: %lluns, max: %lluns\n",
+         stats.ullFileWriteCount,stats.ullFileSyncCount,stats.ullFileSyncTimeTotalNs,stats.ullFileSyncTimeMaxNs);
+  if((!stats.ullFileSyncCount) || (stats.ullFileSyncCount>stats.ullFileWriteCount))
+  {
+    printf("Error in logfile sync statistics\n");
+    return(-1);
+  }
+  if(LogC_SetFileSync(log,LOGC_FILESYNC_INTERVAL,60000))
+  {
+    printf("LogC_SetFileSync() failed\n");
+    return(-1);
+  }
+  ullSyncCount=stats.ullFileSyncCount;
+  LogCTest_AddTestEntrys_m(log,"Testing LogFile sync interval...");
+  /* Synced within the interval, so just LogC_WriteEntriesToDisk() syncs the write */
+  if((LogC_WriteEntriesToDisk(log)) || (LogC_GetStats(log,&stats)) || (stats.ullFileSyncCount!=ullSyncCount+1))
+  {
+    printf("Write within the sync interval not synced by LogC_WriteEntriesToDisk()\n");
+    return(-1);
+  }
+  LOGC_TEST_TRACE("Testing LogFile direct mode...");
+  if(LogC_SetFileMode(log,LOGC_FILEMODE_DIRECT))
+  {
+    LOGC_TEST_TRACE("LOGC_FILEMODE_DIRECT not supported here, skipped");
+  }
+  else
+  {
+    LogCTest_AddTestEntrys_m(log,"Testing LogFile direct mode...");
+    if(LogC_WriteEntriesToDisk(log))
+    {
+      printf("LogC_WriteEntriesToDisk() failed\n");
+      return(-1);
+    }
+    LogCTest_AddTestEntrys_m(log,"Testing LogFile direct mode after partial block...");
+    lEntriesCount+=2*LOGC_TEST_ENTRIES_COUNT;
+  }
+  LOGC_TEST_TRACE("Testing LogFile append mode...");
+  if(LogC_SetFileMode(log,LOGC_FILEMODE_APPEND))
+  {
+    LOGC_TEST_TRACE("LOGC_FILEMODE_APPEND not supported here, skipped");
+  }
+  else
+  {
+    LogCTest_AddTestEntrys_m(log,"Testing LogFile append mode...");
+    lEntriesCount+=LOGC_TEST_ENTRIES_COUNT;
+  }
   LOGC_TEST_TRACE("Disabling logfile...");
   if(LogC_SetFilePath(log,NULL))
   {
     printf("iLogC_SetFilePath_g() failed\n");
     return(-1);
   }
+  if(LogTest_CountFileLines_m(LOGFILE_PATH2)!=lEntriesCount)
+  {
+    printf("Error in logfile, expected %ld complete lines\n",lEntriesCount);
+    return(-1);
+  }
   return(0);
 }
-#endif /* LOGFILE_PATH */
 
-#ifdef LOG_MAX_STORAGE_COUNT
-int LogTest_Storage_g(LogC log)
+#ifdef LOGFILE_BACKPRESSURE_PATH
+int LogTest_Backpressure_g(void)
 {
-  size_t szLength;
-  int iLogsCount=0;
-  char *pcLogText;
-  LOGC_TEST_TRACE("Testing: LOGC_FEATURE_ENABLE_LOG_STORAGE");
+  LogC log;
+  LogCFile logFile={0};
+  LogCStats stats;
+  int iIndex;
+
+  LOGC_TEST_TRACE("Testing: Backpressure");
+  mkdir(LOGFILE_BACKPRESSURE_DIR,0777);
+  logFile.pcFilePath=LOGFILE_BACKPRESSURE_PATH;
+  if(!(log=LogC_New(LOGC_ALL,
+                    150,
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  /* Make the logfile unavailable, so the filequeue runs full */
+  remove(LOGFILE_BACKPRESSURE_PATH);
+  rmdir(LOGFILE_BACKPRESSURE_DIR);
+  if(LogC_SetBackpressure(log,LOGC_BACKPRESSURE_DROP_NEWEST,LOGC_ERROR,0))
+  {
+    puts("LogC_SetBackpressure() failed!");
+    return(-1);
+  }
+  for(iIndex=0;iIndex<30;++iIndex)
+  {
+    LOGC_TEST_TEXT(log,LOGC_DEBUG,"Droppable entry %d",iIndex);
+  }
+  if(!LOG_TEXT(log,LOGC_ERROR,"Entry which is not droppable"))
+  {
+    puts("LOG_TEXT() didn't fail for blocking entry!");
+    return(-1);
+  }
+  if(LogC_SetBackpressure(log,LOGC_BACKPRESSURE_DROP_OLDEST,LOGC_NONE,0))
+  {
+    puts("LogC_SetBackpressure() failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log,LOGC_ERROR,"Droppable error entry, replaces the oldest one");
+  if(LogC_GetStats(log,&stats))
+  {
+    puts("LogC_GetStats() failed!");
+    return(-1);
+  }
+  printf("Dropped entries: %llu\n",stats.ullDroppedCount);
+  /* 10 entries fill the queue, 20 dropped, 1 error entry dropped and 1 entry dropped for the last one */
+  if(stats.ullDroppedCount!=20+1+1)
+  {
+    puts("Wrong count of dropped entries!");
+    return(-1);
+  }
+  /* Make the logfile available again, the marker entry must be written before the next entry */
+  mkdir(LOGFILE_BACKPRESSURE_DIR,0777);
+  LOGC_TEST_TEXT(log,LOGC_INFO,"Logfile available again");
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  /* Full queue from before, marker entry and last entry */
+  if(LogTest_CountFileLines_m(LOGFILE_BACKPRESSURE_PATH)!=10+1+1)
+  {
+    puts("Wrong count of lines in logfile!");
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_BACKPRESSURE_PATH */
+
+#ifdef LOGFILE_TIMESOURCE_PATH
+int LogTest_TimeSource_g(void)
+{
+  static const int iaTimeSources[]={LOGC_TIMESOURCE_REALTIME,LOGC_TIMESOURCE_REALTIME_COARSE,
+                                    LOGC_TIMESOURCE_MONOTONIC,LOGC_TIMESOURCE_TSC};
+  LogC log;
+  LogCFile logFile={0};
+  FILE *fp;
+  char caLine[100];
+  time_t tNow;
+  long lSecondNow;
+  long lSecondEntry;
+  int iHour,iMinute,iSecond;
+  int iIndex;
+  int iEntries=0;
+
+  LOGC_TEST_TRACE("Testing: Time sources");
+  remove(LOGFILE_TIMESOURCE_PATH);
+  logFile.pcFilePath=LOGFILE_TIMESOURCE_PATH;
+  if(!(log=LogC_New(LOGC_ALL,
+                    100,
+                    LOGC_OPTION_PREFIX_TIMESTAMP_TIME|LOGC_OPTION_PREFIX_TIMESTAMP_TIME_NANOSECS|
+                    LOGC_OPTION_TIMESTAMP_UTC|LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  if((!LogC_SetPrefixFormat(log,LOGC_OPTION_PREFIX_TIMESTAMP_TIME_MILLISECS|LOGC_OPTION_PREFIX_TIMESTAMP_TIME_NANOSECS)) ||
+     (!LogC_SetTimeSource(log,42)))
+  {
+    puts("Invalid precision or time source not detected!");
+    return(-1);
+  }
+  for(iIndex=0;iIndex<(int)(sizeof(iaTimeSources)/sizeof(iaTimeSources[0]));++iIndex)
+  {
+    if(LogC_SetTimeSource(log,iaTimeSources[iIndex]))
+    {
+      printf("Time source %d not available\n",iaTimeSources[iIndex]);
+      continue;
+    }
+    LOGC_TEST_TEXT(log,LOGC_INFO,"Time source %d",iaTimeSources[iIndex]);
+    ++iEntries;
+  }
+  tNow=time(NULL);
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  /* Each entry must look like "12:34:56.123456789: Time source 0" and be close to the current time */
+  lSecondNow=(long)(tNow%86400);
+  if(!(fp=fopen(LOGFILE_TIMESOURCE_PATH,"r")))
+    return(-1);
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    printf("%s",caLine);
+    if((sscanf(caLine,"%2d:%2d:%2d.",&iHour,&iMinute,&iSecond)!=3) ||
+       (caLine[8]!='.') || (strspn(&caLine[9],"0123456789")!=9) || (strncmp(&caLine[18],": Time source",13)))
+    {
+      puts("Wrong format of timestamp!");
+      fclose(fp);
+      return(-1);
+    }
+    lSecondEntry=iHour*3600L+iMinute*60L+iSecond;
+    if(((lSecondNow-lSecondEntry+86400)%86400)>5)
+    {
+      puts("Timestamp too far from the current time!");
+      fclose(fp);
+      return(-1);
+    }
+    --iEntries;
+  }
+  fclose(fp);
+  return((iEntries)?-1:0);
+}
+#endif /* LOGFILE_TIMESOURCE_PATH */
+
+#ifdef LOGC_TEST_ENGINE_LOGS
+int LogTest_Engine_g(void)
+{
+  LogC taLogs[LOGC_TEST_ENGINE_LOGS];
+  LogC log;
+  LogCFile logFile={0};
+  char caaPaths[LOGC_TEST_ENGINE_LOGS][32];
+  int iLog;
+  int iIndex;
+
+  LOGC_TEST_TRACE("Testing: Writer engine");
+  if(LogC_EngineStart(10))
+  {
+    puts("LogC_EngineStart() failed!");
+    return(-1);
+  }
+  for(iLog=0;iLog<LOGC_TEST_ENGINE_LOGS;++iLog)
+  {
+    sprintf(caaPaths[iLog],"Test_Engine%d.log",iLog);
+    remove(caaPaths[iLog]);
+    logFile.pcFilePath=caaPaths[iLog];
+    if(!(taLogs[iLog]=LogC_New(LOGC_ALL,
+                               150,
+                               LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR|LOGC_OPTION_THREADSAFE
+                               ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                               ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                               )))
+    {
+      puts("LogC_New() failed!");
+      return(-1);
+    }
+    if(LogC_EngineAttach(taLogs[iLog]))
+    {
+      puts("LogC_EngineAttach() failed!");
+      return(-1);
+    }
+  }
+  for(iIndex=0;iIndex<LOGC_TEST_ENGINE_ENTRIES;++iIndex)
+  {
+    for(iLog=0;iLog<LOGC_TEST_ENGINE_LOGS;++iLog)
+    {
+      LOGC_TEST_TEXT(taLogs[iLog],LOGC_INFO,"Log %d, entry %d",iLog,iIndex);
+    }
+  }
+  /* The partially filled queues are written by the engine too, after the interval */
+  LogTest_SleepMs_m(200);
+  for(iLog=0;iLog<LOGC_TEST_ENGINE_LOGS;++iLog)
+  {
+    if(LogTest_CountFileLines_m(caaPaths[iLog])!=LOGC_TEST_ENGINE_ENTRIES)
+    {
+      printf("Wrong count of lines in %s!\n",caaPaths[iLog]);
+      return(-1);
+    }
+  }
+  /* The first Log-Object is detached by LogC_End(), the others by LogC_EngineStop() */
+  for(iLog=0;iLog<LOGC_TEST_ENGINE_LOGS;++iLog)
+  {
+    LOGC_TEST_TEXT(taLogs[iLog],LOGC_INFO,"Log %d, last entry",iLog);
+  }
+  if((LogC_End(taLogs[0])) || (LogC_EngineStop()))
+  {
+    puts("LogC_End() or LogC_EngineStop() failed!");
+    return(-1);
+  }
+  for(iLog=0;iLog<LOGC_TEST_ENGINE_LOGS;++iLog)
+  {
+    if(LogTest_CountFileLines_m(caaPaths[iLog])!=LOGC_TEST_ENGINE_ENTRIES+1)
+    {
+      printf("Wrong count of lines in %s after stopping the engine!\n",caaPaths[iLog]);
+      return(-1);
+    }
+    if((iLog) && (LogC_End(taLogs[iLog])))
+    {
+      puts("LogC_End() failed!");
+      return(-1);
+    }
+  }
+  /* Just threadsafe Log-Objects can be attached */
+  logFile.pcFilePath=caaPaths[0];
+  if((LogC_EngineStart(0)) ||
+     (!(log=LogC_New(LOGC_ALL,
+                     150,
+                     LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                     ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                     ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                     ))))
+  {
+    puts("LogC_EngineStart() or LogC_New() failed!");
+    return(-1);
+  }
+  if(!LogC_EngineAttach(log))
+  {
+    puts("LogC_EngineAttach() didn't fail for a Log-Object without LOGC_OPTION_THREADSAFE!");
+    return(-1);
+  }
+  if((LogC_End(log)) || (LogC_EngineStop()))
+  {
+    puts("LogC_End() or LogC_EngineStop() failed!");
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGC_TEST_ENGINE_LOGS */
+
+#ifdef LOGFILE_FLUSHTIMER_PATH1
+int LogTest_FlushTimer_g(void)
+{
+  LogC log1;
+  LogC log2;
+  LogCFile logFile={0};
+  LogCStats tagStats;
+  int iIndex;
+
+  LOGC_TEST_TRACE("Testing: Flush timer");
+  if(LogC_FlushTimerStart())
+  {
+    puts("LogC_FlushTimerStart() failed!");
+    return(-1);
+  }
+  remove(LOGFILE_FLUSHTIMER_PATH1);
+  remove(LOGFILE_FLUSHTIMER_PATH2);
+  logFile.pcFilePath=LOGFILE_FLUSHTIMER_PATH1;
+  log1=LogC_New(LOGC_ALL,
+                150,
+                LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR|LOGC_OPTION_THREADSAFE
+                ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                );
+  logFile.pcFilePath=LOGFILE_FLUSHTIMER_PATH2;
+  log2=LogC_New(LOGC_ALL,
+                150,
+                LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR|LOGC_OPTION_THREADSAFE
+                ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                );
+  if((!log1) || (!log2))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  /* The first Log-Object has a short max age, the second one a long max age */
+  if((LogC_SetFileMaxAge(log1,20)) || (LogC_SetFileMaxAge(log2,60000)))
+  {
+    puts("LogC_SetFileMaxAge() failed!");
+    return(-1);
+  }
+  for(iIndex=0;iIndex<3;++iIndex)
+  {
+    LOGC_TEST_TEXT(log1,LOGC_INFO,"Log 1, entry %d",iIndex);
+    LOGC_TEST_TEXT(log2,LOGC_INFO,"Log 2, entry %d",iIndex);
+  }
+  LogTest_SleepMs_m(200);
+  if((LogTest_CountFileLines_m(LOGFILE_FLUSHTIMER_PATH1)!=3) ||
+     (LogTest_CountFileLines_m(LOGFILE_FLUSHTIMER_PATH2)>0))
+  {
+    puts("Partial filequeues not written by their max age!");
+    return(-1);
+  }
+  /* The emptied filequeue starts its max age again with the next entry */
+  LOGC_TEST_TEXT(log1,LOGC_INFO,"Log 1, last entry");
+  LogTest_SleepMs_m(200);
+  if(LogTest_CountFileLines_m(LOGFILE_FLUSHTIMER_PATH1)!=4)
+  {
+    puts("Partial filequeue not written again by its max age!");
+    return(-1);
+  }
+  /* A write within the sync interval is synced by the timer, when the interval expired */
+  if(LogC_SetFileSync(log1,LOGC_FILESYNC_INTERVAL,100))
+  {
+    puts("LogC_SetFileSync() failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log1,LOGC_INFO,"Log 1, synced entry");
+  LogTest_SleepMs_m(50);
+  LOGC_TEST_TEXT(log1,LOGC_INFO,"Log 1, deferred synced entry");
+  LogTest_SleepMs_m(300);
+  if((LogC_GetStats(log1,&tagStats)) || (tagStats.ullFileSyncCount!=2))
+  {
+    printf("%llu syncs instead of 2!\n",tagStats.ullFileSyncCount);
+    return(-1);
+  }
+  /* Removing the max age keeps the entries buffered */
+  if((LogC_SetFileMaxAge(log2,20)) || (LogC_SetFileMaxAge(log2,0)))
+  {
+    puts("LogC_SetFileMaxAge() failed!");
+    return(-1);
+  }
+  LogTest_SleepMs_m(100);
+  if(LogTest_CountFileLines_m(LOGFILE_FLUSHTIMER_PATH2)>0)
+  {
+    puts("Filequeue written after removing the max age!");
+    return(-1);
+  }
+  /* The first Log-Object is removed from the timer by LogC_End() */
+  if((LogC_End(log1)) || (LogC_End(log2)) || (LogC_FlushTimerStop()))
+  {
+    puts("LogC_End() or LogC_FlushTimerStop() failed!");
+    return(-1);
+  }
+  if(LogTest_CountFileLines_m(LOGFILE_FLUSHTIMER_PATH2)!=3)
+  {
+    puts("Wrong count of lines in " LOGFILE_FLUSHTIMER_PATH2 "!");
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_FLUSHTIMER_PATH1 */
+
+#ifdef LOGFILE_PERCPU_PATH
+typedef struct
+{
+  LogC log;
+  int iThread;
+}TagLogTestPerCpuArg;
+
+void *pvLogTest_PerCpuThread_m(void *pvArg)
+{
+  TagLogTestPerCpuArg *ptagArg=pvArg;
+  int iIndex;
+  for(iIndex=0;iIndex<LOGC_TEST_PERCPU_ENTRIES;++iIndex)
+  {
+    LOGC_TEST_TEXT(ptagArg->log,LOGC_INFO,"Thread %d, entry %d",ptagArg->iThread,iIndex);
+  }
+  return(NULL);
+}
+
+int LogTest_PerCpu_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  pthread_t taThreads[LOGC_TEST_PERCPU_THREADS];
+  TagLogTestPerCpuArg tagaArgs[LOGC_TEST_PERCPU_THREADS];
+  int iaNextEntry[LOGC_TEST_PERCPU_THREADS]={0};
+  char caLine[100];
+  FILE *fp;
+  int iThread;
+  int iEntry;
+
+  LOGC_TEST_TRACE("Testing: Per-CPU buffers");
+  remove(LOGFILE_PERCPU_PATH);
+  logFile.pcFilePath=LOGFILE_PERCPU_PATH;
+  if(!(log=LogC_New(LOGC_ALL,
+                    150,
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR|LOGC_OPTION_THREADSAFE
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  if(LogC_SetPerCpuBuffers(log,16))
+  {
+    puts("LogC_SetPerCpuBuffers() failed!");
+    return(-1);
+  }
+  for(iThread=0;iThread<LOGC_TEST_PERCPU_THREADS;++iThread)
+  {
+    tagaArgs[iThread].log=log;
+    tagaArgs[iThread].iThread=iThread;
+    if(pthread_create(&taThreads[iThread],NULL,pvLogTest_PerCpuThread_m,&tagaArgs[iThread]))
+    {
+      puts("pthread_create() failed!");
+      return(-1);
+    }
+  }
+  for(iThread=0;iThread<LOGC_TEST_PERCPU_THREADS;++iThread)
+  {
+    pthread_join(taThreads[iThread],NULL);
+  }
+  /* Resizing and disabling drain the buffers */
+  if((LogC_SetPerCpuBuffers(log,8)) ||
+     (LogC_SetPerCpuBuffers(log,0)) ||
+     (LogC_WriteEntriesToDisk(log)))
+  {
+    puts("Disabling the per-CPU buffers failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log,LOGC_INFO,"Thread 0, entry %d",LOGC_TEST_PERCPU_ENTRIES); /* Added to the filequeue directly */
+  if(LogC_WriteEntriesToDisk(log))
+  {
+    puts("LogC_WriteEntriesToDisk() failed!");
+    return(-1);
+  }
+  if(!(fp=fopen(LOGFILE_PERCPU_PATH,"r")))
+    return(-1);
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    if((sscanf(caLine,"Thread %d, entry %d",&iThread,&iEntry)!=2) ||
+       (iThread<0) || (iThread>=LOGC_TEST_PERCPU_THREADS) ||
+       (iEntry!=iaNextEntry[iThread]++))
+    {
+      printf("Unexpected entry: %s",caLine);
+      fclose(fp);
+      return(-1);
+    }
+  }
+  fclose(fp);
+  for(iThread=0;iThread<LOGC_TEST_PERCPU_THREADS;++iThread)
+  {
+    if(iaNextEntry[iThread]!=LOGC_TEST_PERCPU_ENTRIES+(iThread==0))
+    {
+      printf("Missing entries of thread %d!\n",iThread);
+      return(-1);
+    }
+  }
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_PERCPU_PATH */
+
+/* Returns the count of lines in the file, or -1 if the last line is incomplete */
+long LogTest_CountFileLines_m(const char *pcPath)
+{
+  FILE *fp;
+  int iChar;
+  int iLastChar='\n';
+  long lLines=0;
+
+  if(!(fp=fopen(pcPath,"r")))
+    return(-1);
+  while((iChar=fgetc(fp))!=EOF)
+  {
+    if(iChar=='\n')
+      ++lLines;
+    iLastChar=iChar;
+  }
+  fclose(fp);
+  return((iLastChar=='\n')?lLines:-1);
+}
+#endif /* LOGFILE_PATH */
+
+#ifdef LOGFILE_HEXDUMP_PATH
+int LogTest_HexDump_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  FILE *fp;
+  unsigned char ucaData[LOGC_TEST_HEXDUMP_SIZE];
+  unsigned char ucaRead[LOGC_TEST_HEXDUMP_SIZE];
+  char caLine[100];
+  unsigned int uiOffset;
+  unsigned int uiTotal;
+  unsigned int uiByte;
+  int iPos;
+  int iEntries=0;
+  size_t szRead=0;
+  size_t szIndex;
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+  char *pcEntry;
+  size_t szEntryLength;
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+
+  LOGC_TEST_TRACE("Testing: Hexdump");
+  for(szIndex=0;szIndex<sizeof(ucaData);++szIndex)
+    ucaData[szIndex]=(unsigned char)(szIndex*7);
+  remove(LOGFILE_HEXDUMP_PATH);
+  logFile.pcFilePath=LOGFILE_HEXDUMP_PATH;
+  if(!(log=LogC_New(LOGC_ALL,
+                    60,
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,5
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+  /* The raw payload comes back unchanged, including '\0' bytes */
+  if(LogC_StorageAddBinary(log,LOGC_INFO,ucaData,sizeof(ucaData)))
+  {
+    puts("LogC_StorageAddBinary() failed!");
+    return(-1);
+  }
+  if((!(pcEntry=LogC_StorageGetNextLog(log,&szEntryLength))) ||
+     (szEntryLength!=sizeof(ucaData)+1) || (memcmp(pcEntry,ucaData,sizeof(ucaData))))
+  {
+    puts("Wrong binary entry in storage!");
+    return(-1);
+  }
+  free(pcEntry);
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+  /* 100 bytes don't fit into one entry of 60 chars, so they are continued */
+  if(LOG_HEXDUMP(log,LOGC_INFO,ucaData,sizeof(ucaData),"Payload %d",1))
+  {
+    puts("LOG_HEXDUMP() failed!");
+    return(-1);
+  }
+  if(!LOG_HEXDUMP(log,LOGC_INFO,ucaData,sizeof(ucaData),"%s","Text without space for the payload, which fills the entry"))
+  {
+    puts("LOG_HEXDUMP() didn't fail without space for the payload!");
+    return(-1);
+  }
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  /* Each entry must look like "Payload 1 [offset/100] 00070e..." and continue the last one */
+  if(!(fp=fopen(LOGFILE_HEXDUMP_PATH,"r")))
+    return(-1);
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    printf("%s",caLine);
+    if((sscanf(caLine,"Payload 1 [%u/%u] %n",&uiOffset,&uiTotal,&iPos)!=2) ||
+       (uiOffset!=szRead) || (uiTotal!=sizeof(ucaData)))
+    {
+      puts("Wrong continuation entry!");
+      fclose(fp);
+      return(-1);
+    }
+    while((szRead<sizeof(ucaData)) && (sscanf(&caLine[iPos],"%2x",&uiByte)==1))
+    {
+      ucaRead[szRead++]=(unsigned char)uiByte;
+      iPos+=2;
+    }
+    ++iEntries;
+  }
+  fclose(fp);
+  if((iEntries<2) || (szRead!=sizeof(ucaData)) || (memcmp(ucaData,ucaRead,sizeof(ucaData))))
+  {
+    puts("Wrong payload in logfile!");
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_HEXDUMP_PATH */
+
+#ifdef LOGFILE_LITERAL_PATH
+/* Each literal is logged with LOG_TEXT() and formatted with "%s", the entries must be the same */
+int LogTest_PlainLiteral_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  FILE *fp;
+  char caLiteral[100];
+  char caFormatted[100];
+  int iEntries=0;
+
+  LOGC_TEST_TRACE("Testing: String literals without formatting");
+  remove(LOGFILE_LITERAL_PATH);
+  logFile.pcFilePath=LOGFILE_LITERAL_PATH;
+  if(!(log=LogC_New(LOGC_ALL,
+                    LOGC_TEST_LITERAL_MAX_ENTRY_LENGTH,
+                    LOGC_OPTION_PREFIX_LOGTYPETEXT|LOGC_OPTION_PREFIX_FUNCTIONNAME|
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  /* Just the first one may take the plain path, a '%' always needs formatting */
+  if((LOG_TEXT(log,LOGC_INFO,"Plain literal")) ||
+     (LogC_AddEntry_Text(log,LOGC_INFO,__FILE__,__LINE__,LOGC_FUNCTIONNAME,"%s","Plain literal")) ||
+     (LOG_TEXT(log,LOGC_WARNING,"100%% with percent")) ||
+     (LogC_AddEntry_Text(log,LOGC_WARNING,__FILE__,__LINE__,LOGC_FUNCTIONNAME,"%s","100% with percent")))
+  {
+    puts("LOG_TEXT() or LogC_AddEntry_Text() failed!");
+    return(-1);
+  }
+  /* Truncated, both report it the same way */
+  if(LOG_TEXT(log,LOGC_ERROR,"Plain literal which is longer than the maximum entry length")!=
+     LogC_AddEntry_Text(log,LOGC_ERROR,__FILE__,__LINE__,LOGC_FUNCTIONNAME,"%s","Plain literal which is longer than the maximum entry length"))
+  {
+    puts("Truncation reported differently!");
+    return(-1);
+  }
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  if(!(fp=fopen(LOGFILE_LITERAL_PATH,"r")))
+    return(-1);
+  while((fgets(caLiteral,sizeof(caLiteral),fp)) && (fgets(caFormatted,sizeof(caFormatted),fp)))
+  {
+    printf("%s",caLiteral);
+    if(strcmp(caLiteral,caFormatted))
+    {
+      printf("Formatted entry differs: %s",caFormatted);
+      fclose(fp);
+      return(-1);
+    }
+    ++iEntries;
+  }
+  fclose(fp);
+  if(iEntries!=3)
+  {
+    puts("Wrong count of entries in logfile!");
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_LITERAL_PATH */
+
+#ifdef LOGFILE_ROUTE_ERRORS_PATH
+int LogTest_FileRoutes_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  LogCFileRoute tagaRoutes[3];
+#ifdef LOGFILE_BACKPRESSURE_DIR
+  LogCStats stats;
+#endif /* LOGFILE_BACKPRESSURE_DIR */
+  int iIndex;
+
+  LOGC_TEST_TRACE("Testing: Routing logtypes to logfiles");
+  remove(LOGFILE_ROUTE_ERRORS_PATH);
+  remove(LOGFILE_ROUTE_APP_PATH);
+  remove(LOGFILE_ROUTE_DEBUG_PATH);
+  memset(tagaRoutes,0,sizeof(tagaRoutes));
+  /* Errors are written and synced immediately, info and above (overlapping) and debug use the default queue */
+  tagaRoutes[0].pcFilePath=LOGFILE_ROUTE_ERRORS_PATH;
+  tagaRoutes[0].iMinLogType=LOGC_WARNING;
+  tagaRoutes[0].iMaxLogType=LOGC_FATAL;
+  tagaRoutes[0].szQueueSize=1;
+  tagaRoutes[0].iSyncMode=LOGC_FILESYNC_FLUSH;
+  tagaRoutes[1].pcFilePath=LOGFILE_ROUTE_APP_PATH;
+  tagaRoutes[1].iMinLogType=LOGC_INFO;
+  tagaRoutes[1].iMaxLogType=LOGC_FATAL;
+  tagaRoutes[2].pcFilePath=LOGFILE_ROUTE_DEBUG_PATH;
+  tagaRoutes[2].iMinLogType=LOGC_ALL;
+  tagaRoutes[2].iMaxLogType=LOGC_DEBUG;
+  /* Just the routes, without the logfile with all entries */
+  logFile.ptagRoutes=tagaRoutes;
+  logFile.szRouteCount=3;
+  if(!(log=LogC_New(LOGC_ALL,
+                    100,
+                    LOGC_OPTION_PREFIX_LOGTYPETEXT|LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+                    |LOGC_OPTION_THREADSAFE
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  tagaRoutes[2].iMaxLogType=LOGC_ALL-1;
+  if(!LogC_SetFileRoutes(log,tagaRoutes,3))
+  {
+    puts("Invalid range of logtypes not detected!");
+    return(-1);
+  }
+  tagaRoutes[2].iMaxLogType=LOGC_DEBUG;
+  if(LogC_SetFileRoutes(log,tagaRoutes,3))
+  {
+    puts("LogC_SetFileRoutes() failed!");
+    return(-1);
+  }
+  for(iIndex=0;iIndex<3;++iIndex)
+  {
+    LOGC_TEST_TEXT(log,LOGC_DEBUG_MORE,"Routed debug entry %d",iIndex);
+    LOGC_TEST_TEXT(log,LOGC_INFO,"Routed info entry %d",iIndex);
+    LOGC_TEST_TEXT(log,LOGC_ERROR,"Routed error entry %d",iIndex);
+  }
+  /* Just the queue of the error route is written yet */
+  if((LogTest_CountFileLines_m(LOGFILE_ROUTE_ERRORS_PATH)!=3) ||
+     (LogTest_CountFileLines_m(LOGFILE_ROUTE_APP_PATH)!=0) ||
+     (LogTest_CountFileLines_m(LOGFILE_ROUTE_DEBUG_PATH)!=0))
+  {
+    puts("Wrong count of written entries before writing the queues!");
+    return(-1);
+  }
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  if((LogTest_CountFileLines_m(LOGFILE_ROUTE_ERRORS_PATH)!=3) ||
+     (LogTest_CountFileLines_m(LOGFILE_ROUTE_APP_PATH)!=6) ||
+     (LogTest_CountFileLines_m(LOGFILE_ROUTE_DEBUG_PATH)!=3))
+  {
+    puts("Wrong count of entries in the routed logfiles!");
+    return(-1);
+  }
+#ifdef LOGFILE_BACKPRESSURE_DIR
+  /* A failed write of a route is counted and reported for blocking backpressure, the entry stays queued */
+  mkdir(LOGFILE_BACKPRESSURE_DIR,0777);
+  tagaRoutes[0].pcFilePath=LOGFILE_BACKPRESSURE_PATH;
+  logFile.szRouteCount=1;
+  if(!(log=LogC_New(LOGC_ALL,
+                    100,
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  remove(LOGFILE_BACKPRESSURE_PATH);
+  rmdir(LOGFILE_BACKPRESSURE_DIR);
+  if(!LOG_TEXT(log,LOGC_ERROR,"Entry of a route which can't be written"))
+  {
+    puts("LOG_TEXT() didn't fail for a route which can't be written!");
+    return(-1);
+  }
+  if((LogC_GetStats(log,&stats)) || (stats.ullFileRouteErrorCount!=1))
+  {
+    puts("Failed write of the route not counted!");
+    return(-1);
+  }
+  mkdir(LOGFILE_BACKPRESSURE_DIR,0777);
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  if(LogTest_CountFileLines_m(LOGFILE_BACKPRESSURE_PATH)!=1)
+  {
+    puts("Entry of the route not written after the failed write!");
+    return(-1);
+  }
+#endif /* LOGFILE_BACKPRESSURE_DIR */
+  return(0);
+}
+#endif /* LOGFILE_ROUTE_ERRORS_PATH */
+
+#ifdef LOGFILE_RECORDER_PATH
+int LogTest_FlightRecorder_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  FILE *fp;
+  char caText[20];
+  char caLine[150];
+  char caExpected[150];
+  const char caNoEnd[3]={'a','b','c'};
+  int iIndex;
+  int iLine=0;
+
+  LOGC_TEST_TRACE("Testing: Flight recorder");
+  remove(LOGFILE_RECORDER_PATH);
+  logFile.pcFilePath=LOGFILE_RECORDER_PATH;
+  if(!(log=LogC_New(LOGC_INFO,
+                    100,
+                    LOGC_OPTION_PREFIX_LOGTYPETEXT|LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+                    |LOGC_OPTION_THREADSAFE
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  if((LogC_SetFlightRecorder(log,LOGC_DEBUG,LOGC_ERROR,4)) || (!LogC_SetFlightRecorder(log,LOGC_DEBUG,LOGC_ERROR,4)))
+  {
+    puts("LogC_SetFlightRecorder() failed!");
+    return(-1);
+  }
+  if((!LogC_IsLogTypeEnabled(log,LOGC_DEBUG)) || (LogC_IsLogTypeEnabled(log,LOGC_DEBUG_MORE)))
+  {
+    puts("Recorded logtypes not enabled!");
+    return(-1);
+  }
+  /* 6 entries are recorded, the ring keeps the last 4 */
+  for(iIndex=0;iIndex<5;++iIndex)
+  {
+    sprintf(caText,"copy%d",iIndex);
+    LOGC_TEST_TEXT(log,LOGC_DEBUG,LOGC_TEST_RECORDER_FORMAT,iIndex,caText,"ab",iIndex*1.25,255ULL<<iIndex,'a'+iIndex,5,iIndex,2,"xyz");
+    strcpy(caText,"changed"); /* Strings are recorded by value */
+  }
+  /* Can't be packed, so it's formatted immediately */
+  LOGC_TEST_TEXT(log,LOGC_DEBUG,"Wide %ls",L"text");
+  LOGC_TEST_TEXT(log,LOGC_DEBUG_MORE,"Not recorded");
+  LOGC_TEST_TEXT(log,LOGC_INFO,"Info entry");
+  LOGC_TEST_TEXT(log,LOGC_ERROR,"Error %d",1);
+  LOGC_TEST_TEXT(log,LOGC_ERROR,"Error %d",2); /* Nothing recorded since the last error */
+  /* Strings are just read up to the precision, like printf() does */
+  LOGC_TEST_TEXT(log,LOGC_DEBUG,"Unterminated %.*s|%.2s",3,caNoEnd,caNoEnd);
+  LOGC_TEST_TEXT(log,LOGC_ERROR,"Error %d",3);
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  if(!(fp=fopen(LOGFILE_RECORDER_PATH,"r")))
+  {
+    puts("Failed to open the logfile!");
+    return(-1);
+  }
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    if(iLine==0)
+      strcpy(caExpected,"[Info]: Info entry\n");
+    else if(iLine<4)
+    {
+      /* Formatted when dumped, like LOG_TEXT() does */
+      iIndex=iLine+1;
+      sprintf(caText,"copy%d",iIndex);
+      strcpy(caExpected,"[Debug]: ");
+      sprintf(&caExpected[strlen(caExpected)],LOGC_TEST_RECORDER_FORMAT "\n",
+              iIndex,caText,"ab",iIndex*1.25,255ULL<<iIndex,'a'+iIndex,5,iIndex,2,"xyz");
+    }
+    else if(iLine==4)
+      strcpy(caExpected,"[Debug]: Wide text\n");
+    else if(iLine==7)
+      strcpy(caExpected,"[Debug]: Unterminated abc|ab\n");
+    else
+      sprintf(caExpected,"[Error]: Error %d\n",(iLine<7)?iLine-4:3);
+    if(strcmp(caLine,caExpected))
+    {
+      printf("Wrong entry %d: %s",iLine,caLine);
+      fclose(fp);
+      return(-1);
+    }
+    ++iLine;
+  }
+  fclose(fp);
+  if(iLine!=9)
+  {
+    printf("Wrong count of entries: %d\n",iLine);
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_RECORDER_PATH */
+
+#ifdef LOGFILE_CONTEXT_PATH
+int LogTest_Context_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  FILE *fp;
+  char caValue[300];
+  char caLine[150];
+  char caExpected[150];
+  unsigned long long ullThreadId=0;
+  const char *pcaExpected[]={"No context",
+                             "request=17 tenant=acme: Two fields",
+                             "request=17: One field",
+                             "request=18: Replaced"};
+  int iLine=0;
+
+  LOGC_TEST_TRACE("Testing: Thread context");
+  remove(LOGFILE_CONTEXT_PATH);
+  logFile.pcFilePath=LOGFILE_CONTEXT_PATH;
+  if(!(log=LogC_New(LOGC_INFO,
+                    100,
+                    LOGC_OPTION_PREFIX_LOGTYPETEXT|LOGC_OPTION_PREFIX_THREADID|LOGC_OPTION_PREFIX_CONTEXT|
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log,LOGC_INFO,"No context");
+  if((LogC_ContextPush("request","17")) || (LogC_ContextPush("tenant","acme")))
+  {
+    puts("LogC_ContextPush() failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log,LOGC_INFO,"Two fields");
+  memset(caValue,'x',sizeof(caValue)-1);
+  caValue[sizeof(caValue)-1]='\0';
+  if((!LogC_ContextPush("long",caValue)) || (!LogC_ContextPush("",caValue)) || (LogC_ContextPop()))
+  {
+    puts("LogC_ContextPush()/LogC_ContextPop() failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log,LOGC_INFO,"One field");
+  if((LogC_ContextPop()) || (LogC_ContextPush("request","18")))
+  {
+    puts("LogC_ContextPop() failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log,LOGC_INFO,"Replaced");
+  /* Without the options, the context is not added */
+  if(LogC_SetPrefixFormat(log,LOGC_OPTION_PREFIX_LOGTYPETEXT))
+  {
+    puts("LogC_SetPrefixFormat() failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log,LOGC_INFO,"Not added");
+  LogC_ContextClear();
+  if(!LogC_ContextPop())
+  {
+    puts("LogC_ContextClear() failed!");
+    return(-1);
+  }
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  if(!(fp=fopen(LOGFILE_CONTEXT_PATH,"r")))
+  {
+    puts("Failed to open the logfile!");
+    return(-1);
+  }
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    if(iLine==0)
+    {
+      if(sscanf(caLine,"[Info] tid=%llu",&ullThreadId)!=1)
+        ullThreadId=0; /* Fails below */
+      sprintf(caExpected,"[Info] tid=%llu: %s\n",ullThreadId,pcaExpected[iLine]);
+    }
+    else if(iLine<4)
+      sprintf(caExpected,"[Info] tid=%llu %s\n",ullThreadId,pcaExpected[iLine]);
+    else
+      strcpy(caExpected,"[Info]: Not added\n");
+    if(strcmp(caLine,caExpected))
+    {
+      printf("Wrong entry %d: %s",iLine,caLine);
+      fclose(fp);
+      return(-1);
+    }
+    ++iLine;
+  }
+  fclose(fp);
+  if(iLine!=5)
+  {
+    printf("Wrong count of entries: %d\n",iLine);
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_CONTEXT_PATH */
+
+#ifdef LOGFILE_BATCH_PATH
+typedef struct
+{
+  LogC log;
+  int iThread;
+  int iFailed;
+}TagLogTestBatchArg;
+
+void *pvLogTest_BatchThread_m(void *pvArg)
+{
+  TagLogTestBatchArg *ptagArg=pvArg;
+  LogCBatch batch;
+  int iBatch;
+  int iLine;
+  int iLines;
+
+  for(iBatch=0;iBatch<LOGC_TEST_BATCH_COUNT;++iBatch)
+  {
+    iLines=(iBatch%2)?3:25;
+    if(!(batch=LogC_BatchBegin(ptagArg->log,4)))
+    {
+      ptagArg->iFailed=1;
+      return(NULL);
+    }
+    for(iLine=0;iLine<iLines;++iLine)
+    {
+      if(LOG_BATCH_TEXT(batch,LOGC_INFO,"Thread %d, batch %d, line %d/%d",ptagArg->iThread,iBatch,iLine,iLines))
+        ptagArg->iFailed=1;
+      /* Below the loglevel, skipped */
+      if(LOG_BATCH_TEXT(batch,LOGC_DEBUG,"Not added"))
+        ptagArg->iFailed=1;
+    }
+    if(LogC_BatchCommit(batch))
+      ptagArg->iFailed=1;
+    LOGC_TEST_TEXT(ptagArg->log,LOGC_INFO,"Thread %d, single %d",ptagArg->iThread,iBatch);
+  }
+  return(NULL);
+}
+
+int LogTest_Batch_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  TagLogTestBatchArg tagaArgs[LOGC_TEST_BATCH_THREADS];
+#if defined(LOGC_TEST_THREADS) && defined(__unix__)
+  pthread_t taThreads[LOGC_TEST_BATCH_THREADS];
+#endif /* LOGC_TEST_THREADS && __unix__ */
+  int iaEntries[LOGC_TEST_BATCH_THREADS]={0};
+  char caLine[100];
+  FILE *fp;
+  int iThreads=1;
+  int iThread;
+  int iBatch;
+  int iLine;
+  int iLines;
+  int iCurrThread=-1;
+  int iCurrBatch=-1;
+  int iNextLine=0;
+
+  LOGC_TEST_TRACE("Testing: Batches");
+  remove(LOGFILE_BATCH_PATH);
+  logFile.pcFilePath=LOGFILE_BATCH_PATH;
+  if(!(log=LogC_New(LOGC_INFO,
+                    100,
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+#ifdef LOGC_FEATURE_ENABLE_THREADSAFETY
+                    |LOGC_OPTION_THREADSAFE
+#endif /* LOGC_FEATURE_ENABLE_THREADSAFETY */
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  if(LogC_BatchCommit(LogC_BatchBegin(log,0))) /* Empty batch */
+  {
+    puts("LogC_BatchCommit() failed!");
+    return(-1);
+  }
+#if defined(LOGC_TEST_THREADS) && defined(__unix__)
+  iThreads=LOGC_TEST_BATCH_THREADS;
+  for(iThread=0;iThread<iThreads;++iThread)
+  {
+    tagaArgs[iThread].log=log;
+    tagaArgs[iThread].iThread=iThread;
+    tagaArgs[iThread].iFailed=0;
+    if(pthread_create(&taThreads[iThread],NULL,pvLogTest_BatchThread_m,&tagaArgs[iThread]))
+    {
+      puts("pthread_create() failed!");
+      return(-1);
+    }
+  }
+  for(iThread=0;iThread<iThreads;++iThread)
+  {
+    pthread_join(taThreads[iThread],NULL);
+  }
+#else
+  tagaArgs[0].log=log;
+  tagaArgs[0].iThread=0;
+  tagaArgs[0].iFailed=0;
+  pvLogTest_BatchThread_m(&tagaArgs[0]);
+#endif /* LOGC_TEST_THREADS && __unix__ */
+  for(iThread=0;iThread<iThreads;++iThread)
+  {
+    if(tagaArgs[iThread].iFailed)
+    {
+      printf("Adding the batches of thread %d failed!\n",iThread);
+      return(-1);
+    }
+  }
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  if(!(fp=fopen(LOGFILE_BATCH_PATH,"r")))
+  {
+    puts("Failed to open the logfile!");
+    return(-1);
+  }
+  /* The lines of each batch must follow each other, without entries of other threads in between */
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    if(sscanf(caLine,"Thread %d, batch %d, line %d/%d",&iThread,&iBatch,&iLine,&iLines)==4)
+    {
+      if((iLine!=iNextLine) || ((iLine) && ((iThread!=iCurrThread) || (iBatch!=iCurrBatch))))
+        break;
+      iCurrThread=iThread;
+      iCurrBatch=iBatch;
+      iNextLine=(iLine+1<iLines)?iLine+1:0;
+    }
+    else if((sscanf(caLine,"Thread %d, single %d",&iThread,&iBatch)!=2) || (iNextLine))
+    {
+      break;
+    }
+    if((iThread<0) || (iThread>=iThreads))
+      break;
+    ++iaEntries[iThread];
+  }
+  if(!feof(fp))
+  {
+    printf("Unexpected entry: %s",caLine);
+    fclose(fp);
+    return(-1);
+  }
+  fclose(fp);
+  for(iThread=0;iThread<iThreads;++iThread)
+  {
+    if(iaEntries[iThread]!=LOGC_TEST_BATCH_COUNT/2*(25+3+2))
+    {
+      printf("Wrong count of entries of thread %d: %d\n",iThread,iaEntries[iThread]);
+      return(-1);
+    }
+  }
+  return(0);
+}
+#endif /* LOGFILE_BATCH_PATH */
+
+#ifdef LOGFILE_INDEX_PATH
+int LogTest_FileIndex_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  int iIndex;
+
+  LOGC_TEST_TRACE("Testing: Index of the logfile");
+  remove(LOGFILE_INDEX_PATH);
+  remove(LOGFILE_INDEX_PATH LOGC_INDEX_SUFFIX);
+  remove(LOGFILE_INDEX_PATH2);
+  remove(LOGFILE_INDEX_PATH2 LOGC_INDEX_SUFFIX);
+  logFile.pcFilePath=LOGFILE_INDEX_PATH;
+  if(!(log=LogC_New(LOGC_ALL,
+                    100,
+                    LOGC_OPTION_PREFIX_LOGTYPETEXT|LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  LOGC_TEST_TEXT(log,LOGC_INFO,"Without index");
+  if(LogC_SetFileIndex(log,LOGC_TEST_INDEX_BLOCKSIZE,0))
+  {
+    puts("LogC_SetFileIndex() failed!");
+    return(-1);
+  }
+  /* Other processes could append to the logfile */
+  if(!LogC_SetFileMode(log,LOGC_FILEMODE_APPEND))
+  {
+    puts("LOGC_FILEMODE_APPEND accepted with an index!");
+    return(-1);
+  }
+  for(iIndex=0;iIndex<100;++iIndex)
+    LOGC_TEST_TEXT(log,(iIndex%25==24)?LOGC_ERROR:LOGC_INFO,"Entry %d",iIndex);
+  /* The index follows the logfile, back to the first one it's continued */
+  if(LogC_SetFilePath(log,LOGFILE_INDEX_PATH2))
+  {
+    puts("LogC_SetFilePath() failed!");
+    return(-1);
+  }
+  for(iIndex=0;iIndex<20;++iIndex)
+    LOGC_TEST_TEXT(log,LOGC_DEBUG,"Second %d",iIndex);
+  if(LogC_SetFilePath(log,LOGFILE_INDEX_PATH))
+  {
+    puts("LogC_SetFilePath() failed!");
+    return(-1);
+  }
+  for(iIndex=100;iIndex<120;++iIndex)
+    LOGC_TEST_TEXT(log,LOGC_WARNING,"Entry %d",iIndex);
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  if((LogTest_CheckFileIndex_m(LOGFILE_INDEX_PATH,LOGFILE_INDEX_PATH LOGC_INDEX_SUFFIX,strlen("[Info]: Without index\n"))) ||
+     (LogTest_CheckFileIndex_m(LOGFILE_INDEX_PATH2,LOGFILE_INDEX_PATH2 LOGC_INDEX_SUFFIX,0)))
+    return(-1);
+  return(0);
+}
+
+/**
+ * Check that the records cover the logfile from szIndexStart to the end without gaps,
+ * and the logtypes of each record are the ones of its entries.
+ */
+int LogTest_CheckFileIndex_m(const char *pcPath,
+                             const char *pcIndexPath,
+                             size_t szIndexStart)
+{
+  static const char *pcaLogTypes[]={"[Debug++]","[Debug]","[Info]","[Warning]","[Error]","[Fatal]"};
+  LogCIndexRecord tagRecord;
+  unsigned long long ullPos=szIndexStart;
+  unsigned long long ullLastTimeMs=0;
+  unsigned int uiLogTypes;
+  char caLog[4096];
+  size_t szLogLength;
+  size_t szIndex;
+  size_t szRecords=0;
+  char *pcLine;
+  FILE *fp;
+
+  if(!(fp=fopen(pcPath,"rb")))
+  {
+    printf("Failed to open \"%s\"!\n",pcPath);
+    return(-1);
+  }
+  szLogLength=fread(caLog,1,sizeof(caLog)-1,fp);
+  fclose(fp);
+  caLog[szLogLength]='\0';
+  if(!(fp=fopen(pcIndexPath,"rb")))
+  {
+    printf("Failed to open \"%s\"!\n",pcIndexPath);
+    return(-1);
+  }
+  while(fread(&tagRecord,sizeof(tagRecord),1,fp)==1)
+  {
+    ++szRecords;
+    if((tagRecord.uiMagic!=LOGC_INDEX_MAGIC) ||
+       (tagRecord.ullOffset!=ullPos) ||
+       (tagRecord.ullOffset+tagRecord.ullLength>szLogLength) ||
+       (tagRecord.ullFirstTimeMs>tagRecord.ullLastTimeMs) ||
+       (tagRecord.ullFirstTimeMs<ullLastTimeMs))
+    {
+      printf("Wrong record %lu in \"%s\"\n",(unsigned long)szRecords,pcIndexPath);
+      fclose(fp);
+      return(-1);
+    }
+    /* Logtypes of the entries in the block */
+    uiLogTypes=0;
+    for(pcLine=&caLog[tagRecord.ullOffset];
+        pcLine<&caLog[tagRecord.ullOffset+tagRecord.ullLength];
+        pcLine=strchr(pcLine,'\n')+1)
+    {
+      for(szIndex=0;szIndex<sizeof(pcaLogTypes)/sizeof(pcaLogTypes[0]);++szIndex)
+      {
+        if(!strncmp(pcLine,pcaLogTypes[szIndex],strlen(pcaLogTypes[szIndex])))
+          uiLogTypes|=1U<<szIndex;
+      }
+    }
+    if((uiLogTypes!=tagRecord.uiLogTypes) || (pcLine!=&caLog[tagRecord.ullOffset+tagRecord.ullLength]))
+    {
+      printf("Wrong logtypes or length of record %lu in \"%s\"\n",(unsigned long)szRecords,pcIndexPath);
+      fclose(fp);
+      return(-1);
+    }
+    ullPos+=tagRecord.ullLength;
+    ullLastTimeMs=tagRecord.ullLastTimeMs;
+  }
+  fclose(fp);
+  /* The last block is written on LogC_End() */
+  if((szRecords<2) || (ullPos!=szLogLength))
+  {
+    printf("Index \"%s\" doesn't cover the logfile: %lu records, %llu of %lu bytes\n",
+           pcIndexPath,(unsigned long)szRecords,ullPos,(unsigned long)szLogLength);
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_INDEX_PATH */
+
+#ifdef LOGFILE_SWAP_PATH
+typedef struct
+{
+  LogC log;
+  int iThread;
+}TagLogTestSwapArg;
+
+void *pvLogTest_FileQueueSwapThread_m(void *pvArg)
+{
+  TagLogTestSwapArg *ptagArg=pvArg;
+  int iIndex;
+  for(iIndex=0;iIndex<LOGC_TEST_SWAP_ENTRIES;++iIndex)
+  {
+    LOGC_TEST_TEXT(ptagArg->log,LOGC_INFO,"Thread %d, entry %d",ptagArg->iThread,iIndex);
+  }
+  return(NULL);
+}
+
+/**
+ * Several threads fill the filequeue, while one of them writes the full queue the others continue
+ * with the second queue. The entries of each thread must reach the logfile complete and in order.
+ */
+int LogTest_FileQueueSwap_g(void)
+{
+  LogC log;
+  LogCFile logFile={0};
+  LogCStats tagStats;
+  pthread_t taThreads[LOGC_TEST_SWAP_THREADS];
+  TagLogTestSwapArg tagaArgs[LOGC_TEST_SWAP_THREADS];
+  int iaNextEntry[LOGC_TEST_SWAP_THREADS]={0};
+  char caLine[100];
+  FILE *fp;
+  int iThread;
+  int iEntry;
+
+  LOGC_TEST_TRACE("Testing: Filequeue written without holding the mutex");
+  remove(LOGFILE_SWAP_PATH);
+  logFile.pcFilePath=LOGFILE_SWAP_PATH;
+  if(!(log=LogC_New(LOGC_ALL,
+                    100,
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR|LOGC_OPTION_THREADSAFE
+                    ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  for(iThread=0;iThread<LOGC_TEST_SWAP_THREADS;++iThread)
+  {
+    tagaArgs[iThread].log=log;
+    tagaArgs[iThread].iThread=iThread;
+    if(pthread_create(&taThreads[iThread],NULL,pvLogTest_FileQueueSwapThread_m,&tagaArgs[iThread]))
+    {
+      puts("pthread_create() failed!");
+      return(-1);
+    }
+  }
+  for(iThread=0;iThread<LOGC_TEST_SWAP_THREADS;++iThread)
+  {
+    pthread_join(taThreads[iThread],NULL);
+  }
+  if((LogC_GetStats(log,&tagStats)) || (LogC_End(log)))
+  {
+    puts("LogC_GetStats() or LogC_End() failed!");
+    return(-1);
+  }
+  if(tagStats.ullFileWriteCount<LOGC_TEST_SWAP_THREADS*LOGC_TEST_SWAP_ENTRIES/10)
+  {
+    printf("Just %llu writes of the filequeue!\n",tagStats.ullFileWriteCount);
+    return(-1);
+  }
+  if(!(fp=fopen(LOGFILE_SWAP_PATH,"r")))
+    return(-1);
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    if((sscanf(caLine,"Thread %d, entry %d",&iThread,&iEntry)!=2) ||
+       (iThread<0) || (iThread>=LOGC_TEST_SWAP_THREADS) ||
+       (iEntry!=iaNextEntry[iThread]++))
+    {
+      printf("Unexpected entry: %s",caLine);
+      fclose(fp);
+      return(-1);
+    }
+  }
+  fclose(fp);
+  for(iThread=0;iThread<LOGC_TEST_SWAP_THREADS;++iThread)
+  {
+    if(iaNextEntry[iThread]!=LOGC_TEST_SWAP_ENTRIES)
+    {
+      printf("Missing entries of thread %d!\n",iThread);
+      return(-1);
+    }
+  }
+  return(0);
+}
+#endif /* LOGFILE_SWAP_PATH */
+
+#ifdef LOGFILE_APPEND_PATH
+/**
+ * Several processes append to the same logfile with LOGC_FILEMODE_APPEND as fast as they can,
+ * afterwards each line must be a complete entry and the entries of each process must be in order.
+ */
+int LogTest_AppendProcesses_g(void)
+{
+  pid_t taPids[LOGC_TEST_APPEND_PROCESSES];
+  int iaNextEntry[LOGC_TEST_APPEND_PROCESSES]={0};
+  char caLine[LOGC_TEST_APPEND_PADDING+100];
+  char caLetter[2]={'\0','\0'};
+  FILE *fp;
+  int iProcess;
+  int iEntry;
+  int iStatus;
+  int iPos;
+  int iRc=0;
+  size_t szLength;
+
+  LOGC_TEST_TRACE("Testing: Several processes appending with LOGC_FILEMODE_APPEND");
+  remove(LOGFILE_APPEND_PATH);
+  fflush(stdout); /* Not written again by the children */
+  for(iProcess=0;iProcess<LOGC_TEST_APPEND_PROCESSES;++iProcess)
+  {
+    if((taPids[iProcess]=fork())<0)
+    {
+      puts("fork() failed!");
+      return(-1);
+    }
+    if(!taPids[iProcess])
+      _exit(LogTest_AppendChild_m(iProcess));
+  }
+  for(iProcess=0;iProcess<LOGC_TEST_APPEND_PROCESSES;++iProcess)
+  {
+    if((waitpid(taPids[iProcess],&iStatus,0)!=taPids[iProcess]) ||
+       (!WIFEXITED(iStatus)) || (WEXITSTATUS(iStatus)))
+    {
+      printf("Process %d failed!\n",iProcess);
+      iRc=-1;
+    }
+  }
+  if(iRc)
+    return(-1);
+  if(!(fp=fopen(LOGFILE_APPEND_PATH,"r")))
+    return(-1);
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    /* "P<process> E<entry> <padding>|end\n", the padding is made of one letter per process */
+    szLength=strlen(caLine);
+    if((sscanf(caLine,"P%d E%d %n",&iProcess,&iEntry,&iPos)!=2) ||
+       (iProcess<0) || (iProcess>=LOGC_TEST_APPEND_PROCESSES) ||
+       (iEntry!=iaNextEntry[iProcess]++) ||
+       (szLength!=iPos+(size_t)(iEntry%LOGC_TEST_APPEND_PADDING)+strlen("|end\n")) ||
+       (caLetter[0]=(char)('a'+iProcess),
+        strspn(&caLine[iPos],caLetter)!=(size_t)(iEntry%LOGC_TEST_APPEND_PADDING)) ||
+       (strcmp(&caLine[szLength-strlen("|end\n")],"|end\n")))
+    {
+      printf("Torn or unexpected entry: %s",caLine);
+      fclose(fp);
+      return(-1);
+    }
+  }
+  fclose(fp);
+  for(iProcess=0;iProcess<LOGC_TEST_APPEND_PROCESSES;++iProcess)
+  {
+    if(iaNextEntry[iProcess]!=LOGC_TEST_APPEND_ENTRIES)
+    {
+      printf("Missing entries of process %d!\n",iProcess);
+      return(-1);
+    }
+  }
+  return(0);
+}
+
+int LogTest_AppendChild_m(int iProcess)
+{
+  LogC log;
+  LogCFile logFile={0};
+  char caPadding[LOGC_TEST_APPEND_PADDING];
+  int iEntry;
+
+  memset(caPadding,'a'+iProcess,sizeof(caPadding));
+  logFile.pcFilePath=LOGFILE_APPEND_PATH;
+  if((!(log=LogC_New(LOGC_ALL,
+                     LOGC_TEST_APPEND_PADDING+50,
+                     LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                     ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                     ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                     ))) ||
+     (LogC_SetFileMode(log,LOGC_FILEMODE_APPEND)))
+    return(1);
+  for(iEntry=0;iEntry<LOGC_TEST_APPEND_ENTRIES;++iEntry)
+  {
+    if(LOG_TEXT(log,LOGC_INFO,"P%d E%d %.*s|end",iProcess,iEntry,iEntry%LOGC_TEST_APPEND_PADDING,caPadding))
+      return(1);
+  }
+  return((LogC_End(log))?1:0);
+}
+#endif /* LOGFILE_APPEND_PATH */
+
+#ifdef LOGFILE_CACHE_FORMAT
+#ifdef LOGC_TEST_CACHE_COUNT_FILES
+int LogTest_CountOpenFiles_m(void)
+{
+  DIR *ptagDir;
+  int iCount=0;
+
+  if(!(ptagDir=opendir("/proc/self/fd")))
+    return(-1);
+  while(readdir(ptagDir))
+  {
+    ++iCount;
+  }
+  closedir(ptagDir);
+  return(iCount);
+}
+#endif /* LOGC_TEST_CACHE_COUNT_FILES */
+
+/**
+ * More Log-Objects than the cache can keep open write their logfiles alternately,
+ * so descriptors are evicted and opened again. No entry may get lost and
+ * the number of open descriptors must stay within the cap.
+ */
+int LogTest_FileCache_g(void)
+{
+  LogC logs[LOGC_TEST_CACHE_LOGS];
+  LogCFile logFile={0};
+  char caaPaths[LOGC_TEST_CACHE_LOGS][32];
+  int iLog;
+  int iEntry;
+  int iRc=0;
+#ifdef LOGC_TEST_CACHE_COUNT_FILES
+  int iOpenFiles;
+#endif /* LOGC_TEST_CACHE_COUNT_FILES */
+
+  LOGC_TEST_TRACE("Testing: Descriptor cache with more logfiles than cached descriptors");
+  if(LogC_SetFileCache(LOGC_TEST_CACHE_MAX))
+  {
+    puts("LogC_SetFileCache() failed!");
+    return(-1);
+  }
+#ifdef LOGC_TEST_CACHE_COUNT_FILES
+  iOpenFiles=LogTest_CountOpenFiles_m();
+#endif /* LOGC_TEST_CACHE_COUNT_FILES */
+  for(iLog=0;iLog<LOGC_TEST_CACHE_LOGS;++iLog)
+  {
+    sprintf(caaPaths[iLog],LOGFILE_CACHE_FORMAT,iLog);
+    remove(caaPaths[iLog]);
+    logFile.pcFilePath=caaPaths[iLog];
+    if(!(logs[iLog]=LogC_New(LOGC_ALL,
+                             100,
+                             LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                             ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                             ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                             )))
+    {
+      puts("LogC_New() failed!");
+      return(-1);
+    }
+  }
+  for(iEntry=0;iEntry<LOGC_TEST_CACHE_ENTRIES;++iEntry)
+  {
+    for(iLog=0;iLog<LOGC_TEST_CACHE_LOGS;++iLog)
+    {
+      LOGC_TEST_TEXT(logs[iLog],LOGC_INFO,"Log %d, entry %d",iLog,iEntry);
+    }
+  }
+  for(iLog=0;iLog<LOGC_TEST_CACHE_LOGS;++iLog)
+  {
+    if(LogC_WriteEntriesToDisk(logs[iLog]))
+    {
+      puts("LogC_WriteEntriesToDisk() failed!");
+      iRc=-1;
+    }
+  }
+#ifdef LOGC_TEST_CACHE_COUNT_FILES
+  if((iOpenFiles<0) || (LogTest_CountOpenFiles_m()!=iOpenFiles+LOGC_TEST_CACHE_MAX))
+  {
+    printf("%d descriptors open instead of %d!\n",LogTest_CountOpenFiles_m()-iOpenFiles,LOGC_TEST_CACHE_MAX);
+    iRc=-1;
+  }
+#endif /* LOGC_TEST_CACHE_COUNT_FILES */
+  for(iLog=0;iLog<LOGC_TEST_CACHE_LOGS;++iLog)
+  {
+    if(LogC_End(logs[iLog]))
+    {
+      puts("LogC_End() failed!");
+      iRc=-1;
+    }
+    if(LogTest_CountFileLines_m(caaPaths[iLog])!=LOGC_TEST_CACHE_ENTRIES)
+    {
+      printf("Logfile \"%s\" doesn't have %d entries!\n",caaPaths[iLog],LOGC_TEST_CACHE_ENTRIES);
+      iRc=-1;
+    }
+  }
+#ifdef LOGC_TEST_CACHE_COUNT_FILES
+  /* LogC_End() closes the descriptor of its logfile */
+  if(LogTest_CountOpenFiles_m()!=iOpenFiles)
+  {
+    puts("Descriptors still open after LogC_End()!");
+    iRc=-1;
+  }
+#endif /* LOGC_TEST_CACHE_COUNT_FILES */
+  /* Disabling the cache closes all descriptors */
+  if(LogC_SetFileCache(0))
+  {
+    puts("LogC_SetFileCache() failed!");
+    iRc=-1;
+  }
+#ifdef LOGC_TEST_CACHE_COUNT_FILES
+  if(LogTest_CountOpenFiles_m()!=iOpenFiles)
+  {
+    puts("Descriptors still open after disabling the cache!");
+    iRc=-1;
+  }
+#endif /* LOGC_TEST_CACHE_COUNT_FILES */
+  return(iRc);
+}
+#endif /* LOGFILE_CACHE_FORMAT */
+
+#ifdef LOGC_TEST_PROFILE_ENTRIES
+int LogTest_Profile_g(void)
+{
+  LogC log;
+  FILE *fp;
+  char caLine[200];
+  unsigned long long ullCount;
+  int iIndex;
+  int iStages=0;
+
+  LOGC_TEST_TRACE("Testing: LOGC_FEATURE_ENABLE_PROFILE");
+  if(!(log=LogC_New(LOGC_ALL,
+                    100,
+                    LOGC_OPTION_PREFIX_TIMESTAMP_TIME|LOGC_OPTION_PREFIX_LOGTYPETEXT|
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+                    ,NULL
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  for(iIndex=0;iIndex<LOGC_TEST_PROFILE_ENTRIES;++iIndex)
+  {
+    LOGC_TEST_TEXT(log,LOGC_INFO,"Profiled entry %d",iIndex);
+  }
+  if(!(fp=tmpfile()))
+    return(-1);
+  if(LogC_DumpProfile(log,fp,1))
+  {
+    puts("LogC_DumpProfile() failed!");
+    fclose(fp);
+    return(-1);
+  }
+  /* Each measured stage has one line with the count of all entries */
+  rewind(fp);
+  while(fgets(caLine,sizeof(caLine),fp))
+  {
+    printf("%s",caLine);
+    if((sscanf(caLine,"addentry count %llu",&ullCount)==1) ||
+       (sscanf(caLine,"timestamp count %llu",&ullCount)==1) ||
+       (sscanf(caLine,"format count %llu",&ullCount)==1))
+    {
+      if(ullCount!=LOGC_TEST_PROFILE_ENTRIES)
+      {
+        puts("Wrong count of measurements!");
+        fclose(fp);
+        return(-1);
+      }
+      ++iStages;
+    }
+  }
+  fclose(fp);
+  if(iStages!=3)
+  {
+    puts("Stages missing in profile!");
+    return(-1);
+  }
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGC_TEST_PROFILE_ENTRIES */
+
+#ifdef LOGC_TEST_SPAN_PATH
+int LogTest_Span_g(void)
+{
+  FILE *fp;
+  char caLine[200];
+  int iIndex;
+  int iDepth=0;
+  int iBegin=0;
+  int iEnd=0;
+  int iQuoted=0;
+
+  LOGC_TEST_TRACE("Testing: LOGC_FEATURE_ENABLE_TRACE");
+  if(LOGC_SPAN_BEGIN("Not running")==0)
+  {
+    puts("Span recorded without a trace!");
+    return(-1);
+  }
+  /* Small buffer, so it's written several times while recording */
+  if(LogC_TraceStart(LOGC_TEST_SPAN_PATH,8))
+  {
+    puts("LogC_TraceStart() failed!");
+    return(-1);
+  }
+  if(LogC_TraceStart(LOGC_TEST_SPAN_PATH,8)==0)
+  {
+    puts("Second trace started!");
+    return(-1);
+  }
+  for(iIndex=0;iIndex<LOGC_TEST_SPAN_LOOPS;++iIndex)
+  {
+    if((LOGC_SPAN_BEGIN_FUNCTION()) ||
+       (LOGC_SPAN_BEGIN("Inner \"quoted\"")) ||
+       (LOGC_SPAN_END()) ||
+       (LOGC_SPAN_END()))
+    {
+      puts("Recording span failed!");
+      return(-1);
+    }
+  }
+  if(LOGC_SPAN_END()==0)
+  {
+    puts("Span ended without begin!");
+    return(-1);
+  }
+  if(LogC_TraceStop())
+  {
+    puts("LogC_TraceStop() failed!");
+    return(-1);
+  }
+  /* One event per line, the spans must be nested */
+  if(!(fp=fopen(LOGC_TEST_SPAN_PATH,"r")))
+    return(-1);
+  if((!fgets(caLine,sizeof(caLine),fp)) || (strcmp(caLine,"{\"traceEvents\":[\n")))
+  {
+    puts("Wrong trace header!");
+    fclose(fp);
+    return(-1);
+  }
+  while((fgets(caLine,sizeof(caLine),fp)) && (caLine[0]=='{'))
+  {
+    if(strstr(caLine,"\"ph\":\"B\""))
+    {
+      ++iBegin;
+      ++iDepth;
+      if(strstr(caLine,"{\"name\":\"Inner \\\"quoted\\\"\""))
+        ++iQuoted;
+    }
+    else if(strstr(caLine,"\"ph\":\"E\""))
+    {
+      ++iEnd;
+      --iDepth;
+    }
+    if((iDepth<0) || (iDepth>2) || (!strstr(caLine,"\"ts\":")) || (!strstr(caLine,"\"tid\":")))
+    {
+      printf("Wrong event: %s",caLine);
+      fclose(fp);
+      return(-1);
+    }
+  }
+  fclose(fp);
+  if((strcmp(caLine,"],\"displayTimeUnit\":\"ns\"}\n")) ||
+     (iBegin!=2*LOGC_TEST_SPAN_LOOPS) || (iEnd!=2*LOGC_TEST_SPAN_LOOPS) || (iQuoted!=LOGC_TEST_SPAN_LOOPS))
+  {
+    printf("Wrong trace: %d begin, %d end, %d escaped names, last line %s",iBegin,iEnd,iQuoted,caLine);
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGC_TEST_SPAN_PATH */
+
+#ifdef LOGC_TEST_SHM_NAME
+int LogTest_Shm_g(void)
+{
+  LogC log;
+  LogCStats stats;
+  LogCShmHeader *ptagHeader;
+  long lLines;
+  pid_t tPid;
+  int iIndex;
+  int iFd;
+
+  LOGC_TEST_TRACE("Testing: LOGC_FEATURE_ENABLE_SHM");
+  if(!(log=LogC_New(LOGC_ALL,
+                    150,
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+                    ,NULL
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  if((LogC_SetShmRing(log,LOGC_TEST_SHM_NAME,LOGC_TEST_SHM_SIZE)) ||
+     (LogC_SetBackpressure(log,LOGC_BACKPRESSURE_DROP_NEWEST,LOGC_NONE,0)))
+  {
+    puts("LogC_SetShmRing() or LogC_SetBackpressure() failed!");
+    return(-1);
+  }
+  /* Map the ring like logc-collector does */
+  if((iFd=shm_open(LOGC_TEST_SHM_NAME,O_RDWR,0))<0)
+  {
+    puts("shm_open() failed!");
+    return(-1);
+  }
+  ptagHeader=mmap(NULL,sizeof(LogCShmHeader)+LOGC_TEST_SHM_SIZE,PROT_READ|PROT_WRITE,MAP_SHARED,iFd,0);
+  close(iFd);
+  if((ptagHeader==MAP_FAILED) || (ptagHeader->uiMagic!=LOGC_SHM_MAGIC) || (ptagHeader->ullDataSize!=LOGC_TEST_SHM_SIZE))
+  {
+    puts("Wrong shared memory ring!");
+    return(-1);
+  }
+  LogCTest_AddTestEntrys_m(log,"Testing shared memory ring...");
+  if(LogTest_ShmConsume_m(ptagHeader)!=LOGC_TEST_ENTRIES_COUNT)
+  {
+    puts("Wrong count of entries in the ring!");
+    return(-1);
+  }
+  LOGC_TEST_TRACE("Fill the ring, until entries are dropped...");
+  for(iIndex=0;iIndex<300;++iIndex)
+  {
+    LOGC_TEST_TEXT(log,LOGC_DEBUG,"Droppable entry %d",iIndex);
+  }
+  if((LogC_GetStats(log,&stats)) ||
+     (!stats.ullDroppedCount) ||
+     ((lLines=LogTest_ShmConsume_m(ptagHeader))+(long)stats.ullDroppedCount!=300))
+  {
+    puts("Wrong count of entries in the ring or dropped entries!");
+    return(-1);
+  }
+  printf("Entries in the ring: %ld, dropped: %llu\n",lLines,stats.ullDroppedCount);
+  /* The marker entry is added before the next entry */
+  LOGC_TEST_TEXT(log,LOGC_INFO,"Ring drained");
+  if(LogTest_ShmConsume_m(ptagHeader)!=2)
+  {
+    puts("Marker entry missing in the ring!");
+    return(-1);
+  }
+  LOGC_TEST_TRACE("The ring of a running process is kept, also for itself...");
+  if((!LogC_SetShmRing(log,LOGC_TEST_SHM_NAME,LOGC_TEST_SHM_SIZE)) || (errno!=EEXIST) || (!ptagHeader->ullClosed))
+  {
+    puts("Ring of a running process replaced!");
+    return(-1);
+  }
+  LOGC_TEST_TRACE("The ring of a process which is gone is replaced...");
+  if((tPid=fork())<0)
+  {
+    puts("fork() failed!");
+    return(-1);
+  }
+  if(!tPid)
+    _exit(0);
+  waitpid(tPid,NULL,0);
+  ptagHeader->ullPid=(unsigned long long)tPid;
+  if(LogC_SetShmRing(log,LOGC_TEST_SHM_NAME,LOGC_TEST_SHM_SIZE))
+  {
+    puts("Ring of a finished process not replaced!");
+    return(-1);
+  }
+  if((LogC_End(log)) || (!ptagHeader->ullClosed))
+  {
+    puts("LogC_End() failed or ring not closed!");
+    return(-1);
+  }
+  munmap(ptagHeader,sizeof(LogCShmHeader)+LOGC_TEST_SHM_SIZE);
+  shm_unlink(LOGC_TEST_SHM_NAME);
+  return(0);
+}
+
+/* Consumes all entries of the ring, returns the count of lines */
+long LogTest_ShmConsume_m(LogCShmHeader *ptagHeader)
+{
+  const char *pcData=(const char*)(ptagHeader+1);
+  unsigned long long ullHead=LOGC_SHM_LOAD_ACQUIRE(&ptagHeader->ullHead);
+  unsigned long long ullPos;
+  long lLines=0;
+
+  for(ullPos=ptagHeader->ullTail;ullPos<ullHead;++ullPos)
+  {
+    if(pcData[ullPos&(ptagHeader->ullDataSize-1)]=='\n')
+      ++lLines;
+  }
+  LOGC_SHM_STORE_RELEASE(&ptagHeader->ullTail,ullHead);
+  return(lLines);
+}
+#endif /* LOGC_TEST_SHM_NAME */
+
+#ifdef LOGC_TEST_SOCKET_PATH
+int LogTest_Socket_g(void)
+{
+  LogC log;
+  LogCStats stats;
+  struct sockaddr_un tagAddr;
+  char caFirst[200];
+  long lReceived;
+  int iServer;
+#ifdef LOGFILE_SOCKET_PATH
+  LogCFile logFile={0};
+  logFile.pcFilePath=LOGFILE_SOCKET_PATH;
+  remove(LOGFILE_SOCKET_PATH);
+#endif /* LOGFILE_SOCKET_PATH */
+
+  LOGC_TEST_TRACE("Testing: LOGC_FEATURE_ENABLE_SOCKET");
+  /* Local datagram server, standing in for the syslog daemon */
+  unlink(LOGC_TEST_SOCKET_PATH);
+  memset(&tagAddr,0,sizeof(tagAddr));
+  tagAddr.sun_family=AF_UNIX;
+  strcpy(tagAddr.sun_path,LOGC_TEST_SOCKET_PATH);
+  if(((iServer=socket(AF_UNIX,SOCK_DGRAM,0))<0) ||
+     (bind(iServer,(struct sockaddr*)&tagAddr,sizeof(tagAddr))))
+  {
+    puts("Failed to create the socket server!");
+    return(-1);
+  }
+  if(!(log=LogC_New(LOGC_ALL,
+                    150,
+                    LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+                    ,&logFile
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                    ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                    )))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  if(LogC_SetSocket(log,LOGC_TEST_SOCKET_PATH,LOGC_SOCKET_SYSLOG,1))
+  {
+    puts("LogC_SetSocket() failed!");
+    return(-1);
+  }
+  LogCTest_AddTestEntrys_m(log,"Testing socket...");
+  if((LogC_SocketFlush(log)) || (LogC_GetStats(log,&stats)))
+  {
+    puts("LogC_SocketFlush() or LogC_GetStats() failed!");
+    return(-1);
+  }
+  lReceived=LogTest_SocketReceive_m(iServer,caFirst,sizeof(caFirst));
+  printf("Received %ld datagrams with %llu syscalls, first: \"%s\"\n",lReceived,stats.ullSocketSendCount,caFirst);
+  if((lReceived!=LOGC_TEST_ENTRIES_COUNT) || (stats.ullSocketSendCount!=1) || (strncmp(caFirst,"<14>",4)))
+  {
+    puts("Wrong datagrams received!");
+    return(-1);
+  }
+  LOGC_TEST_TRACE("Stopping the server, the entries must be passed to the fallback...");
+  close(iServer);
+  unlink(LOGC_TEST_SOCKET_PATH);
+  LogCTest_AddTestEntrys_m(log,"Testing socket fallback...");
+  if((!LogC_SocketFlush(log)) || (LogC_GetStats(log,&stats)) || (stats.ullSocketUnsentCount!=LOGC_TEST_ENTRIES_COUNT))
+  {
+    puts("Entries not passed to the fallback!");
+    return(-1);
+  }
+  if(LogC_End(log))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+#ifdef LOGFILE_SOCKET_PATH
+  if(LogTest_CountFileLines_m(LOGFILE_SOCKET_PATH)!=LOGC_TEST_ENTRIES_COUNT)
+  {
+    puts("Wrong count of lines in the fallback logfile!");
+    return(-1);
+  }
+#endif /* LOGFILE_SOCKET_PATH */
+  return(0);
+}
+
+/* Receives all pending datagrams, returns the count and copies the first one */
+long LogTest_SocketReceive_m(int iFd,
+                             char *pcFirst,
+                             size_t szFirstSize)
+{
+  char caBuffer[200];
+  ssize_t sszLength;
+  long lCount=0;
+
+  *pcFirst='\0';
+  while((sszLength=recv(iFd,caBuffer,sizeof(caBuffer)-1,MSG_DONTWAIT))>=0)
+  {
+    caBuffer[sszLength]='\0';
+    if(!lCount++)
+      snprintf(pcFirst,szFirstSize,"%s",caBuffer);
+  }
+  return(lCount);
+}
+#endif /* LOGC_TEST_SOCKET_PATH */
+
+#ifdef LOGFILE_SHARED_PATH
+int LogTest_SharedFile_g(void)
+{
+  LogC logA;
+  LogC logB;
+  LogCFile logFile={0};
+  int iIndex;
+
+  LOGC_TEST_TRACE("Testing: Two Log-Objects appending to the same logfile");
+  remove(LOGFILE_SHARED_PATH);
+  logFile.pcFilePath=LOGFILE_SHARED_PATH;
+  if((!(logA=LogC_New(LOGC_ALL,
+                      100,
+                      LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                      ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                      ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                      ))) ||
+     (!(logB=LogC_New(LOGC_ALL,
+                      100,
+                      LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                      ,&logFile
+#ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                      ,0
+#endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                      ))))
+  {
+    puts("LogC_New() failed!");
+    return(-1);
+  }
+  /* Both write their queues alternately, none may overwrite the entries of the other one */
+  for(iIndex=0;iIndex<LOGC_TEST_SHARED_ENTRIES;++iIndex)
+  {
+    LOGC_TEST_TEXT(logA,LOGC_INFO,"Entry %d of A",iIndex);
+    LOGC_TEST_TEXT(logB,LOGC_INFO,"Entry %d of B",iIndex);
+    if((iIndex%7==6) && ((LogC_WriteEntriesToDisk(logA)) || (LogC_WriteEntriesToDisk(logB))))
+    {
+      puts("LogC_WriteEntriesToDisk() failed!");
+      return(-1);
+    }
+  }
+  if((LogC_End(logA)) || (LogC_End(logB)))
+  {
+    puts("LogC_End() failed!");
+    return(-1);
+  }
+  if(LogTest_CountFileLines_m(LOGFILE_SHARED_PATH)!=2*LOGC_TEST_SHARED_ENTRIES)
+  {
+    puts("Entries of the shared logfile overwritten!");
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGFILE_SHARED_PATH */
+
+#ifdef LOG_MAX_STORAGE_COUNT
+int LogTest_Storage_g(LogC log)
+{
+  size_t szLength;
+  int iLogsCount=0;
+  char *pcLogText;
+  LogCStorageQuery query;
+  LogCStorageEntry *entries;
+  size_t szCount;
+  size_t szIndex;
+  LOGC_TEST_TRACE("Testing: LOGC_FEATURE_ENABLE_LOG_STORAGE");
+  LOGC_TEST_TRACE("Query stored logs, errors and above...");
+  memset(&query,0,sizeof(query));
+  query.iMinLogType=LOGC_ERROR;
+  query.ullTimeFromMs=(unsigned long long)(time(NULL)-300)*1000; /* Last 5 minutes */
+  if(!(entries=LogC_StorageQuery(log,&query,&szCount)))
+  {
+    printf("LogC_StorageQuery() returned no entries\n");
+    return(-1);
+  }
+  for(szIndex=0;szIndex<szCount;++szIndex)
+  {
+    printf("Entry %llu, type %d: \"%s\"\n",entries[szIndex].ullCursor,entries[szIndex].iLogType,entries[szIndex].pcText);
+    if(entries[szIndex].iLogType<LOGC_ERROR)
+    {
+      printf("Error in LogC_StorageQuery(), wrong logtype\n");
+      return(-1);
+    }
+  }
+  /* Continue after the first entry */
+  query.ullAfterCursor=entries[0].ullCursor;
+  query.szMaxCount=1;
+  free(entries);
+  entries=LogC_StorageQuery(log,&query,&szIndex);
+  if((szCount<2) || (szIndex!=1) || (entries[0].ullCursor<=query.ullAfterCursor))
+  {
+    printf("Error in LogC_StorageQuery() with cursor\n");
+    return(-1);
+  }
+  free(entries);
+  query.ullAfterCursor=0;
+  query.ullTimeFromMs=(unsigned long long)(time(NULL)+60)*1000;
+  if((entries=LogC_StorageQuery(log,&query,&szCount)))
+  {
+    printf("Error in LogC_StorageQuery(), entries in the future\n");
+    return(-1);
+  }
   LOGC_TEST_TRACE("Get all stored logs and print them...");
   while((pcLogText=LogC_StorageGetNextLog(log,&szLength)))
   {
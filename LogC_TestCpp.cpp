@@ -0,0 +1,144 @@
+/**
+ * Checks that LOG_TEXT_CPP() of LogC.hpp writes the same entries as LOG_TEXT():
+ * each case is logged with both macros to their own logfile, then the files are compared byte by byte.
+ */
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include "LogC.hpp"
+
+#define LOGC_TEST_TRACE(txt) puts("LOGC_TEST: " txt "\n" \
+                                  "--------------------------------------------------------------------------------")
+
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  #define LOGFILE_C_PATH   "TestCpp_C.log"
+  #define LOGFILE_CPP_PATH "TestCpp_Cpp.log"
+  #define LOGC_TEST_MAX_ENTRY_LENGTH 160 /* Small, so the truncation is checked too */
+
+/* Logs the same case with both macros */
+  #define LOGC_TEST_BOTH(logtype,...) do { assert(!LOG_TEXT(logC,logtype,__VA_ARGS__)); \
+                                           assert(!LOG_TEXT_CPP(logCpp,logtype,__VA_ARGS__)); } while(0)
+
+struct Point
+{
+  int iX;
+  int iY;
+};
+
+template<>
+struct logc::Formatter<Point>
+{
+  static void Append(logc::Appender &appender,
+                     const Point &point)
+  {
+    char caText[32];
+    int iLength=std::snprintf(caText,sizeof(caText),"(%d,%d)",point.iX,point.iY);
+    appender.Append(caText,static_cast<std::size_t>(iLength));
+  }
+};
+
+static LogC LogTestCpp_New_m(const char *pcPath)
+{
+  LogCFile tagFile={};
+
+  tagFile.pcFilePath=pcPath;
+  std::remove(pcPath);
+  return(LogC_New(LOGC_INFO,
+                  LOGC_TEST_MAX_ENTRY_LENGTH,
+                  LOGC_OPTION_PREFIX_LOGTYPETEXT|LOGC_OPTION_PREFIX_FUNCTIONNAME|
+                  LOGC_OPTION_IGNORE_STDOUT|LOGC_OPTION_IGNORE_STDERR
+                  ,&tagFile
+  #ifdef LOGC_FEATURE_ENABLE_LOG_STORAGE
+                  ,0
+  #endif /* LOGC_FEATURE_ENABLE_LOG_STORAGE */
+                  ));
+}
+
+static std::string LogTestCpp_ReadFile_m(const char *pcPath)
+{
+  std::string strContent;
+  char caBuffer[512];
+  std::size_t szRead;
+  FILE *fpFile;
+
+  if(!(fpFile=std::fopen(pcPath,"rb")))
+    return(strContent);
+  while((szRead=std::fread(caBuffer,1,sizeof(caBuffer),fpFile)))
+    strContent.append(caBuffer,szRead);
+  std::fclose(fpFile);
+  return(strContent);
+}
+
+static int LogTestCpp_Compare_g(void)
+{
+  LogC logC;
+  LogC logCpp;
+  Point tagPoint={-1,2};
+  std::string strLong(200,'x');
+  std::string strText("text");
+  std::string_view svText("view of a text");
+  const char *pcNull=NULL;
+  const char caNoEnd[3]={'a','b','c'}; /* Without '\0', just read up to the precision */
+  int iValue=42;
+  std::string strC;
+  std::string strCpp;
+
+  LOGC_TEST_TRACE("Compare LOG_TEXT() and LOG_TEXT_CPP()");
+  assert((logC=LogTestCpp_New_m(LOGFILE_C_PATH)));
+  assert((logCpp=LogTestCpp_New_m(LOGFILE_CPP_PATH)));
+
+  LOGC_TEST_BOTH(LOGC_INFO,"Just a text");
+  LOGC_TEST_BOTH(LOGC_INFO,"100%% done, %d%%",100);
+  LOGC_TEST_BOTH(LOGC_WARNING,"int %d %i %d %d",0,-7,INT_MIN,INT_MAX);
+  LOGC_TEST_BOTH(LOGC_WARNING,"unsigned %u %x %X %o %x",4000000000U,0xbeefU,0xBEEFU,8U,-1);
+  LOGC_TEST_BOTH(LOGC_ERROR,"long %ld %lu %lld %llu",LONG_MIN,ULONG_MAX,LLONG_MIN,ULLONG_MAX);
+  LOGC_TEST_BOTH(LOGC_ERROR,"size %zu, short %hd %hu %hhd %hhu %hx",sizeof(Point),70000,-1,300,-1,70000);
+  LOGC_TEST_BOTH(LOGC_INFO,"flags [%5d][%-5d][%05d][%+d][% d][%#x][%#o][%.3d][%8.3x]",1,2,3,4,5,255,8,6,7);
+  LOGC_TEST_BOTH(LOGC_INFO,"char [%c][%3c][%-3c]",'a','b','c');
+  LOGC_TEST_BOTH(LOGC_INFO,"double %f %.2f %e %g %G",3.14159,-2.5,12345.678,0.0001,1e20);
+  LOGC_TEST_BOTH(LOGC_INFO,"double [%10.3f][%-10.1e][%+.0f][%a]",2.0/3.0,-1.0/3.0,0.5,1.0);
+  LOGC_TEST_BOTH(LOGC_INFO,"pointer %p",static_cast<void*>(&iValue));
+  LOGC_TEST_BOTH(LOGC_INFO,"string [%s][%.2s][%8s][%-8s][%s]","abc","abc","abc","abc",pcNull);
+  LOGC_TEST_BOTH(LOGC_INFO,"unterminated [%.3s][%5.2s]",caNoEnd,static_cast<const char*>(caNoEnd));
+  assert(!LOG_TEXT(logC,LOGC_INFO,"std [%s][%6.4s][%s]",strText.c_str(),svText.data(),"(-1,2)"));
+  assert(!LOG_TEXT_CPP(logCpp,LOGC_INFO,"std [%s][%6.4s][%s]",strText,svText,tagPoint));
+  LOGC_TEST_BOTH(LOGC_INFO,"Ends with a newline\n");
+  /* Truncated to LOGC_TEST_MAX_ENTRY_LENGTH */
+  LOGC_TEST_BOTH(LOGC_ERROR,"long %s end",strLong.c_str());
+  LOGC_TEST_BOTH(LOGC_ERROR,"long %d %s",iValue,strLong.c_str());
+  LOGC_TEST_BOTH(LOGC_ERROR,"A long literal without arguments, LOG_TEXT() adds it without formatting, "
+                            "but it must be truncated just like a formatted text with the same length, e.g. this one");
+  /* Below the loglevel, not written */
+  LOGC_TEST_BOTH(LOGC_DEBUG,"Not written %d",iValue);
+
+  assert(!LogC_End(logC));
+  assert(!LogC_End(logCpp));
+  strC=LogTestCpp_ReadFile_m(LOGFILE_C_PATH);
+  strCpp=LogTestCpp_ReadFile_m(LOGFILE_CPP_PATH);
+  if((strC.empty()) || (strC!=strCpp))
+  {
+    std::fprintf(stderr,"Logfiles differ:\n%s\n---\n%s\n",strC.c_str(),strCpp.c_str());
+    return(-1);
+  }
+  return(0);
+}
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+
+int main(void)
+{
+#ifdef LOGC_FEATURE_ENABLE_LOGFILE
+  if(LogTestCpp_Compare_g())
+  {
+    LOGC_TEST_TRACE("Tests failed");
+    return(EXIT_FAILURE);
+  }
+  LOGC_TEST_TRACE("Tests passed");
+#else
+  LOGC_TEST_TRACE("Tests skipped, needs LOGC_FEATURE_ENABLE_LOGFILE");
+#endif /* LOGC_FEATURE_ENABLE_LOGFILE */
+  return(EXIT_SUCCESS);
+}